@@ -9,10 +9,34 @@ package zenroom
 // #include <stdlib.h>
 // #include <string.h>
 // #include "zenroom.h"
-// typedef int(*fun)(char*, char*, char*, char*, char*, size_t, char*, size_t);
+// typedef int(*fun_cb)(char*, char*, const char*, size_t, const char*, size_t, zen_write_t, zen_write_t, void*);
 //
-// int wrapper(fun exec, char* script, char* conf, char* data, char* keys, char* stdout, size_t stdout_size, char* stderr, size_t stderr_size) {
-//     return exec(script, conf, data, keys, stdout, stdout_size, stderr, stderr_size);
+// // growable buffers collecting output and logs through callbacks
+// typedef struct { char *buf; size_t len; size_t max; } zenbuf;
+// typedef struct { zenbuf out; zenbuf err; } zenbufs;
+//
+// static int zenbuf_append(zenbuf *b, const char *s, size_t len) {
+//     if(b->len + len > b->max) {
+//         size_t max = b->max ? b->max : 4096;
+//         while(max < b->len + len) max *= 2;
+//         char *buf = realloc(b->buf, max);
+//         if(!buf) return 1;
+//         b->buf = buf;
+//         b->max = max;
+//     }
+//     memcpy(b->buf + b->len, s, len);
+//     b->len += len;
+//     return 0;
+// }
+// static int zenbuf_out(void *ctx, const char *s, size_t len) {
+//     return zenbuf_append(&((zenbufs*)ctx)->out, s, len);
+// }
+// static int zenbuf_err(void *ctx, const char *s, size_t len) {
+//     return zenbuf_append(&((zenbufs*)ctx)->err, s, len);
+// }
+//
+// int wrapper_cb(fun_cb exec, char* script, char* conf, const char* keys, size_t keys_len, const char* data, size_t data_len, zenbufs *bufs) {
+//     return exec(script, conf, keys, keys_len, data, data_len, zenbuf_out, zenbuf_err, bufs);
 // }
 import "C"
 
@@ -20,16 +44,13 @@ import (
 	"unsafe"
 )
 
-// maxString is zenroom defined buffer MAX_STRING size
-const BUFSIZE = 2 * 1024 * 1024
-
 type ZenResult struct {
     Output string;
     Logs string;
 }
 
 // ZenroomExec is our primary public API method, and it is here that we call Zenroom's
-// zenroom_exec_tobuf function. This method attempts to pass a required script,
+// zenroom_exec_cb function. This method attempts to pass a required script,
 // and some optional extra parameters to the Zenroom virtual machine, where
 // cryptographic operations are performed with the result being returned to the
 // caller. The method signature has been tweaked slightly from the original
@@ -41,69 +62,75 @@ type ZenResult struct {
 // Returns the output of the execution of the Zenroom virtual machine, or an
 // error.
 func ZenroomExec(script string, conf string, keys string, data string) (ZenResult, bool) {
-	exec := C.fun(C.zenroom_exec_tobuf)
-	return wrapper(exec, script, conf, keys, data)
+	exec := C.fun_cb(C.zenroom_exec_cb)
+	return wrapper(exec, script, conf, []byte(keys), []byte(data))
 }
 
 func ZencodeExec(script string, conf string, keys string, data string) (ZenResult, bool) {
-	exec := C.fun(C.zencode_exec_tobuf)
+	exec := C.fun_cb(C.zencode_exec_cb)
+	return wrapper(exec, script, conf, []byte(keys), []byte(data))
+}
+
+// ZenroomExecBytes and ZencodeExecBytes take keys and data as byte
+// slices which may contain binary data, for instance MessagePack or
+// CBOR. They are passed to Zenroom without copies and, configured
+// with "input=octet", are read by scripts in place as octets.
+func ZenroomExecBytes(script string, conf string, keys []byte, data []byte) (ZenResult, bool) {
+	exec := C.fun_cb(C.zenroom_exec_cb)
 	return wrapper(exec, script, conf, keys, data)
 }
 
-func wrapper(fun C.fun, script string, conf string, keys string, data string) (ZenResult, bool) {
-	var (
-		cScript, cConf, cKeys, cData *C.char
-	)
+func ZencodeExecBytes(script string, conf string, keys []byte, data []byte) (ZenResult, bool) {
+	exec := C.fun_cb(C.zencode_exec_cb)
+	return wrapper(exec, script, conf, keys, data)
+}
 
-	cScript = C.CString(script)
+// bytesPointer returns the address of the first byte, or nil if empty
+func bytesPointer(b []byte) *C.char {
+	if len(b) == 0 {
+		return nil
+	}
+	return (*C.char)(unsafe.Pointer(&b[0]))
+}
+
+// wrapper collects output and logs in buffers growing as they are
+// printed, so nothing is allocated in advance nor truncated
+func wrapper(fun C.fun_cb, script string, conf string, keys []byte, data []byte) (ZenResult, bool) {
+	var cConf *C.char
+
+	cScript := C.CString(script)
 	defer C.free(unsafe.Pointer(cScript))
 
 	if conf != "" {
 		cConf = C.CString(conf)
 		defer C.free(unsafe.Pointer(cConf))
-	} else {
-		cConf = nil
 	}
 
+	bufs := (*C.zenbufs)(C.calloc(1, C.sizeof_zenbufs))
+	defer func() {
+		C.free(unsafe.Pointer(bufs.out.buf))
+		C.free(unsafe.Pointer(bufs.err.buf))
+		C.free(unsafe.Pointer(bufs))
+	}()
 
-	if data != "" {
-		cData = C.CString(data)
-		defer C.free(unsafe.Pointer(cData))
-	} else {
-		cData = nil
-	}
-
-	if keys != "" {
-		cKeys = C.CString(keys)
-		defer C.free(unsafe.Pointer(cKeys))
-	} else {
-		cKeys = nil
-	}
-
-	// create empty strings to capture zenroom's output
-	stdout := emptyString(BUFSIZE)
-	stderr := emptyString(BUFSIZE)
-	defer C.free(unsafe.Pointer(stdout))
-	defer C.free(unsafe.Pointer(stderr))
-
-	res := C.wrapper(
+	res := C.wrapper_cb(
 		fun,
-		cScript,
-		cConf, cKeys, cData,
-		stdout, BUFSIZE,
-		stderr, BUFSIZE,
+		cScript, cConf,
+		bytesPointer(keys), C.size_t(len(keys)),
+		bytesPointer(data), C.size_t(len(data)),
+		bufs,
 	)
 
 	zen_res := ZenResult{
-		Output: C.GoString(stdout),
-		Logs: C.GoString(stderr),
+		Output: C.GoStringN(bufs.out.buf, C.int(bufs.out.len)),
+		Logs: C.GoStringN(bufs.err.buf, C.int(bufs.err.len)),
 	}
 
 	return zen_res, res == 0
 }
 
 // ZencodeExec is our primary public API method, and it is here that we call Zenroom's
-// zencode_exec_tobuf function. This method attempts to pass a required script,
+// zencode_exec_cb function. This method attempts to pass a required script,
 // and some optional extra parameters to the Zenroom virtual machine, where
 // cryptographic operations are performed with the result being returned to the
 // caller. The method signature has been tweaked slightly from the original
@@ -114,9 +141,3 @@ func wrapper(fun C.fun, script string, conf string, keys string, data string) (Z
 //
 // Returns the output of the execution of the Zenroom virtual machine, or an
 // error.
-
-// reimplementation of https://golang.org/src/strings/strings.go?s=13172:13211#L522
-func emptyString(size int) *C.char {
-	p := C.malloc(C.size_t(size))
-	return (*C.char)(p)
-}
@@ -58,6 +58,28 @@ Then print my data`
 	}
 }
 
+func TestBigOutput(t *testing.T) {
+	// larger than the fixed buffers used before, must not be truncated
+	res, _ := ZenroomExec("print(string.rep('x', 4 * 1024 * 1024))", "", "", "")
+	if len(res.Output) != 4*1024*1024+1 {
+		t.Errorf("big output truncated to %d bytes", len(res.Output))
+	}
+}
+
+func TestZencodeBytes(t *testing.T) {
+	script := `rule input format mpack
+Given I have a 'hex' named 'oct'
+Then print the 'oct'`
+	// MessagePack { "oct": 00ff00 } with zero bytes
+	data := []byte("\x81\xa3oct\xc4\x03\x00\xff\x00")
+	for _, conf := range []string{"", "input=octet"} {
+		res, success := ZencodeExecBytes(script, conf, nil, data)
+		if !success || res.Output != "{\"oct\":\"00ff00\"}\n" {
+			t.Errorf("binary data with conf [%s] got %s\n%s", conf, res.Output, res.Logs)
+		}
+	}
+}
+
 // func BenchmarkBasicPrint(b *testing.B) {
 // 	script := []byte(`print ('hello')`)
 // 	for n := 0; n < b.N; n++ {
@@ -70,8 +70,13 @@ ZENROOM_SOURCES = [
     'zen_memory.c',
     'zen_octet.c',
     'zen_parse.c',
+    'zen_json.c',
+    'zen_pack.c',
     'zen_qp.c',
     'zen_ed.c',
+    'zen_rlp.c',
+    'zen_octet_set.c',
+    'zen_lagrange.c',
     'zen_random.c',
     'zenroom.c',
     'zen_ecdh_factory.c'
@@ -1,6 +1,8 @@
+import ctypes as ct
 import pytest
 from schema import Schema, Regex
-from zenroom import zenroom_exec, zencode_exec
+from zenroom import zenroom_exec, zencode_exec, zenroom_exec_bytes, zencode_exec_bytes
+from zenroom.zenroom import _LIBZENROOM
 
 
 def test_zencode_call_random_array():
@@ -33,3 +35,68 @@ def test_lua_call_hello_world():
         "print('hello world')"
     )
     assert lua_res.output == 'hello world'
+
+def test_zencode_binary_data():
+    contract = """rule input format mpack
+Given I have a 'hex' named 'oct'
+Then print the 'oct'
+"""
+    # MessagePack { "oct": 00ff00 } with zero bytes
+    data = b'\x81\xa3oct\xc4\x03\x00\xff\x00'
+    for conf in (None, 'input=octet'):
+        res = zencode_exec_bytes(contract, conf=conf, data=data)
+        assert res.result == {'oct': '00ff00'}
+
+def test_lua_call_big_output():
+    # larger than the fixed buffers used before, must not be truncated
+    lua_res = zenroom_exec(
+        "print(string.rep('x', 4 * 1024 * 1024))"
+    )
+    assert lua_res.output == 'x' * 4 * 1024 * 1024
+
+def _exec_tobuf(script):
+    # runs with the fixed output buffers of the C API
+    stdout = ct.create_string_buffer(4096)
+    stderr = ct.create_string_buffer(4096)
+    _LIBZENROOM.zenroom_exec_tobuf(
+        ct.c_char_p(script.encode()), None, None, None,
+        stdout, ct.c_size_t(len(stdout)),
+        stderr, ct.c_size_t(len(stderr)))
+    return stdout.raw
+
+def test_lua_json_print_failure_tobuf():
+    # a failed encoding prints nothing in the buffer
+    out = _exec_tobuf(
+        "print('before') JSON.print({a=1, b={[1]=1,[3]=3}})")
+    assert out.split(b'\0')[0] == b'before\n'
+
+def test_lua_mpack_print_failure_tobuf():
+    out = _exec_tobuf(
+        "print('before') local t={a=1,b={}} t.b.c=t; mpack_print(t)")
+    assert out.split(b'\0')[0] == b'before\n'
+
+def test_zencode_binary_output():
+    contract = """rule input format mpack
+rule output format mpack
+Given I have a 'hex' named 'oct'
+Then print the 'oct'
+"""
+    data = b'\x81\xa3oct\xc4\x03\x00\xff\x00'
+    res = zencode_exec_bytes(contract, data=data)
+    assert res.output == data
+    assert res.result is None
+
+def test_lua_borrowed_input_read_only():
+    # with input=octet DATA points to the bytes passed, which are const
+    data = b'\x00\x01\x02'
+    res = zenroom_exec_bytes("DATA:fill(O.from_hex('ff'))",
+                             conf='input=octet', data=data)
+    assert 'read-only' in res.logs
+    assert data == b'\x00\x01\x02'
+
+def test_lua_qp_implementation_per_context():
+    # switching implementation does not leak into the next context
+    impl = zenroom_exec("print(require'qp'.implementation())").output
+    res = zenroom_exec("print(require'qp'.implementation('clean'))")
+    assert res.output == 'clean'
+    assert zenroom_exec("print(require'qp'.implementation())").output == impl
@@ -2,10 +2,14 @@ from zenroom.zenroom import (
     ZenResult,
     zencode_exec,
     zenroom_exec,
+    zencode_exec_bytes,
+    zenroom_exec_bytes,
 )
 
 __all__ = [
     'ZenResult',
     'zencode_exec',
     'zenroom_exec',
+    'zencode_exec_bytes',
+    'zenroom_exec_bytes',
 ]
@@ -4,6 +4,7 @@ import io
 import json
 import ctypes as ct
 from dataclasses import dataclass, field
+from typing import Union
 
 from zenroom._config import LIBZENROOM_LOC
 
@@ -13,13 +14,13 @@ _LIBZENROOM = ct.CDLL(str(LIBZENROOM_LOC))
 
 @dataclass
 class ZenResult():
-    output: str = field()
+    output: Union[str, bytes] = field()
     logs: str = field()
 
     def __post_init__(self):
         try:
             self.result = json.loads(self.output)
-        except json.JSONDecodeError:
+        except (json.JSONDecodeError, UnicodeDecodeError):
             self.result = None
 
 
@@ -27,32 +28,68 @@ def _char_p(x):
     return ct.c_char_p(None if x is None else x.encode())
 
 
-def _apply_call(call, script, conf, keys, data):
-    # 2MB
-    stdout_len = 2 * 1024 * 1024
-    stdout_buf = ct.create_string_buffer(stdout_len)
-    # 64kB
-    stderr_len = 64 * 1024
-    stderr_buf = ct.create_string_buffer(stderr_len)
+def _bytes_len(x):
+    # bytes are passed without copies, strings are encoded
+    if x is None:
+        return None, 0
+    if isinstance(x, str):
+        x = x.encode()
+    return bytes(x), len(x)
+
+
+_WRITE_CB = ct.CFUNCTYPE(ct.c_int, ct.c_void_p, ct.POINTER(ct.c_char), ct.c_size_t)
+
+
+def _apply_call(call, script, conf, keys, data, raw=False):
+    # output and logs are collected by callbacks as they are printed,
+    # with no size limit and no buffer allocated in advance. The raw
+    # output is returned as bytes, as binary formats print it
+    stdout, stderr = [], []
+
+    def _collect(chunks):
+        def write(_ctx, buf, length):
+            chunks.append(ct.string_at(buf, length))
+            return 0
+        return _WRITE_CB(write)
+
+    stdout_cb = _collect(stdout)
+    stderr_cb = _collect(stderr)
+    keys, keys_len = _bytes_len(keys)
+    data, data_len = _bytes_len(data)
     call(
         _char_p(script),
         _char_p(conf),
-        _char_p(keys),
-        _char_p(data),
-        stdout_buf,
-        stdout_len,
-        stderr_buf,
-        stderr_len,
+        ct.c_char_p(keys),
+        ct.c_size_t(keys_len),
+        ct.c_char_p(data),
+        ct.c_size_t(data_len),
+        stdout_cb,
+        stderr_cb,
+        None,
     )
+    output = b''.join(stdout)
     return ZenResult(
-        stdout_buf.value.decode().strip(),
-        stderr_buf.value.decode().strip(),
+        output if raw else output.decode().strip(),
+        b''.join(stderr).decode().strip(),
     )
 
 
 def zenroom_exec(script, conf=None, keys=None, data=None):
-    return _apply_call(_LIBZENROOM.zenroom_exec_tobuf, script, conf, keys, data)
+    return _apply_call(_LIBZENROOM.zenroom_exec_cb, script, conf, keys, data)
 
 
 def zencode_exec(script, conf=None, keys=None, data=None):
-    return _apply_call(_LIBZENROOM.zencode_exec_tobuf, script, conf, keys, data)
+    return _apply_call(_LIBZENROOM.zencode_exec_cb, script, conf, keys, data)
+
+
+# keys and data are bytes and may contain binary data, for instance
+# MessagePack or CBOR, use conf "input=octet" to skip copies in Zenroom.
+# The output is the bytes printed, also when binary
+def zenroom_exec_bytes(script, conf=None, keys=None, data=None):
+    return _apply_call(_LIBZENROOM.zenroom_exec_cb, script, conf, keys, data,
+                       raw=True)
+
+
+def zencode_exec_bytes(script, conf=None, keys=None, data=None):
+    return _apply_call(_LIBZENROOM.zencode_exec_cb, script, conf, keys, data,
+                       raw=True)
@@ -1,5 +1,5 @@
 from enum import Enum
-from typing import Any, Callable, Optional, Mapping
+from typing import Any, Callable, Optional, Mapping, Tuple, Union
 from ctypes import CDLL
 
 
@@ -7,7 +7,7 @@ _LIBZENROOM: CDLL
 
 
 class ZenResult:
-    output: str = ...
+    output: Union[str, bytes] = ...
     logs: str = ...
     result: Optional[Mapping] = ...
 
@@ -18,12 +18,17 @@ class ZenResult:
         ...
 
 
+def _bytes_len(x: Optional[Union[str, bytes]]) -> Tuple[Optional[bytes], int]:
+    ...
+
+
 def _apply_call(
         call: Callable,
         script: str,
         conf: Optional[str],
-        keys: Optional[str],
-        data: Optional[str]) -> ZenResult:
+        keys: Optional[Union[str, bytes]],
+        data: Optional[Union[str, bytes]],
+        raw: bool = ...) -> ZenResult:
     ...
 
 
@@ -41,3 +46,19 @@ def zencode_exec(
         keys: Optional[str],
         data: Optional[str]) -> ZenResult:
     ...
+
+
+def zenroom_exec_bytes(
+        script: str,
+        conf: Optional[str],
+        keys: Optional[Union[str, bytes]],
+        data: Optional[Union[str, bytes]]) -> ZenResult:
+    ...
+
+
+def zencode_exec_bytes(
+        script: str,
+        conf: Optional[str],
+        keys: Optional[Union[str, bytes]],
+        data: Optional[Union[str, bytes]]) -> ZenResult:
+    ...
@@ -1,4 +1,4 @@
-use std::ffi::{CStr, CString};
+use std::ffi::CString;
 use std::fmt;
 use std::sync::{Mutex, MutexGuard, Once};
 
@@ -54,17 +54,16 @@ fn aquire_zen_gil() -> ZenGIL {
     mutex.lock().unwrap()
 }
 
-const BUF_SIZE: usize = 2 * 1024 * 1024;
-
-type Fun = unsafe extern "C" fn(
-    *mut ::std::os::raw::c_char,
-    *mut ::std::os::raw::c_char,
-    *mut ::std::os::raw::c_char,
+type FunCb = unsafe extern "C" fn(
     *mut ::std::os::raw::c_char,
     *mut ::std::os::raw::c_char,
-    ::std::os::raw::c_ulong,
-    *mut ::std::os::raw::c_char,
-    ::std::os::raw::c_ulong,
+    *const ::std::os::raw::c_char,
+    c::size_t,
+    *const ::std::os::raw::c_char,
+    c::size_t,
+    c::zen_write_t,
+    c::zen_write_t,
+    *mut ::std::os::raw::c_void,
 ) -> ::std::os::raw::c_int;
 
 pub fn zencode_exec(
@@ -73,7 +72,13 @@ pub fn zencode_exec(
     keys: impl AsRef<str>,
     data: impl AsRef<str>,
 ) -> Result<ZenResult, ZenError> {
-    exec_f(c::zencode_exec_tobuf, script, conf, keys, data)
+    exec_f(
+        c::zencode_exec_cb,
+        script,
+        conf,
+        keys.as_ref().as_bytes(),
+        data.as_ref().as_bytes(),
+    )
 }
 
 pub fn zenroom_exec(
@@ -82,43 +87,97 @@ pub fn zenroom_exec(
     keys: impl AsRef<str>,
     data: impl AsRef<str>,
 ) -> Result<ZenResult, ZenError> {
-    exec_f(c::zenroom_exec_tobuf, script, conf, keys, data)
+    exec_f(
+        c::zenroom_exec_cb,
+        script,
+        conf,
+        keys.as_ref().as_bytes(),
+        data.as_ref().as_bytes(),
+    )
+}
+
+/// Keys and data are byte buffers which may contain binary data, for
+/// instance MessagePack or CBOR. They are passed to Zenroom without
+/// copies and, configured with "input=octet", read in place as octets.
+pub fn zencode_exec_bytes(
+    script: impl AsRef<str>,
+    conf: impl AsRef<str>,
+    keys: impl AsRef<[u8]>,
+    data: impl AsRef<[u8]>,
+) -> Result<ZenResult, ZenError> {
+    exec_f(c::zencode_exec_cb, script, conf, keys, data)
+}
+
+pub fn zenroom_exec_bytes(
+    script: impl AsRef<str>,
+    conf: impl AsRef<str>,
+    keys: impl AsRef<[u8]>,
+    data: impl AsRef<[u8]>,
+) -> Result<ZenResult, ZenError> {
+    exec_f(c::zenroom_exec_cb, script, conf, keys, data)
+}
+
+#[derive(Default)]
+struct Output {
+    stdout: Vec<u8>,
+    stderr: Vec<u8>,
+}
+
+unsafe extern "C" fn write_stdout(
+    ctx: *mut ::std::os::raw::c_void,
+    buf: *const ::std::os::raw::c_char,
+    len: c::size_t,
+) -> ::std::os::raw::c_int {
+    let out = &mut *(ctx as *mut Output);
+    out.stdout
+        .extend_from_slice(std::slice::from_raw_parts(buf as *const u8, len as usize));
+    0
+}
+
+unsafe extern "C" fn write_stderr(
+    ctx: *mut ::std::os::raw::c_void,
+    buf: *const ::std::os::raw::c_char,
+    len: c::size_t,
+) -> ::std::os::raw::c_int {
+    let out = &mut *(ctx as *mut Output);
+    out.stderr
+        .extend_from_slice(std::slice::from_raw_parts(buf as *const u8, len as usize));
+    0
 }
 
+// output and logs are collected by callbacks as they are printed, so
+// nothing is allocated in advance nor truncated
 fn exec_f(
-    fun: Fun,
+    fun: FunCb,
     script: impl AsRef<str>,
     conf: impl AsRef<str>,
-    keys: impl AsRef<str>,
-    data: impl AsRef<str>,
+    keys: impl AsRef<[u8]>,
+    data: impl AsRef<[u8]>,
 ) -> Result<ZenResult, ZenError> {
-    let mut stdout = Vec::<i8>::with_capacity(BUF_SIZE);
-    let stdout_ptr = stdout.as_mut_ptr();
-    let mut stderr = Vec::<i8>::with_capacity(BUF_SIZE);
-    let stderr_ptr = stderr.as_mut_ptr();
+    let script = CString::new(script.as_ref())?;
+    let conf = CString::new(conf.as_ref())?;
+    let (keys, data) = (keys.as_ref(), data.as_ref());
+    let mut out = Output::default();
 
     let lock = aquire_zen_gil();
     let exit_code = unsafe {
         fun(
-            CString::new(script.as_ref())?.into_raw(),
-            CString::new(conf.as_ref())?.into_raw(),
-            CString::new(keys.as_ref())?.into_raw(),
-            CString::new(data.as_ref())?.into_raw(),
-            stdout_ptr,
-            BUF_SIZE as u64,
-            stderr_ptr,
-            BUF_SIZE as u64,
+            script.as_ptr() as *mut _,
+            conf.as_ptr() as *mut _,
+            keys.as_ptr() as *const _,
+            keys.len() as c::size_t,
+            data.as_ptr() as *const _,
+            data.len() as c::size_t,
+            Some(write_stdout),
+            Some(write_stderr),
+            &mut out as *mut Output as *mut _,
         )
     };
     drop(lock);
 
     let res = ZenResult {
-        output: unsafe { CStr::from_ptr(stdout_ptr) }
-            .to_string_lossy()
-            .into_owned(),
-        logs: unsafe { CStr::from_ptr(stderr_ptr) }
-            .to_string_lossy()
-            .into_owned(),
+        output: String::from_utf8_lossy(&out.stdout).into_owned(),
+        logs: String::from_utf8_lossy(&out.stderr).into_owned(),
     };
 
     if exit_code == 0 {
@@ -174,4 +233,26 @@ mod tests {
         }
         Ok(())
     }
+
+    #[test]
+    fn binary_data() -> Result<(), ZenError> {
+        let script = "rule input format mpack\n\
+                      Given I have a 'hex' named 'oct'\n\
+                      Then print the 'oct'";
+        // MessagePack { "oct": 00ff00 } with zero bytes
+        let data = b"\x81\xa3oct\xc4\x03\x00\xff\x00";
+        for conf in ["", "input=octet"] {
+            let result = zencode_exec_bytes(script, conf, b"", data)?;
+            assert_eq!(result.output.trim(), r#"{"oct":"00ff00"}"#);
+        }
+        Ok(())
+    }
+
+    #[test]
+    fn big_output() -> Result<(), ZenError> {
+        // larger than the fixed buffers used before, must not be truncated
+        let result = zenroom_exec("print(string.rep('x', 4 * 1024 * 1024))", "", "", "")?;
+        assert_eq!(result.output.trim_end().len(), 4 * 1024 * 1024);
+        Ok(())
+    }
 }
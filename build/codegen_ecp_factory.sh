@@ -129,7 +129,9 @@ extern void PAIR_${CN}_GTpow(FP12_${CN} *x,BIG_${BS} b);
 #define MODBYTES MODBYTES_${BS}
 #define BIGLEN NLEN_${BS}
 #define DBIGLEN DNLEN_${BS}
+#define BIGBITS BASEBITS_${BS}
 #define BIG_zero(b) BIG_${BS}_zero(b)
+#define BIG_one(b) BIG_${BS}_one(b)
 #define BIG_fromBytesLen(b,v,l) BIG_${BS}_fromBytesLen(b,v,l)
 #define BIG_iszilch(b) BIG_${BS}_iszilch(b)
 #define BIG_diszilch(b) BIG_${BS}_diszilch(b)
@@ -188,6 +190,10 @@ extern void PAIR_${CN}_GTpow(FP12_${CN} *x,BIG_${BS} b);
 #define FP_redc(x,y) FP_${CN}_redc(x,y)
 #define FP_reduce(x) FP_${CN}_reduce(x)
 #define FP_mod(d,s) FP_${CN}_mod(d,s)
+#define FP_one(x) FP_${CN}_one(x)
+#define FP_iszilch(x) FP_${CN}_iszilch(x)
+#define FP_mul(d,l,r) FP_${CN}_mul(d,l,r)
+#define FP_inv(d,s) FP_${CN}_inv(d,s)
 
 #define FP12 FP12_${CN}
 // #define FP12_zero(b) FP12_${CN}_zero(b)
@@ -9,6 +9,14 @@ website := ${pwd}/docs
 luasrc := ${pwd}/lib/lua53/src
 ldadd := ${pwd}/lib/lua53/src/liblua.a
 lua_embed_opts := ""
+# native builds embed src/lua as bytecode compiled by build/luac, set
+# COMPILE_LUA=0 to embed the sources; STRIP_LUA=1 drops debug info from
+# the bytecode and ZSTD_LUA=1 compresses each embedded file with zstd
+COMPILE_LUA ?= 1
+luac_core := lapi lcode lctype ldebug ldo ldump lfunc lgc llex lmem \
+	lobject lopcodes lparser lstate lstring ltable ltm lundump lvm lzio \
+	lauxlib
+hostcc ?= cc
 lua_cflags := -DLUA_COMPAT_5_3 -DLUA_COMPAT_MODULE -DLUA_COMPAT_BITLIB -I${pwd}/lib/milagro-crypto-c/build/include -I${pwd}/src -I${pwd}/lib/milagro-crypto-c/build/include
 
 # ----------------
@@ -60,6 +68,7 @@ ar  := $(shell which x86_64-w64-mingw32-ar)
 ranlib := $(shell which x86_64-w64-mingw32-ranlib)
 ld := $(shell which x86_64-w64-mingw32-ld)
 system := Windows
+COMPILE_LUA := 0
 cflags := -mthreads -D'ARCH=\"WIN\"' -DARCH_WIN
 ldflags := -L/usr/x86_64-w64-mingw32/lib
 ldadd += -l:libm.a -l:libpthread.a -lssp
@@ -87,6 +96,7 @@ objcopy := arm-none-eabi-objcopy
 ranlib := arm-none-eabi-ranlib
 ld := arm-none-eabi-ld
 system := Generic
+COMPILE_LUA := 0
 ldadd += -lm
 cflags_protection := ""
 cflags := ${cflags_protection} -DARCH_CORTEX -mcpu=cortex-m3 -mthumb -mlittle-endian -mthumb-interwork -Wstack-usage=1024 -DLIBRARY -Wno-main -ffreestanding -nostartfiles -specs=nano.specs -specs=nosys.specs
@@ -100,6 +110,7 @@ objcopy := aarch64-linux-gnu-objcopy
 ranlib := aarch64-linux-gnu-ranlib
 ld := aarch64-linux-gnu 
 system := Linux 
+COMPILE_LUA := 0
 ldadd += -lm
 cflags := -O3 -fPIC -D'ARCH=\"LINUX\"' -DARCH_LINUX
 ldflags := -lm -lpthread
@@ -113,6 +124,7 @@ objcopy := riscv64-linux-gnu-objcopy
 ranlib := riscv64-linux-gnu-ranlib
 ld := riscv64-linux-gnu-ld
 system := Generic
+COMPILE_LUA := 0
 ldadd += -lm
 cflags_protection := ""
 cflags := ${cflags_protection}
@@ -123,6 +135,7 @@ endif
 ifneq (,$(findstring ios,$(MAKECMDGOALS)))
 milagro_cmake_flags += -DCMAKE_SYSTEM_PROCESSOR="arm" -DCMAKE_CROSSCOMPILING=1 -DCMAKE_C_COMPILER_WORKS=1
 milagro_cmake_flags += -DCMAKE_OSX_SYSROOT="/" -DCMAKE_OSX_DEPLOYMENT_TARGET=""
+COMPILE_LUA := 0
 endif
 
 ifneq (,$(findstring c++,$(MAKECMDGOALS)))
@@ -140,7 +153,6 @@ ifneq (,$(findstring linux,$(MAKECMDGOALS)))
 cflags := ${cflags} -fPIC ${cflags_protection} -D'ARCH=\"LINUX\"' -DARCH_LINUX
 ldflags := -lm -lpthread
 system := Linux
-cflags += $(if ${COMPILE_LUA}, -DLUA_COMPILED)
 endif
 
 ifneq (,$(findstring clang,$(MAKECMDGOALS)))
@@ -154,6 +166,7 @@ ar := ${pi}/bin/arm-linux-gnueabihf-ar
 cflags := -O3 -march=armv6 -mfloat-abi=hard -mfpu=vfp -I${pi}/arm-linux-gnueabihf/include -fPIC -D'ARCH=\"LINUX\"' -DARCH_LINUX
 ldflags := -L${pi}arm-linux-gnueabihf/lib -lm -lpthread
 system := Linux
+COMPILE_LUA := 0
 endif
 
 ifneq (,$(findstring jemalloc,$(MAKECMDGOALS)))
@@ -184,6 +197,7 @@ ldflags := -shared
 cflags += -fPIC ${cflags_protection} -DLIBRARY -D'ARCH=\"LINUX\"' -DARCH_LINUX -DARCH_ANDROID
 cflags += -DLUA_USE_DLOPEN -I${ndk}/sysroot/usr/include
 system := Android
+COMPILE_LUA := 0
 android := 18
 endif
 
@@ -225,6 +239,7 @@ ar := ${EMSCRIPTEN}/emar
 ld := ${gcc}
 ranlib := ${EMSCRIPTEN}/emranlib
 system:= Javascript
+COMPILE_LUA := 0
 # lua_embed_opts := "compile"
 ldflags := -s "EXPORTED_FUNCTIONS='[\"_zenroom_exec\",\"_zencode_exec\"]'" -s "EXPORTED_RUNTIME_METHODS='[\"ccall\",\"cwrap\",\"printErr\",\"print\"]'" -s USE_SDL=0 -s USE_PTHREADS=0 -lm
 cflags := -Wall -I ${EMSCRIPTEN}/system/include/libc -DLIBRARY
@@ -236,6 +251,7 @@ ld  := ${pwd}/build/xtensa-esp32-elf/bin/xtensa-esp32-elf-ld
 ar  := ${pwd}/build/xtensa-esp32-elf/bin/xtensa-esp32-elf-ar
 ranlib := ${pwd}/build/xtensa-esp32-elf/bin/xtensa-esp32-elf-ranlib
 system := Generic
+COMPILE_LUA := 0
 # TODO: not working, cmake doesn't uses the specified linked (bug?)
 milagro_cmake_flags := -DCMAKE_LINKER=${ld} -DCMAKE_C_LINK_EXECUTABLE="<CMAKE_LINKER> <FLAGS> <LINK_FLAGS> <OBJECTS> -o <TARGET> <LINK_LIBRARIES>"
 cflags := -I. -mlongcalls  #${cflags_protection} -D'ARCH=\"LINUX\"' -DARCH_LINUX
@@ -252,7 +268,6 @@ endif
 
 ifneq (,$(findstring debug,$(MAKECMDGOALS)))
 cflags := -Og -ggdb -DDEBUG=1 -Wall -Wextra -pedantic
-cflags += $(if ${COMPILE_LUA}, -DLUA_COMPILED)
 endif
 
 ifneq (,$(findstring profile,$(MAKECMDGOALS)))
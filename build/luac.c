@@ -0,0 +1,167 @@
+/*  Zenroom (DECODE project)
+ *
+ *  (c) Copyright 2017-2022 Dyne.org foundation
+ *  designed, written and maintained by Denis Roio <jaromil@dyne.org>
+ *
+ * This source code is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Public License as published
+ * by the Free Software Foundation; either version 3 of the License,
+ * or (at your option) any later version.
+ *
+ * This source code is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * Please refer to the GNU Public License for more details.
+ *
+ * You should have received a copy of the GNU Public License along with
+ * this source code; if not, write to:
+ * Free Software Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ */
+
+// Host compiler used by build/embed-lualibs to precompile the Lua
+// sources in src/lua. It is linked with the core of the bundled
+// lib/lua53 (built with -DLUAC_HOST) so that the bytecode matches the
+// interpreter inside zenroom: the chunk is loaded back the same way
+// zenroom loads it before being written, which checks the version,
+// format and type sizes in the header.
+//
+// usage: build/luac [-s] [-n name] -o output input.lua
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <lua.h>
+#include <lauxlib.h>
+#include <ldo.h>
+
+// lib/lua53/src/lauxlib.c leaves these to src/lua_shims.c and zen_memory.c
+typedef struct LoadS {
+	const char *s;
+	size_t size;
+} LoadS;
+
+static const char *getS(lua_State *L, void *ud, size_t *size) {
+	LoadS *ls = (LoadS *)ud;
+	(void)L;
+	if (ls->size == 0) return NULL;
+	*size = ls->size;
+	ls->size = 0;
+	return ls->s;
+}
+
+LUALIB_API int luaL_loadbufferx(lua_State *L, const char *buff, size_t size,
+                                const char *name, const char *mode) {
+	LoadS ls;
+	ls.s = buff;
+	ls.size = size;
+	return lua_load(L, getS, &ls, name, mode);
+}
+
+static void *l_alloc(void *ud, void *ptr, size_t osize, size_t nsize) {
+	(void)ud; (void)osize;
+	if (nsize == 0) {
+		free(ptr);
+		return NULL;
+	}
+	return realloc(ptr, nsize);
+}
+
+typedef struct dump_t {
+	char *buf;
+	size_t len;
+	size_t max;
+} dump_t;
+
+static int writer(lua_State *L, const void *p, size_t size, void *ud) {
+	dump_t *d = (dump_t *)ud;
+	(void)L;
+	if (d->len + size > d->max) {
+		size_t max = (d->max + size) * 2;
+		char *buf = realloc(d->buf, max);
+		if (!buf) return 1;
+		d->buf = buf;
+		d->max = max;
+	}
+	memcpy(d->buf + d->len, p, size);
+	d->len += size;
+	return 0;
+}
+
+static char *load_file(const char *path, size_t *len) {
+	FILE *fd = fopen(path, "rb");
+	char *buf;
+	long size;
+	if (!fd) return NULL;
+	fseek(fd, 0, SEEK_END);
+	size = ftell(fd);
+	fseek(fd, 0, SEEK_SET);
+	buf = malloc(size > 0 ? size : 1);
+	if (buf && fread(buf, 1, size, fd) != (size_t)size) {
+		free(buf);
+		buf = NULL;
+	}
+	fclose(fd);
+	*len = (size_t)size;
+	return buf;
+}
+
+static int fail(lua_State *L, const char *what, const char *path) {
+	fprintf(stderr, "luac: %s %s: %s\n", what, path,
+	        L && lua_isstring(L, -1) ? lua_tostring(L, -1) : "error");
+	return EXIT_FAILURE;
+}
+
+int main(int argc, char **argv) {
+	const char *in = NULL, *out = NULL, *name = NULL;
+	int strip = 0, res = EXIT_FAILURE, i;
+	dump_t d = { NULL, 0, 0 };
+	size_t len;
+	char *src;
+	lua_State *L;
+	FILE *fd;
+	for (i = 1; i < argc; i++) {
+		if (strcmp(argv[i], "-s") == 0) strip = 1;
+		else if (strcmp(argv[i], "-o") == 0 && i + 1 < argc) out = argv[++i];
+		else if (strcmp(argv[i], "-n") == 0 && i + 1 < argc) name = argv[++i];
+		else if (strcmp(argv[i], "-v") == 0) { printf("%s\n", LUA_RELEASE); return 0; }
+		else in = argv[i];
+	}
+	if (!in || !out) {
+		fprintf(stderr, "usage: %s [-s] [-n name] -o output input.lua\n", argv[0]);
+		return EXIT_FAILURE;
+	}
+	src = load_file(in, &len);
+	if (!src) return fail(NULL, "cannot read", in);
+	L = lua_newstate(l_alloc, NULL);
+	if (!L) { free(src); return fail(NULL, "cannot create state for", in); }
+	// the chunk name is saved in the bytecode: use the same name the
+	// embedded source would be loaded with, so error messages match
+	if (!name) name = in;
+	if (luaL_loadbufferx(L, src, len, name, "t") != LUA_OK) {
+		res = fail(L, "cannot compile", in);
+		goto end;
+	}
+	if (lua_dump(L, writer, &d, strip) != 0 || !d.buf) {
+		res = fail(L, "cannot dump", in);
+		goto end;
+	}
+	lua_pop(L, 1);
+	if (luaL_loadbufferx(L, d.buf, d.len, name, luaD_embeddedmode) != LUA_OK) {
+		res = fail(L, "cannot load back bytecode of", in);
+		goto end;
+	}
+	fd = fopen(out, "wb");
+	if (!fd || fwrite(d.buf, 1, d.len, fd) != d.len) {
+		if (fd) fclose(fd);
+		res = fail(NULL, "cannot write", out);
+		goto end;
+	}
+	fclose(fd);
+	res = EXIT_SUCCESS;
+end:
+	free(d.buf);
+	free(src);
+	lua_close(L);
+	return res;
+}
@@ -23,7 +23,8 @@ lowmem-tests = \
 		${1} test/events.lua && \
 		${1} test/code.lua && \
 		${1} test/locals.lua && \
-		${1} test/zentypes.lua
+		${1} test/zentypes.lua && \
+		${1} test/deepmap.lua
 
 # removed for memory usage in wasm
 #	    ${1} test/coroutine.lua
@@ -38,6 +39,8 @@ lowmem-tests = \
 crypto-tests = \
 	@${1} test/octet.lua && \
 	${1} test/octet_conversion.lua && \
+	${1} test/big_arithmetics.lua && \
+	${1} test/pack.lua && \
 	${1} test/hash.lua && \
 	${1} test/ecdh.lua && \
 	${1} test/dh_session.lua && \
@@ -763,6 +763,12 @@ static void checkmode (lua_State *L, const char *mode, const char *x) {
 }
 
 
+/*
+** mode used by zenroom to load the precompiled extensions embedded at
+** build time: only this exact pointer enables binary chunks
+*/
+LUAI_DDEF const char luaD_embeddedmode[] = "b";
+
 static void f_parser (lua_State *L, void *ud) {
   LClosure *cl;
   struct SParser *p = cast(struct SParser *, ud);
@@ -770,14 +776,15 @@ static void f_parser (lua_State *L, void *ud) {
 
   // SECURITY FIX
   // The check for `LUA_SIGNATURE[0]` is removed in order toa void direct bytecode execution.
-  // if (c == LUA_SIGNATURE[0]) {
-  //   checkmode(L, p->mode, "binary");
-  //   cl = luaU_undump(L, p->z, p->name);
-  // }
-  // else {
-  checkmode(L, p->mode, "text");
-  cl = luaY_parser(L, p->z, &p->buff, &p->dyd, p->name, c);
-  // }
+  // Bytecode is only undumped for the embedded extensions, whose mode
+  // string cannot be passed from Lua (i.e. by load).
+  if (c == LUA_SIGNATURE[0] && p->mode == luaD_embeddedmode) {
+    cl = luaU_undump(L, p->z, p->name);
+  }
+  else {
+    checkmode(L, p->mode, "text");
+    cl = luaY_parser(L, p->z, &p->buff, &p->dyd, p->name, c);
+  }
   lua_assert(cl->nupvalues == cl->p->sizeupvalues);
   luaF_initupvals(L, cl);
 }
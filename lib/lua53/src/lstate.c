@@ -269,8 +269,10 @@ void luaE_freethread (lua_State *L, lua_State *L1) {
   luaM_free(L, l);
 }
 
+#ifndef LUAC_HOST
 #include <amcl.h>
 #include <zenroom.h>
+#endif
 
 LUA_API lua_State *lua_newstate (lua_Alloc f, void *ud) {
   int i;
@@ -288,12 +290,17 @@ LUA_API lua_State *lua_newstate (lua_Alloc f, void *ud) {
   g->frealloc = f;
   g->ud = ud;
   g->mainthread = L;
+#ifdef LUAC_HOST
+  // build/luac runs on the build host without a zenroom context
+  g->seed = 0x42424242;
+#else
   // g->seed = 0x42424242; // constant uint32 to be overwritten
   zenroom_t *ZZ = (zenroom_t*)ud;
   g->seed = RAND_byte(ZZ->random_generator)
       | (uint32_t) RAND_byte(ZZ->random_generator) << 8
       | (uint32_t) RAND_byte(ZZ->random_generator) << 16
       | (uint32_t) RAND_byte(ZZ->random_generator) << 24;
+#endif
   g->gcrunning = 0;  /* no GC while building state */
   g->GCestimate = 0;
   g->strt.size = g->strt.nuse = 0;
@@ -532,7 +532,7 @@ void KECCAK_hash(sha3 *sh,char *hash)
 {
     /* generate a SHA3 hash of appropriate size */
     int q=sh->rate-(sh->length%sh->rate);
-    if (q==1) SHA3_process(sh,0x86);
+    if (q==1) SHA3_process(sh,0x81); /* 0x01 | 0x80 when only one byte is left */
     else
     {
         SHA3_process(sh,0x01); // This is the only difference from SHA3
@@ -0,0 +1,32 @@
+#include "cpufeatures.h"
+
+static int avx2_detected = -1;
+// the choice is kept for each thread, so that zenroom contexts
+// running at the same time in other threads are not affected
+#if defined(PQCLEAN_AVX2)
+static __thread int avx2_disabled = 0;
+#else
+static int avx2_disabled = 0;
+#endif
+
+int PQCLEAN_avx2_available(void) {
+#if defined(PQCLEAN_AVX2)
+    if (avx2_detected < 0) {
+        __builtin_cpu_init();
+        avx2_detected = __builtin_cpu_supports("avx2") ? 1 : 0;
+    }
+    return avx2_detected;
+#else
+    (void)avx2_detected;
+    return 0;
+#endif
+}
+
+int PQCLEAN_avx2_enabled(void) {
+    return !avx2_disabled && PQCLEAN_avx2_available();
+}
+
+int PQCLEAN_avx2_enable(int on) {
+    avx2_disabled = !on;
+    return PQCLEAN_avx2_enabled();
+}
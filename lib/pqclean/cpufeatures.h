@@ -0,0 +1,25 @@
+#ifndef CPUFEATURES_H
+#define CPUFEATURES_H
+
+/* Runtime selection between the portable "clean" implementations and
+ * the AVX2 optimized routines. The AVX2 code is compiled with function
+ * level target attributes, so the library still runs on any x86_64 CPU
+ * and the clean code is used whenever AVX2 is missing or disabled. */
+
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__)) \
+    && !defined(__EMSCRIPTEN__) && !defined(PQCLEAN_NO_AVX2)
+#define PQCLEAN_AVX2 1
+#define PQCLEAN_AVX2_TARGET __attribute__((target("avx2")))
+#endif
+
+/* 1 if the CPU supports AVX2 (detected once, then cached) */
+int PQCLEAN_avx2_available(void);
+
+/* 1 if AVX2 routines are available and not disabled at runtime */
+int PQCLEAN_avx2_enabled(void);
+
+/* switch AVX2 routines on (1) or off (0) for the calling thread,
+ * returns the new state */
+int PQCLEAN_avx2_enable(int on);
+
+#endif
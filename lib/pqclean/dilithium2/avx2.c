@@ -0,0 +1,234 @@
+#include "avx2.h"
+
+#if defined(PQCLEAN_AVX2)
+#include "ntt.h"
+#include "reduce.h"
+#include <immintrin.h>
+
+/* The NTT layers with len >= 8 map directly on 8 int32 lanes sharing
+ * one zeta. The three lower layers (len 4, 2, 1) work on pairs of
+ * vectors deinterleaved at 128, 64 and 32 bit granularity, with the
+ * per-lane zetas expanded once in the same layout. */
+
+static int32_t zetas_fwd[3][N / 2];
+static int32_t zetas_inv[3][N / 2];
+static int tables_ready = 0;
+
+/* montgomery_reduce(a * b) on 8 lanes: the 64 bit products of even and
+ * odd lanes are reduced separately and blended back together */
+static inline PQCLEAN_AVX2_TARGET __m256i montmul(__m256i a, __m256i b) {
+    const __m256i qinv = _mm256_set1_epi32(QINV);
+    const __m256i q = _mm256_set1_epi32(Q);
+    __m256i pe, po, te, to;
+
+    pe = _mm256_mul_epi32(a, b);
+    po = _mm256_mul_epi32(_mm256_srli_epi64(a, 32), _mm256_srli_epi64(b, 32));
+    te = _mm256_mul_epi32(_mm256_mul_epi32(pe, qinv), q);
+    to = _mm256_mul_epi32(_mm256_mul_epi32(po, qinv), q);
+    pe = _mm256_srli_epi64(_mm256_sub_epi64(pe, te), 32);
+    po = _mm256_sub_epi64(po, to);
+    return _mm256_blend_epi32(pe, po, 0xAA);
+}
+
+static inline PQCLEAN_AVX2_TARGET __m256i reduce32(__m256i a) {
+    const __m256i q = _mm256_set1_epi32(Q);
+    __m256i t = _mm256_add_epi32(a, _mm256_set1_epi32(1 << 22));
+    t = _mm256_srai_epi32(t, 23);
+    return _mm256_sub_epi32(a, _mm256_mullo_epi32(t, q));
+}
+
+static inline PQCLEAN_AVX2_TARGET void split(__m256i *a, __m256i *b,
+        __m256i x, __m256i y, int bits) {
+    switch (bits) {
+    case 128:
+        *a = _mm256_permute2x128_si256(x, y, 0x20);
+        *b = _mm256_permute2x128_si256(x, y, 0x31);
+        break;
+    case 64:
+        *a = _mm256_unpacklo_epi64(x, y);
+        *b = _mm256_unpackhi_epi64(x, y);
+        break;
+    default:
+        x = _mm256_shuffle_epi32(x, 0xD8);
+        y = _mm256_shuffle_epi32(y, 0xD8);
+        *a = _mm256_unpacklo_epi64(x, y);
+        *b = _mm256_unpackhi_epi64(x, y);
+        break;
+    }
+}
+
+static inline PQCLEAN_AVX2_TARGET void merge(__m256i *x, __m256i *y,
+        __m256i a, __m256i b, int bits) {
+    switch (bits) {
+    case 128:
+        *x = _mm256_permute2x128_si256(a, b, 0x20);
+        *y = _mm256_permute2x128_si256(a, b, 0x31);
+        break;
+    case 64:
+        *x = _mm256_unpacklo_epi64(a, b);
+        *y = _mm256_unpackhi_epi64(a, b);
+        break;
+    default:
+        *x = _mm256_shuffle_epi32(_mm256_unpacklo_epi64(a, b), 0xD8);
+        *y = _mm256_shuffle_epi32(_mm256_unpackhi_epi64(a, b), 0xD8);
+        break;
+    }
+}
+
+/* expand the zetas of layers len = 4, 2, 1 into lane order */
+static PQCLEAN_AVX2_TARGET void init_tables(void) {
+    int32_t fwd[N], inv[N];
+    unsigned int l, len, i;
+    __m256i x, y, a, b;
+
+    for (l = 0, len = 4; len >= 1; len >>= 1, l++) {
+        for (i = 0; i < N; i++) {
+            fwd[i] = PQCLEAN_DILITHIUM2_CLEAN_zetas[128 / len + i / (2 * len)];
+            inv[i] = -PQCLEAN_DILITHIUM2_CLEAN_zetas[256 / len - 1 - i / (2 * len)];
+        }
+        for (i = 0; i < N; i += 16) {
+            x = _mm256_loadu_si256((const __m256i *)&fwd[i]);
+            y = _mm256_loadu_si256((const __m256i *)&fwd[i + 8]);
+            split(&a, &b, x, y, len * 32);
+            _mm256_storeu_si256((__m256i *)&zetas_fwd[l][i / 2], a);
+            x = _mm256_loadu_si256((const __m256i *)&inv[i]);
+            y = _mm256_loadu_si256((const __m256i *)&inv[i + 8]);
+            split(&a, &b, x, y, len * 32);
+            _mm256_storeu_si256((__m256i *)&zetas_inv[l][i / 2], a);
+        }
+    }
+    tables_ready = 1;
+}
+
+PQCLEAN_AVX2_TARGET void PQCLEAN_DILITHIUM2_AVX2_ntt(int32_t a[N]) {
+    unsigned int len, start, j, k, l;
+    __m256i x, y, va, vb, t, z;
+
+    if (!tables_ready) {
+        init_tables();
+    }
+    k = 0;
+    for (len = 128; len >= 8; len >>= 1) {
+        for (start = 0; start < N; start += 2 * len) {
+            z = _mm256_set1_epi32(PQCLEAN_DILITHIUM2_CLEAN_zetas[++k]);
+            for (j = start; j < start + len; j += 8) {
+                va = _mm256_loadu_si256((const __m256i *)&a[j]);
+                vb = _mm256_loadu_si256((const __m256i *)&a[j + len]);
+                t = montmul(z, vb);
+                _mm256_storeu_si256((__m256i *)&a[j + len], _mm256_sub_epi32(va, t));
+                _mm256_storeu_si256((__m256i *)&a[j], _mm256_add_epi32(va, t));
+            }
+        }
+    }
+    for (l = 0, len = 4; len >= 1; len >>= 1, l++) {
+        for (j = 0; j < N; j += 16) {
+            x = _mm256_loadu_si256((const __m256i *)&a[j]);
+            y = _mm256_loadu_si256((const __m256i *)&a[j + 8]);
+            split(&va, &vb, x, y, len * 32);
+            z = _mm256_loadu_si256((const __m256i *)&zetas_fwd[l][j / 2]);
+            t = montmul(z, vb);
+            vb = _mm256_sub_epi32(va, t);
+            va = _mm256_add_epi32(va, t);
+            merge(&x, &y, va, vb, len * 32);
+            _mm256_storeu_si256((__m256i *)&a[j], x);
+            _mm256_storeu_si256((__m256i *)&a[j + 8], y);
+        }
+    }
+}
+
+PQCLEAN_AVX2_TARGET void PQCLEAN_DILITHIUM2_AVX2_invntt_tomont(int32_t a[N]) {
+    unsigned int len, start, j, k, l;
+    __m256i x, y, va, vb, t, z;
+    const __m256i f = _mm256_set1_epi32(41978); // mont^2/256
+
+    if (!tables_ready) {
+        init_tables();
+    }
+    for (l = 2, len = 1; len <= 4; len <<= 1, l--) {
+        for (j = 0; j < N; j += 16) {
+            x = _mm256_loadu_si256((const __m256i *)&a[j]);
+            y = _mm256_loadu_si256((const __m256i *)&a[j + 8]);
+            split(&va, &vb, x, y, len * 32);
+            z = _mm256_loadu_si256((const __m256i *)&zetas_inv[l][j / 2]);
+            t = va;
+            va = _mm256_add_epi32(t, vb);
+            vb = montmul(z, _mm256_sub_epi32(t, vb));
+            merge(&x, &y, va, vb, len * 32);
+            _mm256_storeu_si256((__m256i *)&a[j], x);
+            _mm256_storeu_si256((__m256i *)&a[j + 8], y);
+        }
+    }
+    k = 32;
+    for (len = 8; len < N; len <<= 1) {
+        for (start = 0; start < N; start += 2 * len) {
+            z = _mm256_set1_epi32(-PQCLEAN_DILITHIUM2_CLEAN_zetas[--k]);
+            for (j = start; j < start + len; j += 8) {
+                t = _mm256_loadu_si256((const __m256i *)&a[j]);
+                vb = _mm256_loadu_si256((const __m256i *)&a[j + len]);
+                _mm256_storeu_si256((__m256i *)&a[j], _mm256_add_epi32(t, vb));
+                _mm256_storeu_si256((__m256i *)&a[j + len], montmul(z, _mm256_sub_epi32(t, vb)));
+            }
+        }
+    }
+    for (j = 0; j < N; j += 8) {
+        va = _mm256_loadu_si256((const __m256i *)&a[j]);
+        _mm256_storeu_si256((__m256i *)&a[j], montmul(f, va));
+    }
+}
+
+PQCLEAN_AVX2_TARGET void PQCLEAN_DILITHIUM2_AVX2_poly_pointwise_montgomery(poly *c, const poly *a, const poly *b) {
+    unsigned int i;
+    __m256i va, vb;
+
+    for (i = 0; i < N; i += 8) {
+        va = _mm256_loadu_si256((const __m256i *)&a->coeffs[i]);
+        vb = _mm256_loadu_si256((const __m256i *)&b->coeffs[i]);
+        _mm256_storeu_si256((__m256i *)&c->coeffs[i], montmul(va, vb));
+    }
+}
+
+PQCLEAN_AVX2_TARGET void PQCLEAN_DILITHIUM2_AVX2_poly_reduce(poly *a) {
+    unsigned int i;
+    __m256i va;
+
+    for (i = 0; i < N; i += 8) {
+        va = _mm256_loadu_si256((const __m256i *)&a->coeffs[i]);
+        _mm256_storeu_si256((__m256i *)&a->coeffs[i], reduce32(va));
+    }
+}
+
+PQCLEAN_AVX2_TARGET void PQCLEAN_DILITHIUM2_AVX2_poly_caddq(poly *a) {
+    unsigned int i;
+    const __m256i q = _mm256_set1_epi32(Q);
+    __m256i va;
+
+    for (i = 0; i < N; i += 8) {
+        va = _mm256_loadu_si256((const __m256i *)&a->coeffs[i]);
+        va = _mm256_add_epi32(va, _mm256_and_si256(_mm256_srai_epi32(va, 31), q));
+        _mm256_storeu_si256((__m256i *)&a->coeffs[i], va);
+    }
+}
+
+PQCLEAN_AVX2_TARGET void PQCLEAN_DILITHIUM2_AVX2_poly_add(poly *c, const poly *a, const poly *b) {
+    unsigned int i;
+    __m256i va, vb;
+
+    for (i = 0; i < N; i += 8) {
+        va = _mm256_loadu_si256((const __m256i *)&a->coeffs[i]);
+        vb = _mm256_loadu_si256((const __m256i *)&b->coeffs[i]);
+        _mm256_storeu_si256((__m256i *)&c->coeffs[i], _mm256_add_epi32(va, vb));
+    }
+}
+
+PQCLEAN_AVX2_TARGET void PQCLEAN_DILITHIUM2_AVX2_poly_sub(poly *c, const poly *a, const poly *b) {
+    unsigned int i;
+    __m256i va, vb;
+
+    for (i = 0; i < N; i += 8) {
+        va = _mm256_loadu_si256((const __m256i *)&a->coeffs[i]);
+        vb = _mm256_loadu_si256((const __m256i *)&b->coeffs[i]);
+        _mm256_storeu_si256((__m256i *)&c->coeffs[i], _mm256_sub_epi32(va, vb));
+    }
+}
+
+#endif /* PQCLEAN_AVX2 */
@@ -0,0 +1,27 @@
+#ifndef PQCLEAN_DILITHIUM2_AVX2_H
+#define PQCLEAN_DILITHIUM2_AVX2_H
+#include "../cpufeatures.h"
+#include "params.h"
+#include "poly.h"
+#include <stdint.h>
+
+#if defined(PQCLEAN_AVX2)
+/* AVX2 variants of the NTT and polynomial arithmetic. They work on the
+ * same coefficient order as the clean code and give bit-identical
+ * results, so packing and KATs are unchanged. */
+void PQCLEAN_DILITHIUM2_AVX2_ntt(int32_t a[N]);
+
+void PQCLEAN_DILITHIUM2_AVX2_invntt_tomont(int32_t a[N]);
+
+void PQCLEAN_DILITHIUM2_AVX2_poly_pointwise_montgomery(poly *c, const poly *a, const poly *b);
+
+void PQCLEAN_DILITHIUM2_AVX2_poly_reduce(poly *a);
+
+void PQCLEAN_DILITHIUM2_AVX2_poly_caddq(poly *a);
+
+void PQCLEAN_DILITHIUM2_AVX2_poly_add(poly *c, const poly *a, const poly *b);
+
+void PQCLEAN_DILITHIUM2_AVX2_poly_sub(poly *c, const poly *a, const poly *b);
+#endif
+
+#endif
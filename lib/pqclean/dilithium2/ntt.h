@@ -3,6 +3,8 @@
 #include "params.h"
 #include <stdint.h>
 
+extern const int32_t PQCLEAN_DILITHIUM2_CLEAN_zetas[N];
+
 void PQCLEAN_DILITHIUM2_CLEAN_ntt(int32_t a[N]);
 
 void PQCLEAN_DILITHIUM2_CLEAN_invntt_tomont(int32_t a[N]);
@@ -1,3 +1,5 @@
+#include "../fips202x4.h"
+#include "avx2.h"
 #include "ntt.h"
 #include "params.h"
 #include "poly.h"
@@ -21,6 +23,13 @@ void PQCLEAN_DILITHIUM2_CLEAN_poly_reduce(poly *a) {
     unsigned int i;
     DBENCH_START();
 
+#if defined(PQCLEAN_AVX2)
+    if (PQCLEAN_avx2_enabled()) {
+        PQCLEAN_DILITHIUM2_AVX2_poly_reduce(a);
+        return;
+    }
+#endif
+
     for (i = 0; i < N; ++i) {
         a->coeffs[i] = PQCLEAN_DILITHIUM2_CLEAN_reduce32(a->coeffs[i]);
     }
@@ -40,6 +49,13 @@ void PQCLEAN_DILITHIUM2_CLEAN_poly_caddq(poly *a) {
     unsigned int i;
     DBENCH_START();
 
+#if defined(PQCLEAN_AVX2)
+    if (PQCLEAN_avx2_enabled()) {
+        PQCLEAN_DILITHIUM2_AVX2_poly_caddq(a);
+        return;
+    }
+#endif
+
     for (i = 0; i < N; ++i) {
         a->coeffs[i] = PQCLEAN_DILITHIUM2_CLEAN_caddq(a->coeffs[i]);
     }
@@ -79,6 +95,13 @@ void PQCLEAN_DILITHIUM2_CLEAN_poly_add(poly *c, const poly *a, const poly *b)  {
     unsigned int i;
     DBENCH_START();
 
+#if defined(PQCLEAN_AVX2)
+    if (PQCLEAN_avx2_enabled()) {
+        PQCLEAN_DILITHIUM2_AVX2_poly_add(c, a, b);
+        return;
+    }
+#endif
+
     for (i = 0; i < N; ++i) {
         c->coeffs[i] = a->coeffs[i] + b->coeffs[i];
     }
@@ -101,6 +124,13 @@ void PQCLEAN_DILITHIUM2_CLEAN_poly_sub(poly *c, const poly *a, const poly *b) {
     unsigned int i;
     DBENCH_START();
 
+#if defined(PQCLEAN_AVX2)
+    if (PQCLEAN_avx2_enabled()) {
+        PQCLEAN_DILITHIUM2_AVX2_poly_sub(c, a, b);
+        return;
+    }
+#endif
+
     for (i = 0; i < N; ++i) {
         c->coeffs[i] = a->coeffs[i] - b->coeffs[i];
     }
@@ -175,6 +205,13 @@ void PQCLEAN_DILITHIUM2_CLEAN_poly_pointwise_montgomery(poly *c, const poly *a,
     unsigned int i;
     DBENCH_START();
 
+#if defined(PQCLEAN_AVX2)
+    if (PQCLEAN_avx2_enabled()) {
+        PQCLEAN_DILITHIUM2_AVX2_poly_pointwise_montgomery(c, a, b);
+        return;
+    }
+#endif
+
     for (i = 0; i < N; ++i) {
         c->coeffs[i] = PQCLEAN_DILITHIUM2_CLEAN_montgomery_reduce((int64_t)a->coeffs[i] * b->coeffs[i]);
     }
@@ -389,6 +426,64 @@ void PQCLEAN_DILITHIUM2_CLEAN_poly_uniform(poly *a,
     stream128_release(&state);
 }
 
+/*************************************************
+* Name:        PQCLEAN_DILITHIUM2_CLEAN_poly_uniform_4x
+*
+* Description: Sample four polynomials as in poly_uniform, running the
+*              four SHAKE128 streams in parallel.
+*
+* Arguments:   - poly *a0, *a1, *a2, *a3: pointers to output polynomials
+*              - const uint8_t seed[]: byte array with seed of length SEEDBYTES
+*              - uint16_t nonce0, ..., nonce3: 2-byte nonces
+**************************************************/
+void PQCLEAN_DILITHIUM2_CLEAN_poly_uniform_4x(poly *a0,
+        poly *a1,
+        poly *a2,
+        poly *a3,
+        const uint8_t seed[SEEDBYTES],
+        uint16_t nonce0,
+        uint16_t nonce1,
+        uint16_t nonce2,
+        uint16_t nonce3) {
+    unsigned int i, j, off[4];
+    unsigned int buflen[4], ctr[4];
+    uint8_t buf[4][POLY_UNIFORM_NBLOCKS * STREAM128_BLOCKBYTES + 2];
+    uint8_t in[4][SEEDBYTES + 2];
+    poly *a[4] = { a0, a1, a2, a3 };
+    const uint16_t nonce[4] = { nonce0, nonce1, nonce2, nonce3 };
+    keccakx4_state state;
+
+    for (j = 0; j < 4; ++j) {
+        for (i = 0; i < SEEDBYTES; ++i) {
+            in[j][i] = seed[i];
+        }
+        in[j][SEEDBYTES + 0] = (uint8_t) nonce[j];
+        in[j][SEEDBYTES + 1] = (uint8_t) (nonce[j] >> 8);
+    }
+
+    shake128x4_absorb(&state, in[0], in[1], in[2], in[3], SEEDBYTES + 2);
+    shake128x4_squeezeblocks(buf[0], buf[1], buf[2], buf[3], POLY_UNIFORM_NBLOCKS, &state);
+    for (j = 0; j < 4; ++j) {
+        buflen[j] = POLY_UNIFORM_NBLOCKS * STREAM128_BLOCKBYTES;
+        ctr[j] = rej_uniform(a[j]->coeffs, N, buf[j], buflen[j]);
+    }
+
+    while (ctr[0] < N || ctr[1] < N || ctr[2] < N || ctr[3] < N) {
+        for (j = 0; j < 4; ++j) {
+            off[j] = buflen[j] % 3;
+            for (i = 0; i < off[j]; ++i) {
+                buf[j][i] = buf[j][buflen[j] - off[j] + i];
+            }
+        }
+        shake128x4_squeezeblocks(buf[0] + off[0], buf[1] + off[1],
+                                 buf[2] + off[2], buf[3] + off[3], 1, &state);
+        for (j = 0; j < 4; ++j) {
+            buflen[j] = STREAM128_BLOCKBYTES + off[j];
+            ctr[j] += rej_uniform(a[j]->coeffs + ctr[j], N - ctr[j], buf[j], buflen[j]);
+        }
+    }
+}
+
 /*************************************************
 * Name:        rej_eta
 *
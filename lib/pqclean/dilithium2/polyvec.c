@@ -15,12 +15,24 @@
 *              - const uint8_t rho[]: byte array containing seed rho
 **************************************************/
 void PQCLEAN_DILITHIUM2_CLEAN_polyvec_matrix_expand(polyvecl mat[K], const uint8_t rho[SEEDBYTES]) {
-    unsigned int i, j;
-
-    for (i = 0; i < K; ++i) {
-        for (j = 0; j < L; ++j) {
-            PQCLEAN_DILITHIUM2_CLEAN_poly_uniform(&mat[i].vec[j], rho, (uint16_t) ((i << 8) + j));
-        }
+    unsigned int i, j, n;
+
+    /* entries are sampled four at a time in row-major order */
+    for (n = 0; n + 4 <= K * L; n += 4) {
+        PQCLEAN_DILITHIUM2_CLEAN_poly_uniform_4x(&mat[n / L].vec[n % L],
+                &mat[(n + 1) / L].vec[(n + 1) % L],
+                &mat[(n + 2) / L].vec[(n + 2) % L],
+                &mat[(n + 3) / L].vec[(n + 3) % L],
+                rho,
+                (uint16_t) (((n / L) << 8) + n % L),
+                (uint16_t) ((((n + 1) / L) << 8) + (n + 1) % L),
+                (uint16_t) ((((n + 2) / L) << 8) + (n + 2) % L),
+                (uint16_t) ((((n + 3) / L) << 8) + (n + 3) % L));
+    }
+    for (; n < K * L; ++n) {
+        i = n / L;
+        j = n % L;
+        PQCLEAN_DILITHIUM2_CLEAN_poly_uniform(&mat[i].vec[j], rho, (uint16_t) ((i << 8) + j));
     }
 }
 
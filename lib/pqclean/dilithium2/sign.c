@@ -104,6 +104,33 @@ int PQCLEAN_DILITHIUM2_CLEAN_crypto_pub_gen(uint8_t *pk, uint8_t *sk){
   return 0;  
 }
 
+size_t PQCLEAN_DILITHIUM2_CLEAN_crypto_sign_expanded_sk_bytes(void) {
+    return sizeof(PQCLEAN_DILITHIUM2_CLEAN_expanded_sk);
+}
+
+size_t PQCLEAN_DILITHIUM2_CLEAN_crypto_sign_expanded_pk_bytes(void) {
+    return sizeof(PQCLEAN_DILITHIUM2_CLEAN_expanded_pk);
+}
+
+/*************************************************
+* Name:        PQCLEAN_DILITHIUM2_CLEAN_crypto_sign_expand_sk
+*
+* Description: Unpack a secret key, expand the matrix A and transform
+*              the secret vectors to NTT domain.
+*
+* Arguments:   - expanded_sk *esk: pointer to output expanded key
+*              - uint8_t *sk:    pointer to bit-packed secret key
+**************************************************/
+void PQCLEAN_DILITHIUM2_CLEAN_crypto_sign_expand_sk(PQCLEAN_DILITHIUM2_CLEAN_expanded_sk *esk,
+        const uint8_t *sk) {
+    PQCLEAN_DILITHIUM2_CLEAN_unpack_sk(esk->rho, esk->tr, esk->key, &esk->t0, &esk->s1, &esk->s2, sk);
+
+    PQCLEAN_DILITHIUM2_CLEAN_polyvec_matrix_expand(esk->mat, esk->rho);
+    PQCLEAN_DILITHIUM2_CLEAN_polyvecl_ntt(&esk->s1);
+    PQCLEAN_DILITHIUM2_CLEAN_polyveck_ntt(&esk->s2);
+    PQCLEAN_DILITHIUM2_CLEAN_polyveck_ntt(&esk->t0);
+}
+
 /*************************************************
 * Name:        PQCLEAN_DILITHIUM2_CLEAN_crypto_sign_signature
 *
@@ -122,25 +149,49 @@ int PQCLEAN_DILITHIUM2_CLEAN_crypto_sign_signature(uint8_t *sig,
         const uint8_t *m,
         size_t mlen,
         const uint8_t *sk) {
-    unsigned int n;
-    uint8_t seedbuf[3 * SEEDBYTES + 2 * CRHBYTES];
-    uint8_t *rho, *tr, *key, *mu, *rhoprime;
+    PQCLEAN_DILITHIUM2_CLEAN_expanded_sk esk;
+
+    PQCLEAN_DILITHIUM2_CLEAN_crypto_sign_expand_sk(&esk, sk);
+    return PQCLEAN_DILITHIUM2_CLEAN_crypto_sign_signature_expanded(sig, siglen, m, mlen, &esk);
+}
+
+/*************************************************
+* Name:        PQCLEAN_DILITHIUM2_CLEAN_crypto_sign_signature_expanded
+*
+* Description: Computes signature with an expanded secret key.
+*
+* Arguments:   - uint8_t *sig:   pointer to output signature (of length PQCLEAN_DILITHIUM2_CLEAN_CRYPTO_BYTES)
+*              - size_t *siglen: pointer to output length of signature
+*              - uint8_t *m:     pointer to message to be signed
+*              - size_t mlen:    length of message
+*              - expanded_sk *esk: pointer to expanded secret key
+*
+* Returns 0 (success)
+**************************************************/
+int PQCLEAN_DILITHIUM2_CLEAN_crypto_sign_signature_expanded(uint8_t *sig,
+        size_t *siglen,
+        const uint8_t *m,
+        size_t mlen,
+        const PQCLEAN_DILITHIUM2_CLEAN_expanded_sk *esk) {
+    unsigned int i, n;
+    uint8_t seedbuf[SEEDBYTES + 2 * CRHBYTES];
+    uint8_t *key, *mu, *rhoprime;
     uint16_t nonce = 0;
-    polyvecl mat[K], s1, y, z;
-    polyveck t0, s2, w1, w0, h;
+    polyvecl y, z;
+    polyveck w1, w0, h;
     poly cp;
     shake256incctx state;
 
-    rho = seedbuf;
-    tr = rho + SEEDBYTES;
-    key = tr + SEEDBYTES;
+    key = seedbuf;
     mu = key + SEEDBYTES;
     rhoprime = mu + CRHBYTES;
-    PQCLEAN_DILITHIUM2_CLEAN_unpack_sk(rho, tr, key, &t0, &s1, &s2, sk);
+    for (i = 0; i < SEEDBYTES; ++i) {
+        key[i] = esk->key[i];
+    }
 
     /* Compute CRH(tr, msg) */
     shake256_inc_init(&state);
-    shake256_inc_absorb(&state, tr, SEEDBYTES);
+    shake256_inc_absorb(&state, esk->tr, SEEDBYTES);
     shake256_inc_absorb(&state, m, mlen);
     shake256_inc_finalize(&state);
     shake256_inc_squeeze(mu, CRHBYTES, &state);
@@ -148,12 +199,6 @@ int PQCLEAN_DILITHIUM2_CLEAN_crypto_sign_signature(uint8_t *sig,
 
     shake256(rhoprime, CRHBYTES, key, SEEDBYTES + CRHBYTES);
 
-    /* Expand matrix and transform vectors */
-    PQCLEAN_DILITHIUM2_CLEAN_polyvec_matrix_expand(mat, rho);
-    PQCLEAN_DILITHIUM2_CLEAN_polyvecl_ntt(&s1);
-    PQCLEAN_DILITHIUM2_CLEAN_polyveck_ntt(&s2);
-    PQCLEAN_DILITHIUM2_CLEAN_polyveck_ntt(&t0);
-
 rej:
     /* Sample intermediate vector y */
     PQCLEAN_DILITHIUM2_CLEAN_polyvecl_uniform_gamma1(&y, rhoprime, nonce++);
@@ -161,7 +206,7 @@ rej:
     /* Matrix-vector multiplication */
     z = y;
     PQCLEAN_DILITHIUM2_CLEAN_polyvecl_ntt(&z);
-    PQCLEAN_DILITHIUM2_CLEAN_polyvec_matrix_pointwise_montgomery(&w1, mat, &z);
+    PQCLEAN_DILITHIUM2_CLEAN_polyvec_matrix_pointwise_montgomery(&w1, esk->mat, &z);
     PQCLEAN_DILITHIUM2_CLEAN_polyveck_reduce(&w1);
     PQCLEAN_DILITHIUM2_CLEAN_polyveck_invntt_tomont(&w1);
 
@@ -180,7 +225,7 @@ rej:
     PQCLEAN_DILITHIUM2_CLEAN_poly_ntt(&cp);
 
     /* Compute z, reject if it reveals secret */
-    PQCLEAN_DILITHIUM2_CLEAN_polyvecl_pointwise_poly_montgomery(&z, &cp, &s1);
+    PQCLEAN_DILITHIUM2_CLEAN_polyvecl_pointwise_poly_montgomery(&z, &cp, &esk->s1);
     PQCLEAN_DILITHIUM2_CLEAN_polyvecl_invntt_tomont(&z);
     PQCLEAN_DILITHIUM2_CLEAN_polyvecl_add(&z, &z, &y);
     PQCLEAN_DILITHIUM2_CLEAN_polyvecl_reduce(&z);
@@ -190,7 +235,7 @@ rej:
 
     /* Check that subtracting cs2 does not change high bits of w and low bits
      * do not reveal secret information */
-    PQCLEAN_DILITHIUM2_CLEAN_polyveck_pointwise_poly_montgomery(&h, &cp, &s2);
+    PQCLEAN_DILITHIUM2_CLEAN_polyveck_pointwise_poly_montgomery(&h, &cp, &esk->s2);
     PQCLEAN_DILITHIUM2_CLEAN_polyveck_invntt_tomont(&h);
     PQCLEAN_DILITHIUM2_CLEAN_polyveck_sub(&w0, &w0, &h);
     PQCLEAN_DILITHIUM2_CLEAN_polyveck_reduce(&w0);
@@ -199,7 +244,7 @@ rej:
     }
 
     /* Compute hints for w1 */
-    PQCLEAN_DILITHIUM2_CLEAN_polyveck_pointwise_poly_montgomery(&h, &cp, &t0);
+    PQCLEAN_DILITHIUM2_CLEAN_polyveck_pointwise_poly_montgomery(&h, &cp, &esk->t0);
     PQCLEAN_DILITHIUM2_CLEAN_polyveck_invntt_tomont(&h);
     PQCLEAN_DILITHIUM2_CLEAN_polyveck_reduce(&h);
     if (PQCLEAN_DILITHIUM2_CLEAN_polyveck_chknorm(&h, GAMMA2)) {
@@ -249,6 +294,26 @@ int PQCLEAN_DILITHIUM2_CLEAN_crypto_sign(uint8_t *sm,
     return 0;
 }
 
+/*************************************************
+* Name:        PQCLEAN_DILITHIUM2_CLEAN_crypto_sign_expand_pk
+*
+* Description: Unpack a public key, hash it, expand the matrix A and
+*              transform t1 * 2^D to NTT domain.
+*
+* Arguments:   - expanded_pk *epk: pointer to output expanded key
+*              - const uint8_t *pk: pointer to bit-packed public key
+**************************************************/
+void PQCLEAN_DILITHIUM2_CLEAN_crypto_sign_expand_pk(PQCLEAN_DILITHIUM2_CLEAN_expanded_pk *epk,
+        const uint8_t *pk) {
+    uint8_t rho[SEEDBYTES];
+
+    PQCLEAN_DILITHIUM2_CLEAN_unpack_pk(rho, &epk->t1, pk);
+    shake256(epk->tr, SEEDBYTES, pk, PQCLEAN_DILITHIUM2_CLEAN_CRYPTO_PUBLICKEYBYTES);
+    PQCLEAN_DILITHIUM2_CLEAN_polyvec_matrix_expand(epk->mat, rho);
+    PQCLEAN_DILITHIUM2_CLEAN_polyveck_shiftl(&epk->t1);
+    PQCLEAN_DILITHIUM2_CLEAN_polyveck_ntt(&epk->t1);
+}
+
 /*************************************************
 * Name:        PQCLEAN_DILITHIUM2_CLEAN_crypto_sign_verify
 *
@@ -267,14 +332,40 @@ int PQCLEAN_DILITHIUM2_CLEAN_crypto_sign_verify(const uint8_t *sig,
         const uint8_t *m,
         size_t mlen,
         const uint8_t *pk) {
+    PQCLEAN_DILITHIUM2_CLEAN_expanded_pk epk;
+
+    if (siglen != PQCLEAN_DILITHIUM2_CLEAN_CRYPTO_BYTES) {
+        return -1;
+    }
+    PQCLEAN_DILITHIUM2_CLEAN_crypto_sign_expand_pk(&epk, pk);
+    return PQCLEAN_DILITHIUM2_CLEAN_crypto_sign_verify_expanded(sig, siglen, m, mlen, &epk);
+}
+
+/*************************************************
+* Name:        PQCLEAN_DILITHIUM2_CLEAN_crypto_sign_verify_expanded
+*
+* Description: Verifies signature with an expanded public key.
+*
+* Arguments:   - uint8_t *m: pointer to input signature
+*              - size_t siglen: length of signature
+*              - const uint8_t *m: pointer to message
+*              - size_t mlen: length of message
+*              - const expanded_pk *epk: pointer to expanded public key
+*
+* Returns 0 if signature could be verified correctly and -1 otherwise
+**************************************************/
+int PQCLEAN_DILITHIUM2_CLEAN_crypto_sign_verify_expanded(const uint8_t *sig,
+        size_t siglen,
+        const uint8_t *m,
+        size_t mlen,
+        const PQCLEAN_DILITHIUM2_CLEAN_expanded_pk *epk) {
     unsigned int i;
     uint8_t buf[K * POLYW1_PACKEDBYTES];
-    uint8_t rho[SEEDBYTES];
     uint8_t mu[CRHBYTES];
     uint8_t c[SEEDBYTES];
     uint8_t c2[SEEDBYTES];
     poly cp;
-    polyvecl mat[K], z;
+    polyvecl z;
     polyveck t1, w1, h;
     shake256incctx state;
 
@@ -282,7 +373,6 @@ int PQCLEAN_DILITHIUM2_CLEAN_crypto_sign_verify(const uint8_t *sig,
         return -1;
     }
 
-    PQCLEAN_DILITHIUM2_CLEAN_unpack_pk(rho, &t1, pk);
     if (PQCLEAN_DILITHIUM2_CLEAN_unpack_sig(c, &z, &h, sig)) {
         return -1;
     }
@@ -291,9 +381,8 @@ int PQCLEAN_DILITHIUM2_CLEAN_crypto_sign_verify(const uint8_t *sig,
     }
 
     /* Compute CRH(H(rho, t1), msg) */
-    shake256(mu, SEEDBYTES, pk, PQCLEAN_DILITHIUM2_CLEAN_CRYPTO_PUBLICKEYBYTES);
     shake256_inc_init(&state);
-    shake256_inc_absorb(&state, mu, SEEDBYTES);
+    shake256_inc_absorb(&state, epk->tr, SEEDBYTES);
     shake256_inc_absorb(&state, m, mlen);
     shake256_inc_finalize(&state);
     shake256_inc_squeeze(mu, CRHBYTES, &state);
@@ -301,15 +390,12 @@ int PQCLEAN_DILITHIUM2_CLEAN_crypto_sign_verify(const uint8_t *sig,
 
     /* Matrix-vector multiplication; compute Az - c2^dt1 */
     PQCLEAN_DILITHIUM2_CLEAN_poly_challenge(&cp, c);
-    PQCLEAN_DILITHIUM2_CLEAN_polyvec_matrix_expand(mat, rho);
 
     PQCLEAN_DILITHIUM2_CLEAN_polyvecl_ntt(&z);
-    PQCLEAN_DILITHIUM2_CLEAN_polyvec_matrix_pointwise_montgomery(&w1, mat, &z);
+    PQCLEAN_DILITHIUM2_CLEAN_polyvec_matrix_pointwise_montgomery(&w1, epk->mat, &z);
 
     PQCLEAN_DILITHIUM2_CLEAN_poly_ntt(&cp);
-    PQCLEAN_DILITHIUM2_CLEAN_polyveck_shiftl(&t1);
-    PQCLEAN_DILITHIUM2_CLEAN_polyveck_ntt(&t1);
-    PQCLEAN_DILITHIUM2_CLEAN_polyveck_pointwise_poly_montgomery(&t1, &cp, &t1);
+    PQCLEAN_DILITHIUM2_CLEAN_polyveck_pointwise_poly_montgomery(&t1, &cp, &epk->t1);
 
     PQCLEAN_DILITHIUM2_CLEAN_polyveck_sub(&w1, &w1, &t1);
     PQCLEAN_DILITHIUM2_CLEAN_polyveck_reduce(&w1);
@@ -28,4 +28,41 @@ int PQCLEAN_DILITHIUM2_CLEAN_crypto_sign_open(uint8_t *m, size_t *mlen,
         const uint8_t *sm, size_t smlen,
         const uint8_t *pk);
 
+/* Keys unpacked with the matrix A expanded from rho and the vectors in
+ * NTT domain, so that many messages signed or verified with the same
+ * key pay for the expansion only once. */
+typedef struct {
+    uint8_t rho[SEEDBYTES];
+    uint8_t tr[SEEDBYTES];
+    uint8_t key[SEEDBYTES];
+    polyvecl mat[K];
+    polyvecl s1;
+    polyveck s2;
+    polyveck t0;
+} PQCLEAN_DILITHIUM2_CLEAN_expanded_sk;
+
+typedef struct {
+    uint8_t tr[SEEDBYTES];
+    polyvecl mat[K];
+    polyveck t1;
+} PQCLEAN_DILITHIUM2_CLEAN_expanded_pk;
+
+size_t PQCLEAN_DILITHIUM2_CLEAN_crypto_sign_expanded_sk_bytes(void);
+
+size_t PQCLEAN_DILITHIUM2_CLEAN_crypto_sign_expanded_pk_bytes(void);
+
+void PQCLEAN_DILITHIUM2_CLEAN_crypto_sign_expand_sk(PQCLEAN_DILITHIUM2_CLEAN_expanded_sk *esk,
+        const uint8_t *sk);
+
+void PQCLEAN_DILITHIUM2_CLEAN_crypto_sign_expand_pk(PQCLEAN_DILITHIUM2_CLEAN_expanded_pk *epk,
+        const uint8_t *pk);
+
+int PQCLEAN_DILITHIUM2_CLEAN_crypto_sign_signature_expanded(uint8_t *sig, size_t *siglen,
+        const uint8_t *m, size_t mlen,
+        const PQCLEAN_DILITHIUM2_CLEAN_expanded_sk *esk);
+
+int PQCLEAN_DILITHIUM2_CLEAN_crypto_sign_verify_expanded(const uint8_t *sig, size_t siglen,
+        const uint8_t *m, size_t mlen,
+        const PQCLEAN_DILITHIUM2_CLEAN_expanded_pk *epk);
+
 #endif
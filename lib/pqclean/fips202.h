@@ -164,4 +164,7 @@ void sha3_512_inc_ctx_release(sha3_512incctx *state);
 /* One-stop SHA3-512 shop */
 void sha3_512(uint8_t *output, const uint8_t *input, size_t inlen);
 
+/* The Keccak-f[1600] permutation, also used by the 4-way code */
+void KeccakF1600_StatePermute(uint64_t *state);
+
 #endif
@@ -0,0 +1,509 @@
+/* Four-way parallel Keccak. The AVX2 permutation keeps one 64-bit lane
+ * of each of the four states in a 256-bit register, so one permutation
+ * costs about as much as a single scalar one. */
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "cpufeatures.h"
+#include "fips202x4.h"
+
+#if defined(PQCLEAN_AVX2)
+#include <immintrin.h>
+#endif
+
+#define NROUNDS 24
+
+static const uint64_t KeccakF_RoundConstants[NROUNDS] = {
+    0x0000000000000001ULL, 0x0000000000008082ULL,
+    0x800000000000808aULL, 0x8000000080008000ULL,
+    0x000000000000808bULL, 0x0000000080000001ULL,
+    0x8000000080008081ULL, 0x8000000000008009ULL,
+    0x000000000000008aULL, 0x0000000000000088ULL,
+    0x0000000080008009ULL, 0x000000008000000aULL,
+    0x000000008000808bULL, 0x800000000000008bULL,
+    0x8000000000008089ULL, 0x8000000000008003ULL,
+    0x8000000000008002ULL, 0x8000000000000080ULL,
+    0x000000000000800aULL, 0x800000008000000aULL,
+    0x8000000080008081ULL, 0x8000000000008080ULL,
+    0x0000000080000001ULL, 0x8000000080008008ULL
+};
+
+static uint64_t load64(const uint8_t *x) {
+    uint64_t r = 0;
+    for (size_t i = 0; i < 8; ++i) {
+        r |= (uint64_t)x[i] << 8 * i;
+    }
+    return r;
+}
+
+static void store64(uint8_t *x, uint64_t u) {
+    for (size_t i = 0; i < 8; ++i) {
+        x[i] = (uint8_t) (u >> 8 * i);
+    }
+}
+
+#if defined(PQCLEAN_AVX2)
+
+/* Same unrolled round code as the single-instance permutation, with
+ * each lane held in a vector of the four interleaved states */
+typedef uint64_t v4u64 __attribute__((vector_size(32)));
+
+#define ROL(a, offset) (((a) << (offset)) ^ ((a) >> (64 - (offset))))
+#define LOAD4(s, i) ((v4u64)_mm256_loadu_si256((const __m256i *)((s) + 4 * (i))))
+#define STORE4(s, i, v) _mm256_storeu_si256((__m256i *)((s) + 4 * (i)), (__m256i)(v))
+
+static PQCLEAN_AVX2_TARGET void permute_avx2(uint64_t *state) {
+    int round;
+
+    v4u64 Aba, Abe, Abi, Abo, Abu;
+    v4u64 Aga, Age, Agi, Ago, Agu;
+    v4u64 Aka, Ake, Aki, Ako, Aku;
+    v4u64 Ama, Ame, Ami, Amo, Amu;
+    v4u64 Asa, Ase, Asi, Aso, Asu;
+    v4u64 BCa, BCe, BCi, BCo, BCu;
+    v4u64 Da, De, Di, Do, Du;
+    v4u64 Eba, Ebe, Ebi, Ebo, Ebu;
+    v4u64 Ega, Ege, Egi, Ego, Egu;
+    v4u64 Eka, Eke, Eki, Eko, Eku;
+    v4u64 Ema, Eme, Emi, Emo, Emu;
+    v4u64 Esa, Ese, Esi, Eso, Esu;
+
+    // copyFromState(A, state)
+    Aba = LOAD4(state, 0);
+    Abe = LOAD4(state, 1);
+    Abi = LOAD4(state, 2);
+    Abo = LOAD4(state, 3);
+    Abu = LOAD4(state, 4);
+    Aga = LOAD4(state, 5);
+    Age = LOAD4(state, 6);
+    Agi = LOAD4(state, 7);
+    Ago = LOAD4(state, 8);
+    Agu = LOAD4(state, 9);
+    Aka = LOAD4(state, 10);
+    Ake = LOAD4(state, 11);
+    Aki = LOAD4(state, 12);
+    Ako = LOAD4(state, 13);
+    Aku = LOAD4(state, 14);
+    Ama = LOAD4(state, 15);
+    Ame = LOAD4(state, 16);
+    Ami = LOAD4(state, 17);
+    Amo = LOAD4(state, 18);
+    Amu = LOAD4(state, 19);
+    Asa = LOAD4(state, 20);
+    Ase = LOAD4(state, 21);
+    Asi = LOAD4(state, 22);
+    Aso = LOAD4(state, 23);
+    Asu = LOAD4(state, 24);
+
+    for (round = 0; round < NROUNDS; round += 2) {
+        //    prepareTheta
+        BCa = Aba ^ Aga ^ Aka ^ Ama ^ Asa;
+        BCe = Abe ^ Age ^ Ake ^ Ame ^ Ase;
+        BCi = Abi ^ Agi ^ Aki ^ Ami ^ Asi;
+        BCo = Abo ^ Ago ^ Ako ^ Amo ^ Aso;
+        BCu = Abu ^ Agu ^ Aku ^ Amu ^ Asu;
+
+        // thetaRhoPiChiIotaPrepareTheta(round  , A, E)
+        Da = BCu ^ ROL(BCe, 1);
+        De = BCa ^ ROL(BCi, 1);
+        Di = BCe ^ ROL(BCo, 1);
+        Do = BCi ^ ROL(BCu, 1);
+        Du = BCo ^ ROL(BCa, 1);
+
+        Aba ^= Da;
+        BCa = Aba;
+        Age ^= De;
+        BCe = ROL(Age, 44);
+        Aki ^= Di;
+        BCi = ROL(Aki, 43);
+        Amo ^= Do;
+        BCo = ROL(Amo, 21);
+        Asu ^= Du;
+        BCu = ROL(Asu, 14);
+        Eba = BCa ^ ((~BCe) & BCi);
+        Eba ^= (v4u64)_mm256_set1_epi64x((long long)KeccakF_RoundConstants[round]);
+        Ebe = BCe ^ ((~BCi) & BCo);
+        Ebi = BCi ^ ((~BCo) & BCu);
+        Ebo = BCo ^ ((~BCu) & BCa);
+        Ebu = BCu ^ ((~BCa) & BCe);
+
+        Abo ^= Do;
+        BCa = ROL(Abo, 28);
+        Agu ^= Du;
+        BCe = ROL(Agu, 20);
+        Aka ^= Da;
+        BCi = ROL(Aka, 3);
+        Ame ^= De;
+        BCo = ROL(Ame, 45);
+        Asi ^= Di;
+        BCu = ROL(Asi, 61);
+        Ega = BCa ^ ((~BCe) & BCi);
+        Ege = BCe ^ ((~BCi) & BCo);
+        Egi = BCi ^ ((~BCo) & BCu);
+        Ego = BCo ^ ((~BCu) & BCa);
+        Egu = BCu ^ ((~BCa) & BCe);
+
+        Abe ^= De;
+        BCa = ROL(Abe, 1);
+        Agi ^= Di;
+        BCe = ROL(Agi, 6);
+        Ako ^= Do;
+        BCi = ROL(Ako, 25);
+        Amu ^= Du;
+        BCo = ROL(Amu, 8);
+        Asa ^= Da;
+        BCu = ROL(Asa, 18);
+        Eka = BCa ^ ((~BCe) & BCi);
+        Eke = BCe ^ ((~BCi) & BCo);
+        Eki = BCi ^ ((~BCo) & BCu);
+        Eko = BCo ^ ((~BCu) & BCa);
+        Eku = BCu ^ ((~BCa) & BCe);
+
+        Abu ^= Du;
+        BCa = ROL(Abu, 27);
+        Aga ^= Da;
+        BCe = ROL(Aga, 36);
+        Ake ^= De;
+        BCi = ROL(Ake, 10);
+        Ami ^= Di;
+        BCo = ROL(Ami, 15);
+        Aso ^= Do;
+        BCu = ROL(Aso, 56);
+        Ema = BCa ^ ((~BCe) & BCi);
+        Eme = BCe ^ ((~BCi) & BCo);
+        Emi = BCi ^ ((~BCo) & BCu);
+        Emo = BCo ^ ((~BCu) & BCa);
+        Emu = BCu ^ ((~BCa) & BCe);
+
+        Abi ^= Di;
+        BCa = ROL(Abi, 62);
+        Ago ^= Do;
+        BCe = ROL(Ago, 55);
+        Aku ^= Du;
+        BCi = ROL(Aku, 39);
+        Ama ^= Da;
+        BCo = ROL(Ama, 41);
+        Ase ^= De;
+        BCu = ROL(Ase, 2);
+        Esa = BCa ^ ((~BCe) & BCi);
+        Ese = BCe ^ ((~BCi) & BCo);
+        Esi = BCi ^ ((~BCo) & BCu);
+        Eso = BCo ^ ((~BCu) & BCa);
+        Esu = BCu ^ ((~BCa) & BCe);
+
+        //    prepareTheta
+        BCa = Eba ^ Ega ^ Eka ^ Ema ^ Esa;
+        BCe = Ebe ^ Ege ^ Eke ^ Eme ^ Ese;
+        BCi = Ebi ^ Egi ^ Eki ^ Emi ^ Esi;
+        BCo = Ebo ^ Ego ^ Eko ^ Emo ^ Eso;
+        BCu = Ebu ^ Egu ^ Eku ^ Emu ^ Esu;
+
+        // thetaRhoPiChiIotaPrepareTheta(round+1, E, A)
+        Da = BCu ^ ROL(BCe, 1);
+        De = BCa ^ ROL(BCi, 1);
+        Di = BCe ^ ROL(BCo, 1);
+        Do = BCi ^ ROL(BCu, 1);
+        Du = BCo ^ ROL(BCa, 1);
+
+        Eba ^= Da;
+        BCa = Eba;
+        Ege ^= De;
+        BCe = ROL(Ege, 44);
+        Eki ^= Di;
+        BCi = ROL(Eki, 43);
+        Emo ^= Do;
+        BCo = ROL(Emo, 21);
+        Esu ^= Du;
+        BCu = ROL(Esu, 14);
+        Aba = BCa ^ ((~BCe) & BCi);
+        Aba ^= (v4u64)_mm256_set1_epi64x((long long)KeccakF_RoundConstants[round + 1]);
+        Abe = BCe ^ ((~BCi) & BCo);
+        Abi = BCi ^ ((~BCo) & BCu);
+        Abo = BCo ^ ((~BCu) & BCa);
+        Abu = BCu ^ ((~BCa) & BCe);
+
+        Ebo ^= Do;
+        BCa = ROL(Ebo, 28);
+        Egu ^= Du;
+        BCe = ROL(Egu, 20);
+        Eka ^= Da;
+        BCi = ROL(Eka, 3);
+        Eme ^= De;
+        BCo = ROL(Eme, 45);
+        Esi ^= Di;
+        BCu = ROL(Esi, 61);
+        Aga = BCa ^ ((~BCe) & BCi);
+        Age = BCe ^ ((~BCi) & BCo);
+        Agi = BCi ^ ((~BCo) & BCu);
+        Ago = BCo ^ ((~BCu) & BCa);
+        Agu = BCu ^ ((~BCa) & BCe);
+
+        Ebe ^= De;
+        BCa = ROL(Ebe, 1);
+        Egi ^= Di;
+        BCe = ROL(Egi, 6);
+        Eko ^= Do;
+        BCi = ROL(Eko, 25);
+        Emu ^= Du;
+        BCo = ROL(Emu, 8);
+        Esa ^= Da;
+        BCu = ROL(Esa, 18);
+        Aka = BCa ^ ((~BCe) & BCi);
+        Ake = BCe ^ ((~BCi) & BCo);
+        Aki = BCi ^ ((~BCo) & BCu);
+        Ako = BCo ^ ((~BCu) & BCa);
+        Aku = BCu ^ ((~BCa) & BCe);
+
+        Ebu ^= Du;
+        BCa = ROL(Ebu, 27);
+        Ega ^= Da;
+        BCe = ROL(Ega, 36);
+        Eke ^= De;
+        BCi = ROL(Eke, 10);
+        Emi ^= Di;
+        BCo = ROL(Emi, 15);
+        Eso ^= Do;
+        BCu = ROL(Eso, 56);
+        Ama = BCa ^ ((~BCe) & BCi);
+        Ame = BCe ^ ((~BCi) & BCo);
+        Ami = BCi ^ ((~BCo) & BCu);
+        Amo = BCo ^ ((~BCu) & BCa);
+        Amu = BCu ^ ((~BCa) & BCe);
+
+        Ebi ^= Di;
+        BCa = ROL(Ebi, 62);
+        Ego ^= Do;
+        BCe = ROL(Ego, 55);
+        Eku ^= Du;
+        BCi = ROL(Eku, 39);
+        Ema ^= Da;
+        BCo = ROL(Ema, 41);
+        Ese ^= De;
+        BCu = ROL(Ese, 2);
+        Asa = BCa ^ ((~BCe) & BCi);
+        Ase = BCe ^ ((~BCi) & BCo);
+        Asi = BCi ^ ((~BCo) & BCu);
+        Aso = BCo ^ ((~BCu) & BCa);
+        Asu = BCu ^ ((~BCa) & BCe);
+    }
+
+    // copyToState(state, A)
+    STORE4(state, 0, Aba);
+    STORE4(state, 1, Abe);
+    STORE4(state, 2, Abi);
+    STORE4(state, 3, Abo);
+    STORE4(state, 4, Abu);
+    STORE4(state, 5, Aga);
+    STORE4(state, 6, Age);
+    STORE4(state, 7, Agi);
+    STORE4(state, 8, Ago);
+    STORE4(state, 9, Agu);
+    STORE4(state, 10, Aka);
+    STORE4(state, 11, Ake);
+    STORE4(state, 12, Aki);
+    STORE4(state, 13, Ako);
+    STORE4(state, 14, Aku);
+    STORE4(state, 15, Ama);
+    STORE4(state, 16, Ame);
+    STORE4(state, 17, Ami);
+    STORE4(state, 18, Amo);
+    STORE4(state, 19, Amu);
+    STORE4(state, 20, Asa);
+    STORE4(state, 21, Ase);
+    STORE4(state, 22, Asi);
+    STORE4(state, 23, Aso);
+    STORE4(state, 24, Asu);
+}
+
+#endif
+
+/*************************************************
+ * Name:        KeccakF1600_StatePermute4x
+ *
+ * Description: Apply the Keccak F1600 permutation to four interleaved
+ *              states, using AVX2 when it is available and enabled
+ *
+ * Arguments:   - uint64_t *s: pointer to 100 interleaved lanes
+ **************************************************/
+void KeccakF1600_StatePermute4x(uint64_t *s) {
+    uint64_t t[25];
+    int i, j;
+
+#if defined(PQCLEAN_AVX2)
+    if (PQCLEAN_avx2_enabled()) {
+        permute_avx2(s);
+        return;
+    }
+#endif
+    for (j = 0; j < 4; j++) {
+        for (i = 0; i < 25; i++) {
+            t[i] = s[4 * i + j];
+        }
+        KeccakF1600_StatePermute(t);
+        for (i = 0; i < 25; i++) {
+            s[4 * i + j] = t[i];
+        }
+    }
+}
+
+/* Absorb four messages spanning the same number of full blocks into a
+ * zeroed state, then apply the padding p. */
+static void keccakx4_absorb(uint64_t *s, uint32_t r,
+                            const uint8_t *in[4], const size_t inlen[4],
+                            uint8_t p) {
+    uint8_t t[200];
+    size_t nblocks = inlen[0] / r;
+    size_t b, i, rest;
+    int j;
+
+    memset(s, 0, sizeof(uint64_t) * 100);
+
+    for (b = 0; b < nblocks; b++) {
+        for (j = 0; j < 4; j++) {
+            for (i = 0; i < r / 8; i++) {
+                s[4 * i + j] ^= load64(in[j] + b * r + 8 * i);
+            }
+        }
+        KeccakF1600_StatePermute4x(s);
+    }
+
+    for (j = 0; j < 4; j++) {
+        rest = inlen[j] - nblocks * r;
+        memset(t, 0, r);
+        memcpy(t, in[j] + nblocks * r, rest);
+        t[rest] = p;
+        t[r - 1] |= 128;
+        for (i = 0; i < r / 8; i++) {
+            s[4 * i + j] ^= load64(t + 8 * i);
+        }
+    }
+}
+
+static void keccakx4_squeezeblocks(uint8_t *out[4], size_t nblocks,
+                                   uint64_t *s, uint32_t r) {
+    size_t i;
+    int j;
+
+    while (nblocks > 0) {
+        KeccakF1600_StatePermute4x(s);
+        for (j = 0; j < 4; j++) {
+            for (i = 0; i < r / 8; i++) {
+                store64(out[j] + 8 * i, s[4 * i + j]);
+            }
+            out[j] += r;
+        }
+        nblocks--;
+    }
+}
+
+static void shakex4_absorb(keccakx4_state *state, uint32_t r,
+                           const uint8_t *in0, const uint8_t *in1,
+                           const uint8_t *in2, const uint8_t *in3,
+                           size_t inlen) {
+    const uint8_t *in[4] = { in0, in1, in2, in3 };
+    const size_t len[4] = { inlen, inlen, inlen, inlen };
+    keccakx4_absorb(state->s, r, in, len, 0x1F);
+}
+
+static void shakex4_squeezeblocks(uint8_t *out0, uint8_t *out1,
+                                  uint8_t *out2, uint8_t *out3,
+                                  size_t nblocks, keccakx4_state *state,
+                                  uint32_t r) {
+    uint8_t *out[4] = { out0, out1, out2, out3 };
+    keccakx4_squeezeblocks(out, nblocks, state->s, r);
+}
+
+static void shakex4(uint8_t *out0, uint8_t *out1, uint8_t *out2, uint8_t *out3,
+                    size_t outlen, uint32_t r,
+                    const uint8_t *in0, const uint8_t *in1,
+                    const uint8_t *in2, const uint8_t *in3,
+                    size_t inlen) {
+    keccakx4_state state;
+    uint8_t t[4][SHAKE128_RATE];
+    size_t nblocks = outlen / r;
+    size_t rest = outlen - nblocks * r;
+
+    shakex4_absorb(&state, r, in0, in1, in2, in3, inlen);
+    shakex4_squeezeblocks(out0, out1, out2, out3, nblocks, &state, r);
+    if (rest) {
+        shakex4_squeezeblocks(t[0], t[1], t[2], t[3], 1, &state, r);
+        memcpy(out0 + nblocks * r, t[0], rest);
+        memcpy(out1 + nblocks * r, t[1], rest);
+        memcpy(out2 + nblocks * r, t[2], rest);
+        memcpy(out3 + nblocks * r, t[3], rest);
+    }
+}
+
+void shake128x4_absorb(keccakx4_state *state,
+                       const uint8_t *in0, const uint8_t *in1,
+                       const uint8_t *in2, const uint8_t *in3,
+                       size_t inlen) {
+    shakex4_absorb(state, SHAKE128_RATE, in0, in1, in2, in3, inlen);
+}
+
+void shake128x4_squeezeblocks(uint8_t *out0, uint8_t *out1,
+                              uint8_t *out2, uint8_t *out3,
+                              size_t nblocks, keccakx4_state *state) {
+    shakex4_squeezeblocks(out0, out1, out2, out3, nblocks, state, SHAKE128_RATE);
+}
+
+void shake256x4_absorb(keccakx4_state *state,
+                       const uint8_t *in0, const uint8_t *in1,
+                       const uint8_t *in2, const uint8_t *in3,
+                       size_t inlen) {
+    shakex4_absorb(state, SHAKE256_RATE, in0, in1, in2, in3, inlen);
+}
+
+void shake256x4_squeezeblocks(uint8_t *out0, uint8_t *out1,
+                              uint8_t *out2, uint8_t *out3,
+                              size_t nblocks, keccakx4_state *state) {
+    shakex4_squeezeblocks(out0, out1, out2, out3, nblocks, state, SHAKE256_RATE);
+}
+
+void shake128x4(uint8_t *out0, uint8_t *out1, uint8_t *out2, uint8_t *out3,
+                size_t outlen,
+                const uint8_t *in0, const uint8_t *in1,
+                const uint8_t *in2, const uint8_t *in3,
+                size_t inlen) {
+    shakex4(out0, out1, out2, out3, outlen, SHAKE128_RATE,
+            in0, in1, in2, in3, inlen);
+}
+
+void shake256x4(uint8_t *out0, uint8_t *out1, uint8_t *out2, uint8_t *out3,
+                size_t outlen,
+                const uint8_t *in0, const uint8_t *in1,
+                const uint8_t *in2, const uint8_t *in3,
+                size_t inlen) {
+    shakex4(out0, out1, out2, out3, outlen, SHAKE256_RATE,
+            in0, in1, in2, in3, inlen);
+}
+
+static int hash256x4(uint8_t *out[4], const uint8_t *in[4],
+                     const size_t inlen[4], uint8_t p) {
+    keccakx4_state state;
+    int i, j;
+
+    for (j = 1; j < 4; j++) {
+        if (inlen[j] / SHA3_256_RATE != inlen[0] / SHA3_256_RATE) {
+            return -1;
+        }
+    }
+    keccakx4_absorb(state.s, SHA3_256_RATE, in, inlen, p);
+    KeccakF1600_StatePermute4x(state.s);
+    for (j = 0; j < 4; j++) {
+        for (i = 0; i < 4; i++) {
+            store64(out[j] + 8 * i, state.s[4 * i + j]);
+        }
+    }
+    return 0;
+}
+
+int sha3_256x4(uint8_t *out[4], const uint8_t *in[4], const size_t inlen[4]) {
+    return hash256x4(out, in, inlen, 0x06);
+}
+
+int keccak256x4(uint8_t *out[4], const uint8_t *in[4], const size_t inlen[4]) {
+    return hash256x4(out, in, inlen, 0x01);
+}
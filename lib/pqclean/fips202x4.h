@@ -0,0 +1,61 @@
+#ifndef FIPS202X4_H
+#define FIPS202X4_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "fips202.h"
+
+/* Four independent Keccak states processed in parallel. The lanes are
+ * interleaved so that lane i of instance j is s[4*i + j], which is the
+ * layout of one 256-bit register per lane in the AVX2 permutation.
+ * Without AVX2 the four instances are permuted one after the other. */
+typedef struct {
+    uint64_t s[100];
+} keccakx4_state;
+
+void KeccakF1600_StatePermute4x(uint64_t *s);
+
+/* SHAKE on four inputs of the same length at once. As with the
+ * single-instance non-incremental API the absorb call starts from a
+ * zero state and squeezeblocks can be called repeatedly. */
+void shake128x4_absorb(keccakx4_state *state,
+                       const uint8_t *in0, const uint8_t *in1,
+                       const uint8_t *in2, const uint8_t *in3,
+                       size_t inlen);
+
+void shake128x4_squeezeblocks(uint8_t *out0, uint8_t *out1,
+                              uint8_t *out2, uint8_t *out3,
+                              size_t nblocks, keccakx4_state *state);
+
+void shake256x4_absorb(keccakx4_state *state,
+                       const uint8_t *in0, const uint8_t *in1,
+                       const uint8_t *in2, const uint8_t *in3,
+                       size_t inlen);
+
+void shake256x4_squeezeblocks(uint8_t *out0, uint8_t *out1,
+                              uint8_t *out2, uint8_t *out3,
+                              size_t nblocks, keccakx4_state *state);
+
+void shake128x4(uint8_t *out0, uint8_t *out1, uint8_t *out2, uint8_t *out3,
+                size_t outlen,
+                const uint8_t *in0, const uint8_t *in1,
+                const uint8_t *in2, const uint8_t *in3,
+                size_t inlen);
+
+void shake256x4(uint8_t *out0, uint8_t *out1, uint8_t *out2, uint8_t *out3,
+                size_t outlen,
+                const uint8_t *in0, const uint8_t *in1,
+                const uint8_t *in2, const uint8_t *in3,
+                size_t inlen);
+
+/* Fixed length digests of four messages. The messages may differ in
+ * length as long as they span the same number of full rate blocks,
+ * that is inlen[j] / rate is the same for all four (136 bytes for
+ * both SHA3-256 and Keccak-256). Returns 0 on success, -1 otherwise. */
+int sha3_256x4(uint8_t *out[4], const uint8_t *in[4], const size_t inlen[4]);
+
+/* Keccak-256 with the original 0x01 padding, as used by Ethereum */
+int keccak256x4(uint8_t *out[4], const uint8_t *in[4], const size_t inlen[4]);
+
+#endif
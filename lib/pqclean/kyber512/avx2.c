@@ -0,0 +1,263 @@
+#include "avx2.h"
+
+#if defined(PQCLEAN_AVX2)
+#include "ntt.h"
+#include "reduce.h"
+#include <immintrin.h>
+
+/* The NTT layers with len >= 16 map directly on 16 int16 lanes sharing
+ * one zeta. The three lower layers (len 8, 4, 2) work on pairs of
+ * vectors that are deinterleaved at 128, 64 and 32 bit granularity so
+ * that all "a" coefficients of the butterflies land in one register and
+ * all "b" coefficients in the other; the per-lane zetas are expanded
+ * once in the same layout. */
+
+#define QINV16 ((int16_t)QINV)
+#define BARRETT_V (((1U << 26) + KYBER_Q / 2) / KYBER_Q)
+
+static int16_t zetas_fwd[3][KYBER_N / 2];
+static int16_t zetas_inv[3][KYBER_N / 2];
+static int16_t zetas_mul[KYBER_N];
+static int tables_ready = 0;
+
+static inline PQCLEAN_AVX2_TARGET __m256i fqmul(__m256i a, __m256i b) {
+    const __m256i qinv = _mm256_set1_epi16(QINV16);
+    const __m256i q = _mm256_set1_epi16(KYBER_Q);
+    __m256i lo = _mm256_mullo_epi16(a, b);
+    __m256i hi = _mm256_mulhi_epi16(a, b);
+    lo = _mm256_mullo_epi16(lo, qinv);
+    lo = _mm256_mulhi_epi16(lo, q);
+    return _mm256_sub_epi16(hi, lo);
+}
+
+static inline PQCLEAN_AVX2_TARGET __m256i barrett(__m256i a) {
+    const __m256i v = _mm256_set1_epi16(BARRETT_V);
+    const __m256i q = _mm256_set1_epi16(KYBER_Q);
+    const __m256i rnd = _mm256_set1_epi16(1 << 9);
+    __m256i t = _mm256_mulhi_epi16(a, v);
+    t = _mm256_srai_epi16(_mm256_add_epi16(t, rnd), 10);
+    t = _mm256_mullo_epi16(t, q);
+    return _mm256_sub_epi16(a, t);
+}
+
+/* deinterleave x, y into a (first halves) and b (second halves) of
+ * butterflies of size 'bits' (128, 64 or 32) and back */
+static inline PQCLEAN_AVX2_TARGET void split(__m256i *a, __m256i *b,
+        __m256i x, __m256i y, int bits) {
+    switch (bits) {
+    case 128:
+        *a = _mm256_permute2x128_si256(x, y, 0x20);
+        *b = _mm256_permute2x128_si256(x, y, 0x31);
+        break;
+    case 64:
+        *a = _mm256_unpacklo_epi64(x, y);
+        *b = _mm256_unpackhi_epi64(x, y);
+        break;
+    default:
+        x = _mm256_shuffle_epi32(x, 0xD8);
+        y = _mm256_shuffle_epi32(y, 0xD8);
+        *a = _mm256_unpacklo_epi64(x, y);
+        *b = _mm256_unpackhi_epi64(x, y);
+        break;
+    }
+}
+
+static inline PQCLEAN_AVX2_TARGET void merge(__m256i *x, __m256i *y,
+        __m256i a, __m256i b, int bits) {
+    switch (bits) {
+    case 128:
+        *x = _mm256_permute2x128_si256(a, b, 0x20);
+        *y = _mm256_permute2x128_si256(a, b, 0x31);
+        break;
+    case 64:
+        *x = _mm256_unpacklo_epi64(a, b);
+        *y = _mm256_unpackhi_epi64(a, b);
+        break;
+    default:
+        *x = _mm256_shuffle_epi32(_mm256_unpacklo_epi64(a, b), 0xD8);
+        *y = _mm256_shuffle_epi32(_mm256_unpackhi_epi64(a, b), 0xD8);
+        break;
+    }
+}
+
+/* expand the zetas of layers len = 8, 4, 2 into lane order */
+static PQCLEAN_AVX2_TARGET void init_tables(void) {
+    int16_t fwd[KYBER_N], inv[KYBER_N];
+    unsigned int l, len, i;
+    __m256i x, y, a, b;
+
+    for (l = 0, len = 8; len >= 2; len >>= 1, l++) {
+        for (i = 0; i < KYBER_N; i++) {
+            fwd[i] = PQCLEAN_KYBER512_CLEAN_zetas[128 / len + i / (2 * len)];
+            inv[i] = PQCLEAN_KYBER512_CLEAN_zetas[256 / len - 1 - i / (2 * len)];
+        }
+        for (i = 0; i < KYBER_N; i += 32) {
+            x = _mm256_loadu_si256((const __m256i *)&fwd[i]);
+            y = _mm256_loadu_si256((const __m256i *)&fwd[i + 16]);
+            split(&a, &b, x, y, len * 16);
+            _mm256_storeu_si256((__m256i *)&zetas_fwd[l][i / 2], a);
+            x = _mm256_loadu_si256((const __m256i *)&inv[i]);
+            y = _mm256_loadu_si256((const __m256i *)&inv[i + 16]);
+            split(&a, &b, x, y, len * 16);
+            _mm256_storeu_si256((__m256i *)&zetas_inv[l][i / 2], a);
+        }
+    }
+    /* basemul: zeta of each pair on its odd lane */
+    for (i = 0; i < KYBER_N / 2; i++) {
+        zetas_mul[2 * i] = 0;
+        zetas_mul[2 * i + 1] = (i & 1) ? -PQCLEAN_KYBER512_CLEAN_zetas[64 + i / 2]
+                               : PQCLEAN_KYBER512_CLEAN_zetas[64 + i / 2];
+    }
+    tables_ready = 1;
+}
+
+PQCLEAN_AVX2_TARGET void PQCLEAN_KYBER512_AVX2_ntt(int16_t r[256]) {
+    unsigned int len, start, j, k, l;
+    __m256i x, y, a, b, t, z;
+
+    if (!tables_ready) {
+        init_tables();
+    }
+    k = 1;
+    for (len = 128; len >= 16; len >>= 1) {
+        for (start = 0; start < 256; start += 2 * len) {
+            z = _mm256_set1_epi16(PQCLEAN_KYBER512_CLEAN_zetas[k++]);
+            for (j = start; j < start + len; j += 16) {
+                a = _mm256_loadu_si256((const __m256i *)&r[j]);
+                b = _mm256_loadu_si256((const __m256i *)&r[j + len]);
+                t = fqmul(z, b);
+                _mm256_storeu_si256((__m256i *)&r[j + len], _mm256_sub_epi16(a, t));
+                _mm256_storeu_si256((__m256i *)&r[j], _mm256_add_epi16(a, t));
+            }
+        }
+    }
+    for (l = 0, len = 8; len >= 2; len >>= 1, l++) {
+        for (j = 0; j < 256; j += 32) {
+            x = _mm256_loadu_si256((const __m256i *)&r[j]);
+            y = _mm256_loadu_si256((const __m256i *)&r[j + 16]);
+            split(&a, &b, x, y, len * 16);
+            z = _mm256_loadu_si256((const __m256i *)&zetas_fwd[l][j / 2]);
+            t = fqmul(z, b);
+            b = _mm256_sub_epi16(a, t);
+            a = _mm256_add_epi16(a, t);
+            merge(&x, &y, a, b, len * 16);
+            _mm256_storeu_si256((__m256i *)&r[j], x);
+            _mm256_storeu_si256((__m256i *)&r[j + 16], y);
+        }
+    }
+}
+
+PQCLEAN_AVX2_TARGET void PQCLEAN_KYBER512_AVX2_invntt(int16_t r[256]) {
+    unsigned int len, start, j, k, l;
+    __m256i x, y, a, b, t, z;
+    const __m256i f = _mm256_set1_epi16(1441); // mont^2/128
+
+    if (!tables_ready) {
+        init_tables();
+    }
+    for (l = 2, len = 2; len <= 8; len <<= 1, l--) {
+        for (j = 0; j < 256; j += 32) {
+            x = _mm256_loadu_si256((const __m256i *)&r[j]);
+            y = _mm256_loadu_si256((const __m256i *)&r[j + 16]);
+            split(&a, &b, x, y, len * 16);
+            z = _mm256_loadu_si256((const __m256i *)&zetas_inv[l][j / 2]);
+            t = a;
+            a = barrett(_mm256_add_epi16(t, b));
+            b = fqmul(z, _mm256_sub_epi16(b, t));
+            merge(&x, &y, a, b, len * 16);
+            _mm256_storeu_si256((__m256i *)&r[j], x);
+            _mm256_storeu_si256((__m256i *)&r[j + 16], y);
+        }
+    }
+    k = 15;
+    for (len = 16; len <= 128; len <<= 1) {
+        for (start = 0; start < 256; start += 2 * len) {
+            z = _mm256_set1_epi16(PQCLEAN_KYBER512_CLEAN_zetas[k--]);
+            for (j = start; j < start + len; j += 16) {
+                t = _mm256_loadu_si256((const __m256i *)&r[j]);
+                b = _mm256_loadu_si256((const __m256i *)&r[j + len]);
+                a = barrett(_mm256_add_epi16(t, b));
+                b = fqmul(z, _mm256_sub_epi16(b, t));
+                _mm256_storeu_si256((__m256i *)&r[j], a);
+                _mm256_storeu_si256((__m256i *)&r[j + len], b);
+            }
+        }
+    }
+    for (j = 0; j < 256; j += 16) {
+        a = _mm256_loadu_si256((const __m256i *)&r[j]);
+        _mm256_storeu_si256((__m256i *)&r[j], fqmul(a, f));
+    }
+}
+
+/* swap the two int16 lanes of each coefficient pair */
+static inline PQCLEAN_AVX2_TARGET __m256i swap_pairs(__m256i a) {
+    return _mm256_shufflehi_epi16(_mm256_shufflelo_epi16(a, 0xB1), 0xB1);
+}
+
+PQCLEAN_AVX2_TARGET void PQCLEAN_KYBER512_AVX2_poly_basemul_montgomery(poly *r, const poly *a, const poly *b) {
+    unsigned int i;
+    __m256i va, vb, p, q, z;
+
+    if (!tables_ready) {
+        init_tables();
+    }
+    for (i = 0; i < KYBER_N; i += 16) {
+        va = _mm256_loadu_si256((const __m256i *)&a->coeffs[i]);
+        vb = _mm256_loadu_si256((const __m256i *)&b->coeffs[i]);
+        z = _mm256_loadu_si256((const __m256i *)&zetas_mul[i]);
+        /* even lanes: a0*b0, odd lanes: a1*b1 */
+        p = fqmul(va, vb);
+        /* r0 = a0*b0 + (a1*b1)*zeta */
+        p = _mm256_add_epi16(p, swap_pairs(fqmul(p, z)));
+        /* even lanes: a0*b1, odd lanes: a1*b0 */
+        q = fqmul(va, swap_pairs(vb));
+        /* r1 = a0*b1 + a1*b0 */
+        q = _mm256_add_epi16(q, swap_pairs(q));
+        _mm256_storeu_si256((__m256i *)&r->coeffs[i], _mm256_blend_epi16(p, q, 0xAA));
+    }
+}
+
+PQCLEAN_AVX2_TARGET void PQCLEAN_KYBER512_AVX2_poly_tomont(poly *r) {
+    unsigned int i;
+    const __m256i f = _mm256_set1_epi16((1ULL << 32) % KYBER_Q);
+    __m256i a;
+
+    for (i = 0; i < KYBER_N; i += 16) {
+        a = _mm256_loadu_si256((const __m256i *)&r->coeffs[i]);
+        _mm256_storeu_si256((__m256i *)&r->coeffs[i], fqmul(a, f));
+    }
+}
+
+PQCLEAN_AVX2_TARGET void PQCLEAN_KYBER512_AVX2_poly_reduce(poly *r) {
+    unsigned int i;
+    __m256i a;
+
+    for (i = 0; i < KYBER_N; i += 16) {
+        a = _mm256_loadu_si256((const __m256i *)&r->coeffs[i]);
+        _mm256_storeu_si256((__m256i *)&r->coeffs[i], barrett(a));
+    }
+}
+
+PQCLEAN_AVX2_TARGET void PQCLEAN_KYBER512_AVX2_poly_add(poly *r, const poly *a, const poly *b) {
+    unsigned int i;
+    __m256i va, vb;
+
+    for (i = 0; i < KYBER_N; i += 16) {
+        va = _mm256_loadu_si256((const __m256i *)&a->coeffs[i]);
+        vb = _mm256_loadu_si256((const __m256i *)&b->coeffs[i]);
+        _mm256_storeu_si256((__m256i *)&r->coeffs[i], _mm256_add_epi16(va, vb));
+    }
+}
+
+PQCLEAN_AVX2_TARGET void PQCLEAN_KYBER512_AVX2_poly_sub(poly *r, const poly *a, const poly *b) {
+    unsigned int i;
+    __m256i va, vb;
+
+    for (i = 0; i < KYBER_N; i += 16) {
+        va = _mm256_loadu_si256((const __m256i *)&a->coeffs[i]);
+        vb = _mm256_loadu_si256((const __m256i *)&b->coeffs[i]);
+        _mm256_storeu_si256((__m256i *)&r->coeffs[i], _mm256_sub_epi16(va, vb));
+    }
+}
+
+#endif /* PQCLEAN_AVX2 */
@@ -0,0 +1,27 @@
+#ifndef PQCLEAN_KYBER512_AVX2_H
+#define PQCLEAN_KYBER512_AVX2_H
+#include "../cpufeatures.h"
+#include "params.h"
+#include "poly.h"
+#include <stdint.h>
+
+#if defined(PQCLEAN_AVX2)
+/* AVX2 variants of the NTT and polynomial arithmetic. They work on the
+ * same coefficient order as the clean code and give bit-identical
+ * results, so packing and KATs are unchanged. */
+void PQCLEAN_KYBER512_AVX2_ntt(int16_t r[256]);
+
+void PQCLEAN_KYBER512_AVX2_invntt(int16_t r[256]);
+
+void PQCLEAN_KYBER512_AVX2_poly_basemul_montgomery(poly *r, const poly *a, const poly *b);
+
+void PQCLEAN_KYBER512_AVX2_poly_tomont(poly *r);
+
+void PQCLEAN_KYBER512_AVX2_poly_reduce(poly *r);
+
+void PQCLEAN_KYBER512_AVX2_poly_add(poly *r, const poly *a, const poly *b);
+
+void PQCLEAN_KYBER512_AVX2_poly_sub(poly *r, const poly *a, const poly *b);
+#endif
+
+#endif
@@ -1,3 +1,4 @@
+#include "../fips202x4.h"
 #include "indcpa.h"
 #include "ntt.h"
 #include "params.h"
@@ -159,36 +160,96 @@ static unsigned int rej_uniform(int16_t *r,
 *              - int transposed: boolean deciding whether A or A^T is generated
 **************************************************/
 #define GEN_MATRIX_NBLOCKS ((12*KYBER_N/8*(1 << 12)/KYBER_Q + XOF_BLOCKBYTES)/XOF_BLOCKBYTES)
+
+/*************************************************
+* Name:        gen_matrix_x4
+*
+* Description: Generate four consecutive entries of the matrix, starting
+*              at the n-th in row-major order, running the four XOF
+*              instances in parallel. Each entry is sampled exactly as
+*              by the single-instance code.
+*
+* Arguments:   - polyvec *a: pointer to ouptput matrix A
+*              - const uint8_t *seed: pointer to input seed
+*              - int transposed: boolean deciding whether A or A^T is generated
+*              - unsigned int n: index of the first entry
+**************************************************/
+static void gen_matrix_x4(polyvec *a, const uint8_t seed[KYBER_SYMBYTES], int transposed, unsigned int n) {
+    unsigned int ctr[4], buflen[4], off[4];
+    unsigned int i, j, k, l;
+    uint8_t extseed[4][KYBER_SYMBYTES + 2];
+    uint8_t buf[4][GEN_MATRIX_NBLOCKS * XOF_BLOCKBYTES + 2];
+    int16_t *coeffs[4];
+    keccakx4_state state;
+
+    for (l = 0; l < 4; l++) {
+        i = (n + l) / KYBER_K;
+        j = (n + l) % KYBER_K;
+        for (k = 0; k < KYBER_SYMBYTES; k++) {
+            extseed[l][k] = seed[k];
+        }
+        extseed[l][KYBER_SYMBYTES + 0] = (uint8_t)(transposed ? i : j);
+        extseed[l][KYBER_SYMBYTES + 1] = (uint8_t)(transposed ? j : i);
+        coeffs[l] = a[i].vec[j].coeffs;
+    }
+
+    shake128x4_absorb(&state, extseed[0], extseed[1], extseed[2], extseed[3], KYBER_SYMBYTES + 2);
+    shake128x4_squeezeblocks(buf[0], buf[1], buf[2], buf[3], GEN_MATRIX_NBLOCKS, &state);
+    for (l = 0; l < 4; l++) {
+        buflen[l] = GEN_MATRIX_NBLOCKS * XOF_BLOCKBYTES;
+        ctr[l] = rej_uniform(coeffs[l], KYBER_N, buf[l], buflen[l]);
+    }
+
+    while (ctr[0] < KYBER_N || ctr[1] < KYBER_N || ctr[2] < KYBER_N || ctr[3] < KYBER_N) {
+        for (l = 0; l < 4; l++) {
+            off[l] = buflen[l] % 3;
+            for (k = 0; k < off[l]; k++) {
+                buf[l][k] = buf[l][buflen[l] - off[l] + k];
+            }
+        }
+        shake128x4_squeezeblocks(buf[0] + off[0], buf[1] + off[1],
+                                 buf[2] + off[2], buf[3] + off[3], 1, &state);
+        for (l = 0; l < 4; l++) {
+            buflen[l] = off[l] + XOF_BLOCKBYTES;
+            ctr[l] += rej_uniform(coeffs[l] + ctr[l], KYBER_N - ctr[l], buf[l], buflen[l]);
+        }
+    }
+}
+
 // Not static for benchmarking
 void PQCLEAN_KYBER512_CLEAN_gen_matrix(polyvec *a, const uint8_t seed[KYBER_SYMBYTES], int transposed) {
-    unsigned int ctr, i, j, k;
+    unsigned int ctr, i, j, k, n;
     unsigned int buflen, off;
     uint8_t buf[GEN_MATRIX_NBLOCKS * XOF_BLOCKBYTES + 2];
     xof_state state;
 
-    for (i = 0; i < KYBER_K; i++) {
-        for (j = 0; j < KYBER_K; j++) {
-            if (transposed) {
-                xof_absorb(&state, seed, (uint8_t)i, (uint8_t)j);
-            } else {
-                xof_absorb(&state, seed, (uint8_t)j, (uint8_t)i);
-            }
+    for (n = 0; n + 4 <= KYBER_K * KYBER_K; n += 4) {
+        gen_matrix_x4(a, seed, transposed, n);
+    }
+
+    for (; n < KYBER_K * KYBER_K; n++) {
+        i = n / KYBER_K;
+        j = n % KYBER_K;
+        if (transposed) {
+            xof_absorb(&state, seed, (uint8_t)i, (uint8_t)j);
+        } else {
+            xof_absorb(&state, seed, (uint8_t)j, (uint8_t)i);
+        }
+
+        xof_squeezeblocks(buf, GEN_MATRIX_NBLOCKS, &state);
+        buflen = GEN_MATRIX_NBLOCKS * XOF_BLOCKBYTES;
+        ctr = rej_uniform(a[i].vec[j].coeffs, KYBER_N, buf, buflen);
 
-            xof_squeezeblocks(buf, GEN_MATRIX_NBLOCKS, &state);
-            buflen = GEN_MATRIX_NBLOCKS * XOF_BLOCKBYTES;
-            ctr = rej_uniform(a[i].vec[j].coeffs, KYBER_N, buf, buflen);
-
-            while (ctr < KYBER_N) {
-                off = buflen % 3;
-                for (k = 0; k < off; k++) {
-                    buf[k] = buf[buflen - off + k];
-                }
-                xof_squeezeblocks(buf + off, 1, &state);
-                buflen = off + XOF_BLOCKBYTES;
-                ctr += rej_uniform(a[i].vec[j].coeffs + ctr, KYBER_N - ctr, buf, buflen);
+        while (ctr < KYBER_N) {
+            off = buflen % 3;
+            for (k = 0; k < off; k++) {
+                buf[k] = buf[buflen - off + k];
             }
-            xof_ctx_release(&state);
+            xof_squeezeblocks(buf + off, 1, &state);
+            buflen = off + XOF_BLOCKBYTES;
+            ctr += rej_uniform(a[i].vec[j].coeffs + ctr, KYBER_N - ctr, buf, buflen);
         }
+        xof_ctx_release(&state);
     }
 }
 
@@ -1,3 +1,4 @@
+#include "avx2.h"
 #include "ntt.h"
 #include "params.h"
 #include "reduce.h"
@@ -81,6 +82,13 @@ void PQCLEAN_KYBER512_CLEAN_ntt(int16_t r[256]) {
     unsigned int len, start, j, k;
     int16_t t, zeta;
 
+#if defined(PQCLEAN_AVX2)
+    if (PQCLEAN_avx2_enabled()) {
+        PQCLEAN_KYBER512_AVX2_ntt(r);
+        return;
+    }
+#endif
+
     k = 1;
     for (len = 128; len >= 2; len >>= 1) {
         for (start = 0; start < 256; start = j + len) {
@@ -108,6 +116,13 @@ void PQCLEAN_KYBER512_CLEAN_invntt(int16_t r[256]) {
     int16_t t, zeta;
     const int16_t f = 1441; // mont^2/128
 
+#if defined(PQCLEAN_AVX2)
+    if (PQCLEAN_avx2_enabled()) {
+        PQCLEAN_KYBER512_AVX2_invntt(r);
+        return;
+    }
+#endif
+
     k = 127;
     for (len = 2; len <= 128; len <<= 1) {
         for (start = 0; start < 256; start = j + len) {
@@ -1,3 +1,4 @@
+#include "avx2.h"
 #include "cbd.h"
 #include "ntt.h"
 #include "params.h"
@@ -217,6 +218,14 @@ void PQCLEAN_KYBER512_CLEAN_poly_invntt_tomont(poly *r) {
 **************************************************/
 void PQCLEAN_KYBER512_CLEAN_poly_basemul_montgomery(poly *r, const poly *a, const poly *b) {
     size_t i;
+
+#if defined(PQCLEAN_AVX2)
+    if (PQCLEAN_avx2_enabled()) {
+        PQCLEAN_KYBER512_AVX2_poly_basemul_montgomery(r, a, b);
+        return;
+    }
+#endif
+
     for (i = 0; i < KYBER_N / 4; i++) {
         PQCLEAN_KYBER512_CLEAN_basemul(&r->coeffs[4 * i], &a->coeffs[4 * i], &b->coeffs[4 * i], PQCLEAN_KYBER512_CLEAN_zetas[64 + i]);
         PQCLEAN_KYBER512_CLEAN_basemul(&r->coeffs[4 * i + 2], &a->coeffs[4 * i + 2], &b->coeffs[4 * i + 2], -PQCLEAN_KYBER512_CLEAN_zetas[64 + i]);
@@ -234,6 +243,14 @@ void PQCLEAN_KYBER512_CLEAN_poly_basemul_montgomery(poly *r, const poly *a, cons
 void PQCLEAN_KYBER512_CLEAN_poly_tomont(poly *r) {
     size_t i;
     const int16_t f = (1ULL << 32) % KYBER_Q;
+
+#if defined(PQCLEAN_AVX2)
+    if (PQCLEAN_avx2_enabled()) {
+        PQCLEAN_KYBER512_AVX2_poly_tomont(r);
+        return;
+    }
+#endif
+
     for (i = 0; i < KYBER_N; i++) {
         r->coeffs[i] = PQCLEAN_KYBER512_CLEAN_montgomery_reduce((int32_t)r->coeffs[i] * f);
     }
@@ -249,6 +266,14 @@ void PQCLEAN_KYBER512_CLEAN_poly_tomont(poly *r) {
 **************************************************/
 void PQCLEAN_KYBER512_CLEAN_poly_reduce(poly *r) {
     size_t i;
+
+#if defined(PQCLEAN_AVX2)
+    if (PQCLEAN_avx2_enabled()) {
+        PQCLEAN_KYBER512_AVX2_poly_reduce(r);
+        return;
+    }
+#endif
+
     for (i = 0; i < KYBER_N; i++) {
         r->coeffs[i] = PQCLEAN_KYBER512_CLEAN_barrett_reduce(r->coeffs[i]);
     }
@@ -265,6 +290,14 @@ void PQCLEAN_KYBER512_CLEAN_poly_reduce(poly *r) {
 **************************************************/
 void PQCLEAN_KYBER512_CLEAN_poly_add(poly *r, const poly *a, const poly *b) {
     size_t i;
+
+#if defined(PQCLEAN_AVX2)
+    if (PQCLEAN_avx2_enabled()) {
+        PQCLEAN_KYBER512_AVX2_poly_add(r, a, b);
+        return;
+    }
+#endif
+
     for (i = 0; i < KYBER_N; i++) {
         r->coeffs[i] = a->coeffs[i] + b->coeffs[i];
     }
@@ -281,6 +314,14 @@ void PQCLEAN_KYBER512_CLEAN_poly_add(poly *r, const poly *a, const poly *b) {
 **************************************************/
 void PQCLEAN_KYBER512_CLEAN_poly_sub(poly *r, const poly *a, const poly *b) {
     size_t i;
+
+#if defined(PQCLEAN_AVX2)
+    if (PQCLEAN_avx2_enabled()) {
+        PQCLEAN_KYBER512_AVX2_poly_sub(r, a, b);
+        return;
+    }
+#endif
+
     for (i = 0; i < KYBER_N; i++) {
         r->coeffs[i] = a->coeffs[i] - b->coeffs[i];
     }
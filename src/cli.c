@@ -79,9 +79,9 @@ static const struct sock_fprog  strict = {
 
 extern int zen_setenv(lua_State *L, char *key, char *val);
 
-// This function exits the process on failure.
-void load_file(char *dst, FILE *fd) {
-	char *firstline = NULL;
+// This function exits the process on failure. Returns the number of
+// bytes loaded, files may contain binary data.
+size_t load_file(char *dst, FILE *fd) {
 	long file_size = 0L;
 	size_t offset = 0;
 	size_t bytes = 0;
@@ -101,22 +101,6 @@ void load_file(char *dst, FILE *fd) {
 		func(0, "size of file: %u", file_size);
 	}
 
-	firstline = malloc(MAX_STRING);
-	// skip shebang on firstline
-	if(!fgets(firstline, MAX_STRING, fd)) {
-		if(errno==0) { // file is empty
-			zerror(0, "Error reading, file is empty");
-			if(firstline) free(firstline);
-			exit(1); }
-		zerror(0, "Error reading first line: %s", strerror(errno));
-		exit(1); }
-	if(firstline[0]=='#' && firstline[1]=='!')
-		func(0, "Skipping shebang");
-	else {
-		offset+=strlen(firstline);
-		strncpy(dst, firstline, MAX_STRING);
-	}
-
 	size_t chunk;
 	while(1) {
 		chunk = MAX_STRING;
@@ -135,20 +119,30 @@ void load_file(char *dst, FILE *fd) {
 				} else {
 					func(0, "EOF after %u bytes",offset);
 				}
- 				dst[offset] = '\0';
 				break;
 			}
 			if(ferror(fd)) {
 				zerror(0, "Error in %s: %s", __func__, strerror(errno));
 				fclose(fd);
-				if(firstline) free(firstline);
 				exit(1); }
 		}
 		offset += bytes;
 	}
 	if(fd!=stdin) fclose(fd);
+	if(!offset) {
+		zerror(0, "Error reading, file is empty");
+		exit(1); }
+	// skip shebang on firstline
+	if(offset>1 && dst[0]=='#' && dst[1]=='!') {
+		char *nl = memchr(dst, '\n', offset);
+		size_t skip = nl ? (size_t)(nl-dst)+1 : offset;
+		func(0, "Skipping shebang");
+		offset -= skip;
+		memmove(dst, dst+skip, offset);
+	}
+	dst[offset] = '\0';
 	act(0, "loaded file (%u bytes)", offset);
-	if(firstline) free(firstline);
+	return(offset);
 }
 
 static char *conffile = NULL;
@@ -161,6 +155,8 @@ static char *sidescript = NULL;
 static char *script = NULL;
 static char *keys = NULL;
 static char *data = NULL;
+static size_t keys_len = 0;
+static size_t data_len = 0;
 static char *introspect = NULL;
 
 // for benchmark, breaks c99 spec
@@ -282,21 +278,21 @@ int main(int argc, char **argv) {
 
 	if(keysfile[0]!='\0') {
 		if(verbosity) act(NULL, "reading KEYS from file: %s", keysfile);
-		load_file(keys, fopen(keysfile, "r"));
+		keys_len = load_file(keys, fopen(keysfile, "rb"));
 	}
 
 	if(datafile[0]!='\0' && verbosity) {
 		if(verbosity) act(NULL, "reading DATA from file: %s", datafile);
-		load_file(data, fopen(datafile, "r"));
+		data_len = load_file(data, fopen(datafile, "rb"));
 	}
 
 	if(interactive) {
 		////////////////////////////////////
 		// start an interactive repl console
-		Z = zen_init(
+		Z = zen_init_len(
 			conffile[0]?conffile:NULL,
-			keys[0]?keys:NULL,
-			data[0]?data:NULL);
+			keys, keys_len,
+			data, data_len);
 		lua_State *L = (lua_State*)Z->lua;
 
 		// print function
@@ -324,10 +320,10 @@ int main(int argc, char **argv) {
     clock_gettime(CLOCK_MONOTONIC, &before);
 
 	// set_debug(verbosity);
-	Z = zen_init(
+	Z = zen_init_len(
 			(conffile[0])?conffile:NULL,
-			(keys[0])?keys:NULL,
-			(data[0])?data:NULL);
+			keys, keys_len,
+			data, data_len);
 	if(!Z) {
 		zerror(NULL, "Initialisation failed.");
 		cli_free_buffers();
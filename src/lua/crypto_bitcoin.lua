@@ -404,124 +404,108 @@ function btc.decode_der_signature(raw)
    return sig
 end
 
+-- amount in satoshi as 8-byte little endian
+local function amount_to_uint64(value)
+   local amount = O.new(value):reverse()
+   if #amount < 8 then
+      amount = amount .. O.zero(8 - #amount)
+   end
+   return amount
+end
+
+-- The pieces of the BIP143 hashes are collected in arrays and hashed
+-- by HASH.dsha256 without concatenating them
+
 -- Hash required in the raw transaction (is exposed to be able to use it
 -- in the tests)
 local function _hash_prevouts(tx)
-   local raw
-   local H
-   H = HASH.new('sha256')
-
-   raw = O.new()
-
-   for _, v in pairs(tx.txIn) do
-      raw = raw .. v.txid:reverse() .. btc.to_uint(v.vout, 4)
+   local raw = {}
+   for i, v in ipairs(tx.txIn) do
+      raw[i] = { v.txid:reverse(), btc.to_uint(v.vout, 4) }
    end
-
-   return H:process(H:process(raw))
+   return HASH.dsha256(raw)
 end
 
 -- Hash required in the raw transaction (is exposed to be able to use it
 -- in the tests)
 local function _hash_sequence(tx)
-   local raw
-   local H
-   local seq
-   H = HASH.new('sha256')
-
-   raw = O.new()
-
-   for _, v in pairs(tx.txIn) do
-      seq = v['sequence']
-      if not seq then
-	 -- default value, not enabled
-	 seq = O.from_hex('ffffffff')
-      end
-      raw = raw .. btc.to_uint(seq, 4)
+   local raw = {}
+   for i, v in ipairs(tx.txIn) do
+      -- default value, not enabled
+      raw[i] = btc.to_uint(v['sequence'] or O.from_hex('ffffffff'), 4)
    end
-   
-   return H:process(H:process(raw))
+   return HASH.dsha256(raw)
 end
 
 -- Hash required in the raw transaction (is exposed to be able to use it
 -- in the tests)
 local function _hash_outputs(tx)
-   local raw
-   local H
-   H = HASH.new('sha256')
-
-   raw = O.new()
-
-   for _, v in pairs(tx.txOut) do
-      amount = O.new(v.amount)
-      raw = raw .. amount:reverse()
-      if #v.amount < 8 then
-	 raw = raw .. O.zero(8 - #amount)
-      end
+   local raw = {}
+   local script = O.from_hex('160014')
+   for i, v in ipairs(tx.txOut) do
       -- This is specific to Bech32 addresses, we should be able to verify the kind of address
-      raw = raw .. O.from_hex('160014') .. fif( v.address.raw, v.address.raw, v.address)
-
+      raw[i] = { amount_to_uint64(v.amount), script,
+		 fif( v.address.raw, v.address.raw, v.address) }
    end
+   return HASH.dsha256(raw)
+end
 
-   return H:process(H:process(raw))
+-- The parts of the BIP143 preimage that are equal for all the inputs
+-- of a transaction: computed once, so signing and verifying are
+-- linear in the number of inputs
+local function sighash_cache(tx)
+   return {
+      version = btc.to_uint(tx.version, 4),
+      prevouts = _hash_prevouts(tx),
+      sequence = _hash_sequence(tx),
+      outputs = _hash_outputs(tx),
+      locktime = btc.to_uint(tx.nLockTime, 4),
+      hashtype = btc.to_uint(tx.nHashType, 4)
+   }
 end
 
+local SCRIPT_CODE_PREFIX = O.from_hex('1976a914')
+local SCRIPT_CODE_SUFFIX = O.from_hex('88ac')
 
 -- BIP0143
 -- Double SHA256 of the serialization of:
 --      1. nVersion of the transaction (4-byte little endian)
 --      2. hash_prevouts (32-byte hash)
 --      3. hash_sequence (32-byte hash)
---      4. outpoint (32-byte hash + 4-byte little endian) 
+--      4. outpoint (32-byte hash + 4-byte little endian)
 --      5. scriptCode of the input (serialized as scripts inside CTxOuts)
 --      6. value of the output spent by this input (8-byte little endian)
 --      7. nSequence of the input (4-byte little endian)
 --      8. hash_outputs (32-byte hash)
 --      9. nLocktime of the transaction (4-byte little endian)
 --     10. sighash type of the signature (4-byte little endian)
-local function build_transaction_to_sign(tx, i)
-   local raw
-   local amount
-   local address = fif(tx.txIn[i].address.raw, 
-		       tx.txIn[i].address.raw, tx.txIn[i].address)
+-- @param cache parts common to all inputs, see sighash_cache
+local function transaction_sighash(tx, i, cache)
+   local txin = tx.txIn[i]
+   local address = fif(txin.address.raw, txin.address.raw, txin.address)
    assert(address, "Cannot sign or verify transaction: no address provided")
-   raw = O.new()
-   --      1. nVersion of the transaction (4-byte little endian)
-   raw = raw .. btc.to_uint(tx.version, 4)
-   --      2. hash_prevouts (32-byte hash)
-   raw = raw .. _hash_prevouts(tx)
-   --      3. hash_sequence (32-byte hash)
-   raw = raw .. _hash_sequence(tx)
-   --      4. outpoint (32-byte hash + 4-byte little endian)
-   raw = raw .. tx.txIn[i].txid:reverse() .. btc.to_uint(tx.txIn[i].vout, 4)
-   --      5. scriptCode of the input (serialized as scripts inside CTxOuts)
-   raw = raw .. O.from_hex('1976a914') .. address  .. O.from_hex('88ac')
-   --      6. value of the output spent by this input (8-byte little endian)
-   amount = O.new(tx.txIn[i].amountSpent)
-   raw = raw .. amount:reverse()
-   if #amount < 8 then
-      raw = raw .. O.zero(8 - #amount)
-   end
-   --      7. nSequence of the input (4-byte little endian)
-   raw = raw .. tx.txIn[i].sequence:reverse()
-   --      8. hash_outputs (32-byte hash)
-   raw = raw .. _hash_outputs(tx)
-   --      9. nLocktime of the transaction (4-byte little endian)
-   raw = raw .. btc.to_uint(tx.nLockTime, 4)
-   --     10. sighash type of the signature (4-byte little endian)
-   raw = raw .. btc.to_uint(tx.nHashType, 4)
-
-   return raw
+   return HASH.dsha256(
+      cache.version,
+      cache.prevouts,
+      cache.sequence,
+      txin.txid:reverse(), btc.to_uint(txin.vout, 4),
+      SCRIPT_CODE_PREFIX, address, SCRIPT_CODE_SUFFIX,
+      amount_to_uint64(txin.amountSpent),
+      txin.sequence:reverse(),
+      cache.outputs,
+      cache.locktime,
+      cache.hashtype)
 end
 
 -- Here I sign the transaction
 function btc.build_witness(tx, sk)
    local pk = ECDH.compress_public_key(ECDH.pubgen(sk))
    local witness = {}
+   local cache
    for i=1,#tx.txIn,1 do
       if tx.txIn[i].sigwit then
-	 -- fill address generated from sk if not present in txin
-	 local rawTx = build_transaction_to_sign(tx, i)
-	 local sigHash = HASH.dsha256(rawTx)
+	 cache = cache or sighash_cache(tx)
+	 local sigHash = transaction_sighash(tx, i, cache)
 	 local sig = ECDH.sign_ecdh(sk, sigHash)
 	 witness[i] = {
 	    btc.encode_der_signature(sig) .. O.from_hex('01'),
@@ -540,11 +524,20 @@ function btc.verify_witness(tx)
    if tx.witness == nil then
       return false
    end
+   local cache = sighash_cache(tx)
+   -- inputs spent from the same address share the public key, which
+   -- is costly to uncompress
+   local pks = {}
    for i, v in pairs(tx.witness) do
-      local rawTx = build_transaction_to_sign(tx, i)
-      local sigHash = HASH.dsha256(rawTx)
+      local sigHash = transaction_sighash(tx, i, cache)
       local sig = btc.decode_der_signature(v[1])
-      if not ECDH.verify_hashed(ECDH.uncompress_public_key(v[2]), sigHash, sig, #sigHash) then
+      local hex = v[2]:hex()
+      local pk = pks[hex]
+      if not pk then
+	 pk = ECDH.uncompress_public_key(v[2])
+	 pks[hex] = pk
+      end
+      if not ECDH.verify_hashed(pk, sigHash, sig, #sigHash) then
 	 return false
       end
    end
@@ -176,14 +176,8 @@ end
 
 function elgah.count(tally, value, max)
    elgah.verify_tally(tally, value)
-   local restab = { }
-   max = max or 1000
-   for idx=1,max do
-	  restab[(BIG.new(idx) * hs):octet():url64()] = idx
-   end
-   local res = { pos = value.pos.right + tally.dec.pos,
-				 neg = value.neg.right + tally.dec.neg  }
-   return restab[res.pos:octet():url64()]
+   local res = value.pos.right + tally.dec.pos
+   return res:dlog(hs, max or 1000)
 end
 
 return elgah
@@ -40,118 +40,12 @@ function ETH.o2n(o)
    end
 end
 
--- the empty octect is encoded as nil
--- a table contains in the first position (i.e. 1) the number of elements
-function ETH.encodeRLP(data)
-   local header = nil
-   local res = nil
-   local byt = nil
-
-   if type(data) == 'zenroom.big' then
-      data = ETH.n2o(data)
-   end
-
-   if type(data) == 'table' then
-      -- empty octet
-      res = O.new()
-      for _, v in pairs(data) do
-	 res = res .. ETH.encodeRLP(v)
-      end
-      if #res < 56 then
-	 res = INT.new(192+#res):octet() .. res
-      else
-	 -- Length of the result to be saved before the bytes themselves
-	 byt = INT.new(#res):octet()
-	 header = INT.new(247+#byt):octet() .. byt
-
-      end
-   elseif iszen(type(data)) then
-      res = data:octet()
-
-      -- index single bytes of an octet
-      local byt = INT.new(0)
-      if #res > 0 then
-	 byt = INT.new( res:chop(1) )
-      end
-
-      if #res ~= 1 or byt >= INT.new(128) then
-	 if #res < 56 then
-	    header = INT.new(128+#res):octet()
-	 else
-	    -- Length of the result to be saved before the bytes themselves
-	    byt = INT.new(#res):octet()
-	    header = INT.new(183+#byt):octet() .. byt
-	 end
-      end
-
-   else
-      error("Invalid data type for ETH RLP encoder: "..type(data))
-   end
-   if header then
-      res = header .. res
-   end
-   return res
-end
-
-
--- i is the position from which we start to parse
--- return a table with
--- * res which is the content read
--- * idx which is the position of the next byte to read
-local function decodeRLPgeneric(rlp, i)
-   local byt, bytInt, res, idx
-
-   byt = rlp:sub(i, i)
-   idx=i+1
-   bytInt = tonumber(byt:hex(), 16)
-
-   if bytInt < 128 then
-      res = byt
-   elseif bytInt <= 183 then
-      idx = i+bytInt-128+1
-      if bytInt == 128 then
-	 res = O.new()
-      else
-	 res = rlp:sub(i+1, idx-1)
-      end
-
-   elseif bytInt < 192 then
-      local sizeEnd = bytInt-183;
-      local size = tonumber(rlp:sub(i+1, i+sizeEnd):hex(), 16)
-      idx = i+sizeEnd+size+1
-      res = rlp:sub(i+sizeEnd+1, idx-1)
-   else -- it is a tuple
-      local j
-      if bytInt <= 247 then
-	 idx = i+bytInt-192+1 -- total number of bytes
-      else -- decode big endian encoding
-	 local sizeEnd
-	 sizeEnd = bytInt-247;
-	 local size = tonumber(rlp:sub(i+1, i+sizeEnd):hex(), 16)
-	 idx = i+sizeEnd+size+1
-	 i=i+sizeEnd
-      end
-      i=i+1 -- initial position
-      j=1 -- index inside res
-      res = {}
-      -- decode the tuple in a table
-      while i < idx do
-	 local readNext
-	 readNext = decodeRLPgeneric(rlp, i)
-	 res[j] = readNext.res
-	 j = j+1
-	 i = readNext.idx
-      end
-   end
-   return {
-      res=res,
-      idx=idx
-   }
-end
-
-function ETH.decodeRLP(rlp)
-   return decodeRLPgeneric(rlp, 1).res
-end
+-- RLP encoder and decoder are native (src/zen_rlp.c): encodeRLP
+-- takes an octet, a zenroom value (BIG zero is the empty octet) or a
+-- table of them, decodeRLP returns octets and tables of octets
+local RLP = require'rlp'
+ETH.encodeRLP = RLP.encode
+ETH.decodeRLP = RLP.decode
 
 function ETH.encodeTransaction(tx)
    local fields = {tx["nonce"], tx["gas_price"], tx["gas_limit"], tx["to"],
@@ -176,9 +70,8 @@ end
 
 -- modify the input transaction
 function ETH.encodeSignedTransaction(sk, tx)
-   local H, txHash, sig, y_parity, two, res
-   H = HASH.new('keccak256')
-   txHash = H:process(ETH.encodeTransaction(tx))
+   local txHash, sig, y_parity, two, res
+   txHash = HASH.digest('keccak256', ETH.encodeTransaction(tx))
 
    sig, y_parity = ECDH.sign_ecdh(sk, txHash)
 
@@ -196,7 +89,7 @@ function ETH.encodeSignedTransaction(sk, tx)
 end
 
 local function hashFromSignedTransaction(txSigned)
-   local fields, H, tx
+   local fields, tx
    fields = {"nonce", "gas_price", "gas_limit", "to",
 	     "value", "data"}
 
@@ -209,8 +102,7 @@ local function hashFromSignedTransaction(txSigned)
    tx["r"] = O.new()
    tx["s"] = O.new()
 
-   H = HASH.new('keccak256')
-   return H:process(ETH.encodeTransaction(tx))
+   return HASH.digest('keccak256', ETH.encodeTransaction(tx))
 end
 
 -- Verify the signature of a transaction which implements EIP-155
@@ -227,31 +119,30 @@ function ETH.verifySignatureTransaction(pk, txSigned)
    return ECDH.verify_hashed(pk, txHash, sig, #txHash)
 end
 
+-- hash, signature and parity of the y of the ephemeral key of a
+-- signed transaction
+local function signatureFromSignedTransaction(txSigned)
+   return hashFromSignedTransaction(txSigned),
+      { r=txSigned.r, s=txSigned.s },
+      fif(txSigned.v:parity(), 0, 1) -- y_parity=0 <=> v:parity()=1
+end
+
 -- verify the signature of a transaction only with the address
 function ETH.verify_from_address(add, txSigned)
-   local txHash, sig, y_parity, pk, valid
-   txHash = hashFromSignedTransaction(txSigned)
-
-   sig = {
-      r=txSigned.r,
-      s=txSigned.s
-   }
+   local txHash, sig, y_parity = signatureFromSignedTransaction(txSigned)
+   return ECDH.verify_address(add, txHash, sig, y_parity)
+end
 
-   y_parity = fif(txSigned.v:parity(), 0, 1) -- y_parity=0 <=> v:parity()=1
-
-   local x = INT.new(sig.r)
-   local p = ECDH.prime()
-   local n = ECDH.order()
-   local h = ECDH.cofactor() --h=1
-   repeat
-	   pk, valid = ECDH.recovery(x:octet(), y_parity, txHash, sig)
-	   if h > 0 then   -- do not add n last iteration
-		   x = (x + n) % p
-	   end
-	   h = h-1
-   until (valid and ETH.address_from_public_key(pk) == add) or (h < 0)
-
-   return (valid and ETH.address_from_public_key(pk) == add)
+-- same as verify_from_address on an array of transactions, signed by
+-- the owner of one address or each by the one in an array of
+-- addresses: returns true, or false and the positions of the
+-- transactions that failed
+function ETH.verify_from_address_batch(add, txs)
+   local hashes, sigs, parities = {}, {}, {}
+   for i, tx in ipairs(txs) do
+      hashes[i], sigs[i], parities[i] = signatureFromSignedTransaction(tx)
+   end
+   return ECDH.verify_address_batch(add, hashes, sigs, parities)
 end
 
 -- Assume we are given a smart contract with a function with the
@@ -317,20 +208,33 @@ function ETH.keygen()
 end
 
 function ETH.address_from_public_key(pk)
+   return HASH.digest('keccak256', pk:sub(2, #pk)):sub(13, 32)
+end
+
+-- same as address_from_public_key on an array of public keys, the
+-- keccak hashes are computed four at a time
+function ETH.address_from_public_keys(pks)
    local H = HASH.new('keccak256')
-   return H:process(pk:sub(2, #pk)):sub(13, 32)
+   local xy = {}
+   for i, pk in ipairs(pks) do
+      xy[i] = pk:sub(2, #pk)
+   end
+   local res = H:process_batch(xy)
+   for i, h in ipairs(res) do
+      res[i] = h:sub(13, 32)
+   end
+   return res
 end
 
 -- TODO: remove so many .., there should be something like table.concat for octets
 -- Really simple data encoder, it only works with elementary types (for
 -- example ERC-20 only uses this kind of data types)
 function ETH.data_contract_factory(fz_name, params)
-   local H = HASH.new('keccak256')
    if type(params) ~= 'table' then
       params = {}
    end
    local signature = fz_name .. '(' .. table.concat(params, ",") .. ')'
-   local f_id = O.from_hex(string.sub(hex(H:process(signature)), 1, 8))
+   local f_id = O.from_hex(string.sub(hex(HASH.digest('keccak256', signature)), 1, 8))
    return function(...)
       local args = table.pack(...)
 
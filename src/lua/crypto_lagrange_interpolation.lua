@@ -55,72 +55,28 @@ octP = O.from_hex('fffffffffffffffffffffffffffffffffffffffffffffffffffffffffffff
 P = BIG.new(octP)
 assert(P:octet() == octP)
 
+-- polynomials are evaluated and interpolated in C (src/zen_lagrange.c)
+local LAG = require'lagrange'
+
 function li.create_shared_secret(total, quorum, secret)
    if quorum >= total then
       error('Error calling create_shared_secret: quorum ('..quorum..') must be smaller than total ('..total..')', 2)
    end
    -- check that BIG can contain the whole secret, depends from curve's size and the choosen prime P
-   local secbig = BIG.new(secret)
-   if secbig:octet() ~= secret or secbig > P then
-      error('Secret exceeds maximum BIG size: '..#O..' bytes or the size of the choosen prime')
-   end
-   secbig = secbig % P
-   -- generation of the coefficients of the secret polynomial
-   local coeff = { }
-   -- take last argument or create random
-   if secret then coeff[1] = BIG.new(secret)
-   else coeff[1] = BIG.modrand(P) end
-   for i=2,quorum,1 do
-      coeff[i] = BIG.modrand(P)
-   end
-   --generation of the shares
-   local shares = { }
-   for i=1,total,1 do
-      local x
-      repeat
-	 x = BIG.modrand(P)
-	 if x ~=0 then
-	    --checking for duplicates in shares
-	    for _, k in pairs(shares) do
-	       if x == k then x = 0 end
-	    end
-	 end
-      until x ~= 0	--this part provides trivial unleakability: x coordinate is never zero
-
-      local y = coeff[1]     --a_0
-      local x_n = BIG.new(1)
-      for n=2,quorum,1 do
-	 x_n = x_n:modmul(x, P) -- x^(n-1)
-	 y = BIG.add(y, coeff[n]:modmul(x_n, P))
-	 y = BIG.mod(y, P) -- +a_(n-1)x^(n-1)
+   local secbig
+   if secret then
+      secbig = BIG.new(secret)
+      if secbig:octet() ~= secret or secbig > P then
+	 error('Secret exceeds maximum BIG size: '..#secret..' bytes or the size of the choosen prime')
       end
-      table.insert(shares, {x = x, y = y})
-   end -- for i,total
-   -- overwrite secret for secure disposal
-   return shares, coeff[1]
+   end
+   -- the random polynomial has the secret (or a random number) as
+   -- constant term, the shares are its points on random non-zero x
+   return LAG.create(total, quorum, secbig)
 end
 
 function li.compose_shared_secret(shares)
-   local sec = BIG.new(0)
-   local num
-   local den
-   local quorum = #shares
-   for i = 1,quorum,1 do
-      num = BIG.new(1)
-      if quorum % 2 == 0 then
-	 num = P - num
-      end
-      den = BIG.new(1)
-      for j = 1,quorum,1 do
-	 if j~=i then
-	    num = num:modmul(shares[j].x, P)
-	    den = den:modmul((shares[i].x):modsub(shares[j].x, P), P)
-	 end
-      end
-      sec = BIG.add(sec, (shares[i].y):modmul(num:moddiv(den, P), P))
-      sec = BIG.mod(sec, P)
-   end
-   return sec
+   return LAG.compose(shares)
 end
 
 return li
@@ -116,17 +116,13 @@ function petition.prove_sign_petition(pub, m)
     return true
  end
  
- function petition.count_signatures_petition(scores, pi_tally)
-    local restab = { }
-    for idx=1,1000 do
-       -- if idx ~= 0 then -- not zero
-       restab[(BIG.new(idx) * SALT):octet():hex()] = idx
-       -- end
-    end
+ -- max is the highest count searched, 10 millions by default
+ function petition.count_signatures_petition(scores, pi_tally, max)
+    max = max or 10000000
     local res = { pos = scores.pos.right + pi_tally.dec.pos,
                   neg = scores.neg.right + pi_tally.dec.neg  }
-    return { pos = restab[res.pos:octet():hex()],
-             neg = restab[res.neg:octet():hex()]  }
+    return { pos = res.pos:dlog(SALT, max),
+             neg = res.neg:dlog(SALT, max)  }
  end
 
  return petition
\ No newline at end of file
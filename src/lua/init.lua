@@ -74,12 +74,59 @@ function load_scenario(scen)
    end
 end
 
+-- default scenarios that only add When statements, schemas and
+-- helpers: they are loaded all together the first time a statement,
+-- schema or helper of theirs is looked up
+local default_scenarios = {
+	'zencode_hash', 'zencode_array', 'zencode_random',
+	'zencode_dictionary', 'zencode_verify', 'zencode_keyring',
+	'zencode_pack', 'zencode_bitcoin' }
+function load_default_scenarios()
+	if not default_scenarios then return false end
+	local scenarios = default_scenarios
+	default_scenarios = nil
+	for _, scen in ipairs(scenarios) do load_scenario(scen) end
+	return true
+end
+local function default_scenario_global(name)
+	return function()
+		load_default_scenarios()
+		return rawget(_G, name)
+	end
+end
+
+-- globals created on first access, for modules and values that most
+-- scripts do not use: each constructor is called once
+local lazy_globals = {
+	CBOR = function() return require('zenroom_cbor') end,
+	MPACK = function() return require('zenroom_msgpack') end,
+	BENCH = function() return require('zenroom_bench') end,
+	TIME = function() return require('timetable') end,
+	BTC = function() return require('crypto_bitcoin') end,
+	V = function() return require('semver') end,
+	ZENROOM_VERSION = function() return V(VERSION) end,
+	SALT = function()
+		return ECP.hashtopoint(OCTET.from_string(COPYRIGHT .. LICENSE))
+	end,
+	initkeyring = default_scenario_global('initkeyring'),
+	havekey = default_scenario_global('havekey'),
+	load_pubkey_compat = default_scenario_global('load_pubkey_compat'),
+	shuffle_array_f = default_scenario_global('shuffle_array_f')
+}
+setmetatable(_G, { __index = function(t, k)
+	local new = lazy_globals[k]
+	if not new then return nil end
+	lazy_globals[k] = nil
+	local v = new()
+	rawset(t, k, v)
+	return v
+end })
+
 -- error = zen_error -- from zen_io
 
 -- ZEN = { assert = assert } -- zencode shim when not loaded
 require('zenroom_common')
 INSPECT = require('inspect')
-CBOR = require('zenroom_cbor')
 JSON = require('zenroom_json')
 OCTET = require('zenroom_octet')
 BIG = require('zenroom_big')
@@ -95,39 +142,30 @@ I = INSPECT -- alias
 H = HASH -- alias
 PAIR = ECP2 -- alias
 PAIR.ate = ECP2.miller --alias
-MPACK = require('zenroom_msgpack')
-BENCH = require('zenroom_bench')
 MACHINE = require('statemachine')
-TIME = require('timetable')
--- BITCOIN primitives are imported by default
-BTC = require('crypto_bitcoin')
-V = require('semver')
-ZENROOM_VERSION = V(VERSION)
+-- CBOR, MPACK, BENCH, TIME, BTC (bitcoin primitives), V (semver)
+-- and ZENROOM_VERSION are loaded on first use, see lazy_globals
 
 ZEN = require('zencode')
 -- the global ZEN context
+-- schemas of default scenarios are found once these are loaded
+setmetatable(ZEN.schemas, { __index = function(t, k)
+	if load_default_scenarios() then return rawget(t, k) end
+end })
 
 -- base zencode functions and schemas
 load_scenario('zencode_data') -- pick/in, conversions etc.
 load_scenario('zencode_given')
 load_scenario('zencode_when')
-load_scenario('zencode_hash') -- when extension
-load_scenario('zencode_array') -- when extension
-load_scenario('zencode_random') -- when extension
-load_scenario('zencode_dictionary') -- when extension
-load_scenario('zencode_verify') -- when extension
 load_scenario('zencode_then')
-load_scenario('zencode_keyring')
-load_scenario('zencode_pack') -- mpack and zpack 
+-- hash, array, random, dictionary, verify, keyring, pack (mpack and
+-- zpack) and bitcoin are loaded on demand by load_default_scenarios
 -- this is to evaluate expressions or derivate a column
 -- it would execute lua code inside the zencode and is
 -- therefore dangerous, switched off by default
 -- require('zencode_eval')
 load_scenario('zencode_debug')
 
--- bitcoin is loaded by default
-load_scenario('zencode_bitcoin')
-
 -- scenario are loaded on-demand
 -- scenarios can only implement "When ..." steps
 _G['Given'] = nil
@@ -138,13 +176,13 @@ _G['Then'] = nil
 _G['CONF'] = {
 	input = {
 		encoding = input_encoding('base64'),
-		format = { fun = JSON.auto, name = 'json' },
+		format = get_format('json'),
 		tagged = false
 	},
 	output = {
 		encoding = { fun = guess_outcast('base64'),
 			     name = 'base64' },
-		format = { fun = JSON.auto, name = 'json' },
+		format = get_format('json'),
 		versioning = false
 	},
 	debug = { encoding = { fun = guess_outcast('hex'),
@@ -174,7 +212,8 @@ _G['COPYRIGHT'] =
 	[[
 Forked by Jaromil on 18 January 2020 from Coconut Petition
 ]]
-SALT = ECP.hashtopoint(OCTET.from_string(COPYRIGHT .. LICENSE))
+-- SALT = ECP.hashtopoint(OCTET.from_string(COPYRIGHT .. LICENSE))
+-- is computed on first use, see lazy_globals
 -- Calculate a system-wide crypto challenge for ZKP operations
 -- returns a BIG INT
 -- this is a sort of salted hash for advanced ZKP operations and
@@ -109,6 +109,7 @@ local function set_sentence(self, event, from, to, ctx)
 	tt = gsub(tt, ' +$', '') -- remove final spaces
         tt = tt:lower()
         local func = reg[tt]
+        if not func and load_default_scenarios() then func = reg[tt] end
         if func and type(func) == 'function' then
 	        local args = {} -- handle multiple arguments in same string
                 for arg in string.gmatch(ctx.msg, "'(.-)'") do
@@ -384,7 +385,7 @@ function zencode.add_schema(arr)
 	}
 	for k, v in pairs(arr) do
 		-- check overwrite / duplicate to avoid scenario namespace clash
-		if ZEN.schemas[k] then
+		if rawget(ZEN.schemas, k) then
 			error('Add schema denied, already registered schema: ' .. k, 2)
 		end
 		if _illegal_schemas[k] then
@@ -617,7 +618,7 @@ function zencode:run()
 		-- HEAP integrity guard
 		if CONF.heapguard then
 			-- guard ACK's contents on section switch
-			deepmap(zenguard, ACK)
+			deepmap_inplace(zenguard, ACK)
 		end
 
 		ZEN.OK = true
@@ -635,12 +636,10 @@ function zencode:run()
 	-- PRINT output
 	ZEN:trace('--- Zencode execution completed')
 	if type(OUT) == 'table' then
-		ZEN:trace('<<< Encoding { OUT } to JSON ')
-		-- this is all already encoded
-		-- needs to be formatted
-		-- was used CONF.output.format.fun
-		-- suspended until more formats are implemented
-		print( JSON.encode(OUT) )
+		ZEN:trace('<<< Encoding { OUT } to '..CONF.output.format.name)
+		-- this is all already encoded, binary formats
+		-- print octets as raw bytes
+		CONF.output.format.print(OUT)
 		ZEN:trace('>>> Encoding successful')
 	else -- this should never occur in zencode, OUT is always a table
 		ZEN:trace('<<< Printing OUT (plain format, not a table)')
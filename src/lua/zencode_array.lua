@@ -191,48 +191,48 @@ end)
 --     table.insert(ACK[arr], ACK[ele])
 -- end)
 
+-- true if the element named ele is in the array named arr, or is a
+-- key of the dictionary named arr
+local function _is_found_in(ele, arr)
+	local obj = ACK[ele]
+	ZEN.assert(obj, "Element not found: "..ele)
+	local cont = ACK[arr]
+	ZEN.assert(cont, "Array not found: "..arr)
+	local zentype = ZEN.CODEC[arr].zentype
+	-- zenroom values are compared by content in C, without calling
+	-- == on each element (src/zen_octet_set.c)
+	local zen = luatype(obj) == 'userdata'
+	if zentype == 'array' then
+	   if zen then return O.find(cont, obj) ~= nil end
+	   for k,v in pairs(cont) do
+		  if v == obj then return true end
+	   end
+	elseif zentype == 'dictionary' then
+	   if zen then
+		  local key = O.to_string(obj)
+		  return key ~= nil and cont[key] ~= nil
+	   end
+	   for k,v in pairs(cont) do
+		  local val = k
+		  if luatype(k) == 'string' then
+			 val = O.from_string(k)
+		  end
+		  if val == obj then return true end
+	   end
+	else
+	   ZEN.assert(false, "Invalid container type: "..arr.." is "..zentype)
+	end
+	return false
+end
+
 IfWhen("the '' is not found in ''", function(ele, arr)
-        local obj = ACK[ele]
-        ZEN.assert(obj, "Element not found: "..ele)
-        ZEN.assert(ACK[arr], "Array not found: "..arr)
-		if ZEN.CODEC[arr].zentype == 'array' then
-		   for k,v in pairs(ACK[arr]) do
-			  ZEN.assert(v ~= obj, "Element '"..ele.."' is contained inside: "..arr)
-		   end
-		elseif ZEN.CODEC[arr].zentype == 'dictionary' then
-		   for k,v in pairs(ACK[arr]) do
-			  local val = k
-			  if luatype(k) == 'string' then
-			  	 val = O.from_string(k)
-			  end
-			  ZEN.assert(val ~= obj, "Element '"..ele.."' is contained inside: "..arr)
-		   end
-		else
-		   ZEN.assert(false, "Invalid container type: "..arr.." is "..ZEN.CODEC[arr].zentype)
-		end
+		ZEN.assert(not _is_found_in(ele, arr),
+				   "Element '"..ele.."' is contained inside: "..arr)
 end)
 
 IfWhen("the '' is found in ''", function(ele, arr)
-		local obj = ACK[ele]
-		ZEN.assert(obj, "Element not found: "..ele)
-		ZEN.assert(ACK[arr], "Array not found: "..arr)
-		local found = false
-		if ZEN.CODEC[arr].zentype == 'array' then
-		   for k,v in pairs(ACK[arr]) do
-			  if v == obj then found = true end
-		   end
-		elseif ZEN.CODEC[arr].zentype == 'dictionary' then
-		   for k,v in pairs(ACK[arr]) do
-			  local val = k
-			  if luatype(k) == 'string' then
-			  	 val = O.from_string(k)
-			  end
-			  if val == obj then found = true end
-		   end
-		else
-		   ZEN.assert(false, "Invalid container type: "..arr.." is "..ZEN.CODEC[arr].zentype)
-		end
-		ZEN.assert(found, "The content of element '"..ele.."' is not found inside: "..arr)
+		ZEN.assert(_is_found_in(ele, arr),
+				   "The content of element '"..ele.."' is not found inside: "..arr)
 end)
 
 IfWhen("the '' is found in '' at least '' times", function(ele, arr, times)
@@ -70,7 +70,7 @@
     if t == 'table' then
        res = deepmap(encoding or CONF.input.encoding.fun, k)
        if conversion then
-	  res = deepmap(conversion, res)
+	  res = deepmap_inplace(conversion, res)
        end
     end
     ::ok::
@@ -149,7 +149,8 @@ end
        })
     end
 
-    if objtype == 'string' then
+    -- binary input formats have octets in place of encoded strings
+    if objtype == 'string' or objtype == 'userdata' then
        if expect_table(definition) then
 	  error("Cannot take object: expected '"..definition.."' but found '"..objtype.."' (not a table)",3)
        end
@@ -255,14 +256,10 @@ end
        end
     elseif guessed.luatype == 'table' then
        -- TODO: better error checking on deepmap?
-       if luatype(guessed.check) == 'function' then
-	  deepmap(guessed.check, guessed.raw)
-       end
+       -- the conversion validates while decoding: the encoding
+       -- check is not run before it to avoid scanning twice
        return deepmap(guessed.fun, guessed.raw)
     else -- object
-       if guessed.check then
-	  guessed.check(guessed.raw)
-       end
        return guessed.fun(guessed.raw)
     end
  end
@@ -280,6 +277,9 @@ local function f_factory_encoder(encoder_n, encoder_f, encoder_c)
 		  return data
 	       elseif dt == 'boolean' then
 		  return data
+	       elseif dt == 'userdata' then
+		  -- octet found in a binary input format
+		  return data
 	       end
 	       return encoder_f(data)
    end,
@@ -311,14 +311,19 @@ function input_encoding(what)
       -- mnemonic has no check function (TODO:)
       return f_factory_encoder('mnemonic', O.from_mnemonic, nil)
    elseif what == 'num' or what == 'number' then
-      return f_factory_encoder('number', 
-			       function(data) return tonumber(data) end,
-			       function(data)
-				  if not tonumber(data) then
-				     error("Invalid encoding, not a number: "
-					   ..type(data), 3)
-				  end
-			       end)
+      local function check(data)
+	 if not tonumber(data) then
+	    error("Invalid encoding, not a number: "
+		  ..type(data), 3)
+	 end
+      end
+      return { fun = function(data)
+		  check(data)
+		  return tonumber(data)
+	       end,
+	       encoding = 'number',
+	       check = check
+      }
    end
    error("Input encoding not found: " .. what, 2)
    return nil
@@ -383,13 +388,24 @@ end
     return nil
  end
 
+-- binary formats carry octets as raw bytes: they are found as
+-- octets in input and not encoded in output
 function get_format(what)
    if what == 'json' or what == 'JSON' then
       return { fun = JSON.auto,
+	       print = JSON.print,
 	       name = 'json' }
    elseif what == 'cbor' or what == 'CBOR' then
       return { fun = CBOR.auto,
-	       name = 'cbor' }
+	       print = CBOR.print,
+	       name = 'cbor',
+	       binary = true }
+   elseif what == 'mpack' or what == 'MPACK'
+      or what == 'msgpack' or what == 'MessagePack' then
+      return { fun = MPACK.auto,
+	       print = MPACK.print,
+	       name = 'mpack',
+	       binary = true }
    end
    error("Conversion format not supported: "..what, 2)
    return nil
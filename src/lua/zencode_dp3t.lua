@@ -36,23 +36,29 @@ SHA256 = HASH.new('sha256')
 
 When("renew the secret day key to a new day", function()
 		ZEN.assert(ACK.secret_day_key, "Secret day key not found")
-		local sk = SHA256:process(ACK.secret_day_key)
+		local sk = sha256(ACK.secret_day_key)
 		ZEN.assert(sk, "Error renewing secret day key (SHA256)")
 		ACK.secret_day_key = sk
 end)
 
+-- all the ephemeral ids of a day key, concatenated: the AES-CTR
+-- keystream of the PRF, whose 16 bytes block i is the encryption of
+-- the counter i, one for each epoch of the day (including the last)
+local function ephemeral_ids_stream(sk, broadcast_key, epoch)
+   local epd = math.floor((24*60)/epoch) -- num epochs per day
+   local PRF = SHA256:hmac(sk, broadcast_key)
+   return AES.ctr(PRF, OCTET.zero((epd+1)*16), O.from_number(0))
+end
+
 When("create the ephemeral ids for today", function()
 		ZEN.assert(ACK.secret_day_key, "Secret day key not found")
 		ZEN.assert(ACK.broadcast_key, "Broadcast key not found")
 		ZEN.assert(type(ACK.epoch) == 'number', "Epoch length (minutes) not found")
-		local PRF = SHA256:hmac(ACK.secret_day_key, ACK.broadcast_key)
-		local epd = (24*60)/ACK.epoch -- num epochs per day
-		local zero = OCTET.zero(epd*16) -- 0 byte buffer
+		local PRG = ephemeral_ids_stream(ACK.secret_day_key,
+										 ACK.broadcast_key, ACK.epoch)
 		ACK.ephemeral_ids = { }
-		for i = 0,epd,1 do
-		   local PRG = AES.ctr(PRF, zero, O.from_number(i))
-		   local l,r = OCTET.chop(PRG,16)
-		   table.insert(ACK.ephemeral_ids, l)
+		for i = 1,#PRG,16 do
+		   table.insert(ACK.ephemeral_ids, PRG:sub(i, i+15))
 		end
 end)
 
@@ -62,17 +68,11 @@ When("create the proximity tracing of infected ids", function()
 		ZEN.assert(type(ACK.ephemeral_ids) == 'table', "List of ephemeral ids not found")
 		ZEN.assert(ACK.broadcast_key, "Broadcast key not found")
 		ACK.proximity_tracing = { }
-		local epd = (24*60)/ACK.epoch -- num epochs per day
-		local zero = OCTET.zero(epd*16) -- 0 byte buffer
+		local ephemeral_ids = OCTET.set(ACK.ephemeral_ids)
 		for n,sk in ipairs(ACK.list_of_infected) do
-		   local PRF = SHA256:hmac(sk, ACK.broadcast_key)
-		   for i = 0,epd,1 do
-			  local PRG = OCTET.chop( AES.ctr(PRF, zero, O.from_number(i)), 16)
-			  for nn,eph in next, ACK.ephemeral_ids, nil do
-				 if eph == PRG then
-					table.insert(ACK.proximity_tracing, sk)
-				 end
-			  end
+		   local PRG = ephemeral_ids_stream(sk, ACK.broadcast_key, ACK.epoch)
+		   for i = 1, ephemeral_ids:count_chunks(PRG, 16) do
+			  table.insert(ACK.proximity_tracing, sk)
 		   end
 		end
 end)
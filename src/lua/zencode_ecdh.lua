@@ -214,6 +214,23 @@ local function _verifying(msg, sig, by)
    )
 end
 
+-- verify an array of signatures of the elements of an array, made
+-- by one public key or by an array of public keys in the same order
+local function _verifying_array(msgs, sigs, by)
+   local pk = _pubkey_compat(by)
+   local arr = have(msgs)
+   local s = have(sigs)
+   ZEN.assert(luatype(arr) == 'table' and luatype(s) == 'table',
+	      'Messages and signatures must be arrays: '..msgs..', '..sigs)
+   ZEN.assert(#arr == #s, 'The number of signatures in '..sigs..
+	      ' does not match the number of elements in '..msgs)
+   local ser = { }
+   for i, v in ipairs(arr) do ser[i] = ZEN.serialize(v) end
+   local ok, failed = ECDH.verify_batch(pk, ser, s)
+   ZEN.assert(ok, 'The signatures by '..by..' are not authentic at positions: '..
+	      table.concat(failed, ', '))
+end
+
 When(
    "create the signature of ''", function(msg)
    _signing(msg, 'signature')
@@ -233,3 +250,13 @@ IfWhen(
    "verify the '' has a ecdh signature in '' by ''",
    _verifying
 )
+
+IfWhen(
+   "verify the array '' has signatures in '' by ''",
+   _verifying_array
+)
+
+IfWhen(
+   "verify the array '' has ecdh signatures in '' by ''",
+   _verifying_array
+)
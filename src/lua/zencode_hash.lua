@@ -29,7 +29,7 @@ When(
         if luatype(src) == 'table' then
             src = ZEN.serialize(src) -- serialize tables using zenroom's algo
         end
-        ACK.hash = HASH.new(CONF.hash):process(src)
+        ACK.hash = HASH.digest(CONF.hash, src)
 	new_codec('hash', { zentype = 'element' })
     end
 )
@@ -36,21 +36,37 @@ When("create the '' decoded from mpack ''", function(dst, src)
 end)
 
 
-When("create the zpack of ''", function(src)
+-- the compression level is set by the "zstd" configuration, an
+-- optional dictionary improves the ratio of small similar payloads
+local function _zpack(src, dict)
     empty'zpack'
     local source = have(src)
     local tmp = MPACK.encode( { data = source,
 				codec = ZEN.CODEC[src] } )
-    ACK.zpack = compress( O.from_rawlen(tmp, #tmp) )
+    ACK.zpack = compress( O.from_rawlen(tmp, #tmp), nil, dict )
     new_codec('zpack', { zentype = 'element'})
-end)
+end
 
-When("create the '' decoded from zpack ''", function(dst, src)
+local function _zunpack(dst, src, dict)
     empty(dst)
     local zpack = have(src)
-    local tmp = MPACK.decode ( O.to_string( decompress(zpack) ) )
+    local tmp = MPACK.decode ( O.to_string( decompress(zpack, dict) ) )
     ZEN.assert( tmp.data, "Invalid zpack, data not found: "..src)
     ZEN.assert( tmp.codec, "Invalid zpack, codec not found: "..src)
     ACK[dst] = tmp.data
     ZEN.CODEC[dst] = tmp.codec
+end
+
+When("create the zpack of ''", function(src) _zpack(src) end)
+
+When("create the zpack of '' with dictionary ''", function(src, dict)
+    _zpack(src, have(dict))
+end)
+
+When("create the '' decoded from zpack ''", function(dst, src)
+    _zunpack(dst, src)
+end)
+
+When("create the '' decoded from zpack '' with dictionary ''", function(dst, src, dict)
+    _zunpack(dst, src, have(dict))
 end)
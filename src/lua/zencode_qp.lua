@@ -187,6 +187,34 @@ IfWhen("verify the '' has a dilithium signature in '' by ''",function(msg, sig,
 	  )
 end)
 
+-- batch operations expand the keys only once for all the elements
+When("create the dilithium signatures of each object in ''",function(arr)
+	local sk = havekey'dilithium'
+	local A = have(arr)
+	local count = isarray(A)
+	ZEN.assert(count > 0, 'Object is not an array: '..arr)
+	empty'dilithium signatures'
+	local msgs = {}
+	for i,v in ipairs(A) do msgs[i] = ZEN.serialize(v) end
+	ACK.dilithium_signatures = QP.sign_batch(sk, msgs)
+	new_codec('dilithium signatures', { luatype='table', zentype='array' })
+end)
+
+IfWhen("verify the array '' has dilithium signatures in '' by ''",function(arr, sigs, by)
+	  local pk = _pubkey_compat(by, 'dilithium')
+	  local A = have(arr)
+	  local S = have(sigs)
+	  local count = isarray(A)
+	  ZEN.assert(count > 0, 'Object is not an array: '..arr)
+	  ZEN.assert(isarray(S) == count,
+		     'Number of signatures and messages differ: '..sigs)
+	  local msgs = {}
+	  for i,v in ipairs(A) do msgs[i] = ZEN.serialize(v) end
+	  for i,ok in ipairs(QP.verify_batch(pk, S, msgs)) do
+	     ZEN.assert(ok, 'The signature number '..i..' by '..by..' is not authentic')
+	  end
+end)
+
 --# KYBER #--
 
 -- generate the private key
@@ -35,6 +35,28 @@
 -- my from as
 ----------------------
 
+-- binary output formats print octets as raw bytes in place of
+-- these encodings
+local binary_encodings = {
+   base64 = true, url64 = true, base58 = true,
+   hex = true, bin = true, binary = true
+}
+local function binary_outcast(data)
+   local dt = luatype(data)
+   if dt == 'table' then error("invalid table conversion",2) end
+   if dt == 'userdata' and type(data) ~= 'zenroom.octet' then
+      return data:octet()
+   end
+   return data
+end
+
+local function outcast(sch)
+   if CONF.output.format.binary and binary_encodings[sch] then
+      return binary_outcast
+   end
+   return guess_outcast(sch)
+end
+
 -- executes a guess_outcast and then operates it
 -- sch may be fed with check_codec() result (name of encoding)
 local function then_outcast(val, sch)
@@ -49,7 +71,7 @@ local function then_outcast(val, sch)
    if codec and codec.schema then
       fun = guess_outcast(codec.schema)
    else
-      fun = guess_outcast(sch)
+      fun = outcast(sch)
    end
 
    local lt = luatype(val)
@@ -67,7 +89,7 @@ local function then_outcast(val, sch)
       return fun(val)
    else -- schema not complex
       local res = fun(val)
-      local enc = guess_outcast( codec.encoding )
+      local enc = outcast( codec.encoding )
       if luatype(res) == 'table' then
 	 return deepmap(enc, res)
       else
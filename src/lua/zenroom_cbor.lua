@@ -20,9 +20,19 @@
 --on Tuesday, 20th July 2021
 --]]
 
-local _cbor = require('cbor')
+-- CBOR encoder and decoder implemented in C (zen_pack.c): octets
+-- are byte strings and Lua strings text strings. The pure Lua 'cbor'
+-- module is left available.
+local _cbor = { }
 
-_cbor.decode = _cbor.raw_decode
+_cbor.raw_encode = cbor_encode
+
+-- accepts a string or an octet
+_cbor.raw_decode = cbor_decode
+_cbor.decode = cbor_decode
+
+-- prints the encoded value to the configured output
+_cbor.print = cbor_print
 
 _cbor.encode = function(tab)
    -- encodes zencode types according to CODEC
@@ -43,11 +53,15 @@ end
 _cbor.auto = function(obj)
    local t = luatype(obj)
    if t == 'table' then
-	  -- export table to JSON
+	  -- export table to CBOR
 	  return _cbor.encode(obj)
-   elseif t == 'string' then
-	  -- import JSON string to table
-	  return _cbor.decode(obj)
+   elseif t == 'string' or t == 'userdata' then
+	  -- import CBOR string or octet to table
+	  local res = cbor_decode(obj)
+	  if luatype(res) ~= 'table' then
+		 error("CBOR.auto decoded a "..type(res).." instead of a map or array", 3)
+	  end
+	  return res
    else
 	  error("CBOR.auto unrecognised input type: "..t, 3)
 	  return nil
@@ -20,23 +20,8 @@
 --on Saturday, 13th November 2021
 --]]
 
--- override type to recognize zenroom's types
-luatype = type
-_G['type'] = function(var)
-   local simple = luatype(var)
-   if simple == "userdata" then
-	  local meta = getmetatable(var)
-	  if meta then return(meta.__name)
-	  else return("unknown") end
-   else return(simple) end
-end
--- TODO: optimise in C
-function iszen(n)
-   for _ in n:gmatch("zenroom") do
-	  return true
-   end
-   return false
-end
+-- type() is overridden to recognize zenroom's types, Lua's one is
+-- luatype(): both are set with iszen() in lua_functions.c
 
 -- workaround for a ternary conditional operator
 function fif(condition, if_true, if_false)
@@ -106,99 +91,9 @@ end
 _G["sort_pairs"]  = _pairs
 _G["sort_ipairs"] = _pairs
 
-function deepcopy(orig)
-   local orig_type = type(orig)
-   local copy
-   if orig_type == 'table' then
-	  copy = {}
-	  for orig_key, orig_value in next, orig, nil do
-		 copy[deepcopy(orig_key)] = deepcopy(orig_value)
-	  end
-	  setmetatable(copy, deepcopy(getmetatable(orig)))
-   else -- number, string, boolean, etc
-	  copy = orig
-   end
-   return copy
-end
-
--- deep recursive map on a tree structure
--- for usage see test/deepmap.lua
--- operates only on strings, passes numbers through
-function deepmap(fun,t,...)
-   local luatype = luatype
-   if luatype(fun) ~= 'function' then
-	  error("Internal error: deepmap 1st argument is not a function", 3)
-	  return nil end
-   -- if luatype(t) == 'number' then
-   -- 	  return t end
-   if luatype(t) ~= 'table' then
-	  error("Internal error: deepmap 2nd argument is not a table", 3)
-	  return nil end
-   local res = {}
-   for k,v in pairs(t) do
-	  if luatype(v) == 'table' then
-		 res[k] = deepmap(fun,v,...) -- recursion
-	  else
-		 res[k] = fun(v,k,...)
-	  end
-   end
-   return setmetatable(res, getmetatable(t))
-end
-
-function isarray(obj)
-   if not obj then
-	  warn("Argument of isarray() is nil")
-	  return false
-   end
-   if luatype(obj) == 'string' then
-      -- seach HEAD for ACK[obj] and check its CODEC
-      local o = ACK[obj]
-      if not o then return false end
-      if luatype(o) ~= 'table' then return false end
-      if ZEN.CODEC[obj].zentype == 'array' then return true end
-      return false
-   end
-   if luatype(obj) ~= 'table' then
-      -- warn("Argument of isarray() is not a table")
-      return false
-   end
-   local count = 0
-   for k, v in pairs(obj) do
-	  -- check that all keys are numbers
-	  -- don't check sparse ratio (cjson's lua_array_length)
-	  if luatype(k) ~= "number" then return false end
-	  count = count + 1
-   end
-   return count
-end
-
-function isdictionary(obj)
-   if not obj then
-	  warn("Argument of isdictionary() is nil")
-	  return false
-   end
-   if luatype(obj) == 'string' then
-      -- seach HEAD for ACK[obj] and check its CODEC
-      local o = ACK[obj]
-      if not o then return false end
-      if luatype(o) ~= 'table' then return false end
-      if ZEN.CODEC[obj].zentype == 'dictionary'
-	 or ZEN.CODEC[obj].zentype == 'schema' then
-	 return true end -- TRUE
-      return false
-   end
-   -- check the object itself
-   if luatype(obj) ~= 'table' then return false end
-   -- error("Argument is not a table: "..type(obj)
-   local count = 0
-   for k, v in pairs(obj) do
-	  -- check that all keys are not numbers
-	  -- don't check sparse ratio (cjson's lua_array_length)
-	  if luatype(k) ~= "string" then return false end
-	  count = count + 1
-   end
-   return count
-end
+-- deepcopy(), deepmap(), deepmap_inplace(), isarray() and
+-- isdictionary() are in lua_functions.c, for usage of deepmap see
+-- test/deepmap.lua
 
 function array_contains(arr, obj)
    assert(luatype(arr) == 'table', "Internal error: array_contains argument is not a table")
@@ -254,4 +149,5 @@ function zenguard(val)
 	      error("Zenguard detected an invalid value in HEAP: type "..type(val), 2)
 	      return nil
    end
+   return val -- unchanged by deepmap_inplace
 end
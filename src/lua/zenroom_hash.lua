@@ -39,23 +39,15 @@ local function init(bits)
    return h
 end
 
-function sha256(data) return init(256):process(data) end
-function sha512(data) return init(512):process(data) end
+function sha256(data) return hash.digest('sha256', data) end
+function sha512(data) return hash.digest('sha512', data) end
 function KDF(data, bits)
    local b = bits or 256
    return init(b):kdf2(data)
 end
 
-function hash.dsha256(msg)
-   local SHA256 = HASH.new('sha256')
-   return SHA256:process(SHA256:process(msg))
-end
-
 function hash.hash160(msg)
-   local SHA256 = HASH.new('sha256')
-   local RMD160 = HASH.new('ripemd160')
-   return RMD160:process(SHA256:process(msg))
-
+   return hash.digest('ripemd160', hash.digest('sha256', msg))
 end
 
 
@@ -23,42 +23,28 @@
 local J = require('json')
 
 
-J.decode = function(data)
+-- decodes one or more concatenated JSON objects, elements of unnamed
+-- arrays are added into 'array'. The optional 'conv' is an encoding
+-- name (as in OCTET.from_<conv>) or a function applied to all string
+-- values while parsing
+J.decode = function(data, conv)
    if not data then error("JSON.decode called without argument", 2) end
+   assert(luatype(data) == "string" or type(data) == "zenroom.octet",
+		  "JSON.decode argument of unsopported type: "..type(data))
    assert(#data > 1,"JSON.decode argument is empty string")
-   assert(luatype(data) == "string", "JSON.decode argument of unsopported type: "..luatype(data))
-   local res = {}
-   local right = tostring(data)
-   local left
-   local tmp
-   while right do
-      left, right = jsontok(right) -- function in zen_parser.c
-      if not left then break end
-      tmp = JSON.raw_decode(left)
-      if luatype(tmp) == 'table' then
-            for k,v in pairs(tmp) do
-               -- adds all unnamed array elements into 'array'
-               if luatype(k)=='number' then
-                  res.array = fif(res.array, res.array, {})
-                  table.insert(res.array, v)
-               else
-                  res[k] = v
-               end
-            end
-      else
-         error("JSON decode has not returned a table", 2)
-      end
-   end
-   return res
+   return json_decode(data, conv) -- function in zen_json.c
 end
 
+-- encodes zencode types with 'enc' (an encoding name as in
+-- guess_outcast or a function) and sorts the keys of objects
 J.encode = function(tab,enc)
-   return
-      JSON.raw_encode(
-	 -- process encodes zencode types
-	 -- it is part of inspect.lua
-	 INSPECT.process(tab, enc or CONF.output.encoding.name)
-      )
+   return json_encode(tab, enc or CONF.output.encoding.name) -- zen_json.c
+end
+
+-- prints the JSON encoding of 'tab' followed by a newline, written
+-- straight into the output buffer when configured
+J.print = function(tab,enc)
+   json_print(tab, enc or CONF.output.encoding.name) -- zen_json.c
 end
 
 J.auto = function(obj)
@@ -66,8 +52,8 @@ J.auto = function(obj)
    if t == 'table' then
 	  -- export table to JSON
 	  return JSON.encode(obj)
-   elseif t == 'string' then
-	  -- import JSON string to table
+   elseif t == 'string' or t == 'zenroom.octet' then
+	  -- import JSON string or octet to table
 	  return JSON.decode(obj)
    else
 	  error("JSON.auto unrecognised input type: "..t, 3)
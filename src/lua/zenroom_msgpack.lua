@@ -17,50 +17,35 @@
 --If not, see http://www.gnu.org/licenses/agpl.txt
 --]]
 
--- required by zenroom_zpack
-
-local mpack = require_once'msgpack'
-local pack, unpack = string.pack, string.unpack
-
-local to_octenv = OCTET.to_url64
-local from_octenv = OCTET.from_url64
-
--- userdata codes available
-
--- 0xc{7,8,9} 
-mpack.encoder_functions['zenroom.octet'] = function(v)
-   return pack('>Bs4', 0xc7, to_octenv(v)) end
-mpack.encoder_functions['zenroom.big'] = function(v)
-   return pack('>Bs4', 0xc8, to_octenv(v:octet())) end
--- reserved for zenroom 3.0
--- mpack.encoder_functions['zenroom.float'] = function(v)
---    return pack('>Bs4', 0xc9, to_octenv(v:octet())) end
-
--- 0xd{4,5,6,7,8}
-mpack.encoder_functions['zenroom.ecp']   = function(v)
-   return pack('>Bs4', 0xd4, to_octenv(v:octet())) end
-mpack.encoder_functions['zenroom.ecp2']   = function(v)
-   return pack('>Bs4', 0xd5, to_octenv(v:octet())) end
-
-local function decode_octet(data, offset)
-   local value, pos = string.unpack('>s4', data, offset)
-   return from_octenv(value), pos
-end
-local function decode_big(data, offset)
-   local value, pos = string.unpack('>s4', data, offset)
-   return BIG.new(from_octenv(value)), pos
-end
-local function decode_ecp(data, offset)
-   local value, pos = string.unpack('>s4', data, offset)
-   return ECP.new(from_octenv(value)), pos   
-end
-local function decode_ecp2(data, offset)
-   local value, pos = string.unpack('>s4', data, offset)
-   return ECP2.new(from_octenv(value)), pos   
+-- MessagePack encoder and decoder implemented in C (zen_pack.c):
+-- octets are packed as raw binary strings, BIG, ECP and ECP2 as
+-- extension types. Packs made by the previous Lua encoder, with
+-- url64 strings behind the 0xc7, 0xc8, 0xd4 and 0xd5 markers, are
+-- still decoded. The pure Lua 'msgpack' module is left available.
+
+local mpack = { }
+
+mpack.encode = mpack_encode
+
+-- accepts a string or an octet
+mpack.decode = mpack_decode
+
+-- prints the encoded value to the configured output
+mpack.print = mpack_print
+
+mpack.auto = function(obj)
+   local t = luatype(obj)
+   if t == 'table' then
+      return mpack_encode(obj)
+   elseif t == 'string' or t == 'userdata' then
+      local res = mpack_decode(obj)
+      if luatype(res) ~= 'table' then
+	 error("MPACK.auto decoded a "..type(res).." instead of a map or array", 3)
+      end
+      return res
+   end
+   error("MPACK.auto unrecognised input type: "..t, 3)
+   return nil
 end
-mpack.decoder_functions[0xc7] = decode_octet
-mpack.decoder_functions[0xc8] = decode_big
-mpack.decoder_functions[0xd4] = decode_ecp
-mpack.decoder_functions[0xd5] = decode_ecp2
 
 return mpack
@@ -22,6 +22,13 @@
 
 local octet = require'octet'
 
+-- set of octets and map from octets, compared by content
+-- (src/zen_octet_set.c)
+local octet_set = require'octet_set'
+octet.set = octet_set.new
+octet.map = octet_set.map
+octet.find = octet_set.find
+
 --- implicit convertion functions going both ways
 -- if input is an encoded string, will become an octet
 -- if input is a non-encoded string, it will become a base64 string
@@ -39,24 +46,12 @@ end
 function str(data)
    local t = type(data)
    if(t == "string") and data ~= "" then
-	  if OCTET.is_url64(data) then
-		 -- return decoded string format for JSON.decode
-		 return OCTET.from_url64(data):str()
-	  elseif OCTET.is_base64(data) then
-		 -- return decoded string format for JSON.decode
-       return OCTET.from_base64(data):str()
-      elseif OCTET.is_base58(data) then
-         -- return decoded string format for JSON.decode
-         return OCTET.from_base58(data):str()
-	  elseif OCTET.is_hex(data) then
-		 -- return decoded string format for JSON.decode
-		 return OCTET.from_hex(data):str()
-	  elseif OCTET.is_bin(data) then
-		 -- return decoded string format for JSON.decode
-		 return OCTET.from_bin(data):str()
-	  else -- its already a string (we suppose, this is not deterministic)
-		 return data
-	  end
+	  -- detects url64, base64, base58, hex or bin in a single scan
+	  -- and returns the decoded string format for JSON.decode, else
+	  -- its already a string (we suppose, this is not deterministic)
+	  local o, enc = OCTET.from_auto(data)
+	  if enc == 'string' then return data end
+	  return o:str()
    elseif iszen(t) then
 	  return data:octet():str()
    else
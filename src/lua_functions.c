@@ -81,11 +81,20 @@ const char *zen_lua_findtable (lua_State *L, int idx,
 	return NULL;
 }
 
+// registry table mapping the metatables of zenroom classes to their
+// names, filled by zen_add_class and used by type() and iszen()
+#define ZEN_TYPES "zenroom.types"
+
 void zen_add_class(lua_State *L, char *name,
                   const luaL_Reg *_class, const luaL_Reg *methods) {
 	char classmeta[512] = "zenroom.";
 	strncat(classmeta, name, 511);
 	luaL_newmetatable(L, classmeta);
+	luaL_getsubtable(L, LUA_REGISTRYINDEX, ZEN_TYPES);
+	lua_pushvalue(L, -2);
+	lua_pushstring(L, classmeta);
+	lua_rawset(L, -3);
+	lua_pop(L, 1);
 	lua_pushstring(L, "__index");
 	lua_pushvalue(L, -2);  /* pushes the metatable */
 	lua_settable(L, -3);  /* metatable.__index = metatable */
@@ -111,3 +120,303 @@ void zen_add_class(lua_State *L, char *name,
 	lua_insert(L, -1);
 	luaL_setfuncs(L, _class,0);
 }
+
+// upvalues of type(): the names of basic types indexed by their
+// tag + 1, followed by the ZEN_TYPES table, which is the only
+// upvalue of iszen()
+#define ZEN_TYPES_UPVALUE (LUA_NUMTAGS + 1)
+
+/***
+Returns the type of a value as Lua's type() does, but for userdata
+returns the name of its class, for instance "zenroom.octet", or
+"unknown" when it has no metatable.
+
+    @function type(value)
+    @return string naming the type
+*/
+static int zen_type(lua_State *L) {
+	int t = lua_type(L, 1);
+	luaL_argcheck(L, t != LUA_TNONE, 1, "value expected");
+	if(t != LUA_TUSERDATA && t != LUA_TLIGHTUSERDATA) {
+		lua_pushvalue(L, lua_upvalueindex(t + 1));
+		return 1;
+	}
+	if(!lua_getmetatable(L, 1)) {
+		lua_pushliteral(L, "unknown");
+		return 1;
+	}
+	lua_pushvalue(L, -1);
+	if(lua_rawget(L, lua_upvalueindex(ZEN_TYPES_UPVALUE)) == LUA_TSTRING)
+		return 1;
+	lua_pop(L, 1);
+	lua_getfield(L, -1, "__name"); // userdata not of zenroom
+	return 1;
+}
+
+/***
+Tells if a value is zenroom data. The argument can be the value or
+the name of its type as returned by type().
+
+    @function iszen(value)
+    @return true if zenroom data, else false
+*/
+static int zen_iszen(lua_State *L) {
+	int res = 0;
+	switch(lua_type(L, 1)) {
+	case LUA_TSTRING:
+		res = strstr(lua_tostring(L, 1), "zenroom") != NULL;
+		break;
+	case LUA_TUSERDATA:
+		if(lua_getmetatable(L, 1))
+			res = lua_rawget(L, lua_upvalueindex(1)) != LUA_TNIL;
+		break;
+	}
+	lua_pushboolean(L, res);
+	return 1;
+}
+
+// overrides type() keeping Lua's one as luatype()
+void zen_add_types(lua_State *L) {
+	int i;
+	lua_getglobal(L, "type");
+	lua_setglobal(L, "luatype");
+	for(i=0; i<LUA_NUMTAGS; i++)
+		lua_pushstring(L, lua_typename(L, i));
+	luaL_getsubtable(L, LUA_REGISTRYINDEX, ZEN_TYPES);
+	lua_pushcclosure(L, zen_type, ZEN_TYPES_UPVALUE);
+	lua_setglobal(L, "type");
+	luaL_getsubtable(L, LUA_REGISTRYINDEX, ZEN_TYPES);
+	lua_pushcclosure(L, zen_iszen, 1);
+	lua_setglobal(L, "iszen");
+}
+
+// frames of the explicit stacks used to walk nested tables: source
+// table, destination table and key of the current pair
+#define DEEP_FRAME 3
+
+// deepmap modes
+#define DEEP_COPY    0 // map into a new table
+#define DEEP_INPLACE 1 // replace the values in the table
+
+static void deep_map(lua_State *L, int mode) {
+	int nargs = lua_gettop(L) - 2;
+	int base, i;
+	if(lua_type(L, 1) != LUA_TFUNCTION)
+		luaL_error(L, "Internal error: deepmap 1st argument is not a function");
+	if(lua_type(L, 2) != LUA_TTABLE)
+		luaL_error(L, "Internal error: deepmap 2nd argument is not a table");
+	base = lua_gettop(L);
+	lua_pushvalue(L, 2);
+	if(mode == DEEP_COPY) lua_newtable(L);
+	else lua_pushvalue(L, 2);
+	lua_pushnil(L);
+	while(lua_gettop(L) > base) {
+		// stack: ... src dst key
+		if(!lua_next(L, -3)) {
+			// end of this table: src dst
+			if(mode == DEEP_COPY && lua_getmetatable(L, -2))
+				lua_setmetatable(L, -2);
+			lua_remove(L, -2);
+			if(lua_gettop(L) == base + 1) break; // root result
+			lua_pop(L, 1); // parent's key is on top again
+			continue;
+		}
+		// stack: ... src dst key value
+		if(lua_type(L, -1) == LUA_TTABLE) {
+			luaL_checkstack(L, DEEP_FRAME + 2, "deepmap nesting");
+			if(mode == DEEP_COPY) {
+				lua_newtable(L);
+				lua_pushvalue(L, -3);
+				lua_pushvalue(L, -2);
+				lua_rawset(L, -6); // dst[key] = new table
+			} else lua_pushvalue(L, -1);
+			lua_pushnil(L);
+			// stack: ... src dst key | value dst' nil
+			continue;
+		}
+		luaL_checkstack(L, nargs + 4, "deepmap arguments");
+		lua_pushvalue(L, 1);
+		lua_insert(L, -2);
+		lua_pushvalue(L, -3);
+		for(i=0; i<nargs; i++) lua_pushvalue(L, 3 + i);
+		lua_call(L, 2 + nargs, 1); // fun(value, key, ...)
+		if(mode == DEEP_COPY && lua_isnil(L, -1)) {
+			lua_pop(L, 1);
+			continue;
+		}
+		lua_pushvalue(L, -2);
+		lua_insert(L, -2);
+		lua_rawset(L, -4); // dst[key] = result
+	}
+}
+
+/***
+Maps a function on all the values of nested tables, walking them
+without recursion. Tables are not passed to the function, the
+function is called with the value, its key and any further argument.
+
+    @function deepmap(fun, table, ...)
+    @return a new table of the same structure with the results
+*/
+static int zen_deepmap(lua_State *L) {
+	deep_map(L, DEEP_COPY);
+	return 1;
+}
+
+/***
+Maps a function as @{deepmap} does, but replaces the values inside
+the table with the results instead of creating a new one.
+
+    @function deepmap_inplace(fun, table, ...)
+    @return the same table
+*/
+static int zen_deepmap_inplace(lua_State *L) {
+	deep_map(L, DEEP_INPLACE);
+	return 1;
+}
+
+// pushes the deep copy of the value at idx: tables are walked on an
+// explicit stack, table keys and metatables are copied recursively
+static void deep_copy(lua_State *L, int idx) {
+	int base;
+	if(lua_type(L, idx) != LUA_TTABLE) {
+		lua_pushvalue(L, idx);
+		return;
+	}
+	luaL_checkstack(L, DEEP_FRAME + 4, "deepcopy nesting");
+	base = lua_gettop(L);
+	lua_pushvalue(L, idx);
+	lua_newtable(L);
+	lua_pushnil(L);
+	while(lua_gettop(L) > base) {
+		if(!lua_next(L, -3)) {
+			if(lua_getmetatable(L, -2)) {
+				deep_copy(L, lua_gettop(L));
+				lua_setmetatable(L, -3);
+				lua_pop(L, 1);
+			}
+			lua_remove(L, -2);
+			if(lua_gettop(L) == base + 1) break;
+			lua_pop(L, 1);
+			continue;
+		}
+		// stack: ... src dst key value
+		luaL_checkstack(L, DEEP_FRAME + 4, "deepcopy nesting");
+		deep_copy(L, lua_gettop(L) - 1); // copy of the key
+		if(lua_type(L, -2) == LUA_TTABLE) {
+			lua_newtable(L);
+			lua_pushvalue(L, -1);
+			lua_insert(L, -3);
+			lua_rawset(L, -6); // dst[key'] = new table
+			lua_pushnil(L);
+			// stack: ... src dst key | value dst' nil
+			continue;
+		}
+		lua_pushvalue(L, -2);
+		lua_rawset(L, -5); // dst[key'] = value
+		lua_pop(L, 1);
+	}
+}
+
+/***
+Copies a value, recursing into tables, their keys and metatables.
+
+    @function deepcopy(value)
+    @return a copy sharing no tables with the value
+*/
+static int zen_deepcopy(lua_State *L) {
+	luaL_checkany(L, 1);
+	deep_copy(L, 1);
+	return 1;
+}
+
+// common checks of isarray() and isdictionary(), returns 0 when the
+// result is pushed, else 1 when the argument is a table
+static int zen_table_check(lua_State *L, const char *fname,
+                           const char *zentype, const char *zentype2) {
+	if(!lua_toboolean(L, 1)) {
+		lua_getglobal(L, "warn");
+		lua_pushfstring(L, "Argument of %s() is nil", fname);
+		lua_call(L, 1, 0);
+		lua_pushboolean(L, 0);
+		return 0;
+	}
+	if(lua_type(L, 1) == LUA_TSTRING) {
+		// search HEAP for ACK[obj] and check its CODEC
+		int res = 0;
+		lua_getglobal(L, "ACK");
+		lua_pushvalue(L, 1);
+		if(lua_gettable(L, -2) == LUA_TTABLE) {
+			lua_getglobal(L, "ZEN");
+			lua_getfield(L, -1, "CODEC");
+			lua_pushvalue(L, 1);
+			lua_gettable(L, -2);
+			lua_getfield(L, -1, "zentype");
+			if(lua_type(L, -1) == LUA_TSTRING) {
+				const char *t = lua_tostring(L, -1);
+				res = !strcmp(t, zentype) || (zentype2 && !strcmp(t, zentype2));
+			}
+		}
+		lua_pushboolean(L, res);
+		return 0;
+	}
+	if(lua_type(L, 1) != LUA_TTABLE) {
+		lua_pushboolean(L, 0);
+		return 0;
+	}
+	return 1;
+}
+
+// counts the keys of the table at 1 if all are of the given type
+static void zen_table_count(lua_State *L, int keytype) {
+	lua_Integer count = 0;
+	lua_pushnil(L);
+	while(lua_next(L, 1)) {
+		lua_pop(L, 1);
+		if(lua_type(L, -1) != keytype) {
+			lua_pop(L, 1);
+			lua_pushboolean(L, 0);
+			return;
+		}
+		count++;
+	}
+	lua_pushinteger(L, count);
+}
+
+/***
+Tells if a table, or the name of an object in the HEAP, is an array.
+
+    @function isarray(obj)
+    @return the number of elements, or false
+*/
+static int zen_isarray(lua_State *L) {
+	if(zen_table_check(L, "isarray", "array", NULL))
+		zen_table_count(L, LUA_TNUMBER);
+	return 1;
+}
+
+/***
+Tells if a table, or the name of an object in the HEAP, is a
+dictionary.
+
+    @function isdictionary(obj)
+    @return the number of elements, or false
+*/
+static int zen_isdictionary(lua_State *L) {
+	if(zen_table_check(L, "isdictionary", "dictionary", "schema"))
+		zen_table_count(L, LUA_TSTRING);
+	return 1;
+}
+
+void zen_add_table(lua_State *L) {
+	static const struct luaL_Reg table_funcs [] =
+		{ {"deepmap", zen_deepmap},
+		  {"deepmap_inplace", zen_deepmap_inplace},
+		  {"deepcopy", zen_deepcopy},
+		  {"isarray", zen_isarray},
+		  {"isdictionary", zen_isdictionary},
+		  {NULL, NULL} };
+	lua_getglobal(L, "_G");
+	luaL_setfuncs(L, table_funcs, 0);
+	lua_pop(L, 1);
+}
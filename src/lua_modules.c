@@ -19,12 +19,15 @@
  */
 
 #include <stdio.h>
+#include <stdlib.h>
 #include <errno.h>
 #include <strings.h>
 #include <lua.h>
 #include <lualib.h>
 #include <lauxlib.h>
+#include <ldo.h>
 #include <lua_functions.h>
+#include <zstd.h>
 
 #include <zenroom.h>
 #include <zen_error.h>
@@ -55,6 +58,9 @@ extern int luaopen_big(lua_State *L);
 extern int luaopen_hash(lua_State *L);
 extern int luaopen_qp(lua_State *L);
 extern int luaopen_ed(lua_State *L);
+extern int luaopen_rlp(lua_State *L);
+extern int luaopen_octet_set(lua_State *L);
+extern int luaopen_lagrange(lua_State *L);
 
 // really loaded in lib/lua53/linit.c
 // align here for reference
@@ -77,11 +83,12 @@ luaL_Reg lualibs[] = {
 int zen_load_string(lua_State *L, const char *code,
                     size_t size, const char *name) {
 	int res;
-#ifdef LUA_COMPILED
-	res = luaL_loadbufferx(L,code,size,name,"b");
-#else
-	res = luaL_loadbufferx(L,code,size,name,NULL);
-#endif
+	// bytecode precompiled by build/embed-lualibs is only accepted
+	// through luaD_embeddedmode, never from scripts
+	if(size && code[0] == LUA_SIGNATURE[0])
+		res = luaL_loadbufferx(L,code,size,name,luaD_embeddedmode);
+	else
+		res = luaL_loadbufferx(L,code,size,name,NULL);
 	switch (res) {
 	case LUA_OK: { // func(L, "%s OK %s",__func__,name);
 			break; }
@@ -96,6 +103,41 @@ int zen_load_string(lua_State *L, const char *code,
 	return(res);
 }
 
+#ifndef __EMSCRIPTEN__
+// extensions embedded with the zstd option are inflated before loading
+static int zen_load_extension(lua_State *L, zen_extension_t *p) {
+	const unsigned char *code = (const unsigned char*)p->code;
+	const size_t size = *p->size;
+	unsigned long long len;
+	size_t res;
+	char *buf;
+	int ret;
+	if(size < 4 || (code[0] | code[1]<<8 | code[2]<<16 | (uint32_t)code[3]<<24)
+	   != ZSTD_MAGICNUMBER)
+		return zen_load_string(L, p->code, size, p->name);
+	len = ZSTD_getFrameContentSize(code, size);
+	if(len == ZSTD_CONTENTSIZE_UNKNOWN || len == ZSTD_CONTENTSIZE_ERROR) {
+		lua_pushfstring(L, "invalid zstd frame in extension %s", p->name);
+		return LUA_ERRSYNTAX;
+	}
+	buf = malloc(len ? len : 1);
+	if(!buf) {
+		lua_pushfstring(L, "cannot allocate %d bytes for %s", (int)len, p->name);
+		return LUA_ERRMEM;
+	}
+	res = ZSTD_decompress(buf, len, code, size);
+	if(ZSTD_isError(res)) {
+		free(buf);
+		lua_pushfstring(L, "cannot decompress extension %s: %s",
+		                p->name, ZSTD_getErrorName(res));
+		return LUA_ERRSYNTAX;
+	}
+	ret = zen_load_string(L, buf, res, p->name);
+	free(buf);
+	return ret;
+}
+#endif
+
 int zen_exec_extension(lua_State *L, zen_extension_t *p) {
 	SAFE(p); // HEREs(p->name);
 #ifdef __EMSCRIPTEN__
@@ -109,8 +151,7 @@ int zen_exec_extension(lua_State *L, zen_extension_t *p) {
 		}
 	}
 #else
-	if(zen_load_string(L, p->code, *p->size, p->name)
-	   ==LUA_OK) {
+	if(zen_load_extension(L, p)==LUA_OK) {
 		// func(L,"%s %s", __func__, p->name);
 		// HEREn(*p->size);
 		// HEREp(p->code);
@@ -181,6 +222,12 @@ int zen_require(lua_State *L) {
 		luaL_requiref(L, s, luaopen_qp, 1); }	
 	else if(strcasecmp(s, "ed")  ==0) {
 		luaL_requiref(L, s, luaopen_ed, 1); }
+	else if(strcasecmp(s, "rlp")  ==0) {
+		luaL_requiref(L, s, luaopen_rlp, 1); }
+	else if(strcasecmp(s, "octet_set")  ==0) {
+		luaL_requiref(L, s, luaopen_octet_set, 1); }
+	else if(strcasecmp(s, "lagrange")  ==0) {
+		luaL_requiref(L, s, luaopen_lagrange, 1); }
 	else {
 		// shall we bail out and abort execution here?
 		warning(L, "required extension not found: %s", s);
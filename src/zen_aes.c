@@ -19,6 +19,8 @@
  */
 
 
+#include <string.h>
+
 #include <lua.h>
 #include <lualib.h>
 #include <lauxlib.h>
@@ -132,9 +134,24 @@ static int gcm_decrypt(lua_State *L) {
 	return 2;
 }
 
+/*
+   AES-CTR encrypts or decrypts a message of any length: the counter
+   block starts from the iv (padded with zeroes to 16 bytes) and is
+   incremented as a big endian number after each block, as in NIST
+   SP800-38A.
+
+   @param key AES key octet (must be 16 or 32 bytes long)
+   @param message input text in an octet
+   @param iv initialization vector of at least 12 bytes
+   @return octet containing the output text, as long as the input
+   @function ctr(key, message, iv)
+*/
 static int ctr_process(lua_State *L) {
 	HERE();
 	amcl_aes a;
+	unsigned char ctr[16];
+	char st[16];
+	int i, j, n;
 	octet *key = o_arg(L, 1); SAFE(key);
 	if(key->len != 16 && key->len != 32) {
 		zerror(L, "AES.ctr_process accepts only keys of 16 or 32 bytes, this is %u", key->len);
@@ -146,9 +163,17 @@ static int ctr_process(lua_State *L) {
 		zerror(L, "AES.ctr_process accepts an iv of 12 bytes minimum, this is %u", iv->len);
 		lerror(L, "AES-CTR process aborted");
 		return 0; }
-	AES_init(&a, CTR16, key->len, key->val, iv->val);
+	memset(ctr, 0, 16);
+	memcpy(ctr, iv->val, iv->len < 16 ? iv->len : 16);
+	AES_init(&a, ECB, key->len, key->val, NULL);
 	octet *out = o_dup(L, in); SAFE(out);
-	AMCL_(AES_encrypt)(&a, out->val);
+	for(i=0; i<out->len; i+=16) {
+		memcpy(st, ctr, 16);
+		AES_ecb_encrypt(&a, (uchar*)st);
+		n = out->len - i < 16 ? out->len - i : 16;
+		for(j=0; j<n; j++) out->val[i+j] ^= st[j];
+		for(j=15; j>=0 && ++ctr[j] == 0; j--);
+	}
 	AES_end(&a);
 	return 1;
 }
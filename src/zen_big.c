@@ -21,6 +21,7 @@
  */
 
 #include <math.h>
+#include <stdint.h>
 
 #include <lua.h>
 #include <lualib.h>
@@ -955,6 +956,241 @@ static int big_shiftr(lua_State *L) {
 }
 
 
+// Operations on arrays of BIG numbers modulo n. The elements are
+// copied, reduced, in a contiguous block of BIGs and the results are
+// returned in a single table. BIG_modmul reduces its product one bit
+// at a time, so when n is odd products are reduced by Montgomery
+// multiplication instead, with constants computed once per call.
+
+typedef struct {
+	BIG n;
+	BIG r2;    // R^2 mod n, with R = 2^(BIGBITS*BIGLEN)
+	chunk mc;  // -1/n mod 2^BIGBITS
+	int monty; // n is odd
+} big_modulus;
+
+// modulus at idx, the order of the curve when missing
+static void big_modulus_arg(lua_State *L, int idx, big_modulus *m) {
+	DBIG d;
+	BIG r;
+	uint64_t x, n0;
+	int i;
+	if(lua_isnoneornil(L, idx))
+		BIG_rcopy(m->n, (chunk*)CURVE_Order);
+	else {
+		big *b = big_arg(L, idx); SAFE(b);
+		if(b->doublesize) lerror(L, "modulus cannot be a double big number");
+		BIG_copy(m->n, b->val);
+	}
+	BIG_norm(m->n);
+	if(BIG_iszilch(m->n)) lerror(L, "modulus cannot be zero");
+	// leaves room in a DBIG to add 2^31 products without reducing them
+	if(BIG_nbits(m->n) > 8*MODBYTES) lerror(L, "modulus is too big");
+	m->monty = BIG_parity(m->n);
+	if(!m->monty) return;
+	n0 = (uint64_t)m->n[0];
+	for(x=n0, i=0; i<5; i++) x *= 2 - n0 * x; // 1/n0 mod 2^64
+	m->mc = (chunk)((0 - x) & (((uint64_t)1 << BIGBITS) - 1));
+	BIG_dzero(d);
+	d[BIGLEN] = 1;
+	BIG_dmod(r, d, m->n);
+	BIG_mul(d, r, r);
+	BIG_dmod(m->r2, d, m->n);
+}
+
+// r = a * b mod n, for a and b smaller than n
+static void big_modulus_mul(big_modulus *m, BIG r, BIG a, BIG b) {
+	DBIG d;
+	if(!m->monty) {
+		BIG_modmul(r, a, b, m->n);
+		return;
+	}
+	BIG_mul(d, a, b);
+	BIG_monty(r, m->n, m->mc, d); // a * b / R, less than 2n
+	BIG_mul(d, r, m->r2);
+	BIG_monty(r, m->n, m->mc, d);
+	if(BIG_comp(r, m->n) >= 0) {
+		BIG_sub(r, r, m->n);
+		BIG_norm(r);
+	}
+}
+
+// copies the elements of the array at idx reduced modulo n in a
+// block of BIGs pushed on the stack, count is set to their number
+static BIG *big_array_arg(lua_State *L, int idx, big_modulus *m, int *count) {
+	BIG *v;
+	big *b;
+	int i, n;
+	luaL_checktype(L, idx, LUA_TTABLE);
+	n = (int)luaL_len(L, idx);
+	v = (BIG*)lua_newuserdata(L, (n ? n : 1) * sizeof(BIG));
+	if(!v) lerror(L, "Error allocating %d BIG numbers in %s", n, __func__);
+	for(i=0; i<n; i++) {
+		lua_rawgeti(L, idx, i+1);
+		b = big_arg(L, -1); SAFE(b);
+		if(b->doublesize) lerror(L, "array element %d is a double big number", i+1);
+		BIG_copy(v[i], b->val);
+		BIG_mod(v[i], m->n);
+		lua_pop(L, 1);
+	}
+	*count = n;
+	return v;
+}
+
+// the second operand at idx: an array as long as the first, or a BIG
+// used for all the elements, then the step between operands is 0
+static BIG *big_operand_arg(lua_State *L, int idx, big_modulus *m, int count, int *step) {
+	BIG *v;
+	big *b;
+	int n;
+	if(lua_istable(L, idx)) {
+		v = big_array_arg(L, idx, m, &n);
+		if(n != count)
+			lerror(L, "arrays of different length: %d and %d", count, n);
+		*step = 1;
+		return v;
+	}
+	b = big_arg(L, idx); SAFE(b);
+	if(b->doublesize) lerror(L, "operand is a double big number");
+	v = (BIG*)lua_newuserdata(L, sizeof(BIG));
+	if(!v) lerror(L, "Error allocating BIG number in %s", __func__);
+	BIG_copy(v[0], b->val);
+	BIG_mod(v[0], m->n);
+	*step = 0;
+	return v;
+}
+
+static void big_array_push(lua_State *L, BIG *v, int count) {
+	big *b;
+	int i;
+	lua_createtable(L, count, 0);
+	for(i=0; i<count; i++) {
+		b = big_new(L); SAFE(b);
+		big_init(b);
+		BIG_copy(b->val, v[i]);
+		lua_rawseti(L, -2, i+1);
+	}
+}
+
+/***
+    Multiply each BIG number of an array by another BIG, or by the
+    element in the same position of another array, modulo n.
+
+    @param array table of BIG numbers
+    @param coefficient BIG number or table of as many BIG numbers
+    @param modulo optional, @{ECP.order} by default
+    @return a table of new BIG numbers
+    @function BIG.modmul_batch(array, coefficient, modulo)
+*/
+static int big_modmul_batch(lua_State *L) {
+	big_modulus m;
+	BIG *a, *b;
+	int i, n, step;
+	big_modulus_arg(L, 3, &m);
+	a = big_array_arg(L, 1, &m, &n);
+	b = big_operand_arg(L, 2, &m, n, &step);
+	for(i=0; i<n; i++) big_modulus_mul(&m, a[i], a[i], b[i*step]);
+	big_array_push(L, a, n);
+	return 1;
+}
+
+/***
+    Add to each BIG number of an array another BIG, or the element in
+    the same position of another array, modulo n.
+
+    @param array table of BIG numbers
+    @param addend BIG number or table of as many BIG numbers
+    @param modulo optional, @{ECP.order} by default
+    @return a table of new BIG numbers
+    @function BIG.modadd_batch(array, addend, modulo)
+*/
+static int big_modadd_batch(lua_State *L) {
+	big_modulus m;
+	BIG *a, *b;
+	int i, n, step;
+	big_modulus_arg(L, 3, &m);
+	a = big_array_arg(L, 1, &m, &n);
+	b = big_operand_arg(L, 2, &m, n, &step);
+	for(i=0; i<n; i++) {
+		BIG_add(a[i], a[i], b[i*step]);
+		BIG_norm(a[i]);
+		if(BIG_comp(a[i], m.n) >= 0) {
+			BIG_sub(a[i], a[i], m.n);
+			BIG_norm(a[i]);
+		}
+	}
+	big_array_push(L, a, n);
+	return 1;
+}
+
+/***
+    Invert all the BIG numbers of an array modulo a prime with a
+    single modular inversion (Montgomery's trick): much faster than
+    inverting each of them. Zero has no inverse and stays zero.
+
+    @param array table of BIG numbers
+    @param modulo optional, @{ECP.order} by default
+    @return a table of new BIG numbers
+    @function BIG.modinv_batch(array, modulo)
+*/
+static int big_modinv_batch(lua_State *L) {
+	big_modulus m;
+	BIG *a, *acc, t, inv;
+	int i, n;
+	big_modulus_arg(L, 2, &m);
+	a = big_array_arg(L, 1, &m, &n);
+	acc = (BIG*)lua_newuserdata(L, (n ? n : 1) * sizeof(BIG));
+	if(!acc) lerror(L, "Error allocating %d BIG numbers in %s", n, __func__);
+	// acc[i] is the product of the elements before i
+	BIG_one(t);
+	for(i=0; i<n; i++) {
+		BIG_copy(acc[i], t);
+		if(!BIG_iszilch(a[i])) big_modulus_mul(&m, t, t, a[i]);
+	}
+	if(BIG_iszilch(t)) lerror(L, "modinv_batch: elements not invertible");
+	BIG_invmodp(inv, t, m.n);
+	for(i=n-1; i>=0; i--) {
+		if(BIG_iszilch(a[i])) continue;
+		big_modulus_mul(&m, t, inv, acc[i]); // 1 / a[i]
+		big_modulus_mul(&m, inv, inv, a[i]);
+		BIG_copy(a[i], t);
+	}
+	big_array_push(L, a, n);
+	return 1;
+}
+
+/***
+    Sum the products of the elements in the same position of two
+    arrays of BIG numbers modulo n, reducing only the sum.
+
+    @param left table of BIG numbers
+    @param right table of as many BIG numbers
+    @param modulo optional, @{ECP.order} by default
+    @return a new BIG number
+    @function BIG.inner_product(left, right, modulo)
+*/
+static int big_inner_product(lua_State *L) {
+	big_modulus m;
+	BIG *a, *b;
+	DBIG sum, d;
+	int i, n, step;
+	big *r;
+	big_modulus_arg(L, 3, &m);
+	a = big_array_arg(L, 1, &m, &n);
+	luaL_checktype(L, 2, LUA_TTABLE);
+	b = big_operand_arg(L, 2, &m, n, &step);
+	BIG_dzero(sum);
+	for(i=0; i<n; i++) {
+		BIG_mul(d, a[i], b[i]);
+		BIG_dadd(sum, sum, d);
+		BIG_dnorm(sum);
+	}
+	r = big_new(L); SAFE(r);
+	big_init(r);
+	BIG_dmod(r->val, sum, m.n);
+	return 1;
+}
+
 int luaopen_big(lua_State *L) {
 	(void)L;
 	const struct luaL_Reg big_class[] = {
@@ -984,6 +1220,10 @@ int luaopen_big(lua_State *L) {
 		{"info", lua_biginfo},
 		{"max", lua_bigmax},
 		{"shr", big_shiftr},
+		{"modmul_batch", big_modmul_batch},
+		{"modadd_batch", big_modadd_batch},
+		{"modinv_batch", big_modinv_batch},
+		{"inner_product", big_inner_product},
 		{NULL, NULL}
 	};
 	const struct luaL_Reg big_methods[] = {
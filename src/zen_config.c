@@ -24,6 +24,8 @@
 // debug=1..3
 // rngseed=hex:[256 bits in hex notation]
 // print=sys|stb|mutt
+// zstd=1..22
+// input=string|octet
 ///////////////////////
 
 #include <strings.h>
@@ -75,6 +77,8 @@ extern void set_debug(int lev);
 
 #include <stb_c_lexer.h>
 
+#include <zstd.h>
+
 int zen_conf_parse(zenroom_t *ZZ, const char *configuration) {
 	(void)stb__strchr;            // avoid compiler warnings
 	(void)stb__clex_parse_string; // for unused functions
@@ -104,6 +108,8 @@ int zen_conf_parse(zenroom_t *ZZ, const char *configuration) {
 			if(strcasecmp(lex.string,"verbose")==0) { curconf = VERBOSE; break; }
 			if(strcasecmp(lex.string,"rngseed")  ==0) { curconf = RNGSEED;   break; } // str
 			if(strcasecmp(lex.string,"print") ==0) { curconf = PRINTF;   break; } // str
+			if(strcasecmp(lex.string,"zstd") ==0) { curconf = ZSTDLEVEL;   break; } // int
+			if(strcasecmp(lex.string,"input") ==0) { curconf = INPUT;   break; } // str
 			if(curconf==RNGSEED) {
 				int len = strlen(lex.string);
 				if( len-4 != RANDOM_SEED_LEN *2) { // hex doubles size
@@ -135,6 +141,16 @@ int zen_conf_parse(zenroom_t *ZZ, const char *configuration) {
 				break;
 			}
 
+			if(curconf==INPUT) {
+				if(strcasecmp(lex.string,"string") == 0) ZZ->zconf_input = STRING;
+				else if(strcasecmp(lex.string,"octet") == 0) ZZ->zconf_input = OCTET;
+				else {
+					zerror(NULL, "Invalid input type: %s", lex.string);
+					return 0;
+				}
+				break;
+			}
+
 			// free(lexbuf);
 			zerror(NULL, "Invalid configuration: %s", lex.string);
 			curconf = NIL;
@@ -142,6 +158,15 @@ int zen_conf_parse(zenroom_t *ZZ, const char *configuration) {
 
 		case CLEX_intlit:
 			if(curconf==VERBOSE) { ZZ->debuglevel = lex.int_number; break; }
+			if(curconf==ZSTDLEVEL) {
+				if(lex.int_number < 1 || lex.int_number > ZSTD_maxCLevel()) {
+					zerror(NULL, "Invalid zstd compression level: %ld (must be 1..%u)",
+					       lex.int_number, ZSTD_maxCLevel());
+					return 0;
+				}
+				ZZ->zstd_level = lex.int_number;
+				break;
+			}
 			// free(lexbuf);
 			zerror(NULL, "Invalid integer configuration");
 			curconf = NIL;
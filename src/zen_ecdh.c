@@ -593,6 +593,9 @@ static int ecdh_dsa_recovery(lua_State *L) {
 }
 
 extern int ecdh_add(lua_State *L);
+extern int ecdh_verify_batch(lua_State *L);
+extern int ecdh_verify_address(lua_State *L);
+extern int ecdh_verify_address_batch(lua_State *L);
 
 int luaopen_ecdh(lua_State *L) {
 	(void)L;
@@ -616,6 +619,9 @@ int luaopen_ecdh(lua_State *L) {
 		{"verify", ecdh_dsa_verify},
 		{"sign_hashed", ecdh_dsa_sign_hashed},
 		{"verify_hashed", ecdh_dsa_verify_hashed},
+		{"verify_batch", ecdh_verify_batch},
+		{"verify_address", ecdh_verify_address},
+		{"verify_address_batch", ecdh_verify_address_batch},
 		{"recovery", ecdh_dsa_recovery},
 		{"public_xy", ecdh_pub_xy},
 		{"pubxy", ecdh_pub_xy},
@@ -0,0 +1,897 @@
+// Generated by build/codegen_ecdh_factory.sh
+// Mon Oct 19 11:07:46 UTC 2026
+#include <stdint.h>
+#include <string.h>
+#include <lauxlib.h>
+#include <zen_ecdh.h>
+#include <zen_error.h>
+#include <ecdh_support.h>
+#include <ecdh_SECP256K1.h>
+#include <ecp_SECP256K1.h>
+
+static char ORDER[MODBYTES_256_28];
+static char PRIME[MODBYTES_256_28];
+
+#define Cof CURVE_Cof_I_SECP256K1;
+
+/*
+   Scalar multiplications using the endomorphism of secp256k1 (GLV):
+   each scalar is split in two halves of 128 bits multiplied at once,
+   one by the point and one by its image, which halves the doublings.
+
+   The vb_ functions work on public data only (verification and
+   recovery) and are not constant time: the four halves of u*G + v*W
+   are recoded in width-w NAF and multiplied at once (Shamir's trick).
+   The odd multiples of the generator are computed once, the ones of
+   a public key once per call, which also decodes each key only once.
+
+   The ct_ functions work on secret scalars (private keys and nonces)
+   in constant time, as ECP_mul in milagro: signed windows of fixed
+   length, complete additions and tables read with conditional moves.
+*/
+#define VB_GWIN 8 // window of the generator
+#define VB_WWIN 5 // window of public keys
+#define VB_GTAB (1<<(VB_GWIN-2))
+#define VB_WTAB (1<<(VB_WWIN-2))
+#define VB_NAFLEN (MODBYTES_256_28*8+1)
+#define CT_GWIN 6 // window of the generator
+#define CT_WWIN 4 // window of other points
+#define CT_GTAB (1<<(CT_GWIN-1))
+#define CT_WTAB (1<<(CT_WWIN-1))
+#define CT_BITS 132 // covers the halves plus 2
+#define CT_DIGITS (CT_BITS/CT_WWIN+2)
+
+// endomorphism (x,y) -> (beta*x, y) of secp256k1, which multiplies
+// points by lambda: k = k1 + k2*lambda with k1 and k2 of 128 bits is
+// found as in libsecp256k1, with g1 = round(2^384*b2/n) and
+// g2 = round(2^384*(-b1)/n) for the basis (a1,b1), (a2,b2) where b2=a1
+static char glv_beta_bytes[] = {
+	0x7a, 0xe9, 0x6a, 0x2b, 0x65, 0x7c, 0x07, 0x10, 0x6e, 0x64, 0x47, 0x9e, 0xac, 0x34, 0x34, 0xe9,
+	0x9c, 0xf0, 0x49, 0x75, 0x12, 0xf5, 0x89, 0x95, 0xc1, 0x39, 0x6c, 0x28, 0x71, 0x95, 0x01, 0xee };
+static char glv_g1_bytes[] = {
+	0x30, 0x86, 0xd2, 0x21, 0xa7, 0xd4, 0x6b, 0xcd, 0xe8, 0x6c, 0x90, 0xe4, 0x92, 0x84, 0xeb, 0x15,
+	0x3d, 0xaa, 0x8a, 0x14, 0x71, 0xe8, 0xca, 0x7f, 0xe8, 0x93, 0x20, 0x9a, 0x45, 0xdb, 0xb0, 0x31 };
+static char glv_g2_bytes[] = {
+	0xe4, 0x43, 0x7e, 0xd6, 0x01, 0x0e, 0x88, 0x28, 0x6f, 0x54, 0x7f, 0xa9, 0x0a, 0xbf, 0xe4, 0xc4,
+	0x22, 0x12, 0x08, 0xac, 0x9d, 0xf5, 0x06, 0xc6, 0x15, 0x71, 0xb4, 0xae, 0x8a, 0xc4, 0x7f, 0x71 };
+static char glv_a1_bytes[] = {
+	0x30, 0x86, 0xd2, 0x21, 0xa7, 0xd4, 0x6b, 0xcd, 0xe8, 0x6c, 0x90, 0xe4, 0x92, 0x84, 0xeb, 0x15 };
+static char glv_mb1_bytes[] = {
+	0xe4, 0x43, 0x7e, 0xd6, 0x01, 0x0e, 0x88, 0x28, 0x6f, 0x54, 0x7f, 0xa9, 0x0a, 0xbf, 0xe4, 0xc3 };
+static char glv_a2_bytes[] = { 0x01,
+	0x14, 0xca, 0x50, 0xf7, 0xa8, 0xe2, 0xf3, 0xf6, 0x57, 0xc1, 0x10, 0x8d, 0x9d, 0x44, 0xcf, 0xd8 };
+
+static BIG_256_28 glv_g1, glv_g2, glv_a1, glv_mb1, glv_a2;
+static FP_SECP256K1 glv_beta;
+
+static ECP_SECP256K1 vb_gtab[2*VB_GTAB];
+static ECP_SECP256K1 ct_gtab[2*CT_GTAB], ct_gdbl[2];
+static int glv_ready = 0;
+
+// r = |a - b|, returns 1 when a < b, in constant time
+static int glv_absdiff(BIG_256_28 r, BIG_256_28 a, BIG_256_28 b) {
+	BIG_256_28 t;
+	int neg;
+	BIG_256_28_sub(r, a, b);
+	BIG_256_28_norm(r);
+	neg = (int)((r[NLEN_256_28-1] >> (CHUNK-1)) & 1);
+	BIG_256_28_sub(t, b, a);
+	BIG_256_28_norm(t);
+	BIG_256_28_cmove(r, t, neg);
+	return neg;
+}
+
+// c = round(k*g / 2^384)
+static void glv_round(BIG_256_28 c, BIG_256_28 k, BIG_256_28 g) {
+	DBIG_256_28 d;
+	int up;
+	BIG_256_28_mul(d, k, g);
+	BIG_256_28_dshr(d, 383);
+	BIG_256_28_sdcopy(c, d);
+	up = BIG_256_28_parity(c);
+	BIG_256_28_fshr(c, 1);
+	BIG_256_28_inc(c, up);
+	BIG_256_28_norm(c);
+}
+
+// splits k in |k1| and |k2|, returns their signs in bits 0 and 1
+static int glv_split(BIG_256_28 k1, BIG_256_28 k2, BIG_256_28 k) {
+	BIG_256_28 c1, c2, t, u;
+	int neg;
+	glv_round(c1, k, glv_g1);
+	glv_round(c2, k, glv_g2);
+	// k2 = c1*(-b1) - c2*b2
+	BIG_256_28_smul(t, c1, glv_mb1);
+	BIG_256_28_smul(u, c2, glv_a1);
+	BIG_256_28_norm(t);
+	BIG_256_28_norm(u);
+	neg = glv_absdiff(k2, t, u) << 1;
+	// k1 = k - c1*a1 - c2*a2
+	BIG_256_28_smul(t, c1, glv_a1);
+	BIG_256_28_smul(u, c2, glv_a2);
+	BIG_256_28_add(t, t, u);
+	BIG_256_28_norm(t);
+	return neg | glv_absdiff(k1, k, t);
+}
+
+// odd multiples P, 3P, 5P ... of a point followed by their images
+// by the endomorphism, which in projective coordinates only scales x
+static void vb_table(ECP_SECP256K1 *t, ECP_SECP256K1 *P, int n) {
+	ECP_SECP256K1 P2;
+	int i;
+	ECP_SECP256K1_copy(&t[0], P);
+	ECP_SECP256K1_copy(&P2, P);
+	ECP_SECP256K1_dbl(&P2);
+	for(i=1; i<n; i++) {
+		ECP_SECP256K1_copy(&t[i], &t[i-1]);
+		ECP_SECP256K1_add(&t[i], &P2);
+	}
+	for(i=0; i<n; i++) {
+		ECP_SECP256K1_copy(&t[n+i], &t[i]);
+		FP_SECP256K1_mul(&(t[n+i].x), &(t[i].x), &glv_beta);
+	}
+}
+
+// width-w non adjacent form of a scalar, returns its length
+static int vb_wnaf(signed char *naf, BIG_256_28 k, int w, int neg) {
+	BIG_256_28 t;
+	int i = 0, d;
+	BIG_256_28_copy(t, k);
+	BIG_256_28_norm(t);
+	while(!BIG_256_28_iszilch(t)) {
+		d = 0;
+		if(BIG_256_28_parity(t)) {
+			d = BIG_256_28_lastbits(t, w);
+			if(d >= 1<<(w-1)) d -= 1<<w;
+			if(d > 0) BIG_256_28_dec(t, d);
+			else BIG_256_28_inc(t, -d);
+			BIG_256_28_norm(t);
+		}
+		naf[i++] = (signed char)(neg ? -d : d);
+		BIG_256_28_fshr(t, 1);
+	}
+	return i;
+}
+
+// adds the multiple of a table selected by a NAF digit, the table is
+// shared so negative digits negate a copy
+static inline void vb_add_digit(ECP_SECP256K1 *R, ECP_SECP256K1 *t, int d) {
+	ECP_SECP256K1 N;
+	if(d > 0) {
+		ECP_SECP256K1_add(R, &t[d>>1]);
+	} else {
+		ECP_SECP256K1_copy(&N, &t[(-d)>>1]);
+		ECP_SECP256K1_neg(&N);
+		ECP_SECP256K1_add(R, &N);
+	}
+}
+
+// R = u*G + v*W where wtab is the table of W made by vb_table
+static void vb_mul2(ECP_SECP256K1 *R, BIG_256_28 u, BIG_256_28 v, ECP_SECP256K1 *wtab) {
+	signed char naf[4][VB_NAFLEN];
+	ECP_SECP256K1 *tab[4] = { vb_gtab, vb_gtab + VB_GTAB, wtab, wtab + VB_WTAB };
+	BIG_256_28 k[4];
+	int len[4], neg, i, j, max = 0;
+	neg = glv_split(k[0], k[1], u) | glv_split(k[2], k[3], v) << 2;
+	for(j=0; j<4; j++) {
+		len[j] = vb_wnaf(naf[j], k[j], j < 2 ? VB_GWIN : VB_WWIN, (neg >> j) & 1);
+		if(len[j] > max) max = len[j];
+	}
+	ECP_SECP256K1_inf(R);
+	for(i=max-1; i>=0; i--) {
+		ECP_SECP256K1_dbl(R);
+		for(j=0; j<4; j++)
+			if(i < len[j] && naf[j][i]) vb_add_digit(R, tab[j], naf[j][i]);
+	}
+}
+
+// x(R) mod n == c, compared in projective coordinates to skip the
+// inversion of affine conversion: x(R) may be c or c+n when below p
+static int vb_check_x(ECP_SECP256K1 *R, BIG_256_28 c) {
+	BIG_256_28 p, n, t;
+	FP_SECP256K1 x;
+	if(ECP_SECP256K1_isinf(R)) return 0;
+	BIG_256_28_copy(t, c);
+	FP_SECP256K1_nres(&x, t);
+	FP_SECP256K1_mul(&x, &x, &(R->z));
+	if(FP_SECP256K1_equals(&x, &(R->x))) return 1;
+	BIG_256_28_rcopy(p, Modulus_SECP256K1);
+	BIG_256_28_rcopy(n, CURVE_Order_SECP256K1);
+	BIG_256_28_add(t, c, n);
+	BIG_256_28_norm(t);
+	if(BIG_256_28_comp(t, p) >= 0) return 0;
+	FP_SECP256K1_nres(&x, t);
+	FP_SECP256K1_mul(&x, &x, &(R->z));
+	return FP_SECP256K1_equals(&x, &(R->x));
+}
+
+// reads at most MODBYTES of an octet keeping the lowest ones, as the
+// milagro ECDSA functions do but without shifting the octet
+static void vb_big(BIG_256_28 b, octet *o) {
+	if(o->len > MODBYTES_256_28)
+		BIG_256_28_fromBytesLen(b, o->val + o->len - MODBYTES_256_28, MODBYTES_256_28);
+	else
+		BIG_256_28_fromBytesLen(b, o->val, o->len);
+}
+
+// conditional move of Q in P when d is 1, in constant time
+static inline void ct_cmove(ECP_SECP256K1 *P, ECP_SECP256K1 *Q, int d) {
+	FP_SECP256K1_cmove(&(P->x), &(Q->x), d);
+	FP_SECP256K1_cmove(&(P->y), &(Q->y), d);
+	FP_SECP256K1_cmove(&(P->z), &(Q->z), d);
+}
+
+// 1 when b == c, without branches
+static inline int ct_teq(sign32 b, sign32 c) {
+	sign32 x = b ^ c;
+	x -= 1;
+	return (int)((x >> 31) & 1);
+}
+
+// P = b*Q from the table of n odd multiples of Q, negated when neg
+// is 1, reading all the table: b is odd
+static void ct_select(ECP_SECP256K1 *P, ECP_SECP256K1 *t, int n, sign32 b, int neg) {
+	ECP_SECP256K1 MP;
+	sign32 m = b >> 31;
+	sign32 babs = (((b ^ m) - m) - 1) / 2;
+	int i;
+	ECP_SECP256K1_copy(P, &t[0]);
+	for(i=1; i<n; i++) ct_cmove(P, &t[i], ct_teq(babs, i));
+	ECP_SECP256K1_copy(&MP, P);
+	ECP_SECP256K1_neg(&MP);
+	ct_cmove(P, &MP, (int)(m & 1) ^ neg);
+}
+
+// table for ct_mul: odd multiples of P and their images, then 2P and
+// its image in d
+static void ct_table(ECP_SECP256K1 *t, ECP_SECP256K1 *d, ECP_SECP256K1 *P, int n) {
+	vb_table(t, P, n);
+	ECP_SECP256K1_copy(&d[0], P);
+	ECP_SECP256K1_dbl(&d[0]);
+	ECP_SECP256K1_copy(&d[1], &d[0]);
+	FP_SECP256K1_mul(&(d[1].x), &(d[0].x), &glv_beta);
+}
+
+static void glv_init(void) {
+	ECP_SECP256K1 G;
+	BIG_256_28 b;
+	if(glv_ready) return;
+	BIG_256_28_fromBytesLen(glv_g1, glv_g1_bytes, sizeof(glv_g1_bytes));
+	BIG_256_28_fromBytesLen(glv_g2, glv_g2_bytes, sizeof(glv_g2_bytes));
+	BIG_256_28_fromBytesLen(glv_a1, glv_a1_bytes, sizeof(glv_a1_bytes));
+	BIG_256_28_fromBytesLen(glv_mb1, glv_mb1_bytes, sizeof(glv_mb1_bytes));
+	BIG_256_28_fromBytesLen(glv_a2, glv_a2_bytes, sizeof(glv_a2_bytes));
+	BIG_256_28_fromBytesLen(b, glv_beta_bytes, sizeof(glv_beta_bytes));
+	FP_SECP256K1_nres(&glv_beta, b);
+	ECP_SECP256K1_generator(&G);
+	vb_table(vb_gtab, &G, VB_GTAB);
+	ct_table(ct_gtab, ct_gdbl, &G, CT_GTAB);
+	glv_ready = 1;
+}
+
+// R = k*P where t and d are the table of P made by ct_table with n
+// odd multiples, n = 2^(w-1). Each half of k is made odd adding 1 or
+// 2 (subtracted at the end as P or 2P) and recoded in a fixed number
+// of odd signed digits of w bits, so that the sequence of operations
+// does not depend on k
+static void ct_mul(ECP_SECP256K1 *R, ECP_SECP256K1 *t, ECP_SECP256K1 *d, int n, int w, BIG_256_28 k) {
+	signed char dg[2][CT_DIGITS];
+	BIG_256_28 h[2], o, mo;
+	ECP_SECP256K1 C[2], Q;
+	int neg, nb = (CT_BITS + w - 1) / w, i, j, b, s;
+	neg = glv_split(h[0], h[1], k);
+	for(j=0; j<2; j++) {
+		s = BIG_256_28_parity(h[j]);
+		BIG_256_28_copy(o, h[j]);
+		BIG_256_28_inc(o, 1);
+		BIG_256_28_norm(o);
+		b = BIG_256_28_parity(o); // 1 when 1 was added
+		BIG_256_28_copy(mo, o);
+		BIG_256_28_inc(mo, 1);
+		BIG_256_28_norm(mo);
+		BIG_256_28_cmove(o, mo, s);
+		for(i=0; i<nb; i++) {
+			dg[j][i] = BIG_256_28_lastbits(o, w+1) - (1<<w);
+			BIG_256_28_dec(o, dg[j][i]);
+			BIG_256_28_norm(o);
+			BIG_256_28_fshr(o, w);
+		}
+		dg[j][nb] = BIG_256_28_lastbits(o, w+1);
+		// the correction, with the sign opposite to the half
+		ECP_SECP256K1_copy(&C[j], &d[j]);
+		ct_cmove(&C[j], &t[j*n], b);
+		ECP_SECP256K1_copy(&Q, &C[j]);
+		ECP_SECP256K1_neg(&Q);
+		ct_cmove(&C[j], &Q, ((neg >> j) & 1) ^ 1);
+	}
+	ct_select(R, t, n, dg[0][nb], neg & 1);
+	ct_select(&Q, t + n, n, dg[1][nb], (neg >> 1) & 1);
+	ECP_SECP256K1_add(R, &Q);
+	for(i=nb-1; i>=0; i--) {
+		for(b=0; b<w; b++) ECP_SECP256K1_dbl(R);
+		ct_select(&Q, t, n, dg[0][i], neg & 1);
+		ECP_SECP256K1_add(R, &Q);
+		ct_select(&Q, t + n, n, dg[1][i], (neg >> 1) & 1);
+		ECP_SECP256K1_add(R, &Q);
+	}
+	ECP_SECP256K1_add(R, &C[0]);
+	ECP_SECP256K1_add(R, &C[1]);
+}
+
+// R = k*G with the tables of the generator
+static inline void ct_mul_gen(ECP_SECP256K1 *R, BIG_256_28 k) {
+	glv_init();
+	ct_mul(R, ct_gtab, ct_gdbl, CT_GTAB, CT_GWIN, k);
+}
+
+// R = k*P
+static void ct_mul_point(ECP_SECP256K1 *R, ECP_SECP256K1 *P, BIG_256_28 k) {
+	ECP_SECP256K1 t[2*CT_WTAB], d[2];
+	glv_init();
+	ct_table(t, d, P, CT_WTAB);
+	ct_mul(R, t, d, CT_WTAB, CT_WWIN, k);
+}
+
+/*
+   The functions of milagro's ecdh_SECP256K1.c rewritten with the above
+   multiplications, same arguments and results, for the ECDH table.
+   Octets of signatures longer than MODBYTES are read as milagro
+   does, but not shifted in place.
+*/
+static int glv_key_pair_generate(csprng *RNG, octet* S, octet *W) {
+	BIG_256_28 r, s;
+	ECP_SECP256K1 P;
+	BIG_256_28_rcopy(r, CURVE_Order_SECP256K1);
+	if(RNG != NULL) {
+		BIG_256_28_randomnum(s, r, RNG);
+	} else {
+		BIG_256_28_fromBytes(s, S->val);
+		BIG_256_28_mod(s, r);
+	}
+	S->len = EGS_SECP256K1;
+	BIG_256_28_toBytes(S->val, s);
+	ct_mul_gen(&P, s);
+	ECP_SECP256K1_toOctet(W, &P, false);
+	return 0;
+}
+
+static int glv_svdp_dh(octet *S, octet *WD, octet *Z) {
+	BIG_256_28 r, s, wx;
+	ECP_SECP256K1 W, P;
+	BIG_256_28_fromBytes(s, S->val);
+	if(!ECP_SECP256K1_fromOctet(&W, WD)) return ECDH_ERROR;
+	BIG_256_28_rcopy(r, CURVE_Order_SECP256K1);
+	BIG_256_28_mod(s, r);
+	ct_mul_point(&P, &W, s);
+	if(ECP_SECP256K1_isinf(&P)) return ECDH_ERROR;
+	ECP_SECP256K1_get(wx, wx, &P);
+	Z->len = MODBYTES_256_28;
+	BIG_256_28_toBytes(Z->val, wx);
+	return 0;
+}
+
+// ECDSA signature (C,D) of the hash H, as ECP_SECP256K1_SP_DSA_NOHASH
+static int glv_sign(csprng *RNG, octet *K, octet *S, octet *H,
+                    octet *C, octet *D, int *y_parity) {
+	BIG_256_28 r, s, f, c, d, u, vx, vy, w;
+	ECP_SECP256K1 V;
+	BIG_256_28_rcopy(r, CURVE_Order_SECP256K1);
+	BIG_256_28_fromBytes(s, S->val);
+	BIG_256_28_fromBytesLen(f, H->val,
+	                       H->len > MODBYTES_256_28 ? MODBYTES_256_28 : H->len);
+	if(RNG != NULL) {
+		do {
+			BIG_256_28_randomnum(u, r, RNG);
+			BIG_256_28_randomnum(w, r, RNG); // side channel masking
+			ct_mul_gen(&V, u);
+			ECP_SECP256K1_get(vx, vy, &V);
+			BIG_256_28_copy(c, vx);
+			BIG_256_28_mod(c, r);
+			if(BIG_256_28_iszilch(c)) continue;
+			BIG_256_28_modmul(u, u, w, r);
+			BIG_256_28_invmodp(u, u, r);
+			BIG_256_28_modmul(d, s, c, r);
+			BIG_256_28_add(d, f, d);
+			BIG_256_28_modmul(d, d, w, r);
+			BIG_256_28_modmul(d, u, d, r);
+		} while(BIG_256_28_iszilch(d));
+	} else {
+		BIG_256_28_fromBytes(u, K->val);
+		BIG_256_28_mod(u, r);
+		ct_mul_gen(&V, u);
+		ECP_SECP256K1_get(vx, vy, &V);
+		BIG_256_28_copy(c, vx);
+		BIG_256_28_mod(c, r);
+		if(BIG_256_28_iszilch(c)) return ECDH_ERROR;
+		BIG_256_28_invmodp(u, u, r);
+		BIG_256_28_modmul(d, s, c, r);
+		BIG_256_28_add(d, f, d);
+		BIG_256_28_modmul(d, u, d, r);
+		if(BIG_256_28_iszilch(d)) return ECDH_ERROR;
+	}
+	if(y_parity) *y_parity = BIG_256_28_parity(vy);
+	C->len = D->len = EGS_SECP256K1;
+	BIG_256_28_toBytes(C->val, c);
+	BIG_256_28_toBytes(D->val, d);
+	return 0;
+}
+
+static int glv_sp_dsa(int sha, csprng *RNG, octet *K, octet *S,
+                      octet *F, octet *C, octet *D) {
+	char h[128];
+	octet H = {0, sizeof(h), h};
+	ehashit(sha, F, -1, NULL, &H, sha);
+	return glv_sign(RNG, K, S, &H, C, D, NULL);
+}
+
+static int glv_sp_dsa_nohash(int sha, csprng *RNG, octet *K, octet *S,
+                             octet *H, octet *C, octet *D, int *y_parity) {
+	(void)sha;
+	return glv_sign(RNG, K, S, H, C, D, y_parity);
+}
+
+// ECDSA verification of (C,D) on the hash H, as ECP_SECP256K1_VP_DSA_NOHASH
+static int glv_verify(octet *W, octet *H, octet *C, octet *D) {
+	BIG_256_28 r, f, c, d;
+	ECP_SECP256K1 P, R, t[2*VB_WTAB];
+	BIG_256_28_rcopy(r, CURVE_Order_SECP256K1);
+	vb_big(c, C);
+	vb_big(d, D);
+	BIG_256_28_fromBytesLen(f, H->val,
+	                       H->len > MODBYTES_256_28 ? MODBYTES_256_28 : H->len);
+	if(BIG_256_28_iszilch(c) || BIG_256_28_comp(c, r) >= 0
+	   || BIG_256_28_iszilch(d) || BIG_256_28_comp(d, r) >= 0)
+		return ECDH_INVALID;
+	BIG_256_28_invmodp(d, d, r);
+	BIG_256_28_modmul(f, f, d, r);
+	BIG_256_28_modmul(d, c, d, r);
+	if(!ECP_SECP256K1_fromOctet(&P, W)) return ECDH_ERROR;
+	glv_init();
+	vb_table(t, &P, VB_WTAB);
+	vb_mul2(&R, f, d, t);
+	return vb_check_x(&R, c) ? 0 : ECDH_INVALID;
+}
+
+static int glv_vp_dsa(int sha, octet *W, octet *F, octet *C, octet *D) {
+	char h[128];
+	octet H = {0, sizeof(h), h};
+	ehashit(sha, F, -1, NULL, &H, sha);
+	return glv_verify(W, &H, C, D);
+}
+
+static int glv_vp_dsa_nohash(int sha, octet *W, octet *H, octet *C, octet *D) {
+	(void)sha;
+	return glv_verify(W, H, C, D);
+}
+
+// Q = (d*R - h*G) / c, the public key of the signature (c,d) on h
+// made with the ephemeral key R of abscissa x, in a single
+// multiplication: returns 0 when x is not on the curve. h, c and d
+// are overwritten
+static int glv_recover(ECP_SECP256K1 *Q, BIG_256_28 x, int y_parity,
+                       BIG_256_28 h, BIG_256_28 c, BIG_256_28 d) {
+	BIG_256_28 r;
+	ECP_SECP256K1 P, t[2*VB_WTAB];
+	if(!ECP_SECP256K1_setx(&P, x, y_parity)) return 0;
+	BIG_256_28_rcopy(r, CURVE_Order_SECP256K1);
+	BIG_256_28_invmodp(c, c, r);
+	BIG_256_28_modmul(h, h, c, r);
+	BIG_256_28_modneg(h, h, r);
+	BIG_256_28_norm(h);
+	BIG_256_28_mod(h, r);
+	BIG_256_28_modmul(d, d, c, r);
+	glv_init();
+	vb_table(t, &P, VB_WTAB);
+	vb_mul2(Q, h, d, t);
+	return 1;
+}
+
+static int glv_public_key_recovery(octet *X, int y_parity, octet *H,
+                                   octet *C, octet *D, octet *PK) {
+	BIG_256_28 x, c, d, h;
+	ECP_SECP256K1 R;
+	vb_big(x, X);
+	vb_big(c, C);
+	vb_big(d, D);
+	BIG_256_28_fromBytesLen(h, H->val,
+	                       H->len > MODBYTES_256_28 ? MODBYTES_256_28 : H->len);
+	if(!glv_recover(&R, x, y_parity, h, c, d)) return -1;
+	ECP_SECP256K1_toOctet(PK, &R, false);
+	return ECP_SECP256K1_PUBLIC_KEY_VALIDATE(PK);
+}
+
+void ecdh_init(ecdh *ECDH) {
+	ECDH->fieldsize = EFS_SECP256K1;
+	ECDH->hash = HASH_TYPE_SECP256K1;
+	ECDH->ECP__KEY_PAIR_GENERATE = glv_key_pair_generate;
+	ECDH->ECP__PUBLIC_KEY_VALIDATE	= ECP_SECP256K1_PUBLIC_KEY_VALIDATE;
+	ECDH->ECP__SVDP_DH = glv_svdp_dh;
+	ECDH->ECP__ECIES_ENCRYPT = ECP_SECP256K1_ECIES_ENCRYPT;
+	ECDH->ECP__ECIES_DECRYPT = ECP_SECP256K1_ECIES_DECRYPT;
+	ECDH->ECP__SP_DSA = glv_sp_dsa;
+	ECDH->ECP__VP_DSA = glv_vp_dsa;
+	ECDH->ECP__SP_DSA_NOHASH = glv_sp_dsa_nohash;
+	ECDH->ECP__VP_DSA_NOHASH = glv_vp_dsa_nohash;
+	ECDH->ECP__PUBLIC_KEY_RECOVERY = glv_public_key_recovery;
+        BIG_256_28 tmp; // toBytes takes a non const BIG
+        BIG_256_28_rcopy(tmp, CURVE_Order_SECP256K1);
+        BIG_256_28_toBytes(ORDER, tmp);
+        ECDH->order = ORDER;
+	ECDH->cofactor = Cof;
+        BIG_256_28_rcopy(tmp, Modulus_SECP256K1);
+        BIG_256_28_toBytes(PRIME, tmp);
+        ECDH->prime = PRIME;
+        ECDH->mod_size = MODBYTES_256_28;
+	act(NULL,"ECDH curve is SECP256K1");
+}
+
+/*
+   Takes two points on the curve ECDH (in the form of a public key),
+   add them and return the point (as a public key not compressed)
+
+   @param pk1 addendum point
+   @param pk2 addendum point
+   @return sum result
+*/
+extern ecdh ECDH;
+
+int ecdh_add(lua_State *L) {
+	octet *pk1 = o_arg(L, 1); SAFE(pk1);
+	if((*ECDH.ECP__PUBLIC_KEY_VALIDATE)(pk1)!=0) {
+		return lerror(L, "Invalid public key passed as argument");
+	}
+	octet *pk2 = o_arg(L, 2); SAFE(pk2);
+	if((*ECDH.ECP__PUBLIC_KEY_VALIDATE)(pk2)!=0) {
+		return lerror(L, "Invalid public key passed as argument");
+	}
+	ECP_SECP256K1 p1, p2;
+	// Export public key to octet.  This is like o_dup but skips
+	// first byte since that is used internally by Milagro as a
+	// prefix for Montgomery (2) or non-Montgomery curves (4)
+	octet *pk_sum = o_new(L, pk1->len); SAFE(pk_sum);
+	ECP_SECP256K1_fromOctet(&p1,pk1);
+	ECP_SECP256K1_fromOctet(&p2,pk2);
+	ECP_SECP256K1_add(&p1, &p2);
+	ECP_SECP256K1_toOctet(pk_sum, &p1, false);
+
+	return 1;
+}
+
+// returns the table of a public key decoded once per batch and kept
+// in the table at index cache, NULL if the key is not valid
+static ECP_SECP256K1 *vb_key(lua_State *L, int cache, octet *pk) {
+	ECP_SECP256K1 W, *t;
+	lua_pushlstring(L, pk->val, pk->len);
+	if(lua_rawget(L, cache) != LUA_TNIL)
+		return (ECP_SECP256K1*)lua_touserdata(L, -1);
+	lua_pop(L, 1);
+	lua_pushlstring(L, pk->val, pk->len);
+	if(ECP_SECP256K1_fromOctet(&W, pk)) {
+		t = lua_newuserdata(L, sizeof(ECP_SECP256K1) * 2 * VB_WTAB);
+		vb_table(t, &W, VB_WTAB);
+	} else {
+		t = NULL;
+		lua_pushboolean(L, 0);
+	}
+	lua_pushvalue(L, -1);
+	lua_insert(L, -3);
+	lua_rawset(L, cache);
+	return t;
+}
+
+/*
+   Verifies an array of ECDSA signatures, the same as calling
+   ECDH.verify (or verify_hashed when the length of hashes is given)
+   on each of them.
+
+   @param pk public key, or array of public keys one for each message
+   @param messages array of messages (or hashes)
+   @param signatures array of signatures, tables of r and s
+   @param len size of hashes: messages are not hashed when given
+   @return true when all signatures are valid, else false and the
+   array of the positions of the ones that are not
+*/
+int ecdh_verify_batch(lua_State *L) {
+	char h[128];
+	octet H = {0, sizeof(h), h};
+	BIG_256_28 n, c, d, f, u;
+	ECP_SECP256K1 R, *wtab;
+	octet *pk, *m, *r, *s;
+	int i, num, top, hashlen = 0, failed = 0, valid;
+	luaL_checktype(L, 2, LUA_TTABLE);
+	luaL_checktype(L, 3, LUA_TTABLE);
+	num = lua_rawlen(L, 2);
+	if((int)lua_rawlen(L, 3) != num)
+		return lerror(L, "verify batch: %u messages and %u signatures",
+		              num, (int)lua_rawlen(L, 3));
+	if(lua_type(L, 1) == LUA_TTABLE && (int)lua_rawlen(L, 1) != num)
+		return lerror(L, "verify batch: %u messages and %u public keys",
+		              num, (int)lua_rawlen(L, 1));
+	if(!lua_isnoneornil(L, 4)) {
+		hashlen = luaL_checkinteger(L, 4);
+		if(hashlen <= 0) return lerror(L, "invalid size zero for material to sign");
+	}
+	lua_settop(L, 4);
+	lua_newtable(L); // 5: cache of public keys
+	lua_newtable(L); // 6: positions of failed signatures
+	glv_init();
+	BIG_256_28_rcopy(n, CURVE_Order_SECP256K1);
+	for(i=1; i<=num; i++) {
+		top = lua_gettop(L);
+		if(lua_type(L, 1) == LUA_TTABLE) {
+			lua_rawgeti(L, 1, i);
+			pk = o_arg(L, -1); SAFE(pk);
+		} else {
+			pk = o_arg(L, 1); SAFE(pk);
+		}
+		lua_rawgeti(L, 2, i);
+		m = o_arg(L, -1); SAFE(m);
+		if(lua_rawgeti(L, 3, i) != LUA_TTABLE)
+			return lerror(L, "verify batch: signature %u is not a table", i);
+		lua_getfield(L, -1, "r");
+		r = o_arg(L, -1); SAFE(r);
+		lua_getfield(L, -2, "s");
+		s = o_arg(L, -1); SAFE(s);
+		if(hashlen) {
+			if(m->len != hashlen)
+				return lerror(L, "verify batch: size of hash %u does not match: %u != %u",
+				              i, m->len, hashlen);
+			vb_big(f, m);
+		} else {
+			// same hash as ECDH.verify
+			H.len = 0;
+			ehashit(64, m, -1, NULL, &H, 64);
+			BIG_256_28_fromBytesLen(f, H.val,
+			                       H.len > MODBYTES_256_28 ? MODBYTES_256_28 : H.len);
+		}
+		vb_big(c, r);
+		vb_big(d, s);
+		valid = !(BIG_256_28_iszilch(c) || BIG_256_28_comp(c, n) >= 0
+		          || BIG_256_28_iszilch(d) || BIG_256_28_comp(d, n) >= 0);
+		if(valid) {
+			wtab = vb_key(L, 5, pk);
+			valid = wtab != NULL;
+		}
+		if(valid) {
+			BIG_256_28_invmodp(d, d, n);
+			BIG_256_28_modmul(u, f, d, n);
+			BIG_256_28_modmul(d, c, d, n);
+			vb_mul2(&R, u, d, wtab);
+			valid = vb_check_x(&R, c);
+		}
+		lua_settop(L, top);
+		if(!valid) {
+			lua_pushinteger(L, i);
+			lua_rawseti(L, 6, ++failed);
+		}
+	}
+	lua_pushboolean(L, failed == 0);
+	lua_insert(L, 6);
+	return 2;
+}
+
+/*
+   Ethereum sender verification: the public key is recovered from the
+   signature and the last 20 bytes of the keccak256 of its x|y are
+   compared to the address, without passing keys to Lua. The abscissa
+   of the ephemeral key is r, or r+n when it is below p.
+*/
+// From pqclean/fips202x4.c
+extern int keccak256x4(uint8_t *out[4], const uint8_t *in[4], const size_t inlen[4]);
+
+#define ADDRESS_LEN 20
+#define XY_LEN (2*MODBYTES_256_28)
+
+// reads the signature and its hash, 0 if r or s are not in [1,n-1]
+static int va_sig(BIG_256_28 h, BIG_256_28 c, BIG_256_28 d, octet *H, octet *R, octet *S) {
+	BIG_256_28 n;
+	BIG_256_28_rcopy(n, CURVE_Order_SECP256K1);
+	vb_big(c, R);
+	vb_big(d, S);
+	BIG_256_28_fromBytesLen(h, H->val,
+	                       H->len > MODBYTES_256_28 ? MODBYTES_256_28 : H->len);
+	return !(BIG_256_28_iszilch(c) || BIG_256_28_comp(c, n) >= 0
+	         || BIG_256_28_iszilch(d) || BIG_256_28_comp(d, n) >= 0);
+}
+
+// x|y of an affine point
+static void va_xy(char *xy, ECP_SECP256K1 *Q) {
+	BIG_256_28 x, y;
+	FP_SECP256K1_redc(x, &(Q->x));
+	FP_SECP256K1_redc(y, &(Q->y));
+	BIG_256_28_toBytes(xy, x);
+	BIG_256_28_toBytes(xy + MODBYTES_256_28, y);
+}
+
+static int va_match(char *hash, octet *add) {
+	return add->len == ADDRESS_LEN
+		&& memcmp(hash + 32 - ADDRESS_LEN, add->val, ADDRESS_LEN) == 0;
+}
+
+static int va_keccak_match(char *xy, octet *add) {
+	sha3 sh;
+	char hash[32];
+	int i;
+	SHA3_init(&sh, 32);
+	for(i=0; i<XY_LEN; i++) SHA3_process(&sh, xy[i]);
+	KECCAK_hash(&sh, hash);
+	return va_match(hash, add);
+}
+
+// tries the abscissas of the ephemeral key from the first one (0 is r)
+static int va_verify(octet *add, octet *H, octet *R, octet *S, int y_parity, int first) {
+	BIG_256_28 h, c, d, x, p, n;
+	ECP_SECP256K1 Q;
+	char xy[XY_LEN];
+	int j;
+	if(!va_sig(h, c, d, H, R, S)) return 0;
+	BIG_256_28_rcopy(p, Modulus_SECP256K1);
+	BIG_256_28_rcopy(n, CURVE_Order_SECP256K1);
+	BIG_256_28_copy(x, c);
+	for(j=0; j<2; j++) {
+		if(j < first) continue;
+		if(j) {
+			BIG_256_28_add(x, x, n);
+			BIG_256_28_norm(x);
+			if(BIG_256_28_comp(x, p) >= 0) break;
+			va_sig(h, c, d, H, R, S);
+		}
+		if(!glv_recover(&Q, x, y_parity, h, c, d)) continue;
+		if(ECP_SECP256K1_isinf(&Q)) continue;
+		ECP_SECP256K1_affine(&Q);
+		va_xy(xy, &Q);
+		if(va_keccak_match(xy, add)) return 1;
+	}
+	return 0;
+}
+
+static int va_parity(lua_State *L, int idx) {
+	if(lua_isboolean(L, idx)) return lua_toboolean(L, idx);
+	return (int)luaL_checkinteger(L, idx);
+}
+
+/*
+   Verifies that an ECDSA signature on a hash was made by the owner of
+   an Ethereum address.
+
+   @param address 20 bytes
+   @param hash the hash that was signed
+   @param sig table of r and s
+   @param y_parity parity of the y of the ephemeral key
+   @return true or false
+*/
+int ecdh_verify_address(lua_State *L) {
+	octet *add, *h, *r, *s;
+	int y_parity;
+	add = o_arg(L, 1); SAFE(add);
+	h = o_arg(L, 2); SAFE(h);
+	luaL_checktype(L, 3, LUA_TTABLE);
+	y_parity = va_parity(L, 4);
+	lua_getfield(L, 3, "r");
+	r = o_arg(L, -1); SAFE(r);
+	lua_getfield(L, 3, "s");
+	s = o_arg(L, -1); SAFE(s);
+	lua_pushboolean(L, va_verify(add, h, r, s, y_parity, 0));
+	return 1;
+}
+
+/*
+   Verifies an array of signatures as ecdh_verify_address. The keys
+   are recovered one by one, then converted to affine coordinates with
+   a single inversion and hashed four at a time.
+
+   @param addresses an address, or an array with one for each hash
+   @param hashes array of hashes
+   @param sigs array of signatures, tables of r and s
+   @param parities array of parities of the ephemeral keys
+   @return true when all signatures are valid, else false and the
+   array of the positions of the ones that are not
+*/
+int ecdh_verify_address_batch(lua_State *L) {
+	BIG_256_28 h, c, d, x;
+	FP_SECP256K1 acc, inv, t, *pre;
+	ECP_SECP256K1 *Q;
+	char *xy, *ok;
+	octet *add, *m, *r, *s;
+	int i, j, k, num, top, y_parity, failed = 0;
+	luaL_checktype(L, 2, LUA_TTABLE);
+	luaL_checktype(L, 3, LUA_TTABLE);
+	luaL_checktype(L, 4, LUA_TTABLE);
+	num = lua_rawlen(L, 2);
+	if((int)lua_rawlen(L, 3) != num || (int)lua_rawlen(L, 4) != num)
+		return lerror(L, "verify address batch: %u hashes, %u signatures and %u parities",
+		              num, (int)lua_rawlen(L, 3), (int)lua_rawlen(L, 4));
+	if(lua_type(L, 1) == LUA_TTABLE && (int)lua_rawlen(L, 1) != num)
+		return lerror(L, "verify address batch: %u hashes and %u addresses",
+		              num, (int)lua_rawlen(L, 1));
+	lua_settop(L, 4);
+	Q = lua_newuserdata(L, (sizeof(ECP_SECP256K1) + sizeof(FP_SECP256K1) + XY_LEN + 1) * (num ? num : 1));
+	pre = (FP_SECP256K1*)(Q + num);
+	xy = (char*)(pre + num);
+	ok = xy + XY_LEN * num;
+	lua_newtable(L); // 6: positions of failed signatures
+	FP_SECP256K1_one(&acc);
+	// recover the keys, keeping the products of z
+	for(i=0; i<num; i++) {
+		top = lua_gettop(L);
+		lua_rawgeti(L, 2, i+1);
+		m = o_arg(L, -1); SAFE(m);
+		if(lua_rawgeti(L, 3, i+1) != LUA_TTABLE)
+			return lerror(L, "verify address batch: signature %u is not a table", i+1);
+		lua_getfield(L, -1, "r");
+		r = o_arg(L, -1); SAFE(r);
+		lua_getfield(L, -2, "s");
+		s = o_arg(L, -1); SAFE(s);
+		lua_rawgeti(L, 4, i+1);
+		y_parity = va_parity(L, -1);
+		ok[i] = va_sig(h, c, d, m, r, s);
+		BIG_256_28_copy(x, c);
+		ok[i] = ok[i] && glv_recover(&Q[i], x, y_parity, h, c, d)
+			&& !ECP_SECP256K1_isinf(&Q[i]);
+		if(ok[i]) {
+			FP_SECP256K1_copy(&pre[i], &acc);
+			FP_SECP256K1_mul(&acc, &acc, &(Q[i].z));
+		}
+		lua_settop(L, top);
+	}
+	// affine coordinates
+	FP_SECP256K1_inv(&inv, &acc);
+	for(i=num-1; i>=0; i--) {
+		if(!ok[i]) continue;
+		FP_SECP256K1_mul(&t, &inv, &pre[i]);
+		FP_SECP256K1_mul(&inv, &inv, &(Q[i].z));
+		FP_SECP256K1_mul(&(Q[i].x), &(Q[i].x), &t);
+		FP_SECP256K1_mul(&(Q[i].y), &(Q[i].y), &t);
+		FP_SECP256K1_reduce(&(Q[i].x));
+		FP_SECP256K1_reduce(&(Q[i].y));
+		va_xy(xy + XY_LEN * i, &Q[i]);
+	}
+	// hashes and addresses
+	for(i=0; i<num; ) {
+		uint8_t hash[4][32], *out[4];
+		const uint8_t *in[4];
+		size_t inlen[4];
+		int idx[4];
+		for(k=0; k<4 && i<num; i++)
+			if(ok[i]) idx[k++] = i;
+		for(j=0; j<k; j++) {
+			in[j] = (const uint8_t*)xy + XY_LEN * idx[j];
+			inlen[j] = XY_LEN;
+			out[j] = hash[j];
+		}
+		if(k == 4) keccak256x4(out, in, inlen);
+		for(j=0; j<k; j++) {
+			top = lua_gettop(L);
+			if(lua_type(L, 1) == LUA_TTABLE) lua_rawgeti(L, 1, idx[j]+1);
+			else lua_pushvalue(L, 1);
+			add = o_arg(L, -1); SAFE(add);
+			if(k == 4) ok[idx[j]] = va_match((char*)hash[j], add);
+			else ok[idx[j]] = va_keccak_match(xy + XY_LEN * idx[j], add);
+			lua_settop(L, top);
+		}
+	}
+	// failures, tried again with the other abscissa, if any
+	for(i=0; i<num; i++) {
+		if(ok[i]) continue;
+		top = lua_gettop(L);
+		if(lua_type(L, 1) == LUA_TTABLE) lua_rawgeti(L, 1, i+1);
+		else lua_pushvalue(L, 1);
+		add = o_arg(L, -1); SAFE(add);
+		lua_rawgeti(L, 2, i+1);
+		m = o_arg(L, -1); SAFE(m);
+		lua_rawgeti(L, 3, i+1);
+		lua_getfield(L, -1, "r");
+		r = o_arg(L, -1); SAFE(r);
+		lua_getfield(L, -2, "s");
+		s = o_arg(L, -1); SAFE(s);
+		lua_rawgeti(L, 4, i+1);
+		if(!va_verify(add, m, r, s, va_parity(L, -1), 1)) {
+			lua_pushinteger(L, i+1);
+			lua_rawseti(L, 6, ++failed);
+		}
+		lua_settop(L, top);
+	}
+	lua_pushboolean(L, failed == 0);
+	lua_insert(L, 6);
+	return 2;
+}
@@ -43,6 +43,10 @@
 //  @copyright Dyne.org foundation 2017-2019
 
 
+#include <math.h>
+#include <stdint.h>
+#include <string.h>
+
 #include <lua.h>
 #include <lualib.h>
 #include <lauxlib.h>
@@ -435,6 +439,273 @@ static int ecp_output(lua_State *L) {
 	return 1;
 }
 
+// Discrete logarithm by baby-step giant-step, used to count the
+// results of homomorphic sums (ElGamal tallies and petitions). The
+// baby steps j*B for j in [1,m] are kept in an open addressing table
+// keyed by 64 bits of their affine x, which is also the x of
+// -j*B: each giant step of -2m*B then covers 2m values. The tables
+// of the last few base points used are cached in the registry, most
+// recent first, and reused by any later call that needs at most as
+// many baby steps.
+
+#define DLOG_BATCH 128 // points made affine with a single inversion
+#define DLOG_MIN_STEPS 16
+#define DLOG_MAX_STEPS (1<<16) // table of 2 MiB, beyond it giant steps grow
+#define DLOG_MAX_VALUE ((int64_t)1<<40) // about 2^23 giant steps
+#define DLOG_CACHE "zenroom.ecp.dlog"
+#define DLOG_CACHE_SIZE 4
+
+typedef struct {
+	uint64_t key;
+	uint32_t idx; // j, 0 when the slot is free
+} dlog_slot;
+
+typedef struct {
+	int64_t m;
+	uint32_t mask;
+	ECP stride; // -2m*B
+	int baselen;
+	char base[MODBYTES*2 + 0x10]; // B as octet, key of the cache
+	dlog_slot slot[];
+} dlog_table;
+
+typedef struct {
+	ECP P[DLOG_BATCH];
+	FP acc[DLOG_BATCH];
+	uint64_t key[DLOG_BATCH];
+} dlog_batch;
+
+// fills key[] with 64 bits taken from the lowest limbs of the affine
+// x of P[0..n), using a single field inversion (Montgomery's trick);
+// 0 for the infinity
+static void dlog_keys(dlog_batch *b, int n) {
+	FP inv, t;
+	BIG x;
+	int i;
+	FP_one(&t);
+	for(i=0; i<n; i++) {
+		if(!FP_iszilch(&b->P[i].z)) FP_mul(&t, &t, &b->P[i].z);
+		FP_copy(&b->acc[i], &t);
+	}
+	FP_inv(&inv, &t);
+	for(i=n-1; i>=0; i--) {
+		b->key[i] = 0;
+		if(FP_iszilch(&b->P[i].z)) continue;
+		// inv is 1/acc[i], then 1/z[i] is inv*acc[i-1]
+		if(i>0) FP_mul(&t, &inv, &b->acc[i-1]);
+		else FP_copy(&t, &inv);
+		FP_mul(&inv, &inv, &b->P[i].z);
+		FP_mul(&t, &t, &b->P[i].x);
+		FP_redc(x, &t);
+		b->key[i] = ((uint64_t)x[2] << 42) ^ ((uint64_t)x[1] << 21) ^ (uint64_t)x[0];
+	}
+}
+
+static uint32_t dlog_find(dlog_table *t, uint64_t key) {
+	uint32_t h = (uint32_t)key & t->mask;
+	while(t->slot[h].idx) {
+		if(t->slot[h].key == key) return t->slot[h].idx;
+		h = (h+1) & t->mask;
+	}
+	return 0;
+}
+
+static void dlog_insert(dlog_table *t, uint64_t key, uint32_t idx) {
+	uint32_t h = (uint32_t)key & t->mask;
+	while(t->slot[h].idx) {
+		if(t->slot[h].key == key) return;
+		h = (h+1) & t->mask;
+	}
+	t->slot[h].key = key;
+	t->slot[h].idx = idx;
+}
+
+static void dlog_big(BIG b, int64_t n) {
+	char bytes[8];
+	int i;
+	for(i=7; i>=0; i--) { bytes[i] = n & 0xff; n >>= 8; }
+	BIG_fromBytesLen(b, bytes, 8);
+}
+
+// pushes a new table of m baby steps of B
+static dlog_table *dlog_table_new(lua_State *L, ECP *B, int64_t m, dlog_batch *b) {
+	dlog_table *t;
+	ECP R;
+	BIG k;
+	uint32_t cap = 1;
+	int64_t j;
+	int n, i;
+	while((int64_t)cap < 2*m) cap <<= 1;
+	t = (dlog_table*)lua_newuserdata(L, sizeof(dlog_table) + cap*sizeof(dlog_slot));
+	if(!t) {
+		lerror(L, "Error allocating discrete log table in %s", __func__);
+		return NULL; }
+	memset(t->slot, 0, cap*sizeof(dlog_slot));
+	t->m = m;
+	t->mask = cap - 1;
+	ECP_copy(&R, B);
+	for(j=1; j<=m; j+=n) {
+		n = m+1-j < DLOG_BATCH ? (int)(m+1-j) : DLOG_BATCH;
+		for(i=0; i<n; i++) {
+			ECP_copy(&b->P[i], &R);
+			ECP_add(&R, B);
+		}
+		dlog_keys(b, n);
+		for(i=0; i<n; i++) dlog_insert(t, b->key[i], (uint32_t)(j+i));
+	}
+	ECP_copy(&t->stride, B);
+	dlog_big(k, 2*m);
+	PAIR_G1mul(&t->stride, k);
+	ECP_neg(&t->stride);
+	return t;
+}
+
+// returns the cached table of the base with at least m steps, pushed
+// and moved first in the cache, else NULL leaving the stack unchanged
+static dlog_table *dlog_cache_get(lua_State *L, octet *base, int64_t m) {
+	dlog_table *t;
+	int i, n;
+	if(lua_getfield(L, LUA_REGISTRYINDEX, DLOG_CACHE) != LUA_TTABLE) {
+		lua_pop(L, 1);
+		lua_newtable(L);
+		lua_pushvalue(L, -1);
+		lua_setfield(L, LUA_REGISTRYINDEX, DLOG_CACHE);
+	}
+	n = lua_rawlen(L, -1);
+	for(i=1; i<=n; i++) {
+		lua_rawgeti(L, -1, i);
+		t = (dlog_table*)lua_touserdata(L, -1);
+		if(t->baselen == base->len && memcmp(t->base, base->val, base->len) == 0) {
+			if(t->m < m) {
+				lua_pop(L, 2);
+				return NULL; }
+			for(; i>1; i--) {
+				lua_rawgeti(L, -2, i-1);
+				lua_rawseti(L, -3, i);
+			}
+			lua_pushvalue(L, -1);
+			lua_rawseti(L, -3, 1);
+			lua_remove(L, -2);
+			return t;
+		}
+		lua_pop(L, 1);
+	}
+	lua_pop(L, 1);
+	return NULL;
+}
+
+// makes the table at the top of the stack the first of the cache,
+// replacing the older one of the same base or the least recent
+static void dlog_cache_put(lua_State *L, dlog_table *t) {
+	dlog_table *c;
+	int i, n;
+	lua_getfield(L, LUA_REGISTRYINDEX, DLOG_CACHE);
+	n = lua_rawlen(L, -1);
+	for(i=1; i<=n; i++) {
+		lua_rawgeti(L, -1, i);
+		c = (dlog_table*)lua_touserdata(L, -1);
+		lua_pop(L, 1);
+		if(c->baselen == t->baselen && memcmp(c->base, t->base, t->baselen) == 0)
+			break;
+	}
+	if(i > DLOG_CACHE_SIZE) i = DLOG_CACHE_SIZE;
+	for(; i>1; i--) {
+		lua_rawgeti(L, -1, i-1);
+		lua_rawseti(L, -2, i);
+	}
+	lua_pushvalue(L, -2);
+	lua_rawseti(L, -2, 1);
+	lua_pop(L, 1);
+}
+
+// true if n is in [0,max] and n*B is Q
+static int dlog_check(ECP *Q, ECP *B, int64_t n, int64_t max) {
+	ECP R;
+	BIG k;
+	if(n < 0 || n > max) return 0;
+	ECP_copy(&R, B);
+	dlog_big(k, n);
+	PAIR_G1mul(&R, k);
+	return ECP_equals(&R, Q);
+}
+
+/***
+    Finds the discrete logarithm of a point to a base: the number n
+    between 0 and max such that base * n is the point. It takes about
+    2*sqrt(max) point additions; the table of the baby steps is kept
+    and reused by later calls on the same base, for the last 4 bases.
+
+    @function dlog(point, base, max)
+    @param point result of the multiplication of the base
+    @param base ecp point that was multiplied
+    @param max highest value searched, 1000 by default and at most 2^40
+    @return integer n or nil if not found
+*/
+static int ecp_dlog(lua_State *L) {
+	ecp *q = ecp_arg(L, 1); SAFE(q);
+	ecp *e = ecp_arg(L, 2); SAFE(e);
+	int64_t max = luaL_optinteger(L, 3, 1000);
+	int64_t m, imax, i, j, c;
+	char buf[MODBYTES*2 + 0x10];
+	octet o = { 0, sizeof(buf), buf };
+	dlog_table *t = NULL;
+	dlog_batch *b;
+	ECP R;
+	int n, k;
+	luaL_argcheck(L, max >= 0 && max <= DLOG_MAX_VALUE, 3, "maximum out of range");
+	if(ECP_isinf(&e->val)) {
+		lerror(L, "%s: the base is the point at infinity", __func__);
+		return 0; }
+	if(ECP_isinf(&q->val)) {
+		lua_pushinteger(L, 0);
+		return 1; }
+	m = (int64_t)sqrt(((double)max + 1) / 2) + 1;
+	if(m < DLOG_MIN_STEPS) m = DLOG_MIN_STEPS;
+	if(m > DLOG_MAX_STEPS) m = DLOG_MAX_STEPS;
+	b = (dlog_batch*)lua_newuserdata(L, sizeof(dlog_batch));
+	if(!b) {
+		lerror(L, "Error allocating discrete log batch in %s", __func__);
+		return 0; }
+	// look for a table of the base in the cache, with enough steps
+	_ecp_to_octet(&o, e);
+	t = dlog_cache_get(L, &o, m);
+	if(!t) {
+		t = dlog_table_new(L, &e->val, m, b); SAFE(t);
+		memcpy(t->base, o.val, o.len);
+		t->baselen = o.len;
+		dlog_cache_put(L, t);
+	}
+	// giant steps Q - i*2m*B for i in [0,imax], so that (imax*2m + m)
+	// is at least max
+	m = t->m;
+	imax = (max + m) / (2*m);
+	ECP_copy(&R, &q->val);
+	for(i=0; i<=imax; i+=n) {
+		n = imax+1-i < DLOG_BATCH ? (int)(imax+1-i) : DLOG_BATCH;
+		for(k=0; k<n; k++) {
+			ECP_copy(&b->P[k], &R);
+			ECP_add(&R, &t->stride);
+		}
+		dlog_keys(b, n);
+		for(k=0; k<n; k++) {
+			c = (i+k)*2*m;
+			if(b->key[k] == 0 && ECP_isinf(&b->P[k])) {
+				if(dlog_check(&q->val, &e->val, c, max)) goto found;
+				continue;
+			}
+			j = dlog_find(t, b->key[k]);
+			if(!j) continue;
+			if(dlog_check(&q->val, &e->val, c + j, max)) { c += j; goto found; }
+			if(dlog_check(&q->val, &e->val, c - j, max)) { c -= j; goto found; }
+		}
+	}
+	lua_pushnil(L);
+	return 1;
+found:
+	lua_pushinteger(L, (lua_Integer)c);
+	return 1;
+}
+
 int luaopen_ecp(lua_State *L) {
 	(void)L;
 	const struct luaL_Reg ecp_class[] = {
@@ -451,6 +722,7 @@ int luaopen_ecp(lua_State *L) {
 		{"mul", ecp_mul},
 		{"validate", ecp_validate},
 		{"prime", ecp_prime},
+		{"dlog", ecp_dlog},
 		{NULL, NULL}};
 	const struct luaL_Reg ecp_methods[] = {
 		{"affine", ecp_affine},
@@ -462,6 +734,7 @@ int luaopen_ecp(lua_State *L) {
 		{"add", ecp_add},
 		{"x", ecp_get_x},
 		{"y", ecp_get_y},
+		{"dlog", ecp_dlog},
 		{"__add", ecp_add},
 		{"sub", ecp_sub},
 		{"__sub", ecp_sub},
@@ -61,6 +61,11 @@ extern void RMD160_init(dword *MDbuf);
 extern void RMD160_process(dword *MDbuf, byte *message, dword length);
 extern void RMD160_hash(dword *MDbuf, byte *hashcode);
 
+// From pqclean/fips202x4.c
+extern int sha3_256x4(uint8_t *out[4], const uint8_t *in[4], const size_t inlen[4]);
+extern int keccak256x4(uint8_t *out[4], const uint8_t *in[4], const size_t inlen[4]);
+#define KECCAK256_RATE 136
+
 /**
    Create a new hash object of a selected algorithm (sha256 or
    sha512). The resulting object can then process any @{OCTET} into
@@ -72,66 +77,79 @@ extern void RMD160_hash(dword *MDbuf, byte *hashcode);
    @see process
 */
 
+// internal use to match an algorithm name, returns its length in
+// bytes or 0 when unknown
+static int _algo(const char *hashtype, int *algo) {
+	if(strncasecmp(hashtype,"sha256",6) == 0) {
+		*algo = _SHA256; return 32;
+	} else if(strncasecmp(hashtype,"sha384",6) == 0) {
+		*algo = _SHA384; return 48;
+	} else if(strncasecmp(hashtype,"sha512",6) == 0) {
+		*algo = _SHA512; return 64;
+	} else if(strncasecmp(hashtype,"sha3_256",7) == 0) {
+		*algo = _SHA3_256; return 32;
+	} else if(strncasecmp(hashtype,"sha3_512",7) == 0) {
+		*algo = _SHA3_512; return 64;
+	} else if(strncasecmp(hashtype,"keccak256",9) == 0) {
+		*algo = _KECCAK256; return 32;
+	} else if(strncasecmp(hashtype,"ripemd160",9) == 0) {
+		*algo = _RMD160; return 20;
+	} // ... TODO: other hashes
+	return 0;
+}
+
 hash* hash_new(lua_State *L, const char *hashtype) {
 	HEREs(hashtype);
+	// TODO: change default to empty random (waiting for seed)
+	if(!hashtype) hashtype = "sha256";
+	int algo, len = _algo(hashtype, &algo);
+	if(!len) {
+		lerror(L, "Hash algorithm not known: %s", hashtype);
+		return NULL; }
 	hash *h = lua_newuserdata(L, sizeof(hash));
 	if(!h) {
 		lerror(L, "Error allocating new hash generator in %s",__func__);
 		return NULL; }
 	luaL_getmetatable(L, "zenroom.hash");
 	lua_setmetatable(L, -2);
-	char ht[16];
 	h->sha256 = NULL; h->sha384 = NULL; h->sha512 = NULL;
+	h->sha3_256 = NULL; h->sha3_512 = NULL; h->keccak256 = NULL;
+	h->rmd160 = NULL;
 	h->rng = NULL;
-	if(hashtype) strncpy(ht,hashtype,15);
-	// TODO: change default to empty random (waiting for seed)
-	else         strncpy(ht,"sha256",15);
-	if(strncasecmp(hashtype,"sha256",6) == 0) {
-		strncpy(h->name,hashtype,15);
-		h->len = 32;
-		h->algo = _SHA256;
+	strncpy(h->name,hashtype,15);
+	h->name[15] = '\0';
+	h->len = len;
+	h->algo = algo;
+	switch(algo) {
+	case _SHA256:
 		h->sha256 = (hash256*)zen_memory_alloc(sizeof(hash256));
 		HASH256_init(h->sha256);
-	} else if(strncasecmp(hashtype,"sha384",6) == 0) {
-		strncpy(h->name,hashtype,15);
-		h->len = 48;
-		h->algo = _SHA384;
+		break;
+	case _SHA384:
 		h->sha384 = (hash384*)zen_memory_alloc(sizeof(hash384));
 		HASH384_init(h->sha384);
-	} else if(strncasecmp(hashtype,"sha512",6) == 0) {
-		strncpy(h->name,hashtype,15);
-		h->len = 64;
-		h->algo = _SHA512;
+		break;
+	case _SHA512:
 		h->sha512 = (hash512*)zen_memory_alloc(sizeof(hash512));
 		HASH512_init(h->sha512);
-	} else if(strncasecmp(hashtype,"sha3_256",7) == 0) {
-		strncpy(h->name,hashtype,15);
-		h->len = 32;
-		h->algo = _SHA3_256;
+		break;
+	case _SHA3_256:
 		h->sha3_256 = (sha3*)zen_memory_alloc(sizeof(sha3));
 		SHA3_init(h->sha3_256, h->len);
-	} else if(strncasecmp(hashtype,"sha3_512",7) == 0) {
-		strncpy(h->name,hashtype,15);
-		h->len = 64;
-		h->algo = _SHA3_512;
+		break;
+	case _SHA3_512:
 		h->sha3_512 = (sha3*)zen_memory_alloc(sizeof(sha3));
 		SHA3_init(h->sha3_512, h->len);
-	} else if(strncasecmp(hashtype,"keccak256",9) == 0) {
-		strncpy(h->name,hashtype,15);
-		h->len = 32;
-		h->algo = _KECCAK256;
+		break;
+	case _KECCAK256:
 		h->keccak256 = (sha3*)zen_memory_alloc(sizeof(sha3));
 		SHA3_init(h->keccak256, h->len);
-	} else if(strncasecmp(hashtype,"ripemd160",9) == 0) {
-		strncpy(h->name,hashtype,15);
-		h->len = 20;
-		h->algo = _RMD160;
-		h->rmd160 = (dword*)zen_memory_alloc((160/32)+0x0f);
+		break;
+	case _RMD160:
+		h->rmd160 = (dword*)zen_memory_alloc(sizeof(dword)*5);
 		RMD160_init(h->rmd160);
-	} // ... TODO: other hashes
-	else {
-		lerror(L, "Hash algorithm not known: %s", hashtype);
-		return NULL; }
+		break;
+	}
 	return(h);
 }
 
@@ -146,10 +164,13 @@ int hash_destroy(lua_State *L) {
 	hash *h = hash_arg(L,1); SAFE(h);
 	HEREs(h->name);
 	if(h->rng) free(h->rng);
-	if(h->algo == _SHA256)
-		zen_memory_free(h->sha256);
-	else if (h->algo == _SHA512)
-		zen_memory_free(h->sha512);
+	if(h->sha256) zen_memory_free(h->sha256);
+	if(h->sha384) zen_memory_free(h->sha384);
+	if(h->sha512) zen_memory_free(h->sha512);
+	if(h->sha3_256) zen_memory_free(h->sha3_256);
+	if(h->sha3_512) zen_memory_free(h->sha3_512);
+	if(h->keccak256) zen_memory_free(h->keccak256);
+	if(h->rmd160) zen_memory_free(h->rmd160);
 	return 0;
 }
 
@@ -247,6 +268,228 @@ static int hash_yeld(lua_State *L) {
 	return 1;
 }
 
+/**
+   Hash an octet in one shot, without creating a hash object. The
+   state of the hash function lives on the stack, so the only
+   allocation is the resulting octet: this is the fastest way to hash
+   single messages and is used by @{sha256}, @{sha512} and most
+   Zencode statements.
+
+   @param algo string indicating the type of hash algorithm
+   @param data octet containing the data to be hashed
+   @function HASH.digest(algo, data)
+   @return a new octet containing the hash of the data
+*/
+static int hash_digest(lua_State *L) {
+	const char *hashtype = luaL_checkstring(L, 1);
+	octet *o = o_arg(L, 2); SAFE(o);
+	register int i;
+	int algo, len = _algo(hashtype, &algo);
+	if(!len) {
+		lerror(L, "Hash algorithm not known: %s", hashtype);
+		return 0; }
+	octet *res = o_new(L, len); SAFE(res);
+	switch(algo) {
+	case _SHA256: {
+		hash256 sha256;
+		HASH256_init(&sha256);
+		for(i=0;i<o->len;i++) HASH256_process(&sha256,o->val[i]);
+		HASH256_hash(&sha256,res->val);
+		break; }
+	case _SHA384: {
+		hash384 sha384;
+		HASH384_init(&sha384);
+		for(i=0;i<o->len;i++) HASH384_process(&sha384,o->val[i]);
+		HASH384_hash(&sha384,res->val);
+		break; }
+	case _SHA512: {
+		hash512 sha512;
+		HASH512_init(&sha512);
+		for(i=0;i<o->len;i++) HASH512_process(&sha512,o->val[i]);
+		HASH512_hash(&sha512,res->val);
+		break; }
+	case _SHA3_256:
+	case _SHA3_512:
+	case _KECCAK256: {
+		sha3 sha;
+		SHA3_init(&sha, len);
+		for(i=0;i<o->len;i++) SHA3_process(&sha,o->val[i]);
+		if(algo == _KECCAK256) KECCAK_hash(&sha,res->val);
+		else SHA3_hash(&sha,res->val);
+		break; }
+	case _RMD160: {
+		dword rmd160[5];
+		RMD160_init(rmd160);
+		RMD160_process(rmd160, (unsigned char*)o->val, o->len);
+		RMD160_hash(rmd160, (unsigned char*)res->val);
+		break; }
+	}
+	res->len = len;
+	return 1;
+}
+
+// feeds an octet, a string or an array of them (also nested) to sha256
+static int dsha256_feed(lua_State *L, int idx, hash256 *sha, int depth) {
+	const char *val;
+	size_t len, i;
+	octet *o = (octet*) luaL_testudata(L, idx, "zenroom.octet");
+	if(o) {
+		val = o->val; len = o->len;
+	} else if(lua_type(L, idx) == LUA_TSTRING) {
+		val = lua_tolstring(L, idx, &len);
+	} else if(lua_type(L, idx) == LUA_TTABLE && depth < 8) {
+		lua_Integer n = luaL_len(L, idx), k;
+		for(k=1; k<=n; k++) {
+			lua_rawgeti(L, idx, k);
+			if(!dsha256_feed(L, lua_gettop(L), sha, depth+1)) return 0;
+			lua_pop(L, 1);
+		}
+		return 1;
+	} else {
+		zerror(L, "%s: arguments must be octets, strings or arrays of them",
+		       __func__);
+		return 0;
+	}
+	for(i=0; i<len; i++) HASH256_process(sha, val[i]);
+	return 1;
+}
+
+/**
+   Double SHA256 as used by Bitcoin: sha256(sha256(data)). Takes any
+   number of octets, strings or arrays of them and hashes their
+   concatenation, without building it in memory: transaction
+   preimages are hashed piece by piece.
+
+   @param ... octets, strings or arrays of them
+   @function HASH.dsha256(...)
+   @return a new octet of 32 bytes
+*/
+static int hash_dsha256(lua_State *L) {
+	int i, n = lua_gettop(L);
+	char first[32];
+	hash256 sha;
+	HASH256_init(&sha);
+	for(i=1; i<=n; i++) {
+		if(!dsha256_feed(L, i, &sha, 0)) {
+			lerror(L, "%s: invalid argument %d", __func__, i);
+			return 0; }
+	}
+	HASH256_hash(&sha, first);
+	HASH256_init(&sha);
+	for(i=0; i<32; i++) HASH256_process(&sha, first[i]);
+	octet *res = o_new(L, 32); SAFE(res);
+	HASH256_hash(&sha, res->val);
+	res->len = 32;
+	return 1;
+}
+
+// sort key for the batch: 4-way hashing needs the same number of
+// full blocks in all lanes
+typedef struct {
+	int idx;
+	int blocks;
+} batch_entry;
+
+static int batch_cmp(const void *a, const void *b) {
+	const batch_entry *x = (const batch_entry*)a;
+	const batch_entry *y = (const batch_entry*)b;
+	if(x->blocks != y->blocks) return x->blocks - y->blocks;
+	return x->idx - y->idx;
+}
+
+// points an octet to the element of the batch on top of the stack,
+// without allocating: the value stays referenced by the table
+static int batch_arg(lua_State *L, octet *o) {
+	size_t len;
+	octet *ud = (octet*) luaL_testudata(L, -1, "zenroom.octet");
+	if(ud) {
+		*o = *ud;
+		return 1;
+	}
+	if(lua_type(L, -1) == LUA_TSTRING) {
+		o->val = (char*)lua_tolstring(L, -1, &len);
+		o->len = o->max = (int)len;
+		return 1;
+	}
+	zerror(L, "%s: array elements must be octets or strings", __func__);
+	return 0;
+}
+
+/**
+   Hash an array of octets at once. Returns an array of the same
+   size with the hash of each element in the same position. For
+   `keccak256` and `sha3_256` the messages are hashed four at a time
+   using a parallel Keccak (AVX2 when available), which makes
+   computing many Ethereum addresses or transaction hashes much
+   faster; other algorithms are processed one by one.
+
+   @param array table of octets to be hashed
+   @function hash:process_batch(array)
+   @return a new table of octets containing the hashes
+*/
+static int hash_process_batch(lua_State *L) {
+	hash *h = hash_arg(L,1); SAFE(h);
+	luaL_checktype(L, 2, LUA_TTABLE);
+	int n = lua_rawlen(L, 2);
+	int i, j, k, run;
+	octet o;
+	octet *res;
+	int x4 = (h->algo == _KECCAK256 || h->algo == _SHA3_256);
+	batch_entry *entries = malloc(sizeof(batch_entry) * (n ? n : 1));
+	if(!entries) {
+		lerror(L, "Error allocating batch in %s",__func__);
+		return 0; }
+	for(i=0; i<n; i++) {
+		lua_rawgeti(L, 2, i+1);
+		if(!batch_arg(L, &o)) {
+			free(entries);
+			lerror(L, "hash batch failed at element %d", i+1);
+			return 0; }
+		entries[i].idx = i+1;
+		entries[i].blocks = x4 ? o.len / KECCAK256_RATE : 0;
+		lua_pop(L, 1);
+	}
+	if(x4) qsort(entries, n, sizeof(batch_entry), batch_cmp);
+	lua_createtable(L, n, 0); // results at index 3
+	for(i=0; i<n; i+=run) {
+		// run of entries with the same number of blocks
+		for(run=1; i+run<n && entries[i+run].blocks == entries[i].blocks; run++);
+		j = 0;
+		if(x4) for(; j+4<=run; j+=4) {
+			const uint8_t *in[4];
+			size_t inlen[4];
+			uint8_t *out[4];
+			for(k=0; k<4; k++) {
+				lua_rawgeti(L, 2, entries[i+j+k].idx);
+				batch_arg(L, &o);
+				in[k] = (const uint8_t*)o.val;
+				inlen[k] = o.len;
+			}
+			for(k=0; k<4; k++) {
+				res = o_new(L, h->len); SAFE(res);
+				res->len = h->len;
+				out[k] = (uint8_t*)res->val;
+			}
+			if(h->algo == _KECCAK256) keccak256x4(out, in, inlen);
+			else sha3_256x4(out, in, inlen);
+			for(k=3; k>=0; k--) lua_rawseti(L, 3, entries[i+j+k].idx);
+			lua_pop(L, 4);
+		}
+		for(; j<run; j++) {
+			lua_rawgeti(L, 2, entries[i+j].idx);
+			batch_arg(L, &o);
+			res = o_new(L, h->len); SAFE(res);
+			_feed(h, &o);
+			_yeld(h, res);
+			res->len = h->len;
+			lua_rawseti(L, 3, entries[i+j].idx);
+			lua_pop(L, 1);
+		}
+	}
+	free(entries);
+	return 1;
+}
+
 /**
    Compute the HMAC of a message using a key. This method takes any
    data and any key material to comput an HMAC of the same length of
@@ -460,6 +703,8 @@ int luaopen_hash(lua_State *L) {
 	(void)L;
 	const struct luaL_Reg hash_class[] = {
 		{"new",lua_new_hash},
+		{"digest",hash_digest},
+		{"dsha256",hash_dsha256},
 		{"octet",hash_to_octet},
 		{"hmac",hash_hmac},
 		{"kdf2", hash_kdf2},
@@ -475,6 +720,7 @@ int luaopen_hash(lua_State *L) {
 	const struct luaL_Reg hash_methods[] = {
 		{"octet",hash_to_octet},
 		{"process",hash_process},
+		{"process_batch",hash_process_batch},
 		{"feed",hash_feed},
 		{"yeld",hash_yeld},
 		{"do",hash_process},
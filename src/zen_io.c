@@ -19,6 +19,8 @@
  */
 
 #include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
 #include <unistd.h>
 #include <ctype.h>
 #include <errno.h>
@@ -42,12 +44,48 @@
 #endif
 
 #include <zstd.h>
+#include <zstd_errors.h>
 
 #if defined(ARCH_CORTEX)
 extern int SEMIHOSTING_STDOUT_FILENO;
 extern int write_to_console(const char* str);
 #endif
 
+// passes output to the callback configured for stdout or stderr,
+// once a callback fails the rest of that output is discarded
+int zen_write_cb(zenroom_t *Z, int err, const char *buf, size_t len) {
+	zen_write_t cb = err ? Z->stderr_cb : Z->stdout_cb;
+	size_t *full = err ? &Z->stderr_full : &Z->stdout_full;
+	if(*full) return(0);
+	if((*cb)(Z->cb_ctx, buf, len) != 0) {
+		*full = 1;
+		if(!err) zerror(Z->lua, "Output callback failed, result data lost");
+		Z->exitcode = ERR_GENERIC;
+		return(0);
+	}
+	return(len);
+}
+
+// formats on the stack when short, else on the heap: the callback
+// always receives the whole formatted string
+static int zen_write_cb_va(zenroom_t *Z, int err, const char *fmt, va_list va) {
+	char buf[MAX_LINE];
+	va_list cp;
+	va_copy(cp, va);
+	int res = (*Z->vsnprintf)(buf, MAX_LINE, fmt, va);
+	if(res >= MAX_LINE) {
+		char *tmp = malloc(res+1);
+		if(tmp) {
+			(*Z->vsnprintf)(tmp, res+1, fmt, cp);
+			zen_write_cb(Z, err, tmp, res);
+			free(tmp);
+		}
+	} else if(res > 0)
+		zen_write_cb(Z, err, buf, res);
+	va_end(cp);
+	return(res > 0 ? res : 1); // never fall back to stdio
+}
+
 int zen_write_err_va(zenroom_t *Z, const char *fmt, va_list va) {
 	int res = 0;
 #ifdef __ANDROID__
@@ -58,6 +96,7 @@ int zen_write_err_va(zenroom_t *Z, const char *fmt, va_list va) {
 	res = write_to_console(buffer);
 #else
 	if(!Z) res = vfprintf(stderr,fmt,va); // no init yet, print to stderr
+	if(!res && Z->stderr_cb) return zen_write_cb_va(Z, 1, fmt, va);
 	if(!res && Z->stderr_buf) { // print to configured buffer
 		if(Z->stderr_full) {
 			zerror(Z->lua, "Error buffer full, log message lost");
@@ -97,6 +136,7 @@ int zen_write_err_va(zenroom_t *Z, const char *fmt, va_list va) {
 int zen_write_out_va(zenroom_t *Z, const char *fmt, va_list va) {
 	int res = 0;
 	if(!Z) res = vfprintf(stdout,fmt,va); // no init yet, print to stdout
+	if(!res && Z->stdout_cb) return zen_write_cb_va(Z, 0, fmt, va);
 	if(!res && Z->stdout_buf) { // print to configured buffer
 		if(Z->stdout_full) {
 			zerror(Z->lua, "Output buffer full, result data lost");
@@ -163,6 +203,59 @@ int zen_write_out(zenroom_t *Z, const char *fmt, ...) {
 	return len;
 }
 
+// writes an output already encoded in full, as json_print and the
+// pack printers do once encoding succeeded, to the callback or the
+// buffer configured else to stdout. The buffer is NUL terminated when
+// there is room, as vsnprintf does.
+void zen_write_out_bytes(lua_State *L, const char *buf, size_t len) {
+	Z(L);
+	if(Z && Z->stdout_cb) {
+		zen_write_cb(Z, 0, buf, len);
+		return;
+	}
+	if(Z && Z->stdout_buf) {
+		size_t max = Z->stdout_len - Z->stdout_pos;
+		char *dst = Z->stdout_buf + Z->stdout_pos;
+		if(Z->stdout_full || Z->stdout_pos >= Z->stdout_len) {
+			zerror(L, "Output buffer full, result data lost");
+			return;
+		}
+		if(len < max) {
+			memcpy(dst, buf, len);
+			dst[len] = '\0';
+			Z->stdout_pos += len;
+			return;
+		}
+		memcpy(dst, buf, max-1);
+		dst[max-1] = '\0';
+		zerror(L, "Output buffer too small, data truncated: %u bytes (max %u)",
+		       len, max);
+		Z->stdout_full = 1;
+		Z->stdout_pos += max;
+		return;
+	}
+#if defined(__EMSCRIPTEN__) || defined(ARCH_CORTEX)
+	// print adds the newline itself
+	if(len && buf[len-1] == '\n') {
+		lua_getglobal(L, "print");
+		lua_pushlstring(L, buf, len-1);
+	} else {
+		lua_getglobal(L, "write");
+		lua_pushlstring(L, buf, len);
+	}
+	lua_call(L, 1, 0);
+#else
+	{
+		size_t pos = 0;
+		while(pos < len) {
+			ssize_t res = write(STDOUT_FILENO, buf+pos, len-pos);
+			if(res <= 0) break;
+			pos += res;
+		}
+	}
+#endif
+}
+
 // passes the string to be printed through the 'tostring'
 // meta-function configured in Lua, taking care of conversions
 const char *lua_print_format(lua_State *L,
@@ -178,11 +271,32 @@ const char *lua_print_format(lua_State *L,
 	return s;
 }
 
+// passes the arguments to the callback if configured in _Z, as they
+// are written on stdout: separated by tabs and with their length
+static int lua_print_tocb(lua_State *L, int err, char newline) {
+	Z(L);
+	if(!(err ? Z->stderr_cb : Z->stdout_cb)) return 0;
+	int i;
+	int n = lua_gettop(L);  /* number of arguments */
+	size_t len;
+	const char *s;
+	lua_getglobal(L, "tostring");
+	for (i=1; i<=n; i++) {
+		s = lua_print_format(L, i, &len);
+		if(i>1) zen_write_cb(Z, err, "\t", 1);
+		zen_write_cb(Z, err, s, len);
+		lua_pop(L, 1);
+	}
+	zen_write_cb(Z, err, &newline, 1);
+	return 1;
+}
+
 // retrieves output buffer if configured in _Z and append to that the
 // output without exceeding its length. Return 1 if output buffer was
 // configured so calling function can decide if to proceed with other
 // prints (stdout) or not
 static int lua_print_stdout_tobuf(lua_State *L, char newline) {
+	if( lua_print_tocb(L, 0, newline) ) return 1;
 	Z(L);
 	if(Z->stdout_buf && (Z->stdout_pos < Z->stdout_len)) {
 		int i;
@@ -204,6 +318,7 @@ static int lua_print_stdout_tobuf(lua_State *L, char newline) {
 }
 
 static int lua_print_stderr_tobuf(lua_State *L, char newline) {
+	if( lua_print_tocb(L, 1, newline) ) return 1;
 	Z(L);
 	if(Z->stderr_buf && (Z->stderr_pos < Z->stderr_len)) {
 		int i;
@@ -372,6 +487,12 @@ static int zen_printerr(lua_State *L) {
 
 // print without an ending newline
 static int zen_write (lua_State *L) {
+	Z(L);
+	if(Z->stdout_cb) { // raw bytes, as written on stdout
+		octet *o = o_arg(L, 1); SAFE(o);
+		zen_write_cb(Z, 0, o->val, o->len);
+		return 0;
+	}
 	if( lua_print_stdout_tobuf(L,' ') ) return 0;
 	octet *o = o_arg(L, 1); SAFE(o);
 	short res;
@@ -476,6 +597,12 @@ static int zen_printerr(lua_State *L) {
 
 // print without an ending newline
 static int zen_write (lua_State *L) {
+	Z(L);
+	if(Z->stdout_cb) { // raw bytes, as written on stdout
+		octet *o = o_arg(L, 1); SAFE(o);
+		zen_write_cb(Z, 0, o->val, o->len);
+		return 0;
+	}
 	if( lua_print_stdout_tobuf(L,' ') ) return 0;
 	octet *o = o_arg(L, 1); SAFE(o);
 	short res;
@@ -541,42 +668,140 @@ static int zen_fatal(lua_State *L) {
 	return 0; // unreachable code
 }
 
+// optional arguments: compression level (default from "zstd=" conf)
+// and a dictionary, which can be trained with "zstd --train" or be
+// any raw sample of content similar to the one compressed
 int zen_zstd_compress(lua_State *L) {
-  octet *dst, *src;
+  octet *dst, *src, *dict = NULL;
+  int level;
+  size_t res;
   Z(L);
   if(!Z->zstd_c)
     Z->zstd_c = ZSTD_createCCtx();
   src = o_arg(L, 1); SAFE(src);
-  dst = o_new(L, ZSTD_compressBound(src->len));
-  dst->len = ZSTD_compressCCtx(Z->zstd_c,
-			       dst->val, dst->max,
-			       src->val, src->len,
-			       ZSTD_maxCLevel());
-  func(L, "octet compressed: %u -> %u",src->len, dst->len);
-  if (ZSTD_isError(dst->len)) {
-    fprintf(stderr,"ZSTD error: %s\n",ZSTD_getErrorName(dst->len));
+  level = luaL_optinteger(L, 2, Z->zstd_level);
+  if(level < ZSTD_minCLevel() || level > ZSTD_maxCLevel()) {
+    lerror(L, "Invalid zstd compression level: %i", level);
+    return 0;
+  }
+  if(!lua_isnoneornil(L, 3)) {
+    dict = o_arg(L, 3); SAFE(dict);
+  }
+  dst = o_new(L, ZSTD_compressBound(src->len)); SAFE(dst);
+  if(dict)
+    res = ZSTD_compress_usingDict(Z->zstd_c,
+				  dst->val, dst->max,
+				  src->val, src->len,
+				  dict->val, dict->len, level);
+  else
+    res = ZSTD_compressCCtx(Z->zstd_c,
+			    dst->val, dst->max,
+			    src->val, src->len, level);
+  if (ZSTD_isError(res)) {
+    fprintf(stderr,"ZSTD error: %s\n",ZSTD_getErrorName(res));
     zen_fatal(L);
   }
+  dst->len = res;
+  func(L, "octet compressed (level %i): %u -> %u",level, src->len, dst->len);
   return 1;
 }
 
+// frames written by compress() always carry their content size, which
+// is then used to allocate the destination at once. Frames without it
+// (e.g. produced by streaming compressors) are decompressed in chunks
+// growing the buffer up to MAX_OCTET
+static size_t zstd_decompress_stream(ZSTD_DCtx *dctx, octet *src, octet *dict,
+				     char **out, size_t *outlen) {
+  ZSTD_inBuffer in = { src->val, src->len, 0 };
+  ZSTD_outBuffer o = { NULL, 0, 0 };
+  size_t res, max = ZSTD_DStreamOutSize();
+  char *tmp, *buf = NULL;
+  if(dict) {
+    res = ZSTD_DCtx_loadDictionary(dctx, dict->val, dict->len);
+    if(ZSTD_isError(res)) goto end;
+  }
+  do {
+    if(o.pos == o.size) {
+      if(o.size >= MAX_OCTET) {
+	res = (size_t)-ZSTD_error_dstSize_tooSmall; goto end; }
+      max = o.size ? o.size<<1 : max;
+      if(max > MAX_OCTET) max = MAX_OCTET;
+      tmp = realloc(buf, max);
+      if(!tmp) {
+	res = (size_t)-ZSTD_error_memory_allocation; goto end; }
+      buf = tmp;
+      o.dst = buf; o.size = max;
+    }
+    res = ZSTD_decompressStream(dctx, &o, &in);
+    if(ZSTD_isError(res)) goto end;
+  } while(in.pos < in.size || (res != 0 && o.pos == o.size));
+  if(res != 0) res = (size_t)-ZSTD_error_srcSize_wrong;
+ end:
+  // drop session and dictionary from the shared context
+  ZSTD_DCtx_reset(dctx, ZSTD_reset_session_and_parameters);
+  if(ZSTD_isError(res)) {
+    free(buf);
+    return res;
+  }
+  *out = buf;
+  *outlen = o.pos;
+  return 0;
+}
+
+// optional argument: the dictionary used to compress
 int zen_zstd_decompress(lua_State *L) {
-  octet *src, *dst;
+  octet *src, *dst, *dict = NULL;
+  unsigned long long size;
+  size_t res;
   Z(L);
   if(!Z->zstd_d)
     Z->zstd_d = ZSTD_createDCtx();
   src = o_arg(L, 1); SAFE(src);
-  dst = o_new(L, src->len * 3); // assuming max bound is *3
-  SAFE(dst);
+  if(!lua_isnoneornil(L, 2)) {
+    dict = o_arg(L, 2); SAFE(dict);
+  }
   func(L, "decompressing octet: %u", src->len);
-  dst->len = ZSTD_decompressDCtx(Z->zstd_d,
-		      dst->val, dst->max,
-		      src->val, src->len);
-  func(L, "octet uncompressed: %u -> %u",src->len, dst->len);
-  if (ZSTD_isError(dst->len)) {
-    fprintf(stderr,"ZSTD error: %s\n",ZSTD_getErrorName(dst->len));
-    zen_fatal(L);
+  size = ZSTD_getFrameContentSize(src->val, src->len);
+  if(size == ZSTD_CONTENTSIZE_ERROR) {
+    lerror(L, "Invalid zstd frame");
+    return 0;
   }
+  // concatenated frames are streamed as well
+  if(size == ZSTD_CONTENTSIZE_UNKNOWN
+     || ZSTD_findFrameCompressedSize(src->val, src->len) != (size_t)src->len) {
+    char *buf = NULL;
+    size_t len = 0;
+    res = zstd_decompress_stream(Z->zstd_d, src, dict, &buf, &len);
+    if (ZSTD_isError(res)) {
+      fprintf(stderr,"ZSTD error: %s\n",ZSTD_getErrorName(res));
+      zen_fatal(L);
+    }
+    dst = o_new(L, len); SAFE(dst);
+    memcpy(dst->val, buf, len);
+    dst->len = len;
+    free(buf);
+  } else {
+    if(size > MAX_OCTET) {
+      lerror(L, "Decompressed zstd size too big: %llu", size);
+      return 0;
+    }
+    dst = o_new(L, size); SAFE(dst);
+    if(dict)
+      res = ZSTD_decompress_usingDict(Z->zstd_d,
+				      dst->val, dst->max,
+				      src->val, src->len,
+				      dict->val, dict->len);
+    else
+      res = ZSTD_decompressDCtx(Z->zstd_d,
+				dst->val, dst->max,
+				src->val, src->len);
+    if (ZSTD_isError(res)) {
+      fprintf(stderr,"ZSTD error: %s\n",ZSTD_getErrorName(res));
+      zen_fatal(L);
+    }
+    dst->len = res;
+  }
+  func(L, "octet uncompressed: %u -> %u",src->len, dst->len);
   return 1;
 }
 
@@ -0,0 +1,707 @@
+/* This file is part of Zenroom (https://zenroom.dyne.org)
+ *
+ * Copyright (C) 2017-2022 Dyne.org foundation
+ * designed, written and maintained by Denis Roio <jaromil@dyne.org>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ */
+
+// JSON parser building Lua tables in a single pass, used by
+// JSON.decode in zenroom_json.lua. It follows the behaviour of the
+// json.lua parser it replaces: numbers are converted with the same
+// rules of Lua's tonumber(), null values are skipped and errors
+// report the line and column of the input.
+//
+// JSON encoder used by JSON.encode and to print the OUT table at the
+// end of Zencode execution: zenroom values are converted in the
+// configured encoding while walking the table, object keys are
+// sorted and the output is written straight into the configured
+// output buffer when printing.
+
+#include <stdlib.h>
+#include <string.h>
+
+#include <zenroom.h>
+#include <zen_error.h>
+#include <encoding.h>
+
+#include <lua.h>
+#include <lualib.h>
+#include <lauxlib.h>
+
+#include <zen_octet.h>
+
+// prototype from zen_io.c
+extern void zen_write_out_bytes(lua_State *L, const char *buf, size_t len);
+
+// maximum nesting of objects and arrays
+#define JSON_MAX_DEPTH 256
+// longest token accepted as number or literal
+#define JSON_MAX_TOKEN 128
+
+typedef struct {
+	const char *s;
+	size_t len;
+	size_t pos;
+	int conv; // stack index of the string conversion function, or 0
+	int depth;
+} json_parser;
+
+static int json_error(lua_State *L, json_parser *p, const char *msg) {
+	int line = 1, col = 1;
+	size_t i;
+	for(i=0; i<p->pos && i<p->len; i++) {
+		col++;
+		if(p->s[i] == '\n') { line++; col = 1; }
+	}
+	return luaL_error(L, "The JSON input is not valid: %s at line %d col %d",
+	                  msg, line, col);
+}
+
+static inline void skip_space(json_parser *p) {
+	while(p->pos < p->len) {
+		char c = p->s[p->pos];
+		if(c != ' ' && c != '\t' && c != '\r' && c != '\n') break;
+		p->pos++;
+	}
+}
+
+static inline int is_delim(char c) {
+	return (c==' ' || c=='\t' || c=='\r' || c=='\n'
+	        || c==']' || c=='}' || c==',');
+}
+
+static int hex4(const char *s) {
+	int i, n = 0;
+	for(i=0; i<4; i++) {
+		char c = s[i];
+		n <<= 4;
+		if(c>='0' && c<='9') n |= c - '0';
+		else if(c>='a' && c<='f') n |= c - 'a' + 10;
+		else if(c>='A' && c<='F') n |= c - 'A' + 10;
+		else return -1;
+	}
+	return n;
+}
+
+static void add_utf8(luaL_Buffer *b, unsigned long n) {
+	if(n <= 0x7f) {
+		luaL_addchar(b, (char)n);
+	} else if(n <= 0x7ff) {
+		luaL_addchar(b, (char)(0xc0 | (n >> 6)));
+		luaL_addchar(b, (char)(0x80 | (n & 0x3f)));
+	} else if(n <= 0xffff) {
+		luaL_addchar(b, (char)(0xe0 | (n >> 12)));
+		luaL_addchar(b, (char)(0x80 | ((n >> 6) & 0x3f)));
+		luaL_addchar(b, (char)(0x80 | (n & 0x3f)));
+	} else {
+		luaL_addchar(b, (char)(0xf0 | (n >> 18)));
+		luaL_addchar(b, (char)(0x80 | ((n >> 12) & 0x3f)));
+		luaL_addchar(b, (char)(0x80 | ((n >> 6) & 0x3f)));
+		luaL_addchar(b, (char)(0x80 | (n & 0x3f)));
+	}
+}
+
+// pushes the string starting at the opening quote, strings without
+// escapes are pushed straight from the input
+static void parse_string(lua_State *L, json_parser *p) {
+	const char *s = p->s;
+	size_t start = ++p->pos, i;
+	luaL_Buffer b;
+	for(i=start; i<p->len; i++) {
+		unsigned char c = s[i];
+		if(c == '"') {
+			lua_pushlstring(L, s+start, i-start);
+			p->pos = i+1;
+			return;
+		}
+		if(c == '\\') break;
+		if(c < 32) {
+			p->pos = i;
+			json_error(L, p, "control character in string");
+		}
+	}
+	luaL_buffinit(L, &b);
+	luaL_addlstring(&b, s+start, i-start);
+	for(; i<p->len; i++) {
+		unsigned char c = s[i];
+		if(c == '"') {
+			luaL_pushresult(&b);
+			p->pos = i+1;
+			return;
+		}
+		if(c < 32) {
+			p->pos = i;
+			json_error(L, p, "control character in string");
+		}
+		if(c != '\\') { luaL_addchar(&b, c); continue; }
+		if(++i >= p->len) break;
+		switch(s[i]) {
+		case '"': luaL_addchar(&b, '"'); break;
+		case '\\': luaL_addchar(&b, '\\'); break;
+		case '/': luaL_addchar(&b, '/'); break;
+		case 'b': luaL_addchar(&b, '\b'); break;
+		case 'f': luaL_addchar(&b, '\f'); break;
+		case 'n': luaL_addchar(&b, '\n'); break;
+		case 'r': luaL_addchar(&b, '\r'); break;
+		case 't': luaL_addchar(&b, '\t'); break;
+		case 'u': {
+			int n1 = 0, n2 = 0;
+			if(i+4 >= p->len || (n1 = hex4(s+i+1)) < 0) {
+				p->pos = i;
+				json_error(L, p, "invalid unicode escape in string");
+			}
+			i += 4;
+			// surrogate pair
+			if(n1 >= 0xd800 && n1 <= 0xdbff && i+6 < p->len
+			   && s[i+1] == '\\' && s[i+2] == 'u'
+			   && (n2 = hex4(s+i+3)) >= 0xdc00 && n2 <= 0xdfff) {
+				add_utf8(&b, ((n1 - 0xd800) << 10) + (n2 - 0xdc00) + 0x10000);
+				i += 6;
+			} else add_utf8(&b, n1);
+			break; }
+		default:
+			p->pos = i;
+			json_error(L, p, "invalid escape char in string");
+		}
+	}
+	p->pos = start;
+	json_error(L, p, "expected closing quote for string");
+}
+
+static void parse_value(lua_State *L, json_parser *p);
+
+static void parse_array(lua_State *L, json_parser *p, int t, lua_Integer n) {
+	p->pos++;
+	for(;;) {
+		skip_space(p);
+		if(p->pos < p->len && p->s[p->pos] == ']') { p->pos++; return; }
+		parse_value(L, p);
+		lua_rawseti(L, t, n++);
+		skip_space(p);
+		if(p->pos >= p->len) json_error(L, p, "expected ']' or ','");
+		char c = p->s[p->pos++];
+		if(c == ']') return;
+		if(c != ',') json_error(L, p, "expected ']' or ','");
+	}
+}
+
+static void parse_object(lua_State *L, json_parser *p, int t) {
+	p->pos++;
+	for(;;) {
+		skip_space(p);
+		if(p->pos < p->len && p->s[p->pos] == '}') { p->pos++; return; }
+		if(p->pos >= p->len || p->s[p->pos] != '"')
+			json_error(L, p, "expected string for key");
+		parse_string(L, p);
+		skip_space(p);
+		if(p->pos >= p->len || p->s[p->pos] != ':')
+			json_error(L, p, "expected ':' after key");
+		p->pos++;
+		skip_space(p);
+		parse_value(L, p);
+		if(lua_isnil(L, -1)) lua_pop(L, 2); // null
+		else lua_rawset(L, t);
+		skip_space(p);
+		if(p->pos >= p->len) json_error(L, p, "expected '}' or ','");
+		char c = p->s[p->pos++];
+		if(c == '}') return;
+		if(c != ',') json_error(L, p, "expected '}' or ','");
+	}
+}
+
+// numbers and literals span until the next delimiter
+static void parse_token(lua_State *L, json_parser *p) {
+	char tok[JSON_MAX_TOKEN+1];
+	size_t start = p->pos, len;
+	while(p->pos < p->len && !is_delim(p->s[p->pos])) p->pos++;
+	len = p->pos - start;
+	if(len > JSON_MAX_TOKEN) {
+		p->pos = start;
+		json_error(L, p, "token too long");
+	}
+	memcpy(tok, p->s+start, len);
+	tok[len] = '\0';
+	if(tok[0] == 't' || tok[0] == 'f' || tok[0] == 'n') {
+		if(strcmp(tok, "true") == 0) lua_pushboolean(L, 1);
+		else if(strcmp(tok, "false") == 0) lua_pushboolean(L, 0);
+		else if(strcmp(tok, "null") == 0) lua_pushnil(L);
+		else { p->pos = start; json_error(L, p, "invalid literal"); }
+		return;
+	}
+	if(lua_stringtonumber(L, tok) != len+1) {
+		p->pos = start;
+		json_error(L, p, "invalid number");
+	}
+}
+
+static void parse_value(lua_State *L, json_parser *p) {
+	if(p->pos >= p->len) json_error(L, p, "unexpected end of input");
+	char c = p->s[p->pos];
+	switch(c) {
+	case '"':
+		parse_string(L, p);
+		if(p->conv) {
+			lua_pushvalue(L, p->conv);
+			lua_insert(L, -2);
+			lua_call(L, 1, 1);
+		}
+		return;
+	case '{':
+	case '[':
+		if(++p->depth > JSON_MAX_DEPTH)
+			json_error(L, p, "too many nested levels");
+		luaL_checkstack(L, 4, "JSON nesting");
+		lua_newtable(L);
+		if(c == '{') parse_object(L, p, lua_gettop(L));
+		else parse_array(L, p, lua_gettop(L), 1);
+		p->depth--;
+		return;
+	case '-': case '0': case '1': case '2': case '3': case '4':
+	case '5': case '6': case '7': case '8': case '9':
+	case 't': case 'f': case 'n':
+		parse_token(L, p);
+		return;
+	}
+	json_error(L, p, "unexpected character");
+}
+
+/*
+  Decodes a string of one or more concatenated JSON objects or arrays
+  into a single table: the keys of all objects are merged and the
+  elements of arrays are appended to its 'array' member. Parsing stops
+  at the first character that cannot start an object or an array.
+
+  The optional second argument is a function (or the name of an
+  OCTET.from_<encoding> conversion) applied to every string value.
+*/
+static int lua_json_decode(lua_State *L) {
+	json_parser p;
+	octet *o = (octet*) luaL_testudata(L, 1, "zenroom.octet");
+	if(o) {
+		p.s = o->val;
+		p.len = o->len;
+	} else
+		p.s = luaL_checklstring(L, 1, &p.len);
+	p.pos = 0;
+	p.depth = 0;
+	p.conv = 0;
+	lua_settop(L, 2);
+	if(lua_type(L, 2) == LUA_TSTRING) {
+		const char *enc = lua_tostring(L, 2);
+		lua_getglobal(L, "OCTET");
+		lua_pushfstring(L, "from_%s", enc);
+		lua_gettable(L, -2);
+		if(!lua_isfunction(L, -1))
+			return luaL_error(L, "JSON decode: invalid encoding %s", enc);
+		lua_replace(L, 2);
+		lua_pop(L, 1);
+	}
+	if(lua_isfunction(L, 2)) p.conv = 2;
+	else if(!lua_isnil(L, 2))
+		return luaL_error(L, "JSON decode: invalid conversion argument");
+	lua_newtable(L); // result at 3
+	for(;;) {
+		skip_space(&p);
+		while(p.pos < p.len && p.s[p.pos] == 0x0) {
+			p.pos++;
+			skip_space(&p);
+		}
+		if(p.pos >= p.len) break;
+		if(p.s[p.pos] == '{') {
+			p.depth++;
+			parse_object(L, &p, 3);
+			p.depth--;
+		} else if(p.s[p.pos] == '[') {
+			lua_getfield(L, 3, "array");
+			if(!lua_istable(L, -1)) {
+				lua_pop(L, 1);
+				lua_newtable(L);
+				lua_pushvalue(L, -1);
+				lua_setfield(L, 3, "array");
+			}
+			p.depth++;
+			parse_array(L, &p, lua_gettop(L), lua_rawlen(L, -1) + 1);
+			p.depth--;
+			lua_pop(L, 1);
+		} else {
+			func(L, "JSON doesn't start with '{', char found: %c (%02x)",
+			     p.s[p.pos], (unsigned char)p.s[p.pos]);
+			break;
+		}
+	}
+	return 1;
+}
+
+// output encodings of octets done without calling back into Lua
+enum { JSON_ENC_LUA = 0, JSON_ENC_BASE64, JSON_ENC_URL64,
+       JSON_ENC_HEX, JSON_ENC_STRING };
+
+typedef struct {
+	lua_State *L;
+	char *buf;   // output, points inside the box
+	size_t len;
+	size_t cap;
+	int enc;     // JSON_ENC_* used for octets
+	int depth;
+} json_writer;
+
+// fixed stack positions used by the encoder after its arguments
+#define JSON_STACK 3 // set of tables being encoded
+#define JSON_BOX   4 // userdata holding the output
+#define JSON_CONV  5 // Lua conversion function for zenroom values
+
+static char *json_reserve(json_writer *w, size_t n) {
+	if(w->len + n > w->cap) {
+		size_t cap = w->cap ? w->cap << 1 : 1024;
+		char *p;
+		while(cap < w->len + n) cap <<= 1;
+		p = lua_newuserdata(w->L, cap);
+		if(w->len) memcpy(p, w->buf, w->len);
+		lua_replace(w->L, JSON_BOX);
+		w->buf = p;
+		w->cap = cap;
+	}
+	return w->buf + w->len;
+}
+
+static inline void json_put(json_writer *w, const char *s, size_t len) {
+	memcpy(json_reserve(w, len), s, len);
+	w->len += len;
+}
+
+static inline void json_putc(json_writer *w, char c) {
+	*json_reserve(w, 1) = c;
+	w->len++;
+}
+
+// same escapes of json.lua: control chars, quote and backslash
+static void encode_string(json_writer *w, const char *s, size_t len) {
+	static const char hexes[] = "0123456789abcdef";
+	size_t i, run = 0;
+	json_putc(w, '"');
+	for(i=0; i<len; i++) {
+		unsigned char c = s[i];
+		char esc;
+		if(c >= 32 && c != '"' && c != '\\') continue;
+		json_put(w, s+run, i-run);
+		run = i+1;
+		switch(c) {
+		case '"':  esc = '"'; break;
+		case '\\': esc = '\\'; break;
+		case '\b': esc = 'b'; break;
+		case '\f': esc = 'f'; break;
+		case '\n': esc = 'n'; break;
+		case '\r': esc = 'r'; break;
+		case '\t': esc = 't'; break;
+		default: {
+			char u[6] = { '\\', 'u', '0', '0', hexes[c>>4], hexes[c&0xf] };
+			json_put(w, u, 6);
+			continue; }
+		}
+		json_putc(w, '\\');
+		json_putc(w, esc);
+	}
+	json_put(w, s+run, len-run);
+	json_putc(w, '"');
+}
+
+static void encode_octet(json_writer *w, octet *o) {
+	char *p;
+	switch(w->enc) {
+	case JSON_ENC_BASE64:
+		// OCT_tobase64 and U64encode terminate the string
+		p = json_reserve(w, 4*((o->len+2)/3) + 3);
+		*p = '"';
+		OCT_tobase64(p+1, o);
+		break;
+	case JSON_ENC_URL64:
+		p = json_reserve(w, 4*((o->len+2)/3) + 3);
+		*p = '"';
+		U64encode(p+1, o->val, o->len);
+		break;
+	case JSON_ENC_HEX:
+		p = json_reserve(w, (o->len<<1) + 3);
+		*p = '"';
+		buf2hex(p+1, o->val, o->len);
+		break;
+	default:
+		encode_string(w, o->val, o->len);
+		return;
+	}
+	w->len += strlen(p+1) + 1;
+	json_putc(w, '"');
+}
+
+static int encode_value(json_writer *w, int idx);
+
+// zenroom values are converted as in INSPECT.process: octets and
+// values having an :octet() method are encoded here when the
+// encoding is supported, else converted by the function returned
+// from guess_outcast(). Empty octets convert to nil, the return is 0
+// when nothing was written.
+static int encode_zen(json_writer *w, int idx) {
+	lua_State *L = w->L;
+	octet *o;
+	int res = 1;
+	int t = luaL_getmetafield(L, idx, "__name");
+	if(t != LUA_TSTRING || !strstr(lua_tostring(L, -1), "zenroom"))
+		return luaL_error(L, "unexpected type '%s'",
+		                  t == LUA_TSTRING ? lua_tostring(L, -1) : "unknown");
+	lua_pop(L, 1);
+	if(w->enc == JSON_ENC_LUA) {
+		if(lua_isnil(L, JSON_CONV)) {
+			lua_getglobal(L, "guess_outcast");
+			lua_pushvalue(L, 2);
+			lua_call(L, 1, 1);
+			lua_replace(L, JSON_CONV);
+		}
+		lua_pushvalue(L, JSON_CONV);
+		lua_pushvalue(L, idx);
+		lua_call(L, 1, 1);
+		res = lua_isnil(L, -1) ? 0 : encode_value(w, lua_gettop(L));
+		lua_pop(L, 1);
+		return res;
+	}
+	o = (octet*) luaL_testudata(L, idx, "zenroom.octet");
+	if(o) {
+		if(!o->len) return 0;
+		encode_octet(w, o);
+		return 1;
+	}
+	lua_getfield(L, idx, "octet");
+	lua_pushvalue(L, idx);
+	lua_call(L, 1, 1);
+	o = (octet*) luaL_testudata(L, -1, "zenroom.octet");
+	if(!o) return luaL_error(L, "JSON encode: octet conversion failed");
+	if(o->len) encode_octet(w, o);
+	else res = 0;
+	lua_pop(L, 1);
+	return res;
+}
+
+typedef struct {
+	const char *s;
+	size_t len;
+	lua_Integer pos; // position of the value in the pairs table
+} json_key;
+
+// string comparison of Lua's table.sort with the C locale
+static int json_keycmp(const void *a, const void *b) {
+	const json_key *ka = a, *kb = b;
+	int r = memcmp(ka->s, kb->s, ka->len < kb->len ? ka->len : kb->len);
+	if(r) return r;
+	return (ka->len > kb->len) - (ka->len < kb->len);
+}
+
+static void encode_array(json_writer *w, int idx) {
+	lua_State *L = w->L;
+	lua_Integer i, n = 0, len = luaL_len(L, idx);
+	int hole = 0;
+	lua_pushnil(L);
+	while(lua_next(L, idx)) {
+		if(lua_type(L, -2) != LUA_TNUMBER)
+			luaL_error(L, "invalid table: mixed or invalid key types");
+		n++;
+		lua_pop(L, 1);
+	}
+	if(n != len)
+		luaL_error(L, "invalid table: sparse array (n=%I, #val=%I)", n, len);
+	json_putc(w, '[');
+	for(i=1; i<=n; i++) {
+		size_t mark = w->len;
+		if(i>1) json_putc(w, ',');
+		lua_rawgeti(L, idx, i);
+		// elements converted to nil are dropped only at the end
+		if(encode_value(w, lua_gettop(L))) {
+			if(hole) luaL_error(L, "invalid table: sparse array");
+		} else {
+			w->len = mark;
+			hole = 1;
+		}
+		lua_pop(L, 1);
+	}
+	json_putc(w, ']');
+}
+
+static void encode_object(json_writer *w, int idx) {
+	lua_State *L = w->L;
+	lua_Integer i, n = 0;
+	json_key *keys;
+	int pairs, first = 1;
+	lua_pushnil(L);
+	while(lua_next(L, idx)) { n++; lua_pop(L, 1); }
+	keys = lua_newuserdata(L, n * sizeof(json_key));
+	// keys and values are anchored in a sequence while sorting
+	lua_createtable(L, n<<1, 0);
+	pairs = lua_gettop(L);
+	i = 0;
+	lua_pushnil(L);
+	while(lua_next(L, idx)) {
+		if(lua_type(L, -2) != LUA_TSTRING)
+			luaL_error(L, "invalid table: mixed or invalid key types");
+		lua_rawseti(L, pairs, (i<<1)+2);
+		lua_pushvalue(L, -1);
+		lua_rawseti(L, pairs, (i<<1)+1);
+		keys[i].s = lua_tolstring(L, -1, &keys[i].len);
+		keys[i].pos = (i<<1)+2;
+		i++;
+	}
+	qsort(keys, n, sizeof(json_key), json_keycmp);
+	json_putc(w, '{');
+	for(i=0; i<n; i++) {
+		size_t mark = w->len;
+		if(!first) json_putc(w, ',');
+		encode_string(w, keys[i].s, keys[i].len);
+		json_putc(w, ':');
+		lua_rawgeti(L, pairs, keys[i].pos);
+		if(encode_value(w, lua_gettop(L))) first = 0;
+		else w->len = mark; // value converted to nil
+		lua_pop(L, 1);
+	}
+	json_putc(w, '}');
+	lua_pop(L, 2);
+}
+
+static void encode_table(json_writer *w, int idx) {
+	lua_State *L = w->L;
+	int array;
+	if(++w->depth > JSON_MAX_DEPTH)
+		luaL_error(L, "JSON encode: too many nested levels");
+	luaL_checkstack(L, 8, "JSON nesting");
+	lua_pushvalue(L, idx);
+	if(lua_rawget(L, JSON_STACK) != LUA_TNIL)
+		luaL_error(L, "circular reference");
+	lua_pop(L, 1);
+	lua_pushvalue(L, idx);
+	lua_pushboolean(L, 1);
+	lua_rawset(L, JSON_STACK);
+	array = (lua_rawgeti(L, idx, 1) != LUA_TNIL);
+	lua_pop(L, 1);
+	if(!array) {
+		lua_pushnil(L);
+		if(lua_next(L, idx)) lua_pop(L, 2);
+		else array = 1; // empty table
+	}
+	if(array) encode_array(w, idx);
+	else encode_object(w, idx);
+	lua_pushvalue(L, idx);
+	lua_pushnil(L);
+	lua_rawset(L, JSON_STACK);
+	w->depth--;
+}
+
+static int encode_value(json_writer *w, int idx) {
+	lua_State *L = w->L;
+	size_t len;
+	const char *s;
+	switch(lua_type(L, idx)) {
+	case LUA_TNIL:
+		json_put(w, "null", 4);
+		break;
+	case LUA_TBOOLEAN:
+		if(lua_toboolean(L, idx)) json_put(w, "true", 4);
+		else json_put(w, "false", 5);
+		break;
+	case LUA_TNUMBER:
+		// same format of tostring()
+		lua_pushvalue(L, idx);
+		s = lua_tolstring(L, -1, &len);
+		json_put(w, s, len);
+		lua_pop(L, 1);
+		break;
+	case LUA_TSTRING:
+		s = lua_tolstring(L, idx, &len);
+		encode_string(w, s, len);
+		break;
+	case LUA_TTABLE:
+		encode_table(w, idx);
+		break;
+	case LUA_TFUNCTION:
+		// address as printed by tostring()
+		s = lua_pushfstring(L, "\"%p\"", lua_topointer(L, idx));
+		json_put(w, s, strlen(s));
+		lua_pop(L, 1);
+		break;
+	case LUA_TUSERDATA:
+		return encode_zen(w, idx);
+	default:
+		luaL_error(L, "unexpected type '%s'", luaL_typename(L, idx));
+	}
+	return 1;
+}
+
+// sets up the stack and the writer for json_encode and json_print
+static void json_writer_init(lua_State *L, json_writer *w) {
+	luaL_checkany(L, 1);
+	lua_settop(L, 2);
+	w->L = L;
+	w->buf = NULL;
+	w->len = 0;
+	w->cap = 0;
+	w->depth = 0;
+	w->enc = JSON_ENC_LUA;
+	if(lua_type(L, 2) == LUA_TSTRING) {
+		const char *enc = lua_tostring(L, 2);
+		if(strcmp(enc, "base64") == 0) w->enc = JSON_ENC_BASE64;
+		else if(strcmp(enc, "url64") == 0) w->enc = JSON_ENC_URL64;
+		else if(strcmp(enc, "hex") == 0) w->enc = JSON_ENC_HEX;
+		else if(strcmp(enc, "string") == 0) w->enc = JSON_ENC_STRING;
+	} else if(!lua_isfunction(L, 2))
+		luaL_error(L, "JSON encode: invalid encoding argument");
+	lua_newtable(L);                      // JSON_STACK
+	lua_pushnil(L);                       // JSON_BOX
+	if(lua_isfunction(L, 2)) lua_pushvalue(L, 2);
+	else lua_pushnil(L);                  // JSON_CONV
+}
+
+/*
+  Encodes a value to a JSON string. Zenroom values found are
+  converted to the encoding named in the second argument (the same
+  names of guess_outcast) or by the function passed as second
+  argument. Keys of objects are always sorted.
+*/
+static int lua_json_encode(lua_State *L) {
+	json_writer w;
+	json_writer_init(L, &w);
+	encode_value(&w, 1);
+	lua_pushlstring(L, w.buf ? w.buf : "", w.len);
+	return 1;
+}
+
+/*
+  Prints a value encoded as in json_encode followed by a newline. The
+  JSON is built in the encoder's own buffer and written out at once
+  when complete: nothing is printed when encoding fails.
+*/
+static int lua_json_print(lua_State *L) {
+	json_writer w;
+	json_writer_init(L, &w);
+	encode_value(&w, 1);
+	json_putc(&w, '\n');
+	zen_write_out_bytes(L, w.buf, w.len);
+	return 0;
+}
+
+void zen_add_json(lua_State *L) {
+	static const struct luaL_Reg json_funcs [] =
+		{ {"json_decode", lua_json_decode},
+		  {"json_encode", lua_json_encode},
+		  {"json_print", lua_json_print},
+		  {NULL, NULL} };
+	lua_getglobal(L, "_G");
+	luaL_setfuncs(L, json_funcs, 0);
+	lua_pop(L, 1);
+}
@@ -0,0 +1,366 @@
+/* This file is part of Zenroom (https://zenroom.dyne.org)
+ *
+ * Copyright (C) 2017-2022 Dyne.org foundation
+ * designed, written and maintained by Denis Roio <jaromil@dyne.org>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ */
+
+// Shamir secret sharing over the prime P = 2^256 - 189, used by
+// crypto_lagrange_interpolation.lua. The BIG numbers of zenroom are
+// sized for the curve and reduce by any other modulus one bit at a
+// time, so the arithmetic here is done on 8 words of 32 bits, using
+// 2^256 = 189 (mod P) to reduce products. Shares are evaluated with
+// Horner's rule and the Lagrange coefficients share a single
+// inversion (Montgomery's trick).
+//
+// Random numbers are drawn from the generator of the context in the
+// same order as the former Lua implementation, so a seeded context
+// creates the same shares.
+
+#include <stdint.h>
+#include <string.h>
+
+#include <zenroom.h>
+#include <zen_error.h>
+
+#include <lua.h>
+#include <lualib.h>
+#include <lauxlib.h>
+
+#include <lua_functions.h>
+#include <zen_octet.h>
+#include <zen_big.h>
+
+#define FE_WORDS 8
+// P = 2^256 - FE_C
+#define FE_C 189
+
+typedef uint32_t fe[FE_WORDS]; // little endian words
+
+static const fe fe_p = {
+	0xffffff43, 0xffffffff, 0xffffffff, 0xffffffff,
+	0xffffffff, 0xffffffff, 0xffffffff, 0xffffffff };
+
+static inline int fe_iszero(const fe a) {
+	uint32_t r = 0;
+	int i;
+	for(i=0; i<FE_WORDS; i++) r |= a[i];
+	return r == 0;
+}
+
+static inline int fe_geq_p(const fe a) {
+	int i;
+	for(i=FE_WORDS-1; i>0; i--) if(a[i] != 0xffffffff) return 0;
+	return a[0] >= fe_p[0];
+}
+
+// r = a + c, dropping the carry out of 2^256 which is returned
+static inline uint32_t fe_add_small(fe r, const fe a, uint64_t c) {
+	int i;
+	for(i=0; i<FE_WORDS; i++) {
+		c += a[i];
+		r[i] = (uint32_t)c;
+		c >>= 32;
+	}
+	return (uint32_t)c;
+}
+
+static inline void fe_add(fe r, const fe a, const fe b) {
+	uint64_t c = 0;
+	int i;
+	for(i=0; i<FE_WORDS; i++) {
+		c += (uint64_t)a[i] + b[i];
+		r[i] = (uint32_t)c;
+		c >>= 32;
+	}
+	// subtracting P is adding FE_C modulo 2^256
+	if(c || fe_geq_p(r)) fe_add_small(r, r, FE_C);
+}
+
+static inline void fe_sub(fe r, const fe a, const fe b) {
+	uint64_t t;
+	uint32_t borrow = 0;
+	int i;
+	for(i=0; i<FE_WORDS; i++) {
+		t = (uint64_t)a[i] - b[i] - borrow;
+		r[i] = (uint32_t)t;
+		borrow = (uint32_t)(t >> 63);
+	}
+	// adding P is subtracting FE_C modulo 2^256, which cannot borrow
+	// again since the result is at least 2^256 - P + 1
+	if(borrow) {
+		borrow = FE_C;
+		for(i=0; i<FE_WORDS; i++) {
+			t = (uint64_t)r[i] - borrow;
+			r[i] = (uint32_t)t;
+			borrow = (uint32_t)(t >> 63);
+		}
+	}
+}
+
+// r = t mod P, for t of 512 bits
+static inline void fe_reduce(fe r, const uint32_t t[2*FE_WORDS]) {
+	uint64_t c = 0;
+	int i;
+	// low + high * 2^256 = low + high * FE_C
+
+	for(i=0; i<FE_WORDS; i++) {
+		c += (uint64_t)t[i+FE_WORDS] * FE_C + t[i];
+		r[i] = (uint32_t)c;
+		c >>= 32;
+	}
+	// the overflow is less than 2^9, folding it once more may carry
+	// only when the result is small, then a last fold cannot
+	if(fe_add_small(r, r, c * FE_C)) fe_add_small(r, r, FE_C);
+	if(fe_geq_p(r)) fe_add_small(r, r, FE_C);
+}
+
+static void fe_mul(fe r, const fe a, const fe b) {
+	uint32_t t[2*FE_WORDS];
+	uint64_t c;
+	int i, j;
+	memset(t, 0, sizeof(t));
+	for(i=0; i<FE_WORDS; i++) {
+		c = 0;
+		for(j=0; j<FE_WORDS; j++) {
+			c += (uint64_t)a[i] * b[j] + t[i+j];
+			t[i+j] = (uint32_t)c;
+			c >>= 32;
+		}
+		t[i+FE_WORDS] = (uint32_t)c;
+	}
+	fe_reduce(r, t);
+}
+
+// r = a^(P-2) = 1/a, zero stays zero
+static void fe_inv(fe r, const fe a) {
+	fe e, x;
+	int i, b;
+	memcpy(e, fe_p, sizeof(fe));
+	e[0] -= 2;
+	memcpy(x, a, sizeof(fe));
+	memset(r, 0, sizeof(fe));
+	r[0] = 1;
+	for(i=FE_WORDS*32-1; i>=0; i--) {
+		fe_mul(r, r, r);
+		b = (e[i>>5] >> (i & 31)) & 1;
+		if(b) fe_mul(r, r, x);
+	}
+}
+
+// conversions from and to BIG numbers, through their big endian bytes
+static void fe_from_big(lua_State *L, fe r, big *b) {
+	char bytes[MODBYTES];
+	int i;
+	if(b->doublesize) lerror(L, "Lagrange interpolation: double BIG number");
+	BIG_toBytes(bytes, b->val);
+	for(i=0; i < MODBYTES - 4*FE_WORDS; i++)
+		if(bytes[i]) lerror(L, "Lagrange interpolation: number exceeds 256 bits");
+	for(i=0; i<FE_WORDS; i++) {
+		const unsigned char *p =
+			(const unsigned char*)bytes + MODBYTES - 4*(i+1);
+		r[i] = (uint32_t)p[0] << 24 | (uint32_t)p[1] << 16
+			| (uint32_t)p[2] << 8 | p[3];
+	}
+	if(fe_geq_p(r)) fe_add_small(r, r, FE_C);
+}
+
+static void fe_push_big(lua_State *L, const fe a) {
+	char bytes[MODBYTES];
+	big *b;
+	int i;
+	memset(bytes, 0, MODBYTES);
+	for(i=0; i<FE_WORDS; i++) {
+		unsigned char *p = (unsigned char*)bytes + MODBYTES - 4*(i+1);
+		p[0] = a[i] >> 24; p[1] = a[i] >> 16; p[2] = a[i] >> 8; p[3] = a[i];
+	}
+	b = big_new(L); SAFE(b);
+	big_init(b);
+	BIG_fromBytesLen(b->val, bytes, MODBYTES);
+}
+
+// random number modulo P, drawn as BIG_randomnum does it: 512 bits
+// taken from each byte of the generator starting from its lowest bit,
+// the first being the most significant, then reduced by P
+static void fe_random(lua_State *L, fe r) {
+	uint32_t t[2*FE_WORDS];
+	unsigned char b;
+	int i, k;
+	Z(L);
+	memset(t, 0, sizeof(t));
+	for(i=2*FE_WORDS-1; i>=0; i--) {
+		for(k=3; k>=0; k--) {
+			b = (unsigned char)RAND_byte(Z->random_generator);
+			// reverse the bits of the byte
+			b = (b & 0xf0) >> 4 | (b & 0x0f) << 4;
+			b = (b & 0xcc) >> 2 | (b & 0x33) << 2;
+			b = (b & 0xaa) >> 1 | (b & 0x55) << 1;
+			t[i] |= (uint32_t)b << (8*k);
+		}
+	}
+	fe_reduce(r, t);
+}
+
+// scratch memory is a userdata pushed on the stack, so that it is
+// collected also when an argument raises an error
+static void *lag_alloc(lua_State *L, size_t size) {
+	void *r = lua_newuserdata(L, size ? size : 1);
+	if(!r) lerror(L, "Error allocating %u bytes in %s", (unsigned)size, __func__);
+	return r;
+}
+
+/***
+    Splits a secret in shares, any quorum of which recomposes it: the
+    shares are points of a random polynomial of degree quorum-1 whose
+    constant term is the secret.
+
+    @function LAG.create(total, quorum, secret)
+    @param total number of shares
+    @param quorum number of shares needed to recompose the secret
+    @param secret optional BIG smaller than 2^256, random if nil
+    @return table of shares { x = BIG, y = BIG } and the secret
+*/
+static int lag_create(lua_State *L) {
+	lua_Integer total = luaL_checkinteger(L, 1);
+	lua_Integer quorum = luaL_checkinteger(L, 2);
+	lua_Integer i, k;
+	fe *coeff, *xs, y;
+	uint32_t *index, mask, h, e;
+	luaL_argcheck(L, quorum > 0, 2, "quorum must be positive");
+	luaL_argcheck(L, total >= quorum, 1, "total must not be smaller than quorum");
+	if(lua_isnoneornil(L, 3)) fe_random(L, y);
+	else fe_from_big(L, y, big_arg(L, 3));
+	lua_settop(L, 2);
+	coeff = (fe*)lag_alloc(L, quorum * sizeof(fe));
+	memcpy(coeff[0], y, sizeof(fe));
+	for(i=1; i<quorum; i++) fe_random(L, coeff[i]);
+	// x coordinates are never zero nor repeated: the index is an
+	// open addressing table of their lowest word
+	for(mask=1; mask < 2*(uint64_t)total; mask <<= 1);
+	mask--;
+	xs = (fe*)lag_alloc(L, total * sizeof(fe));
+	index = (uint32_t*)lag_alloc(L, (mask + 1) * sizeof(uint32_t));
+	memset(index, 0, (mask + 1) * sizeof(uint32_t));
+	lua_createtable(L, (int)total, 0);
+	for(i=0; i<total; i++) {
+		for(;;) {
+			fe_random(L, xs[i]);
+			if(fe_iszero(xs[i])) continue;
+			for(h = xs[i][0] & mask; (e = index[h]); h = (h+1) & mask)
+				if(memcmp(xs[e-1], xs[i], sizeof(fe)) == 0) break;
+			if(!e) break;
+		}
+		index[h] = (uint32_t)i + 1;
+		memcpy(y, coeff[quorum-1], sizeof(fe));
+		for(k=quorum-2; k>=0; k--) {
+			fe_mul(y, y, xs[i]);
+			fe_add(y, y, coeff[k]);
+		}
+		lua_createtable(L, 0, 2);
+		fe_push_big(L, xs[i]);
+		lua_setfield(L, -2, "x");
+		fe_push_big(L, y);
+		lua_setfield(L, -2, "y");
+		lua_rawseti(L, -2, i+1);
+	}
+	fe_push_big(L, coeff[0]);
+	// overwrite the polynomial for secure disposal
+	memset(coeff, 0, quorum * sizeof(fe));
+	memset(y, 0, sizeof(fe));
+	return 2;
+}
+
+/***
+    Recomposes the secret from a quorum of shares, by Lagrange
+    interpolation of their polynomial at zero.
+
+    @function LAG.compose(shares)
+    @param shares array of { x = BIG, y = BIG }
+    @return the secret as BIG
+*/
+static int lag_compose(lua_State *L) {
+	lua_Integer n, i, j;
+	fe *xs, *ys, *num, *den, *acc, t, sec;
+	luaL_checktype(L, 1, LUA_TTABLE);
+	n = luaL_len(L, 1);
+	xs = (fe*)lag_alloc(L, 5 * n * sizeof(fe));
+	ys = xs + n; num = ys + n; den = num + n; acc = den + n;
+	for(i=0; i<n; i++) {
+		if(lua_rawgeti(L, 1, i+1) != LUA_TTABLE)
+			lerror(L, "Lagrange interpolation: share %d is not a table", (int)i+1);
+		lua_getfield(L, -1, "x");
+		lua_getfield(L, -2, "y");
+		fe_from_big(L, xs[i], big_arg(L, -2));
+		fe_from_big(L, ys[i], big_arg(L, -1));
+		lua_pop(L, 3);
+	}
+	// the numerator of each coefficient is the product of all -x
+	// but its own, from prefix and suffix products
+	memset(t, 0, sizeof(fe)); t[0] = 1;
+	for(i=0; i<n; i++) {
+		memcpy(num[i], t, sizeof(fe));
+		fe_sub(sec, fe_p, xs[i]); // -x, sec used as scratch
+		fe_mul(t, t, sec);
+	}
+	memset(t, 0, sizeof(fe)); t[0] = 1;
+	for(i=n-1; i>=0; i--) {
+		fe_mul(num[i], num[i], t);
+		fe_sub(sec, fe_p, xs[i]);
+		fe_mul(t, t, sec);
+	}
+	for(i=0; i<n; i++) {
+		memset(den[i], 0, sizeof(fe)); den[i][0] = 1;
+		for(j=0; j<n; j++) {
+			if(j == i) continue;
+			fe_sub(t, xs[i], xs[j]);
+			fe_mul(den[i], den[i], t);
+		}
+	}
+	// invert all the denominators with a single inversion
+	memset(t, 0, sizeof(fe)); t[0] = 1;
+	for(i=0; i<n; i++) {
+		memcpy(acc[i], t, sizeof(fe));
+		fe_mul(t, t, den[i]);
+	}
+	if(n && fe_iszero(t))
+		lerror(L, "Lagrange interpolation: shares with the same x");
+	fe_inv(t, t);
+	memset(sec, 0, sizeof(fe));
+	for(i=n-1; i>=0; i--) {
+		fe inv;
+		fe_mul(inv, t, acc[i]); // 1 / den[i]
+		fe_mul(t, t, den[i]);
+		fe_mul(inv, inv, num[i]);
+		fe_mul(inv, inv, ys[i]);
+		fe_add(sec, sec, inv);
+	}
+	fe_push_big(L, sec);
+	return 1;
+}
+
+int luaopen_lagrange(lua_State *L) {
+	(void)L;
+	const struct luaL_Reg lagrange_class[] = {
+		{"create", lag_create},
+		{"compose", lag_compose},
+		{NULL,NULL}
+	};
+	const struct luaL_Reg lagrange_methods[] = {
+		{NULL,NULL}
+	};
+	zen_add_class(L, "lagrange", lagrange_class, lagrange_methods);
+	return 1;
+}
@@ -161,6 +161,77 @@ int is_bin(const char *in) {
 	return len; 
 }
 
+// character classes of encodings recognised by encoding_scan
+#define ENC_URL64  0x01
+#define ENC_BASE64 0x02
+#define ENC_BASE58 0x04
+#define ENC_HEX    0x08
+#define ENC_BIN    0x10
+static const uint8_t enc_class[256] = {
+	 0,  0,  0,  0,  0,  0,  0,  0,  0, 16, 16, 16, 16, 16,  0,  0,
+	 0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,
+	16,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  2,  0,  1,  0,  3,
+	27, 31, 15, 15, 15, 15, 15, 15, 15, 15,  0,  0,  0,  2,  0,  0,
+	 0, 15, 15, 15, 15, 15, 15,  7,  7,  3,  7,  7,  7,  7,  7,  3,
+	 7,  7,  7,  7,  7,  7,  7,  7,  7,  7,  7,  0,  0,  0,  0,  1,
+	 0, 15, 15, 15, 15, 15, 15,  7,  7,  7,  7,  7,  3,  7,  7,  7,
+	 7,  7,  7,  7,  7,  7,  7,  7,  7,  7,  7,  0,  0,  0,  0,  0,
+	 0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,
+	 0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,
+	 0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,
+	 0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,
+	 0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,
+	 0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,
+	 0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,
+	 0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,
+};
+
+// order of preference when more encodings are valid, same as the
+// sequence of checks done by str() in zenroom_octet.lua
+static const struct { int flag; const char *name; } enc_order[] = {
+	{ENC_URL64, "url64"}, {ENC_BASE64, "base64"}, {ENC_BASE58, "base58"},
+	{ENC_HEX, "hex"}, {ENC_BIN, "bin"}, {0, NULL} };
+
+// scans the string once and returns the set of ENC_* flags of the
+// encodings it is valid for, with the same length rules of the is_*
+// functions. If 'bits' is not NULL it is set to the number of binary
+// digits found, to size the decoding of binary strings.
+static int encoding_scan(const char *in, size_t len, int *bits) {
+	register const uint8_t *p = (const uint8_t*)in;
+	register const uint8_t *end = p + len;
+	register uint8_t set = 0x1f;
+	int pads = 0, nb = 0;
+	for(; p<end && set; p++) {
+		set &= enc_class[*p];
+		nb += (*p == '0' || *p == '1');
+	}
+	if(set & ENC_BASE64) {
+		// padding only at the end
+		while(pads < 2 && pads < (int)len && in[len-1-pads] == '=') pads++;
+		if(len < 4 || len%4 || memchr(in, '=', len-pads)) set &= ~ENC_BASE64;
+	}
+	if(len < 3) set &= ~ENC_URL64;
+	if(!len) set = 0;
+	if(bits) *bits = nb;
+	return set;
+}
+
+// length of the octet decoded from a string of the encoding, for
+// base58 this is the maximum length
+static int encoding_decoded_len(int enc, const char *in, size_t len, int bits) {
+	int pads = 0;
+	switch(enc) {
+	case ENC_URL64: return (len>>2)*3 + ((len&3) > 1 ? (len&3)-1 : 0);
+	case ENC_BASE64:
+		while(pads < 2 && in[len-1-pads] == '=') pads++;
+		return (len>>2)*3 - pads;
+	case ENC_BASE58: return B64decoded_len(len);
+	case ENC_HEX: return len>>1;
+	case ENC_BIN: return bits>>3;
+	}
+	return len;
+}
+
 // REMEMBER: newuserdata already pushes the object in lua's stack
 octet* o_new(lua_State *L, const int size) {
 	if(size<0) {
@@ -187,6 +258,42 @@ octet* o_new(lua_State *L, const int size) {
 	return(o);
 }
 
+// the user value of octets made by o_borrow is a light userdata
+// pointing here: they are read-only and o_destroy does not free the
+// memory they point to
+static const char octet_borrowed = 0;
+
+// pushes a read-only octet pointing to memory owned by the caller,
+// without copying it: the buffer must stay unchanged while the octet
+// is used
+octet* o_borrow(lua_State *L, const char *buf, const int len) {
+	if(len<0 || len>MAX_OCTET) {
+		zerror(L, "Cannot borrow octet, invalid size: %i", len);
+		return NULL; }
+	octet *o = (octet *)lua_newuserdata(L, sizeof(octet));
+	if(!o) {
+		zerror(L, "Error allocating new userdata for octet");
+		return NULL; }
+	luaL_getmetatable(L, "zenroom.octet");
+	lua_setmetatable(L, -2);
+	lua_pushlightuserdata(L, (void*)&octet_borrowed);
+	lua_setuservalue(L, -2);
+	o->val = (char*)buf;
+	o->len = len;
+	o->max = len;
+	return(o);
+}
+
+// true if the value at n is an octet made by o_borrow
+int o_borrowed(lua_State *L, int n) {
+	int res;
+	if(lua_type(L, n) != LUA_TUSERDATA) return 0;
+	res = lua_getuservalue(L, n) == LUA_TLIGHTUSERDATA
+		&& lua_touserdata(L, -1) == (void*)&octet_borrowed;
+	lua_pop(L, 1);
+	return res;
+}
+
 // here most internal type conversions happen
 octet* o_arg(lua_State *L,int n) {
 	void *ud;
@@ -282,7 +389,8 @@ int o_destroy(lua_State *L) {
 	void *ud = luaL_testudata(L, 1, "zenroom.octet");
 	if(ud) {
 		octet *o = (octet*)ud;
-		if(o->val) zen_memory_free(o->val);
+		if(o->val && !o_borrowed(L, 1))
+			zen_memory_free(o->val);
 	}
 	return 0;
 }
@@ -318,6 +426,9 @@ static int newoctet (lua_State *L) {
 
 static int filloctet(lua_State *L) {
 	int i;
+	if(o_borrowed(L, 1)) {
+		lerror(L, "Cannot fill a read-only octet");
+		return 0; }
 	octet *o = o_arg(L,1); SAFE(o);
 	octet *fill = o_arg(L,2); SAFE(fill);
 	for(i=0; i<o->max; i++)
@@ -481,13 +592,8 @@ static int from_url64(lua_State *L) {
 	return 1;
 }
 
-static int from_base58(lua_State *L) {
-	const char *s = lua_tostring(L, 1);
-	luaL_argcheck(L, s != NULL, 1, "base58 string expected");
-	int len = is_base58(s);
-	if(!len) {
-		lerror(L, "base58 string contains invalid characters");
-		return 0; }
+// pushes the octet decoded from a valid base58 string
+static int base58_decode(lua_State *L, const char *s, int len) {
 	size_t binmax = B64decoded_len(len); //((len + 3) >> 2) *3;
 	char *tmp = zen_memory_alloc(binmax);
 	// size_t binmax = len + len + len;
@@ -506,6 +612,16 @@ static int from_base58(lua_State *L) {
 	return 1;
 }
 
+static int from_base58(lua_State *L) {
+	const char *s = lua_tostring(L, 1);
+	luaL_argcheck(L, s != NULL, 1, "base58 string expected");
+	int len = is_base58(s);
+	if(!len) {
+		lerror(L, "base58 string contains invalid characters");
+		return 0; }
+	return base58_decode(L, s, len);
+}
+
 static int from_string(lua_State *L) {
 	const char *s = lua_tostring(L, 1);
 	luaL_argcheck(L, s != NULL, 1, "string expected");
@@ -559,14 +675,8 @@ static int from_hex(lua_State *L) {
 
 // I'm quite happy about this: its fast and secure. It can just be
 // made more elegant.
-static int from_bin(lua_State *L) {
-	const char *s = lua_tostring(L, 1);
-	luaL_argcheck(L, s != NULL, 1, "binary string sequence expected");
-	const int len = is_bin(s);
-	if(!len || len>MAX_FILE) {
-		zerror(L, "invalid binary sequence size: %u", len);
-		lerror(L, "operation aborted");
-		return 0; }
+// pushes the octet decoded from a valid binary string of 'len' chars
+static int bin_decode(lua_State *L, const char *s, int len) {
 	octet *o = o_new(L, len+4); // destination
 	register char *S = (char*)s;
 	register int p; // position in whole string
@@ -594,6 +704,100 @@ static int from_bin(lua_State *L) {
 	return 1;
 }
 
+static int from_bin(lua_State *L) {
+	const char *s = lua_tostring(L, 1);
+	luaL_argcheck(L, s != NULL, 1, "binary string sequence expected");
+	const int len = is_bin(s);
+	if(!len || len>MAX_FILE) {
+		zerror(L, "invalid binary sequence size: %u", len);
+		lerror(L, "operation aborted");
+		return 0; }
+	return bin_decode(L, s, len);
+}
+
+/***
+Lists the encodings a string is valid for, scanning it only once.
+
+The encodings are listed in the order of preference used by @{from_auto}.
+
+    @function OCTET.encodings(string)
+    @return array of encoding names, or nil if none
+    @return length in bytes of the octet decoded with the first encoding
+*/
+static int lua_encodings(lua_State *L) {
+	size_t len;
+	const char *s = luaL_checklstring(L, 1, &len);
+	int bits, i, n = 0, first = 0;
+	int set = encoding_scan(s, len, &bits);
+	if(!set) { lua_pushnil(L); return 1; }
+	lua_newtable(L);
+	for(i=0; enc_order[i].flag; i++) {
+		if(!(set & enc_order[i].flag)) continue;
+		if(!first) first = enc_order[i].flag;
+		lua_pushstring(L, enc_order[i].name);
+		lua_rawseti(L, -2, ++n);
+	}
+	lua_pushinteger(L, encoding_decoded_len(first, s, len, bits));
+	return 2;
+}
+
+/***
+Imports a string of unknown encoding into an octet.
+
+The string is scanned once to detect its encoding among url64,
+base64, base58, hex and binary, in this order of preference, then
+decoded. Strings not matching any encoding are imported as they are.
+
+    @function OCTET.from_auto(string)
+    @return octet decoded from the string
+    @return name of the encoding detected
+*/
+static int from_auto(lua_State *L) {
+	size_t len;
+	const char *s = luaL_checklstring(L, 1, &len);
+	int bits, i, enc = 0;
+	int set = encoding_scan(s, len, &bits);
+	octet *o;
+	for(i=0; enc_order[i].flag; i++)
+		if(set & enc_order[i].flag) { enc = enc_order[i].flag; break; }
+	if(len > (enc == ENC_BIN ? MAX_FILE : MAX_OCTET<<1)) {
+		zerror(L, "%s: invalid string size: %u", __func__, len);
+		lerror(L, "operation aborted");
+		return 0; }
+	switch(enc) {
+	case ENC_URL64:
+		o = o_new(L, encoding_decoded_len(enc, s, len, bits)+1); SAFE(o);
+		o->len = U64decode(o->val, s);
+		break;
+	case ENC_BASE64:
+		o = o_new(L, encoding_decoded_len(enc, s, len, bits)); SAFE(o);
+		OCT_frombase64(o, (char*)s);
+		break;
+	case ENC_BASE58:
+		base58_decode(L, s, len);
+		break;
+	case ENC_HEX:
+		o = o_new(L, (len+1)>>1); SAFE(o);
+		o->len = hex2buf(o->val, s);
+		break;
+	case ENC_BIN:
+		bin_decode(L, s, len);
+		break;
+	default:
+		if(len > MAX_OCTET) {
+			zerror(L, "%s: invalid string size: %u", __func__, len);
+			lerror(L, "operation aborted");
+			return 0; }
+		o = o_new(L, len); SAFE(o);
+		memcpy(o->val, s, len);
+		o->len = len;
+		lua_pushstring(L, "string");
+		return 2;
+	}
+	lua_pushstring(L, enc_order[i].name);
+	return 2;
+}
+
 /*
   In the bitcoin world, addresses are the hash of the public key (binary data).
   However, the user usually knows them in some encoded form (which also include
@@ -1354,6 +1558,8 @@ int luaopen_octet(lua_State *L) {
 		{"from_hex",   from_hex},
 		{"from_bin",   from_bin},
 		{"from_mnemonic",   from_mnemonic},
+		{"from_auto", from_auto},
+		{"encodings", lua_encodings},
 		{"base64",from_base64},
 		{"url64",from_url64},
 		{"base58",from_base58},
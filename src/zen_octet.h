@@ -28,6 +28,11 @@ octet* o_new(lua_State *L, const int size);
 
 octet *o_dup(lua_State *L, octet *o);
 
+// pushes a read-only octet using the caller's buffer, returns NULL
+// on error; o_borrowed tells if the value at n is one of them
+octet* o_borrow(lua_State *L, const char *buf, const int len);
+int o_borrowed(lua_State *L, int n);
+
 octet* o_arg(lua_State *L,int n);
 
 void push_octet_to_hex_string(lua_State *L, octet *o);
@@ -0,0 +1,525 @@
+/* This file is part of Zenroom (https://zenroom.dyne.org)
+ *
+ * Copyright (C) 2017-2022 Dyne.org foundation
+ * designed, written and maintained by Denis Roio <jaromil@dyne.org>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ */
+
+// Set of octets compared by their content, created by OCTET.set(),
+// and map from octets to any value, created by OCTET.map(): Lua
+// tables can only key octets by identity, so the alternative is to
+// convert each of them to a string. Elements are copied in an arena
+// and found through an open addressing index of their hashes, they
+// are kept in order of insertion. The values of a map are in a table
+// bound to it, at the position of their key.
+//
+// Elements may come from the input of a script, so they are hashed
+// with SipHash-2-4 keyed by bytes of the random pool of the context
+// (runtime_random256): colliding elements cannot be chosen without
+// knowing it, and the random sequence seen by scripts is not changed.
+
+#include <stdint.h>
+#include <string.h>
+
+#include <zenroom.h>
+#include <zen_error.h>
+
+#include <lua.h>
+#include <lualib.h>
+#include <lauxlib.h>
+
+#include <lua_functions.h>
+#include <zen_octet.h>
+#include <zen_memory.h>
+
+typedef struct {
+	uint64_t hash;
+	uint32_t off; // position of the bytes in the arena
+	uint32_t len;
+} set_entry;
+
+typedef struct {
+	uint64_t k0, k1;  // SipHash key
+	uint32_t count;
+	uint32_t size;    // allocated entries
+	uint32_t mask;    // slots in the index - 1
+	uint32_t *index;  // number of the entry + 1, 0 when free
+	set_entry *entry;
+	char *arena;
+	size_t used;
+	size_t cap;
+} octet_set;
+
+#define SIP_ROTL(x,b) (uint64_t)(((x) << (b)) | ((x) >> (64 - (b))))
+#define SIP_ROUND { \
+		v0 += v1; v1 = SIP_ROTL(v1,13); v1 ^= v0; v0 = SIP_ROTL(v0,32); \
+		v2 += v3; v3 = SIP_ROTL(v3,16); v3 ^= v2; \
+		v0 += v3; v3 = SIP_ROTL(v3,21); v3 ^= v0; \
+		v2 += v1; v1 = SIP_ROTL(v1,17); v1 ^= v2; v2 = SIP_ROTL(v2,32); }
+
+static inline uint64_t sip_u64(const unsigned char *p) {
+	return (uint64_t)p[0] | (uint64_t)p[1] << 8 | (uint64_t)p[2] << 16
+		| (uint64_t)p[3] << 24 | (uint64_t)p[4] << 32 | (uint64_t)p[5] << 40
+		| (uint64_t)p[6] << 48 | (uint64_t)p[7] << 56;
+}
+
+static uint64_t set_hash(const octet_set *s, const char *k, size_t len) {
+	const unsigned char *p = (const unsigned char*)k;
+	const unsigned char *end = p + (len & ~(size_t)7);
+	uint64_t v0 = s->k0 ^ 0x736f6d6570736575ULL;
+	uint64_t v1 = s->k1 ^ 0x646f72616e646f6dULL;
+	uint64_t v2 = s->k0 ^ 0x6c7967656e657261ULL;
+	uint64_t v3 = s->k1 ^ 0x7465646279746573ULL;
+	uint64_t m, b = (uint64_t)len << 56;
+	for(; p != end; p += 8) {
+		m = sip_u64(p);
+		v3 ^= m;
+		SIP_ROUND; SIP_ROUND;
+		v0 ^= m;
+	}
+	switch(len & 7) {
+	case 7: b |= (uint64_t)p[6] << 48; // fall through
+	case 6: b |= (uint64_t)p[5] << 40; // fall through
+	case 5: b |= (uint64_t)p[4] << 32; // fall through
+	case 4: b |= (uint64_t)p[3] << 24; // fall through
+	case 3: b |= (uint64_t)p[2] << 16; // fall through
+	case 2: b |= (uint64_t)p[1] << 8;  // fall through
+	case 1: b |= (uint64_t)p[0];
+	}
+	v3 ^= b;
+	SIP_ROUND; SIP_ROUND;
+	v0 ^= b;
+	v2 ^= 0xff;
+	SIP_ROUND; SIP_ROUND; SIP_ROUND; SIP_ROUND;
+	return v0 ^ v1 ^ v2 ^ v3;
+}
+
+static octet_set *set_arg(lua_State *L, int n) {
+	void *ud = luaL_testudata(L, n, "zenroom.octet_set");
+	if(!ud) ud = luaL_testudata(L, n, "zenroom.octet_map");
+	luaL_argcheck(L, ud != NULL, n, "octet set or map expected");
+	return (octet_set*)ud;
+}
+
+static octet_set *map_arg(lua_State *L, int n) {
+	void *ud = luaL_checkudata(L, n, "zenroom.octet_map");
+	luaL_argcheck(L, ud != NULL, n, "octet map expected");
+	return (octet_set*)ud;
+}
+
+// bytes of the value at idx: strings are taken as they are, all other
+// values are converted to octet
+static const char *set_key(lua_State *L, int idx, size_t *len) {
+	octet *o;
+	if(lua_type(L, idx) == LUA_TSTRING)
+		return lua_tolstring(L, idx, len);
+	o = o_arg(L, idx); SAFE(o);
+	*len = o->len;
+	return o->val;
+}
+
+// same as set_key, but NULL for the values not taken from tables:
+// with zen only zenroom values are, which are the only ones a
+// zenroom value can be equal to with ==, else also strings
+static const char *set_table_key(lua_State *L, int idx, size_t *len, int zen) {
+	int t = lua_type(L, idx);
+	if(t == LUA_TUSERDATA || (!zen && t == LUA_TSTRING))
+		return set_key(L, idx, len);
+	return NULL;
+}
+
+// number of the entry + 1 holding k, or 0, and in slot where it is
+// or should be placed
+static uint32_t set_find(octet_set *s, const char *k, size_t len,
+                         uint64_t hash, uint32_t *slot) {
+	uint32_t h = (uint32_t)hash & s->mask, e;
+	while((e = s->index[h])) {
+		set_entry *en = &s->entry[e-1];
+		if(en->hash == hash && en->len == len
+		   && memcmp(s->arena + en->off, k, len) == 0)
+			break;
+		h = (h+1) & s->mask;
+	}
+	*slot = h;
+	return e;
+}
+
+static void set_grow_index(lua_State *L, octet_set *s) {
+	uint32_t size = (s->mask + 1) << 1, i, h;
+	uint32_t *index = (uint32_t*)zen_memory_alloc(size * sizeof(uint32_t));
+	if(!index) lerror(L, "Error allocating octet set index in %s", __func__);
+	memset(index, 0, size * sizeof(uint32_t));
+	for(i=0; i<s->count; i++) {
+		h = (uint32_t)s->entry[i].hash & (size - 1);
+		while(index[h]) h = (h+1) & (size - 1);
+		index[h] = i + 1;
+	}
+	zen_memory_free(s->index);
+	s->index = index;
+	s->mask = size - 1;
+}
+
+// returns the number of the entry + 1 holding k, added is set to 1
+// if it was not already in the set
+static uint32_t set_insert(lua_State *L, octet_set *s, const char *k, size_t len,
+                           int *added) {
+	uint64_t hash = set_hash(s, k, len);
+	uint32_t slot, e;
+	set_entry *en;
+	*added = 0;
+	if((e = set_find(s, k, len, hash, &slot))) return e;
+	if((s->count + 1) * 2 > s->mask + 1) {
+		set_grow_index(L, s);
+		set_find(s, k, len, hash, &slot);
+	}
+	if(s->count == s->size) {
+		uint32_t size = s->size << 1;
+		en = (set_entry*)zen_memory_realloc(s->entry, size * sizeof(set_entry));
+		if(!en) lerror(L, "Error allocating octet set entries in %s", __func__);
+		s->entry = en;
+		s->size = size;
+	}
+	if(s->used + len > s->cap) {
+		size_t cap = s->cap << 1;
+		char *arena;
+		while(cap < s->used + len) cap <<= 1;
+		arena = (char*)zen_memory_realloc(s->arena, cap);
+		if(!arena) lerror(L, "Error allocating octet set arena in %s", __func__);
+		s->arena = arena;
+		s->cap = cap;
+	}
+	en = &s->entry[s->count];
+	en->hash = hash;
+	en->off = (uint32_t)s->used;
+	en->len = (uint32_t)len;
+	if(len) memcpy(s->arena + s->used, k, len);
+	s->used += len;
+	s->index[slot] = ++s->count;
+	*added = 1;
+	return s->count;
+}
+
+static uint32_t set_lookup(octet_set *s, const char *k, size_t len) {
+	uint32_t slot;
+	return set_find(s, k, len, set_hash(s, k, len), &slot);
+}
+
+// pushes a new empty set or map with room for n elements
+static octet_set *set_push(lua_State *L, const char *meta, lua_Integer n) {
+	octet_set *s = (octet_set*)lua_newuserdata(L, sizeof(octet_set));
+	if(!s) {
+		lerror(L, "Error allocating octet set in %s", __func__);
+		return NULL; }
+	memset(s, 0, sizeof(octet_set));
+	luaL_getmetatable(L, meta);
+	lua_setmetatable(L, -2);
+	s->size = 16;
+	s->mask = 31;
+	s->cap = 512;
+	while((lua_Integer)s->size < n) { s->size <<= 1; s->mask = (s->mask << 1) | 1; }
+	s->entry = (set_entry*)zen_memory_alloc(s->size * sizeof(set_entry));
+	s->index = (uint32_t*)zen_memory_alloc((s->mask + 1) * sizeof(uint32_t));
+	s->arena = zen_memory_alloc(s->cap);
+	if(!s->entry || !s->index || !s->arena) {
+		lerror(L, "Error allocating octet set in %s", __func__);
+		return NULL; }
+	memset(s->index, 0, (s->mask + 1) * sizeof(uint32_t));
+	Z(L);
+	if(Z) {
+		s->k0 = sip_u64((unsigned char*)Z->runtime_random256);
+		s->k1 = sip_u64((unsigned char*)Z->runtime_random256 + 8);
+	}
+	return s;
+}
+
+/***
+    Creates a set of octets, compared by their content. Strings are
+    taken as they are, other zenroom values are converted to octet.
+
+    @function OCTET.set(array, zen)
+    @param array optional table of elements to insert
+    @param zen if true only the zenroom values of the array are
+    inserted, the others (strings, numbers and tables) are skipped
+    @return a new set
+*/
+static int set_new(lua_State *L) {
+	octet_set *s;
+	lua_Integer i, n = 0;
+	const char *k;
+	size_t len;
+	int zen = lua_toboolean(L, 2), added;
+	if(!lua_isnoneornil(L, 1)) {
+		luaL_checktype(L, 1, LUA_TTABLE);
+		n = luaL_len(L, 1);
+	}
+	s = set_push(L, "zenroom.octet_set", n); SAFE(s);
+	for(i=1; i<=n; i++) {
+		lua_rawgeti(L, 1, i);
+		if(zen) k = set_table_key(L, lua_gettop(L), &len, 1);
+		else k = set_key(L, lua_gettop(L), &len);
+		if(k) set_insert(L, s, k, len, &added);
+		lua_pop(L, 1);
+	}
+	return 1;
+}
+
+/***
+    Creates a map from octets, compared by their content, to any
+    value. Strings are taken as they are, other zenroom values are
+    converted to octet.
+
+    @function OCTET.map(table)
+    @param table optional table whose pairs are copied in the map:
+    the keys that are not strings or zenroom values are skipped
+    @return a new map
+*/
+static int map_new(lua_State *L) {
+	octet_set *s;
+	const char *k;
+	size_t len;
+	uint32_t e;
+	int added;
+	if(!lua_isnoneornil(L, 1)) luaL_checktype(L, 1, LUA_TTABLE);
+	lua_settop(L, 1);
+	s = set_push(L, "zenroom.octet_map", 0); SAFE(s);
+	lua_newtable(L);
+	if(lua_istable(L, 1)) {
+		lua_pushnil(L);
+		while(lua_next(L, 1)) {
+			k = set_table_key(L, -2, &len, 0);
+			if(k) {
+				e = set_insert(L, s, k, len, &added);
+				lua_rawseti(L, 3, e);
+			} else lua_pop(L, 1);
+		}
+	}
+	lua_setuservalue(L, 2);
+	return 1;
+}
+
+/***
+    Finds the first element of an array equal by content to a zenroom
+    value, as the set would compare them, without building a set: for
+    a single search it is cheaper. Elements that are not zenroom values
+    (strings, numbers and tables) are skipped, since they are never
+    equal to one with ==.
+
+    @function OCTET.find(array, value)
+    @return the position of the element or nil if not found
+*/
+static int set_find_in(lua_State *L) {
+	lua_Integer i, n;
+	const char *v, *k;
+	size_t vlen, len;
+	char *copy;
+	int mt;
+	luaL_checktype(L, 1, LUA_TTABLE);
+	v = set_key(L, 2, &vlen);
+	// the octet converted from a value that is not one is not on
+	// the stack and may be collected while converting the elements
+	copy = lua_newuserdata(L, vlen ? vlen : 1);
+	if(vlen) memcpy(copy, v, vlen);
+	n = luaL_len(L, 1);
+	luaL_getmetatable(L, "zenroom.octet");
+	mt = lua_gettop(L);
+	for(i=1; i<=n; i++) {
+		// octets are checked against their metatable fetched once,
+		// the other values are converted
+		if(lua_rawgeti(L, 1, i) == LUA_TUSERDATA && lua_getmetatable(L, -1)) {
+			octet *o = lua_rawequal(L, -1, mt) ? (octet*)lua_touserdata(L, -2) : NULL;
+			lua_pop(L, 1);
+			if(o) {
+				k = o->val;
+				len = o->len;
+			} else k = set_table_key(L, lua_gettop(L), &len, 1);
+		} else k = set_table_key(L, lua_gettop(L), &len, 1);
+		if(k && len == vlen && memcmp(k, copy, len) == 0) {
+			lua_pushinteger(L, i);
+			return 1;
+		}
+		lua_pop(L, 1);
+	}
+	lua_pushnil(L);
+	return 1;
+}
+
+static int set_destroy(lua_State *L) {
+	octet_set *s = set_arg(L, 1);
+	zen_memory_free(s->entry);
+	zen_memory_free(s->index);
+	zen_memory_free(s->arena);
+	s->entry = NULL;
+	s->index = NULL;
+	s->arena = NULL;
+	s->count = 0;
+	return 0;
+}
+
+/***
+    Inserts an element in the set.
+
+    @function set:insert(element)
+    @return true if added, false if it was already in the set
+*/
+static int set_insert_lua(lua_State *L) {
+	octet_set *s = set_arg(L, 1);
+	size_t len;
+	int added;
+	const char *k = set_key(L, 2, &len);
+	set_insert(L, s, k, len, &added);
+	lua_pushboolean(L, added);
+	return 1;
+}
+
+/***
+    Checks if an element is in the set, or a key in the map.
+
+    @function set:contains(element)
+    @return true or false
+*/
+static int set_contains(lua_State *L) {
+	octet_set *s = set_arg(L, 1);
+	size_t len;
+	const char *k = set_key(L, 2, &len);
+	lua_pushboolean(L, set_lookup(s, k, len) != 0);
+	return 1;
+}
+
+/***
+    Sets the value of a key in the map.
+
+    @function map:put(key, value)
+    @return true if the key is new, false if its value is replaced
+*/
+static int map_put(lua_State *L) {
+	octet_set *s = map_arg(L, 1);
+	size_t len;
+	int added;
+	const char *k = set_key(L, 2, &len);
+	uint32_t e;
+	luaL_checkany(L, 3);
+	e = set_insert(L, s, k, len, &added);
+	lua_getuservalue(L, 1);
+	lua_pushvalue(L, 3);
+	lua_rawseti(L, -2, e);
+	lua_pushboolean(L, added);
+	return 1;
+}
+
+/***
+    Gets the value of a key in the map.
+
+    @function map:get(key)
+    @return the value or nil if the key is not in the map
+*/
+static int map_get(lua_State *L) {
+	octet_set *s = map_arg(L, 1);
+	size_t len;
+	const char *k = set_key(L, 2, &len);
+	uint32_t e = set_lookup(s, k, len);
+	if(!e) {
+		lua_pushnil(L);
+		return 1; }
+	lua_getuservalue(L, 1);
+	lua_rawgeti(L, -1, e);
+	return 1;
+}
+
+/***
+    Splits an octet in chunks of the given size (the last may be
+    shorter) and counts how many of them are in the set, without
+    creating an octet for each of them.
+
+    @function set:count_chunks(octet, size)
+    @return number of chunks found in the set
+*/
+static int set_count_chunks(lua_State *L) {
+	octet_set *s = set_arg(L, 1);
+	size_t len, i, n;
+	const char *k = set_key(L, 2, &len);
+	lua_Integer size = luaL_checkinteger(L, 3);
+	lua_Integer found = 0;
+	luaL_argcheck(L, size > 0, 3, "chunk size must be positive");
+	for(i=0; i<len; i+=n) {
+		n = len - i < (size_t)size ? len - i : (size_t)size;
+		found += set_lookup(s, k + i, n) != 0;
+	}
+	lua_pushinteger(L, found);
+	return 1;
+}
+
+/***
+    Lists the elements of the set, or the keys of the map, in order of
+    insertion.
+
+    @function set:array()
+    @return table of octets
+*/
+static int set_array(lua_State *L) {
+	octet_set *s = set_arg(L, 1);
+	uint32_t i;
+	octet *o;
+	lua_createtable(L, s->count, 0);
+	for(i=0; i<s->count; i++) {
+		o = o_new(L, s->entry[i].len); SAFE(o);
+		memcpy(o->val, s->arena + s->entry[i].off, s->entry[i].len);
+		o->len = s->entry[i].len;
+		lua_rawseti(L, -2, i+1);
+	}
+	return 1;
+}
+
+static int set_len(lua_State *L) {
+	octet_set *s = set_arg(L, 1);
+	lua_pushinteger(L, s->count);
+	return 1;
+}
+
+int luaopen_octet_set(lua_State *L) {
+	(void)L;
+	const struct luaL_Reg map_class[] = {
+		{"new", map_new},
+		{NULL,NULL}
+	};
+	const struct luaL_Reg map_methods[] = {
+		{"put", map_put},
+		{"get", map_get},
+		{"contains", set_contains},
+		{"keys", set_array},
+		{"__len", set_len},
+		{"__gc", set_destroy},
+		{NULL,NULL}
+	};
+	const struct luaL_Reg set_class[] = {
+		{"new", set_new},
+		{"map", map_new},
+		{"find", set_find_in},
+		{NULL,NULL}
+	};
+	const struct luaL_Reg set_methods[] = {
+		{"insert", set_insert_lua},
+		{"contains", set_contains},
+		{"count_chunks", set_count_chunks},
+		{"array", set_array},
+		{"__len", set_len},
+		{"__gc", set_destroy},
+		{NULL,NULL}
+	};
+	zen_add_class(L, "octet_map", map_class, map_methods);
+	lua_pop(L, 1);
+	zen_add_class(L, "octet_set", set_class, set_methods);
+	return 1;
+}
@@ -0,0 +1,747 @@
+/* This file is part of Zenroom (https://zenroom.dyne.org)
+ *
+ * Copyright (C) 2017-2022 Dyne.org foundation
+ * designed, written and maintained by Denis Roio <jaromil@dyne.org>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ */
+
+// MessagePack and CBOR binary formats used by MPACK and CBOR in Lua
+// and by the "rule input format" and "rule output format" of
+// Zencode. Octets are carried as raw binary strings and decoded back
+// into octets, Lua strings as text strings. Maps with string keys
+// are encoded with sorted keys, as done by the JSON encoder.
+//
+// MessagePack packs BIG, ECP and ECP2 values as ext32 extension
+// types so that zpacks restore them, packs made by the previous Lua
+// encoder (url64 strings behind the 0xc7, 0xc8, 0xd4 and 0xd5
+// markers) are still decoded.
+
+#include <math.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <zenroom.h>
+#include <zen_error.h>
+
+#include <lua.h>
+#include <lualib.h>
+#include <lauxlib.h>
+
+#include <zen_octet.h>
+
+// prototype from zen_io.c
+extern void zen_write_out_bytes(lua_State *L, const char *buf, size_t len);
+
+// maximum nesting of maps and arrays
+#define PACK_MAX_DEPTH 256
+
+// element types, numbered as CBOR major types
+enum { PACK_UINT = 0, PACK_NINT, PACK_BYTES, PACK_TEXT,
+       PACK_ARRAY, PACK_MAP };
+
+// MessagePack extension types of zenroom values
+#define MPACK_EXT_BIG  1
+#define MPACK_EXT_ECP  2
+#define MPACK_EXT_ECP2 3
+
+static const struct {
+	const char *name;
+	int ext;
+} mpack_ext[] = {
+	{ "zenroom.big",  MPACK_EXT_BIG },
+	{ "zenroom.ecp",  MPACK_EXT_ECP },
+	{ "zenroom.ecp2", MPACK_EXT_ECP2 },
+	{ NULL, 0 }
+};
+
+static const char *mpack_ext_class(int ext) {
+	switch(ext) {
+	case MPACK_EXT_BIG: return "BIG";
+	case MPACK_EXT_ECP: return "ECP";
+	case MPACK_EXT_ECP2: return "ECP2";
+	}
+	return NULL;
+}
+
+typedef struct {
+	lua_State *L;
+	char *buf;   // output, points inside the box
+	size_t len;
+	size_t cap;
+	int cbor;    // CBOR when set, else MessagePack
+	int depth;
+} pack_writer;
+
+// fixed stack positions used by the encoder after its argument
+#define PACK_STACK 2 // set of tables being encoded
+#define PACK_BOX   3 // userdata holding the output
+
+static char *pack_reserve(pack_writer *w, size_t n) {
+	if(w->len + n > w->cap) {
+		size_t cap = w->cap ? w->cap << 1 : 1024;
+		char *p;
+		while(cap < w->len + n) cap <<= 1;
+		p = lua_newuserdata(w->L, cap);
+		if(w->len) memcpy(p, w->buf, w->len);
+		lua_replace(w->L, PACK_BOX);
+		w->buf = p;
+		w->cap = cap;
+	}
+	return w->buf + w->len;
+}
+
+static inline void pack_put(pack_writer *w, const void *s, size_t len) {
+	memcpy(pack_reserve(w, len), s, len);
+	w->len += len;
+}
+
+static inline void pack_putc(pack_writer *w, unsigned char c) {
+	*pack_reserve(w, 1) = (char)c;
+	w->len++;
+}
+
+// writes the lowest bytes of v in network order after the byte c
+static void pack_putn(pack_writer *w, unsigned char c, uint64_t v, int bytes) {
+	unsigned char *p = (unsigned char*)pack_reserve(w, bytes+1);
+	int i;
+	p[0] = c;
+	for(i=bytes; i>0; i--) { p[i] = v & 0xff; v >>= 8; }
+	w->len += bytes+1;
+}
+
+static void cbor_head(pack_writer *w, int major, uint64_t n) {
+	unsigned char m = major << 5;
+	if(n < 24) pack_putc(w, m | n);
+	else if(n <= 0xff) pack_putn(w, m | 24, n, 1);
+	else if(n <= 0xffff) pack_putn(w, m | 25, n, 2);
+	else if(n <= 0xffffffff) pack_putn(w, m | 26, n, 4);
+	else pack_putn(w, m | 27, n, 8);
+}
+
+// negative integers are passed as -1-n like in CBOR
+static void mpack_head(pack_writer *w, int type, uint64_t n) {
+	int64_t v;
+	switch(type) {
+	case PACK_UINT:
+		if(n < 0x80) pack_putc(w, n);
+		else if(n <= 0xff) pack_putn(w, 0xcc, n, 1);
+		else if(n <= 0xffff) pack_putn(w, 0xcd, n, 2);
+		else if(n <= 0xffffffff) pack_putn(w, 0xce, n, 4);
+		else pack_putn(w, 0xcf, n, 8);
+		return;
+	case PACK_NINT:
+		v = -1 - (int64_t)n;
+		if(v >= -32) pack_putc(w, (unsigned char)v);
+		else if(v >= INT8_MIN) pack_putn(w, 0xd0, (uint64_t)v, 1);
+		else if(v >= INT16_MIN) pack_putn(w, 0xd1, (uint64_t)v, 2);
+		else if(v >= INT32_MIN) pack_putn(w, 0xd2, (uint64_t)v, 4);
+		else pack_putn(w, 0xd3, (uint64_t)v, 8);
+		return;
+	case PACK_BYTES:
+		if(n <= 0xff) pack_putn(w, 0xc4, n, 1);
+		else if(n <= 0xffff) pack_putn(w, 0xc5, n, 2);
+		else pack_putn(w, 0xc6, n, 4);
+		return;
+	case PACK_TEXT:
+		if(n < 32) pack_putc(w, 0xa0 | n);
+		else if(n <= 0xff) pack_putn(w, 0xd9, n, 1);
+		else if(n <= 0xffff) pack_putn(w, 0xda, n, 2);
+		else pack_putn(w, 0xdb, n, 4);
+		return;
+	case PACK_ARRAY:
+		if(n < 16) pack_putc(w, 0x90 | n);
+		else if(n <= 0xffff) pack_putn(w, 0xdc, n, 2);
+		else pack_putn(w, 0xdd, n, 4);
+		return;
+	case PACK_MAP:
+		if(n < 16) pack_putc(w, 0x80 | n);
+		else if(n <= 0xffff) pack_putn(w, 0xde, n, 2);
+		else pack_putn(w, 0xdf, n, 4);
+		return;
+	}
+}
+
+static inline void pack_head(pack_writer *w, int type, uint64_t n) {
+	if(w->cbor) cbor_head(w, type, n);
+	else mpack_head(w, type, n);
+}
+
+static void encode_number(pack_writer *w, int idx) {
+	lua_State *L = w->L;
+	if(lua_isinteger(L, idx)) {
+		int64_t v = lua_tointeger(L, idx);
+		if(v >= 0) pack_head(w, PACK_UINT, (uint64_t)v);
+		else pack_head(w, PACK_NINT, (uint64_t)(-1 - v));
+		return;
+	}
+	// floats keep the precision of lua_Number
+	if(sizeof(lua_Number) == sizeof(float)) {
+		union { float f; uint32_t u; } n;
+		n.f = (float)lua_tonumber(L, idx);
+		pack_putn(w, w->cbor ? 0xfa : 0xca, n.u, 4);
+	} else {
+		union { double d; uint64_t u; } n;
+		n.d = (double)lua_tonumber(L, idx);
+		pack_putn(w, w->cbor ? 0xfb : 0xcb, n.u, 8);
+	}
+}
+
+// octets are written as binary strings and the other zenroom values
+// by their :octet() conversion, in MessagePack BIG, ECP and ECP2 are
+// wrapped in extension types to be restored when decoding
+static void encode_zen(pack_writer *w, int idx) {
+	lua_State *L = w->L;
+	octet *o = (octet*) luaL_testudata(L, idx, "zenroom.octet");
+	const char *name;
+	int i, ext = 0;
+	if(o) {
+		pack_head(w, PACK_BYTES, o->len);
+		pack_put(w, o->val, o->len);
+		return;
+	}
+	if(luaL_getmetafield(L, idx, "__name") != LUA_TSTRING
+	   || !strstr(lua_tostring(L, -1), "zenroom"))
+		luaL_error(L, "unexpected type '%s'", luaL_typename(L, idx));
+	name = lua_tostring(L, -1);
+	for(i=0; !w->cbor && mpack_ext[i].name; i++)
+		if(strcmp(name, mpack_ext[i].name) == 0) ext = mpack_ext[i].ext;
+	lua_pop(L, 1);
+	lua_getfield(L, idx, "octet");
+	lua_pushvalue(L, idx);
+	lua_call(L, 1, 1);
+	o = (octet*) luaL_testudata(L, -1, "zenroom.octet");
+	if(!o) luaL_error(L, "%s encode: octet conversion failed",
+	                  w->cbor ? "CBOR" : "MessagePack");
+	if(ext) {
+		pack_putn(w, 0xc9, o->len, 4);
+		pack_putc(w, ext);
+	} else
+		pack_head(w, PACK_BYTES, o->len);
+	pack_put(w, o->val, o->len);
+	lua_pop(L, 1);
+}
+
+typedef struct {
+	const char *s;
+	size_t len;
+	lua_Integer pos; // position of the key in the pairs table
+} pack_key;
+
+static int pack_keycmp(const void *a, const void *b) {
+	const pack_key *ka = a, *kb = b;
+	int r = memcmp(ka->s, kb->s, ka->len < kb->len ? ka->len : kb->len);
+	if(r) return r;
+	return (ka->len > kb->len) - (ka->len < kb->len);
+}
+
+static void encode_value(pack_writer *w, int idx);
+
+// keys and values are anchored in a sequence while sorting, keys of
+// other types than strings are written in the order of pairs()
+static void encode_map(pack_writer *w, int idx, lua_Integer n) {
+	lua_State *L = w->L;
+	lua_Integer i = 0;
+	pack_key *keys;
+	int pairs, sort = 1;
+	keys = lua_newuserdata(L, n * sizeof(pack_key));
+	lua_createtable(L, n<<1, 0);
+	pairs = lua_gettop(L);
+	lua_pushnil(L);
+	while(lua_next(L, idx)) {
+		lua_rawseti(L, pairs, (i<<1)+2);
+		lua_pushvalue(L, -1);
+		lua_rawseti(L, pairs, (i<<1)+1);
+		if(lua_type(L, -1) == LUA_TSTRING)
+			keys[i].s = lua_tolstring(L, -1, &keys[i].len);
+		else sort = 0;
+		keys[i].pos = (i<<1)+1;
+		i++;
+	}
+	if(sort) qsort(keys, n, sizeof(pack_key), pack_keycmp);
+	pack_head(w, PACK_MAP, n);
+	for(i=0; i<n; i++) {
+		lua_rawgeti(L, pairs, keys[i].pos);
+		encode_value(w, lua_gettop(L));
+		lua_rawgeti(L, pairs, keys[i].pos+1);
+		encode_value(w, lua_gettop(L));
+		lua_pop(L, 2);
+	}
+	lua_pop(L, 2);
+}
+
+// tables having only the keys 1..n are arrays, empty tables too
+static void encode_table(pack_writer *w, int idx) {
+	lua_State *L = w->L;
+	lua_Integer i, n = 0;
+	int array = 1;
+	if(++w->depth > PACK_MAX_DEPTH)
+		luaL_error(L, "%s encode: too many nested levels",
+		           w->cbor ? "CBOR" : "MessagePack");
+	luaL_checkstack(L, 8, "pack nesting");
+	lua_pushvalue(L, idx);
+	if(lua_rawget(L, PACK_STACK) != LUA_TNIL)
+		luaL_error(L, "circular reference");
+	lua_pop(L, 1);
+	lua_pushvalue(L, idx);
+	lua_pushboolean(L, 1);
+	lua_rawset(L, PACK_STACK);
+	lua_pushnil(L);
+	while(lua_next(L, idx)) {
+		lua_pop(L, 1);
+		n++;
+		if(array && !lua_isinteger(L, -1)) array = 0;
+	}
+	if(array) {
+		for(i=1; i<=n; i++) {
+			if(lua_rawgeti(L, idx, i) == LUA_TNIL) array = 0;
+			lua_pop(L, 1);
+			if(!array) break;
+		}
+	}
+	if(array) {
+		pack_head(w, PACK_ARRAY, n);
+		for(i=1; i<=n; i++) {
+			lua_rawgeti(L, idx, i);
+			encode_value(w, lua_gettop(L));
+			lua_pop(L, 1);
+		}
+	} else
+		encode_map(w, idx, n);
+	lua_pushvalue(L, idx);
+	lua_pushnil(L);
+	lua_rawset(L, PACK_STACK);
+	w->depth--;
+}
+
+static void encode_value(pack_writer *w, int idx) {
+	lua_State *L = w->L;
+	const char *s;
+	size_t len;
+	switch(lua_type(L, idx)) {
+	case LUA_TNIL:
+		pack_putc(w, w->cbor ? 0xf6 : 0xc0);
+		break;
+	case LUA_TBOOLEAN:
+		if(lua_toboolean(L, idx)) pack_putc(w, w->cbor ? 0xf5 : 0xc3);
+		else pack_putc(w, w->cbor ? 0xf4 : 0xc2);
+		break;
+	case LUA_TNUMBER:
+		encode_number(w, idx);
+		break;
+	case LUA_TSTRING:
+		s = lua_tolstring(L, idx, &len);
+		pack_head(w, PACK_TEXT, len);
+		pack_put(w, s, len);
+		break;
+	case LUA_TTABLE:
+		encode_table(w, idx);
+		break;
+	case LUA_TUSERDATA:
+		encode_zen(w, idx);
+		break;
+	default:
+		luaL_error(L, "unexpected type '%s'", luaL_typename(L, idx));
+	}
+}
+
+// sets up the stack and the writer for the encode and print functions
+static void pack_writer_init(lua_State *L, pack_writer *w, int cbor) {
+	luaL_checkany(L, 1);
+	lua_settop(L, 1);
+	w->L = L;
+	w->buf = NULL;
+	w->len = 0;
+	w->cap = 0;
+	w->depth = 0;
+	w->cbor = cbor;
+	lua_newtable(L);                      // PACK_STACK
+	lua_pushnil(L);                       // PACK_BOX
+}
+
+static int pack_encode(lua_State *L, int cbor) {
+	pack_writer w;
+	pack_writer_init(L, &w, cbor);
+	encode_value(&w, 1);
+	lua_pushlstring(L, w.buf ? w.buf : "", w.len);
+	return 1;
+}
+
+// writes the encoded value at once when complete: nothing is
+// printed when encoding fails
+static int pack_print(lua_State *L, int cbor) {
+	pack_writer w;
+	pack_writer_init(L, &w, cbor);
+	encode_value(&w, 1);
+	zen_write_out_bytes(L, w.buf ? w.buf : "", w.len);
+	return 0;
+}
+
+typedef struct {
+	const unsigned char *s;
+	size_t len;
+	size_t pos;
+	int cbor;
+	int depth;
+} pack_parser;
+
+static int pack_error(lua_State *L, pack_parser *p, const char *msg) {
+	return luaL_error(L, "The %s input is not valid: %s at byte %d",
+	                  p->cbor ? "CBOR" : "MessagePack", msg, (int)p->pos);
+}
+
+// returns the next n bytes of input and moves past them
+static const unsigned char *pack_take(lua_State *L, pack_parser *p, uint64_t n) {
+	const unsigned char *r = p->s + p->pos;
+	if(n > p->len - p->pos) pack_error(L, p, "unexpected end of input");
+	p->pos += n;
+	return r;
+}
+
+static uint64_t pack_getn(lua_State *L, pack_parser *p, int bytes) {
+	const unsigned char *b = pack_take(L, p, bytes);
+	uint64_t v = 0;
+	int i;
+	for(i=0; i<bytes; i++) v = (v << 8) | b[i];
+	return v;
+}
+
+static void push_uint(lua_State *L, uint64_t v) {
+	if(v <= (uint64_t)LUA_MAXINTEGER) lua_pushinteger(L, (lua_Integer)v);
+	else lua_pushnumber(L, (lua_Number)v);
+}
+
+static void push_int(lua_State *L, int64_t v) {
+	if(v >= LUA_MININTEGER && v <= LUA_MAXINTEGER)
+		lua_pushinteger(L, (lua_Integer)v);
+	else lua_pushnumber(L, (lua_Number)v);
+}
+
+static void push_octet(lua_State *L, pack_parser *p, uint64_t n) {
+	const unsigned char *b = pack_take(L, p, n);
+	octet *o;
+	if(n > MAX_OCTET) pack_error(L, p, "binary string too big");
+	o = o_new(L, (int)n); SAFE(o);
+	memcpy(o->val, b, n);
+	o->len = n;
+}
+
+static void push_text(lua_State *L, pack_parser *p, uint64_t n) {
+	const unsigned char *b = pack_take(L, p, n);
+	lua_pushlstring(L, (const char*)b, n);
+}
+
+// pushes the result of CLASS.new(octet on top of the stack)
+static void push_zen(lua_State *L, pack_parser *p, const char *class) {
+	if(!class) pack_error(L, p, "unsupported extension type");
+	lua_getglobal(L, class);
+	lua_getfield(L, -1, "new");
+	lua_remove(L, -2);
+	lua_insert(L, -2);
+	lua_call(L, 1, 1);
+}
+
+static void pack_value(lua_State *L, pack_parser *p);
+
+static void pack_array(lua_State *L, pack_parser *p, uint64_t n) {
+	uint64_t i;
+	// every element takes at least one byte
+	if(n > p->len - p->pos) pack_error(L, p, "unexpected end of input");
+	if(++p->depth > PACK_MAX_DEPTH) pack_error(L, p, "too many nested levels");
+	luaL_checkstack(L, 4, "pack nesting");
+	lua_createtable(L, (int)n, 0);
+	for(i=1; i<=n; i++) {
+		pack_value(L, p);
+		lua_rawseti(L, -2, (lua_Integer)i);
+	}
+	p->depth--;
+}
+
+// keys decoded as octets are converted to strings, entries with nil
+// values are skipped
+static void pack_map_entry(lua_State *L, pack_parser *p) {
+	octet *o;
+	pack_value(L, p);
+	switch(lua_type(L, -1)) {
+	case LUA_TSTRING: case LUA_TNUMBER: case LUA_TBOOLEAN:
+		break;
+	case LUA_TUSERDATA:
+		o = (octet*) luaL_testudata(L, -1, "zenroom.octet");
+		if(o) {
+			lua_pushlstring(L, o->val, o->len);
+			lua_replace(L, -2);
+			break;
+		}
+		// fallthrough
+	default:
+		pack_error(L, p, "invalid key type");
+	}
+	pack_value(L, p);
+	if(lua_isnil(L, -1)) lua_pop(L, 2);
+	else lua_rawset(L, -3);
+}
+
+static void pack_map(lua_State *L, pack_parser *p, uint64_t n) {
+	uint64_t i;
+	if(n > p->len - p->pos) pack_error(L, p, "unexpected end of input");
+	if(++p->depth > PACK_MAX_DEPTH) pack_error(L, p, "too many nested levels");
+	luaL_checkstack(L, 4, "pack nesting");
+	lua_createtable(L, 0, (int)n);
+	for(i=0; i<n; i++) pack_map_entry(L, p);
+	p->depth--;
+}
+
+static void mpack_value(lua_State *L, pack_parser *p) {
+	unsigned char c = *pack_take(L, p, 1);
+	uint64_t n;
+	if(c <= 0x7f) { lua_pushinteger(L, c); return; }
+	if(c >= 0xe0) { lua_pushinteger(L, (int8_t)c); return; }
+	if(c <= 0x8f) { pack_map(L, p, c & 0x0f); return; }
+	if(c <= 0x9f) { pack_array(L, p, c & 0x0f); return; }
+	if(c <= 0xbf) { push_text(L, p, c & 0x1f); return; }
+	switch(c) {
+	case 0xc0: lua_pushnil(L); return;
+	case 0xc2: lua_pushboolean(L, 0); return;
+	case 0xc3: lua_pushboolean(L, 1); return;
+	case 0xc4: push_octet(L, p, pack_getn(L, p, 1)); return;
+	case 0xc5: push_octet(L, p, pack_getn(L, p, 2)); return;
+	case 0xc6: push_octet(L, p, pack_getn(L, p, 4)); return;
+	case 0xc7: case 0xc8: case 0xd4: case 0xd5:
+		// previous Lua encoder: url64 string with 32 bit length
+		n = pack_getn(L, p, 4);
+		lua_getglobal(L, "OCTET");
+		lua_getfield(L, -1, "from_url64");
+		lua_remove(L, -2);
+		push_text(L, p, n);
+		lua_call(L, 1, 1);
+		if(c == 0xc8) push_zen(L, p, "BIG");
+		else if(c == 0xd4) push_zen(L, p, "ECP");
+		else if(c == 0xd5) push_zen(L, p, "ECP2");
+		return;
+	case 0xc9:
+		n = pack_getn(L, p, 4);
+		c = *pack_take(L, p, 1);
+		push_octet(L, p, n);
+		push_zen(L, p, mpack_ext_class(c));
+		return;
+	case 0xca: {
+		union { float f; uint32_t u; } v;
+		v.u = pack_getn(L, p, 4);
+		lua_pushnumber(L, (lua_Number)v.f);
+		return; }
+	case 0xcb: {
+		union { double d; uint64_t u; } v;
+		v.u = pack_getn(L, p, 8);
+		lua_pushnumber(L, (lua_Number)v.d);
+		return; }
+	case 0xcc: push_uint(L, pack_getn(L, p, 1)); return;
+	case 0xcd: push_uint(L, pack_getn(L, p, 2)); return;
+	case 0xce: push_uint(L, pack_getn(L, p, 4)); return;
+	case 0xcf: push_uint(L, pack_getn(L, p, 8)); return;
+	case 0xd0: push_int(L, (int8_t)pack_getn(L, p, 1)); return;
+	case 0xd1: push_int(L, (int16_t)pack_getn(L, p, 2)); return;
+	case 0xd2: push_int(L, (int32_t)pack_getn(L, p, 4)); return;
+	case 0xd3: push_int(L, (int64_t)pack_getn(L, p, 8)); return;
+	case 0xd9: push_text(L, p, pack_getn(L, p, 1)); return;
+	case 0xda: push_text(L, p, pack_getn(L, p, 2)); return;
+	case 0xdb: push_text(L, p, pack_getn(L, p, 4)); return;
+	case 0xdc: pack_array(L, p, pack_getn(L, p, 2)); return;
+	case 0xdd: pack_array(L, p, pack_getn(L, p, 4)); return;
+	case 0xde: pack_map(L, p, pack_getn(L, p, 2)); return;
+	case 0xdf: pack_map(L, p, pack_getn(L, p, 4)); return;
+	}
+	p->pos--;
+	pack_error(L, p, "unsupported type");
+}
+
+#define CBOR_INDEFINITE UINT64_MAX
+#define CBOR_BREAK 0xff
+
+// reads the argument following the initial byte
+static uint64_t cbor_arg(lua_State *L, pack_parser *p, unsigned char ib) {
+	unsigned char ai = ib & 0x1f;
+	if(ai < 24) return ai;
+	switch(ai) {
+	case 24: return pack_getn(L, p, 1);
+	case 25: return pack_getn(L, p, 2);
+	case 26: return pack_getn(L, p, 4);
+	case 27: return pack_getn(L, p, 8);
+	case 31: return CBOR_INDEFINITE;
+	}
+	p->pos--;
+	pack_error(L, p, "invalid additional information");
+	return 0;
+}
+
+static inline int cbor_break(lua_State *L, pack_parser *p) {
+	if(p->pos >= p->len) pack_error(L, p, "unexpected end of input");
+	if(p->s[p->pos] != CBOR_BREAK) return 0;
+	p->pos++;
+	return 1;
+}
+
+// indefinite length strings are made of definite chunks
+static void cbor_chunks(lua_State *L, pack_parser *p, int major) {
+	luaL_Buffer b;
+	luaL_buffinit(L, &b);
+	while(!cbor_break(L, p)) {
+		unsigned char ib = *pack_take(L, p, 1);
+		uint64_t n;
+		if(ib >> 5 != major) pack_error(L, p, "invalid string chunk");
+		n = cbor_arg(L, p, ib);
+		if(n == CBOR_INDEFINITE) pack_error(L, p, "invalid string chunk");
+		luaL_addlstring(&b, (const char*)pack_take(L, p, n), n);
+	}
+	luaL_pushresult(&b);
+	if(major == PACK_BYTES) {
+		size_t len;
+		const char *s = lua_tolstring(L, -1, &len);
+		octet *o;
+		if(len > MAX_OCTET) pack_error(L, p, "binary string too big");
+		o = o_new(L, (int)len); SAFE(o);
+		memcpy(o->val, s, len);
+		o->len = len;
+		lua_replace(L, -2);
+	}
+}
+
+static lua_Number cbor_half(uint16_t h) {
+	int e = (h >> 10) & 0x1f;
+	int m = h & 0x3ff;
+	double v;
+	if(e == 0) v = ldexp(m, -24);
+	else if(e != 31) v = ldexp(m + 1024, e - 25);
+	else v = m ? NAN : INFINITY;
+	return (lua_Number)((h & 0x8000) ? -v : v);
+}
+
+static void cbor_value(lua_State *L, pack_parser *p) {
+	unsigned char ib = *pack_take(L, p, 1);
+	int major = ib >> 5;
+	uint64_t n;
+	lua_Integer i;
+	if(major == 7) {
+		switch(ib & 0x1f) {
+		case 20: lua_pushboolean(L, 0); return;
+		case 21: lua_pushboolean(L, 1); return;
+		case 22: case 23: lua_pushnil(L); return;
+		case 25:
+			lua_pushnumber(L, cbor_half(pack_getn(L, p, 2)));
+			return;
+		case 26: {
+			union { float f; uint32_t u; } v;
+			v.u = pack_getn(L, p, 4);
+			lua_pushnumber(L, (lua_Number)v.f);
+			return; }
+		case 27: {
+			union { double d; uint64_t u; } v;
+			v.u = pack_getn(L, p, 8);
+			lua_pushnumber(L, (lua_Number)v.d);
+			return; }
+		}
+		p->pos--;
+		pack_error(L, p, "unsupported simple value");
+	}
+	n = cbor_arg(L, p, ib);
+	if(n == CBOR_INDEFINITE && (major < PACK_BYTES || major > PACK_MAP)) {
+		p->pos--;
+		pack_error(L, p, "invalid indefinite length");
+	}
+	switch(major) {
+	case PACK_UINT:
+		push_uint(L, n);
+		return;
+	case PACK_NINT:
+		if(n <= INT64_MAX) push_int(L, -1 - (int64_t)n);
+		else lua_pushnumber(L, -1 - (lua_Number)n);
+		return;
+	case PACK_BYTES:
+		if(n == CBOR_INDEFINITE) cbor_chunks(L, p, major);
+		else push_octet(L, p, n);
+		return;
+	case PACK_TEXT:
+		if(n == CBOR_INDEFINITE) cbor_chunks(L, p, major);
+		else push_text(L, p, n);
+		return;
+	case PACK_ARRAY:
+		if(n != CBOR_INDEFINITE) { pack_array(L, p, n); return; }
+		if(++p->depth > PACK_MAX_DEPTH) pack_error(L, p, "too many nested levels");
+		luaL_checkstack(L, 4, "pack nesting");
+		lua_newtable(L);
+		for(i=1; !cbor_break(L, p); i++) {
+			cbor_value(L, p);
+			lua_rawseti(L, -2, i);
+		}
+		p->depth--;
+		return;
+	case PACK_MAP:
+		if(n != CBOR_INDEFINITE) { pack_map(L, p, n); return; }
+		if(++p->depth > PACK_MAX_DEPTH) pack_error(L, p, "too many nested levels");
+		luaL_checkstack(L, 4, "pack nesting");
+		lua_newtable(L);
+		while(!cbor_break(L, p)) pack_map_entry(L, p);
+		p->depth--;
+		return;
+	default:
+		// tags are ignored, the tagged value is decoded as is
+		if(++p->depth > PACK_MAX_DEPTH) pack_error(L, p, "too many nested levels");
+		cbor_value(L, p);
+		p->depth--;
+	}
+}
+
+static void pack_value(lua_State *L, pack_parser *p) {
+	if(p->cbor) cbor_value(L, p);
+	else mpack_value(L, p);
+}
+
+// decodes a single value from a string or an octet
+static int pack_decode(lua_State *L, int cbor) {
+	pack_parser p;
+	octet *o = (octet*) luaL_testudata(L, 1, "zenroom.octet");
+	if(o) {
+		p.s = (const unsigned char*)o->val;
+		p.len = o->len;
+	} else
+		p.s = (const unsigned char*)luaL_checklstring(L, 1, &p.len);
+	p.pos = 0;
+	p.cbor = cbor;
+	p.depth = 0;
+	pack_value(L, &p);
+	if(p.pos < p.len) pack_error(L, &p, "trailing data");
+	return 1;
+}
+
+static int lua_mpack_encode(lua_State *L) { return pack_encode(L, 0); }
+static int lua_mpack_decode(lua_State *L) { return pack_decode(L, 0); }
+static int lua_mpack_print(lua_State *L) { return pack_print(L, 0); }
+static int lua_cbor_encode(lua_State *L) { return pack_encode(L, 1); }
+static int lua_cbor_decode(lua_State *L) { return pack_decode(L, 1); }
+static int lua_cbor_print(lua_State *L) { return pack_print(L, 1); }
+
+void zen_add_pack(lua_State *L) {
+	static const struct luaL_Reg pack_funcs [] =
+		{ {"mpack_encode", lua_mpack_encode},
+		  {"mpack_decode", lua_mpack_decode},
+		  {"mpack_print", lua_mpack_print},
+		  {"cbor_encode", lua_cbor_encode},
+		  {"cbor_decode", lua_cbor_decode},
+		  {"cbor_print", lua_cbor_print},
+		  {NULL, NULL} };
+	lua_getglobal(L, "_G");
+	luaL_setfuncs(L, pack_funcs, 0);
+	lua_pop(L, 1);
+}
@@ -18,6 +18,8 @@
  *
  */
 
+#include <strings.h>
+
 #include <lua.h>
 #include <lualib.h>
 #include <lauxlib.h>
@@ -48,6 +50,18 @@ extern int PQCLEAN_DILITHIUM2_CLEAN_crypto_sign(
 extern int PQCLEAN_DILITHIUM2_CLEAN_crypto_sign_open(
 	uint8_t *m, size_t *mlen,
 	const uint8_t *sm, size_t smlen, const uint8_t *pk);
+// keys with the matrix already expanded, used to sign or verify many
+// messages at once (opaque here, see dilithium2/sign.h)
+extern size_t PQCLEAN_DILITHIUM2_CLEAN_crypto_sign_expanded_sk_bytes(void);
+extern size_t PQCLEAN_DILITHIUM2_CLEAN_crypto_sign_expanded_pk_bytes(void);
+extern void PQCLEAN_DILITHIUM2_CLEAN_crypto_sign_expand_sk(void *esk, const uint8_t *sk);
+extern void PQCLEAN_DILITHIUM2_CLEAN_crypto_sign_expand_pk(void *epk, const uint8_t *pk);
+extern int PQCLEAN_DILITHIUM2_CLEAN_crypto_sign_signature_expanded(
+	uint8_t *sig, size_t *siglen,
+	const uint8_t *m, size_t mlen, const void *esk);
+extern int PQCLEAN_DILITHIUM2_CLEAN_crypto_sign_verify_expanded(
+	const uint8_t *sig, size_t siglen,
+	const uint8_t *m, size_t mlen, const void *epk);
 
 /*
   Quantum proof kyber kem/cipher
@@ -76,6 +90,51 @@ extern int PQCLEAN_SNTRUP761_CLEAN_crypto_kem_pubgen(uint8_t *pk, uint8_t *sk);
 extern int PQCLEAN_SNTRUP761_CLEAN_crypto_kem_enc(uint8_t *ct, uint8_t *ss, const uint8_t *pk);
 extern int PQCLEAN_SNTRUP761_CLEAN_crypto_kem_dec(uint8_t *ss, const uint8_t *ct, const uint8_t *sk);
 
+/*
+  Runtime selection of AVX2 optimized routines (lib/pqclean/cpufeatures.c)
+*/
+extern int PQCLEAN_avx2_available(void);
+extern int PQCLEAN_avx2_enabled(void);
+extern int PQCLEAN_avx2_enable(int on);
+
+/*#######################################*/
+/*            Implementation             */
+/*#######################################*/
+// applies the implementation chosen in the context to the calling
+// thread, done before running each script: the switch lives in the
+// thread, so contexts in other threads keep their own
+void zen_qp_select(zenroom_t *Z) {
+	PQCLEAN_avx2_enable(!Z->qp_clean);
+}
+
+// returns the name of the implementation in use ("avx2" or "clean")
+// and optionally switches to the one given as argument, for this
+// context only: AVX2 is selected by default when supported by the
+// CPU, "clean" is the portable fallback and always available.
+static int qp_implementation(lua_State *L) {
+	Z(L);
+	const char *impl = luaL_optstring(L, 1, NULL);
+	if(impl) {
+		if(strcasecmp(impl, "clean") == 0)
+			Z->qp_clean = 1;
+		else if(strcasecmp(impl, "avx2") == 0) {
+			if(!PQCLEAN_avx2_available()) {
+				zerror(L, "AVX2 implementation not supported on this CPU");
+				lua_pushboolean(L, 0);
+				return 1;
+			}
+			Z->qp_clean = 0;
+		} else {
+			zerror(L, "unknown quantum-proof implementation: %s", impl);
+			lua_pushboolean(L, 0);
+			return 1;
+		}
+		zen_qp_select(Z);
+	}
+	lua_pushstring(L, PQCLEAN_avx2_enabled() ? "avx2" : "clean");
+	return 1;
+}
+
 
 
 /*#######################################*/
@@ -206,6 +265,106 @@ static int qp_verify(lua_State *L) {
 	return 1;
 }
 
+// wipes the expanded secret key when collected, also after an error
+static int qp_esk_gc(lua_State *L) {
+	void *esk = lua_touserdata(L, 1);
+	if(esk) memset(esk, 0, lua_rawlen(L, 1));
+	return 0;
+}
+
+// scratch memory is a userdata pushed on the stack, so that it is
+// collected also when an error is raised while in use
+static void *qp_esk_new(lua_State *L, size_t size) {
+	void *esk = lua_newuserdata(L, size);
+	if(luaL_newmetatable(L, "zenroom.qp.esk")) {
+		lua_pushcfunction(L, qp_esk_gc);
+		lua_setfield(L, -2, "__gc");
+	}
+	lua_setmetatable(L, -2);
+	return esk;
+}
+
+// sign an array of messages with the same secret key, the key is
+// unpacked and its matrix expanded only once. Returns an array of
+// signatures in the same order.
+static int qp_sign_batch(lua_State *L) {
+	octet *sk = o_arg(L, 1); SAFE(sk);
+	luaL_checktype(L, 2, LUA_TTABLE);
+	if(sk->len != PQCLEAN_DILITHIUM2_CLEAN_CRYPTO_SECRETKEYBYTES) {
+		lerror(L, "invalid size for secret key");
+		lua_pushboolean(L, 0);
+		return 1;
+	}
+	size_t esklen = PQCLEAN_DILITHIUM2_CLEAN_crypto_sign_expanded_sk_bytes();
+	void *esk = qp_esk_new(L, esklen);
+	PQCLEAN_DILITHIUM2_CLEAN_crypto_sign_expand_sk(esk, (unsigned char*)sk->val);
+	int i, n = lua_rawlen(L, 2);
+	lua_createtable(L, n, 0);
+	for(i=1; i<=n; i++) {
+		lua_rawgeti(L, 2, i);
+		octet *m = o_arg(L, -1);
+		octet *sig = m ? o_new(L, PQCLEAN_DILITHIUM2_CLEAN_CRYPTO_BYTES) : NULL;
+		if(!sig) {
+			memset(esk, 0, esklen);
+			lerror(L, "%s: cannot sign message %d", __func__, i);
+			return 0; }
+		PQCLEAN_DILITHIUM2_CLEAN_crypto_sign_signature_expanded((unsigned char*)sig->val,
+									(size_t*)&sig->len,
+									(unsigned char*)m->val, m->len,
+									esk);
+		lua_rawseti(L, -3, i);
+		lua_pop(L, 1);
+	}
+	memset(esk, 0, esklen);
+	return 1;
+}
+
+// verify an array of signatures on an array of messages, the public
+// key may be a single octet or an array with one key for each
+// signature. Consecutive signatures by the same key share the
+// unpacked key and its expanded matrix. Returns an array of booleans.
+static int qp_verify_batch(lua_State *L) {
+	luaL_checktype(L, 2, LUA_TTABLE);
+	luaL_checktype(L, 3, LUA_TTABLE);
+	int i, n = lua_rawlen(L, 2);
+	int pkarr = lua_istable(L, 1);
+	if((int)lua_rawlen(L, 3) != n || (pkarr && (int)lua_rawlen(L, 1) != n)) {
+		lerror(L, "%s: arrays of different length", __func__);
+		return 0; }
+	void *epk = lua_newuserdata(L, PQCLEAN_DILITHIUM2_CLEAN_crypto_sign_expanded_pk_bytes());
+	char lastpk[PQCLEAN_DILITHIUM2_CLEAN_CRYPTO_PUBLICKEYBYTES];
+	int expanded = 0;
+	lua_createtable(L, n, 0);
+	for(i=1; i<=n; i++) {
+		int result = -1;
+		if(pkarr) lua_rawgeti(L, 1, i);
+		else lua_pushvalue(L, 1);
+		lua_rawgeti(L, 2, i);
+		lua_rawgeti(L, 3, i);
+		octet *pk = o_arg(L, -3);
+		octet *sig = o_arg(L, -2);
+		octet *m = o_arg(L, -1);
+		if(!pk || !sig || !m) {
+			lerror(L, "%s: invalid arguments at position %d", __func__, i);
+			return 0; }
+		if(pk->len == PQCLEAN_DILITHIUM2_CLEAN_CRYPTO_PUBLICKEYBYTES) {
+			if(!expanded || memcmp(lastpk, pk->val, pk->len) != 0) {
+				PQCLEAN_DILITHIUM2_CLEAN_crypto_sign_expand_pk(epk, (unsigned char*)pk->val);
+				memcpy(lastpk, pk->val, pk->len);
+				expanded = 1;
+			}
+			result = PQCLEAN_DILITHIUM2_CLEAN_crypto_sign_verify_expanded((unsigned char*)sig->val,
+										      (size_t)sig->len,
+										      (unsigned char*)m->val, m->len,
+										      epk);
+		}
+		lua_pop(L, 3);
+		lua_pushboolean(L, result == 0);
+		lua_rawseti(L, -2, i);
+	}
+	return 1;
+}
+
 static int qp_signature_len(lua_State *L){
 	lua_pushinteger(L, PQCLEAN_DILITHIUM2_CLEAN_CRYPTO_BYTES);
 	return 1;
@@ -444,13 +603,16 @@ static int qp_sntrup_kem_dec(lua_State *L) {
 int luaopen_qp(lua_State *L) {
 	(void)L;
 	const struct luaL_Reg ecdh_class[] = {
+		{"implementation", qp_implementation},
 		// Dilithium2
 		{"sigkeygen", qp_signature_keygen},
 		{"sigpubgen", qp_signature_pubgen},
 		{"sigpubcheck", qp_signature_pubcheck},
 		{"sign", qp_sign},
+		{"sign_batch", qp_sign_batch},
 		{"signed_msg", qp_signed_message},
 		{"verify", qp_verify},
+		{"verify_batch", qp_verify_batch},
 		{"verified_msg", qp_verified_message},
 		{"signature_len", qp_signature_len},
 		{"signature_check", qp_signature_check},
@@ -0,0 +1,310 @@
+/* This file is part of Zenroom (https://zenroom.dyne.org)
+ *
+ * Copyright (C) 2017-2022 Dyne.org foundation
+ * designed, written and maintained by Denis Roio <jaromil@dyne.org>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ */
+
+// Recursive Length Prefix, the serialization of Ethereum
+// transactions, used by ETH.encodeRLP and ETH.decodeRLP in
+// crypto_ethereum.lua. Items are octets, or any zenroom value
+// converted with :octet() (a BIG equal to zero is the empty item),
+// lists are Lua tables encoded in the order of pairs().
+//
+// Decoded items are new octets copied from the input, so that they
+// can be changed without touching it.
+
+#include <stdint.h>
+#include <string.h>
+
+#include <zenroom.h>
+#include <zen_error.h>
+
+#include <lua.h>
+#include <lualib.h>
+#include <lauxlib.h>
+
+#include <lua_functions.h>
+#include <zen_octet.h>
+#include <zen_big.h>
+
+// maximum nesting of lists
+#define RLP_MAX_DEPTH 256
+
+typedef struct {
+	lua_State *L;
+	char *buf;   // output, points inside the box once grown
+	size_t len;
+	size_t cap;
+	int depth;
+} rlp_writer;
+
+// fixed stack position used by the encoder after its argument
+#define RLP_BOX 2 // userdata holding the output
+
+static char *rlp_reserve(rlp_writer *w, size_t n) {
+	if(w->len + n > w->cap) {
+		size_t cap = w->cap ? w->cap << 1 : 512;
+		char *p;
+		while(cap < w->len + n) cap <<= 1;
+		p = lua_newuserdata(w->L, cap);
+		if(w->len) memcpy(p, w->buf, w->len);
+		lua_replace(w->L, RLP_BOX);
+		w->buf = p;
+		w->cap = cap;
+	}
+	return w->buf + w->len;
+}
+
+// number of bytes of the big endian encoding of n
+static inline int rlp_lenbytes(size_t n) {
+	int b = 0;
+	while(n) { b++; n >>= 8; }
+	return b;
+}
+
+// writes the prefix of a string (short 0x80) or list (short 0xc0)
+// of n bytes at p, returns its size: p may be NULL to measure it
+static int rlp_head(unsigned char *p, unsigned char shortbase, size_t n) {
+	int b, i;
+	if(n < 56) {
+		if(p) p[0] = shortbase + n;
+		return 1;
+	}
+	b = rlp_lenbytes(n);
+	if(p) {
+		p[0] = shortbase + 55 + b;
+		for(i=b; i>0; i--) { p[i] = n & 0xff; n >>= 8; }
+	}
+	return b + 1;
+}
+
+static void rlp_put_item(rlp_writer *w, const char *s, size_t len) {
+	unsigned char *p;
+	int h;
+	if(len == 1 && (unsigned char)s[0] < 0x80) {
+		*rlp_reserve(w, 1) = s[0];
+		w->len++;
+		return;
+	}
+	h = rlp_head(NULL, 0x80, len);
+	p = (unsigned char*)rlp_reserve(w, h + len);
+	rlp_head(p, 0x80, len);
+	memcpy(p + h, s, len);
+	w->len += h + len;
+}
+
+static int rlp_is_zero(const octet *o) {
+	int i;
+	for(i=0; i<o->len; i++) if(o->val[i]) return 0;
+	return 1;
+}
+
+// writes a BIG as its big endian bytes without leading zeroes, as
+// new_octet_from_big does, but without allocating an octet
+static void rlp_put_big(rlp_writer *w, big *b) {
+	char bytes[MODBYTES];
+	int i;
+	BIG_toBytes(bytes, b->val);
+	for(i=0; i<MODBYTES && bytes[i]==0x0; i++);
+	rlp_put_item(w, bytes+i, MODBYTES-i);
+}
+
+static void rlp_encode_value(rlp_writer *w, int idx);
+
+static void rlp_encode_list(rlp_writer *w, int idx) {
+	lua_State *L = w->L;
+	size_t start = w->len, len;
+	unsigned char *p;
+	int h;
+	if(++w->depth > RLP_MAX_DEPTH)
+		luaL_error(L, "ETH RLP encoder: too many nested lists");
+	luaL_checkstack(L, 3, "ETH RLP encoder");
+	lua_pushnil(L);
+	while(lua_next(L, idx)) {
+		rlp_encode_value(w, lua_gettop(L));
+		lua_pop(L, 1);
+	}
+	w->depth--;
+	// move the payload after the prefix, known only now
+	len = w->len - start;
+	h = rlp_head(NULL, 0xc0, len);
+	rlp_reserve(w, h);
+	p = (unsigned char*)w->buf + start;
+	memmove(p + h, p, len);
+	rlp_head(p, 0xc0, len);
+	w->len += h;
+}
+
+static void rlp_encode_value(rlp_writer *w, int idx) {
+	lua_State *L = w->L;
+	octet *o;
+	big *b;
+	if(lua_type(L, idx) == LUA_TTABLE) {
+		rlp_encode_list(w, idx);
+		return;
+	}
+	o = (octet*) luaL_testudata(L, idx, "zenroom.octet");
+	if(o) {
+		rlp_put_item(w, o->val, o->len);
+		return;
+	}
+	b = (big*) luaL_testudata(L, idx, "zenroom.big");
+	if(b && !b->doublesize && b->val) {
+		rlp_put_big(w, b);
+		return;
+	}
+	if(b) {
+		o = new_octet_from_big(L, b); SAFE(o);
+		// in RLP the number zero is the empty string
+		if(rlp_is_zero(o)) rlp_put_item(w, NULL, 0);
+		else rlp_put_item(w, o->val, o->len);
+		lua_pop(L, 1);
+		return;
+	}
+	if(lua_type(L, idx) != LUA_TUSERDATA
+	   || luaL_getmetafield(L, idx, "__name") != LUA_TSTRING
+	   || strncmp(lua_tostring(L, -1), "zenroom.", 8) != 0)
+		luaL_error(L, "Invalid data type for ETH RLP encoder: %s",
+		           luaL_typename(L, idx));
+	lua_pop(L, 1);
+	lua_getfield(L, idx, "octet");
+	lua_pushvalue(L, idx);
+	lua_call(L, 1, 1);
+	o = (octet*) luaL_testudata(L, -1, "zenroom.octet");
+	if(!o) luaL_error(L, "ETH RLP encoder: octet conversion failed");
+	rlp_put_item(w, o->val, o->len);
+	lua_pop(L, 1);
+}
+
+/***
+Encodes an octet, a zenroom value or a table of them (nested at
+will) in RLP.
+
+@function RLP.encode(data)
+@return octet
+*/
+static int rlp_encode(lua_State *L) {
+	rlp_writer w;
+	octet *o;
+	luaL_checkany(L, 1);
+	lua_settop(L, 1);
+	lua_pushnil(L); // RLP_BOX
+	w.L = L;
+	w.buf = NULL;
+	w.len = 0;
+	w.cap = 0;
+	w.depth = 0;
+	rlp_encode_value(&w, 1);
+	o = o_new(L, (int)w.len); SAFE(o);
+	if(w.len) memcpy(o->val, w.buf, w.len);
+	o->len = (int)w.len;
+	return 1;
+}
+
+typedef struct {
+	const unsigned char *s;
+	size_t len;
+	int depth;
+} rlp_parser;
+
+static int rlp_error(lua_State *L, const char *msg, size_t pos) {
+	return luaL_error(L, "The RLP input is not valid: %s at byte %d",
+	                  msg, (int)pos);
+}
+
+// pushes a copy of s[pos..pos+len) as octet
+static void rlp_push_slice(lua_State *L, rlp_parser *p, size_t pos, size_t len) {
+	octet *o = o_new(L, (int)len);
+	if(!o) {
+		lerror(L, "ETH RLP decoder: cannot allocate octet");
+		return; }
+	memcpy(o->val, p->s + pos, len);
+	o->len = (int)len;
+}
+
+// decodes the item at pos, which must end before end, pushes it and
+// returns the position after it
+static size_t rlp_decode_value(lua_State *L, rlp_parser *p, size_t pos, size_t end) {
+	unsigned char c = p->s[pos];
+	size_t len = 0, start;
+	int b, i;
+	if(c < 0x80) {
+		rlp_push_slice(L, p, pos, 1);
+		return pos + 1;
+	}
+	if(c < 0xb8 || (c >= 0xc0 && c < 0xf8)) {
+		len = c - (c < 0xc0 ? 0x80 : 0xc0);
+		start = pos + 1;
+	} else {
+		b = c - (c < 0xc0 ? 0xb7 : 0xf7);
+		if(b > (int)sizeof(size_t) || (size_t)b >= end - pos)
+			rlp_error(L, "length out of bounds", pos);
+		for(i=1; i<=b; i++) len = (len << 8) | p->s[pos+i];
+		start = pos + 1 + b;
+	}
+	if(len > end - start) rlp_error(L, "length out of bounds", pos);
+	if(c < 0xc0) {
+		rlp_push_slice(L, p, start, len);
+		return start + len;
+	}
+	if(++p->depth > RLP_MAX_DEPTH) rlp_error(L, "too many nested lists", pos);
+	luaL_checkstack(L, 3, "ETH RLP decoder");
+	lua_newtable(L);
+	pos = start;
+	for(i=1; pos < start + len; i++) {
+		pos = rlp_decode_value(L, p, pos, start + len);
+		lua_rawseti(L, -2, i);
+	}
+	p->depth--;
+	return pos;
+}
+
+/***
+Decodes the first RLP item found in an octet (or string) into an
+octet or a table of them: the octets point inside the input.
+
+@function RLP.decode(rlp)
+@return octet or table
+*/
+static int rlp_decode(lua_State *L) {
+	rlp_parser p;
+	octet *o = (octet*) luaL_testudata(L, 1, "zenroom.octet");
+	if(o) {
+		p.s = (const unsigned char*)o->val;
+		p.len = o->len;
+	} else
+		p.s = (const unsigned char*)luaL_checklstring(L, 1, &p.len);
+	lua_settop(L, 1);
+	p.depth = 0;
+	if(p.len == 0) rlp_error(L, "unexpected end of input", 0);
+	rlp_decode_value(L, &p, 0, p.len);
+	return 1;
+}
+
+int luaopen_rlp(lua_State *L) {
+	(void)L;
+	const struct luaL_Reg rlp_class[] = {
+		{"encode", rlp_encode},
+		{"decode", rlp_decode},
+		{NULL,NULL}
+	};
+	const struct luaL_Reg rlp_methods[] = {
+		{NULL,NULL}
+	};
+	zen_add_class(L, "rlp", rlp_class, rlp_methods);
+	return 1;
+}
@@ -46,6 +46,7 @@
 
 #include <zenroom.h>
 #include <zen_memory.h>
+#include <amcl.h>
 
 // hex2oct used to import hex sequence into rng seed
 #include <encoding.h>
@@ -62,6 +63,9 @@
 
 // prototypes from zen_octet.c
 extern void push_buffer_to_octet(lua_State *L, char *p, size_t len);
+extern octet* o_borrow(lua_State *L, const char *buf, const int len);
+// prototype from zen_qp.c
+extern void zen_qp_select(zenroom_t *Z);
 
 // prototypes from lua_modules.c
 extern int zen_require_override(lua_State *L, const int restricted);
@@ -71,6 +75,13 @@ extern int zen_lua_init(lua_State *L);
 extern void zen_add_io(lua_State *L);
 // prototypes from zen_parse.c
 extern void zen_add_parse(lua_State *L);
+// prototypes from zen_json.c
+extern void zen_add_json(lua_State *L);
+// prototypes from zen_pack.c
+extern void zen_add_pack(lua_State *L);
+// prototypes from lua_functions.c
+extern void zen_add_types(lua_State *L);
+extern void zen_add_table(lua_State *L);
 // prototype from zen_config.c
 extern int zen_conf_parse(zenroom_t *ZZ, const char *configuration);
 
@@ -141,6 +152,10 @@ int zen_init_pmain(lua_State *L) { // protected mode init
 	// load our own openlibs and extensions
 	zen_add_io(L);
 	zen_add_parse(L);
+	zen_add_json(L);
+	zen_add_pack(L);
+	zen_add_types(L);
+	zen_add_table(L);
 
 	zen_add_random(L);
 
@@ -153,9 +168,36 @@ int zen_init_pmain(lua_State *L) { // protected mode init
 }
 
 #include <lstate.h>
+// DATA and KEYS are declared as Lua strings or, when configured with
+// input=octet, as read-only octets borrowing the caller's buffers
+static void zen_setinput(zenroom_t *ZZ, const char *name,
+                         const char *buf, size_t len) {
+	lua_State *L = (lua_State*)ZZ->lua;
+	if(!buf || !len) return;
+	func(L, "declaring global: %s", name);
+	if(ZZ->zconf_input == OCTET && len <= MAX_OCTET) {
+		if(o_borrow(L, buf, len)) {
+			lua_setglobal(L, name);
+			return;
+		}
+	}
+	if(ZZ->zconf_input == OCTET)
+		warning(L, "%s too big to be an octet (%u bytes)", name, len);
+	lua_pushlstring(L, buf, len);
+	lua_setglobal(L, name);
+}
+
+zenroom_t *zen_init(const char *conf, char *keys, char *data) {
+	return zen_init_len(conf,
+	                    keys, keys ? strlen(keys) : 0,
+	                    data, data ? strlen(data) : 0);
+}
+
 // initializes globals: Z, L (in this order)
 // zen_init_pmain is the Lua routine executed in protected mode
-zenroom_t *zen_init(const char *conf, char *keys, char *data) {
+zenroom_t *zen_init_len(const char *conf,
+                        const char *keys, size_t keys_len,
+                        const char *data, size_t data_len) {
 	zenroom_t *ZZ = (zenroom_t*)malloc(sizeof(zenroom_t));
 
 	// create the zenroom_t global context
@@ -167,16 +209,22 @@ zenroom_t *zen_init(const char *conf, char *keys, char *data) {
 	ZZ->stderr_pos = 0;
 	ZZ->stderr_len = 0;
 	ZZ->stderr_full = 0;
+	ZZ->stdout_cb = NULL;
+	ZZ->stderr_cb = NULL;
+	ZZ->cb_ctx = NULL;
 	ZZ->userdata = NULL;
 	ZZ->errorlevel = 0;
 	ZZ->debuglevel = 2;
 	ZZ->random_generator = NULL;
 	ZZ->random_external = 0;
+	ZZ->qp_clean = 0;
 	ZZ->zstd_c = NULL;
 	ZZ->zstd_d = NULL;
+	ZZ->zstd_level = ZSTD_CLEVEL_DEFAULT;
 	// set zero rngseed as config flag
 	ZZ->zconf_rngseed[0] = '\0';
 	ZZ->zconf_printf = LIBC;
+	ZZ->zconf_input = STRING;
 	ZZ->exitcode = 1; // success
 
 	if(conf) {
@@ -261,14 +309,8 @@ zenroom_t *zen_init(const char *conf, char *keys, char *data) {
 	lua_setglobal(ZZ->lua, "RNGSEED");
 
 	// load arguments if present
-	if(data) {
-		func(ZZ->lua, "declaring global: DATA");
-		zen_setenv(ZZ->lua,"DATA",data);
-	}
-	if(keys) {
-		func(ZZ->lua, "declaring global: KEYS");
-		zen_setenv(ZZ->lua,"KEYS",keys);
-	}
+	zen_setinput(ZZ, "DATA", data, data_len);
+	zen_setinput(ZZ, "KEYS", keys, keys_len);
 	return(ZZ);
 }
 
@@ -318,6 +360,7 @@ int zen_exec_zencode(zenroom_t *ZZ, const char *script) {
 	int ret;
 	char *zscript = malloc(MAX_ZENCODE);
 	lua_State* L = (lua_State*)ZZ->lua;
+	zen_qp_select(ZZ);
 	// introspection on code being executed
 	(*ZZ->snprintf)(zscript,MAX_ZENCODE-1,
 	        "local _res, _err\n"
@@ -351,6 +394,7 @@ int zen_exec_script(zenroom_t *ZZ, const char *script) {
 		return ERR_INIT; }
 	int ret;
 	lua_State* L = (lua_State*)ZZ->lua;
+	zen_qp_select(ZZ);
 	// introspection on code being executed
 	zen_setenv(L,"CODE",(char*)script);
 	ret = luaL_dostring(L, script);
@@ -507,3 +551,92 @@ int zenroom_exec_tobuf(char *script, char *conf, char *keys, char *data,
 	return( _check_zenroom_result(Z, zen_exec_script(Z, script) ));
 }
 
+int zencode_exec_len(char *script, char *conf,
+		const char *keys, size_t keys_len,
+		const char *data, size_t data_len,
+		char *stdout_buf, size_t stdout_len,
+		char *stderr_buf, size_t stderr_len) {
+
+	if (_check_script_arg(script) != SUCCESS) return ERR_INIT;
+
+	char *c;
+	c = conf ? (conf[0] == '\0') ? NULL : conf : NULL;
+
+	zenroom_t *Z = zen_init_len(c, keys, keys_len, data, data_len);
+	if (_check_zenroom_init(Z) != SUCCESS) return ERR_INIT;
+
+	// setup stdout and stderr buffers
+	Z->stdout_buf = stdout_buf;
+	Z->stdout_len = stdout_len;
+	Z->stderr_buf = stderr_buf;
+	Z->stderr_len = stderr_len;
+
+	return( _check_zenroom_result(Z, zen_exec_zencode(Z, script) ));
+}
+
+int zenroom_exec_len(char *script, char *conf,
+		const char *keys, size_t keys_len,
+		const char *data, size_t data_len,
+		char *stdout_buf, size_t stdout_len,
+		char *stderr_buf, size_t stderr_len) {
+
+	if (_check_script_arg(script) != SUCCESS) return ERR_INIT;
+
+	char *c;
+	c = conf ? (conf[0] == '\0') ? NULL : conf : NULL;
+
+	zenroom_t *Z = zen_init_len(c, keys, keys_len, data, data_len);
+	if (_check_zenroom_init(Z) != SUCCESS) return ERR_INIT;
+
+	// setup stdout and stderr buffers
+	Z->stdout_buf = stdout_buf;
+	Z->stdout_len = stdout_len;
+	Z->stderr_buf = stderr_buf;
+	Z->stderr_len = stderr_len;
+
+	return( _check_zenroom_result(Z, zen_exec_script(Z, script) ));
+}
+
+int zencode_exec_cb(char *script, char *conf,
+		const char *keys, size_t keys_len,
+		const char *data, size_t data_len,
+		zen_write_t stdout_cb, zen_write_t stderr_cb,
+		void *cb_ctx) {
+
+	if (_check_script_arg(script) != SUCCESS) return ERR_INIT;
+
+	char *c;
+	c = conf ? (conf[0] == '\0') ? NULL : conf : NULL;
+
+	zenroom_t *Z = zen_init_len(c, keys, keys_len, data, data_len);
+	if (_check_zenroom_init(Z) != SUCCESS) return ERR_INIT;
+
+	// setup stdout and stderr callbacks
+	Z->stdout_cb = stdout_cb;
+	Z->stderr_cb = stderr_cb;
+	Z->cb_ctx = cb_ctx;
+
+	return( _check_zenroom_result(Z, zen_exec_zencode(Z, script) ));
+}
+
+int zenroom_exec_cb(char *script, char *conf,
+		const char *keys, size_t keys_len,
+		const char *data, size_t data_len,
+		zen_write_t stdout_cb, zen_write_t stderr_cb,
+		void *cb_ctx) {
+
+	if (_check_script_arg(script) != SUCCESS) return ERR_INIT;
+
+	char *c;
+	c = conf ? (conf[0] == '\0') ? NULL : conf : NULL;
+
+	zenroom_t *Z = zen_init_len(c, keys, keys_len, data, data_len);
+	if (_check_zenroom_init(Z) != SUCCESS) return ERR_INIT;
+
+	// setup stdout and stderr callbacks
+	Z->stdout_cb = stdout_cb;
+	Z->stderr_cb = stderr_cb;
+	Z->cb_ctx = cb_ctx;
+
+	return( _check_zenroom_result(Z, zen_exec_script(Z, script) ));
+}
@@ -24,6 +24,13 @@
 /////////////////////////////////////////
 // high level api: one simple call
 
+#include <stddef.h>
+
+// callback receiving output as it is printed, with the opaque ctx
+// given at exec. Returns 0 on success, any other value discards the
+// rest of the output on that stream.
+typedef int (*zen_write_t)(void *ctx, const char *buf, size_t len);
+
 int zenroom_exec(char *script, char *conf, char *keys, char *data);
 
 int zencode_exec(char *script, char *conf, char *keys, char *data);
@@ -38,6 +45,35 @@ int zencode_exec_tobuf(char *script, char *conf, char *keys, char *data,
                        char *stdout_buf, size_t stdout_len,
                        char *stderr_buf, size_t stderr_len);
 
+// keys and data are buffers of the given length and may contain
+// binary data. With the "input=octet" configuration they are exposed
+// to scripts as octets pointing to the same buffers, without copies:
+// the buffers must not change until the call returns.
+int zenroom_exec_len(char *script, char *conf,
+                     const char *keys, size_t keys_len,
+                     const char *data, size_t data_len,
+                     char *stdout_buf, size_t stdout_len,
+                     char *stderr_buf, size_t stderr_len);
+int zencode_exec_len(char *script, char *conf,
+                     const char *keys, size_t keys_len,
+                     const char *data, size_t data_len,
+                     char *stdout_buf, size_t stdout_len,
+                     char *stderr_buf, size_t stderr_len);
+
+// output and logs are passed to callbacks as they are printed, so
+// nothing is truncated and no buffer has to be sized in advance. The
+// callbacks may be NULL to print on stdout and stderr.
+int zenroom_exec_cb(char *script, char *conf,
+                    const char *keys, size_t keys_len,
+                    const char *data, size_t data_len,
+                    zen_write_t stdout_cb, zen_write_t stderr_cb,
+                    void *cb_ctx);
+int zencode_exec_cb(char *script, char *conf,
+                    const char *keys, size_t keys_len,
+                    const char *data, size_t data_len,
+                    zen_write_t stdout_cb, zen_write_t stderr_cb,
+                    void *cb_ctx);
+
 ////////////////////////////////////////
 
 
@@ -63,7 +99,8 @@ typedef int (*vsnprintf_t)( char * buf, size_t count, char const * fmt, va_list
 
 // conf switches
 typedef enum { STB, MUTT, LIBC } printftype;
-typedef enum { NIL, VERBOSE, COLOR, RNGSEED, PRINTF } zconf;
+typedef enum { STRING, OCTET } inputtype;
+typedef enum { NIL, VERBOSE, COLOR, RNGSEED, PRINTF, ZSTDLEVEL, INPUT } zconf;
 
 // zenroom context, also available as "_Z" global in lua space
 // contents are opaque in lua and available only as lightuserdata
@@ -71,6 +108,7 @@ typedef struct {
 	void *lua; // (lua_State*)
         void *zstd_c; // ZSTD context
         void *zstd_d;
+        int zstd_level; // default compression level
 
 	char *stdout_buf;
 	size_t stdout_len;
@@ -82,11 +120,17 @@ typedef struct {
 	size_t stderr_pos;
 	size_t stderr_full;
 
+	zen_write_t stdout_cb; // take precedence over buffers
+	zen_write_t stderr_cb;
+	void *cb_ctx;
+
 	void *random_generator; // cast to RNG
 	char random_seed[RANDOM_SEED_LEN+4];
         char runtime_random256[256+4];
 	int random_external; // signal when rngseed is external
 
+	int qp_clean; // QP.implementation('clean') selected
+
 	int debuglevel;
 	int errorlevel;
 	void *userdata; // anything passed at init (reserved for caller)
@@ -98,6 +142,7 @@ typedef struct {
 
   	char zconf_rngseed[(RANDOM_SEED_LEN*2)+4]; // 0x and terminating \0
   	printftype zconf_printf;
+	inputtype zconf_input; // how DATA and KEYS are exposed
 
 	int exitcode;
 } zenroom_t;
@@ -110,6 +155,9 @@ typedef struct {
 #define SUCCESS 0 // EXIT_SUCCESS
 
 zenroom_t *zen_init(const char *conf, char *keys, char *data);
+zenroom_t *zen_init_len(const char *conf,
+                        const char *keys, size_t keys_len,
+                        const char *data, size_t data_len);
 int  zen_exec_script(zenroom_t *Z, const char *script);
 int  zen_exec_zencode(zenroom_t *Z, const char *script);
 void zen_teardown(zenroom_t *zenroom);
@@ -0,0 +1,52 @@
+#!/usr/bin/env bash
+
+# Time operations on arrays of BIG numbers modulo the order of the
+# curve: with a Lua loop of scalar operations and with the batch
+# functions of BIG
+# usage: ./benchmark_big_batch.sh [elements] [runs]
+# prints the best run in milliseconds for each, the operations are
+# repeated 10 times in a run and averaged, since filling the arrays
+# takes longer
+
+####################
+# common script init
+if ! test -r utils.sh; then
+	echo "run executable from its own directory: $0"; exit 1; fi
+. ./utils.sh
+Z="`detect_zenroom_path` `detect_zenroom_conf`"
+
+#################
+Elements=${1:-10000}
+Runs=${2:-5}
+
+# $1 statements
+bench() {
+	bench_time <<EOF
+local a, b = { }, { }
+for i=1,$Elements do a[i] = BIG.new(O.random(31)) b[i] = BIG.new(O.random(31)) end
+local o = ECP.order()
+local r = { }
+for k=1,10 do
+$1
+end
+EOF
+}
+
+base=`bench ""`
+# $1 name, $2 loop, $3 batch
+row() {
+	local l=`bench "$2"`
+	local c=`bench "$3"`
+	echo "$1,`bench_diff $l $base 10000`,`bench_diff $c $base 10000`"
+}
+
+echo "$Elements elements,loop,batch"
+row modmul "for i=1,#a do r[i] = BIG.modmul(a[i], b[i], o) end" \
+	"r = BIG.modmul_batch(a, b, o)"
+row modadd "for i=1,#a do r[i] = (a[i] + b[i]) % o end" \
+	"r = BIG.modadd_batch(a, b, o)"
+row modinv "for i=1,#a do r[i] = BIG.modinv(a[i], o) end" \
+	"r = BIG.modinv_batch(a, o)"
+row inner_product "local s = BIG.new(0)
+for i=1,#a do s = (s + BIG.modmul(a[i], b[i], o)) % o end" \
+	"local s = BIG.inner_product(a, b, o)"
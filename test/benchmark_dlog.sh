@@ -0,0 +1,43 @@
+#!/usr/bin/env bash
+
+# Time the count of homomorphic sums by discrete log, as done by
+# ELGAH.count and PET.count_signatures_petition: with the table of
+# multiples built in Lua on every call, as they used to do (only up
+# to 10^4), with ECP.dlog on a new base and with ECP.dlog reusing
+# the cached table. The count searched is the maximum, the worst case
+# usage: ./benchmark_dlog.sh [runs]
+# prints the best run in milliseconds for each
+
+####################
+# common script init
+if ! test -r utils.sh; then
+	echo "run executable from its own directory: $0"; exit 1; fi
+. ./utils.sh
+Z="`detect_zenroom_path` `detect_zenroom_conf`"
+
+#################
+Runs=${1:-5}
+
+# $1 maximum, $2 statement
+bench() {
+	bench_time <<EOF
+local H = ECP.hashtopoint(OCTET.from_string('benchmark dlog'))
+local P = H * BIG.new($1)
+$2
+EOF
+}
+
+echo "max,lua table,dlog,dlog cached"
+for n in 1000 10000 100000 1000000 10000000; do
+	base=`bench $n ""`
+	l="-"
+	if [ $n -le 10000 ]; then
+		l=`bench $n "local t = { }
+for i=1,$n do t[(BIG.new(i) * H):octet():hex()] = i end
+assert(t[P:octet():hex()] == $n)"`
+		l=`bench_diff $l $base`
+	fi
+	c=`bench $n "assert(P:dlog(H, $n) == $n)"`
+	w2=`bench $n "assert(P:dlog(H, $n) == $n) assert(P:dlog(H, $n) == $n)"`
+	echo "$n,$l,`bench_diff $c $base`,`bench_diff $w2 $c`"
+done
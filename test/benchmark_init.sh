@@ -0,0 +1,41 @@
+#!/usr/bin/env bash
+
+# Compare the ways src/lua can be embedded in zenroom: plain sources,
+# bytecode, stripped bytecode and zstd compressed stripped bytecode.
+# Rebuilds zenroom with each mode, then runs an empty script
+# usage: ./benchmark_init.sh [make target] [runs]
+# prints binary size, memory in use after init and the median and
+# minimum "Time used" in microseconds, which includes zen_init
+
+####################
+# common script init
+if ! test -r utils.sh; then
+	echo "run executable from its own directory: $0"; exit 1; fi
+. ./utils.sh
+Z="`detect_zenroom_path` `detect_zenroom_conf`"
+
+#################
+Target=${1:-linux}
+Runs=${2:-41}
+Tmp=`mktemp -d`
+
+# $1 name, rest make variables
+bench() {
+	local name=$1; shift
+	make -C .. $Target "$@" >$Tmp/build.log 2>&1 || {
+		echo "build failed for $name, see $Tmp/build.log"; exit 1; }
+	local bin=`echo $Z | cut -d' ' -f1`
+	local size=`stat -c %s $bin 2>/dev/null || stat -f %z $bin`
+	local mem=`echo 'print(1)' | $Z 2>&1 | awk -F: '/Memory in use/ {print $2}'`
+	echo 'print(1)' | bench_runs | awk -v n="$name" -v s="$size" -v m="$mem" \
+		'{a[NR]=$1} END { printf "%-12s %9s %8s %8s %8s\n", n, s, m, a[int((NR+1)/2)], a[1] }'
+}
+
+printf "%-12s %9s %8s %8s %8s\n" mode size init median min
+bench source     COMPILE_LUA=0
+bench bytecode   COMPILE_LUA=1
+bench stripped   COMPILE_LUA=1 STRIP_LUA=1
+bench zstd       COMPILE_LUA=1 STRIP_LUA=1 ZSTD_LUA=1
+# leave the default build in place
+make -C .. $Target >/dev/null 2>&1
+rm -rf $Tmp
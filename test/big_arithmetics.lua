@@ -21,3 +21,42 @@ assert(four:int() == 4, "Error four conversion to int")
 
 assert(BIG.new(O.from_hex('0a')):int() == 10, "Octet -> BIG -> integer conversion failed")
 assert(BIG.new(O.from_hex('14')):int() == 20, "Octet -> BIG -> integer conversion failed")
+
+print '== BIG batch operations'
+local o = ECP.order()
+-- odd modulus other than the order, and an even one
+local p = BIG.new(O.from_hex('fffffffffffffffffffffffffffffffffffffffffffffffffffffffefffffc2f'))
+local e = BIG.new(O.from_hex('ffffffffffffffffffffffffffffffff00000000000000000000000000000000'))
+local a, b = { }, { }
+for i=1,50 do a[i] = BIG.random() b[i] = BIG.random() end
+a[7] = BIG.new(0)
+a[8] = BIG.new(1)
+a[9] = o - BIG.new(1)
+for _, n in ipairs({ o, p, e }) do
+   local mul = BIG.modmul_batch(a, b, n)
+   local add = BIG.modadd_batch(a, b, n)
+   local sca = BIG.modmul_batch(a, b[1], n)
+   local ip = BIG.new(0)
+   for i=1,#a do
+	  assert(mul[i] == BIG.modmul(a[i], b[i], n), "Wrong modmul_batch")
+	  assert(sca[i] == BIG.modmul(a[i], b[1], n), "Wrong modmul_batch by a BIG")
+	  assert(add[i] == (a[i] + b[i]) % n, "Wrong modadd_batch")
+	  ip = (ip + BIG.modmul(a[i], b[i], n)) % n
+   end
+   assert(BIG.inner_product(a, b, n) == ip, "Wrong inner_product")
+end
+for _, n in ipairs({ o, p }) do
+   local inv = BIG.modinv_batch(a, n)
+   assert(inv[7] == BIG.new(0), "Zero inverted")
+   for i=1,#a do
+	  if i ~= 7 then
+		 assert(inv[i] == BIG.modinv(a[i], n), "Wrong modinv_batch")
+		 assert(BIG.modmul(inv[i], a[i], n) == BIG.new(1), "Wrong inverse")
+	  end
+   end
+end
+-- the order of the curve is the default modulus
+assert(BIG.modmul_batch(a, b)[3] == BIG.modmul(a[3], b[3]), "Wrong default modulus")
+assert(#BIG.modinv_batch({ }) == 0, "Wrong empty batch")
+assert(not pcall(BIG.modmul_batch, a, { b[1] }), "Arrays of different length")
+print '= OK'
@@ -0,0 +1,51 @@
+#!/usr/bin/env bash
+
+# Time the ECDH operations made of scalar multiplications on
+# secp256k1: key generation, session, signature, verification and
+# public key recovery
+# usage: ./benchmark_glv.sh [number of operations] [runs]
+# prints the best time in microseconds of one operation
+
+####################
+# common script init
+if ! test -r ../utils.sh; then
+	echo "run executable from its own directory: $0"; exit 1; fi
+. ../utils.sh
+Z="`detect_zenroom_path` `detect_zenroom_conf`"
+
+#################
+Num=${1:-1000}
+Runs=${2:-3}
+
+# $1 statement, repeated for i=1,Num
+bench() {
+	bench_time <<EOF
+local sks, pks, hashes, sigs, pars = { }, { }, { }, { }, { }
+for i=1,$Num do
+   sks[i] = sha256(O.from_string('secret '..i))
+   hashes[i] = sha256(O.from_string('message '..i))
+end
+local kp = ECDH.keygen()
+local peer = kp.public
+local sig, par = ECDH.sign_hashed(kp.private, hashes[1], 32)
+local r = sig.r
+for i=1,$Num do
+   $1
+end
+EOF
+}
+
+# $1 time, $2 base time
+us() {
+	bench_diff $1 $2 $Num
+}
+
+base=`bench ""`
+echo "operation,microseconds"
+echo "keygen,`us $(bench "ECDH.keygen()") $base`"
+echo "pubgen,`us $(bench "ECDH.pubgen(sks[i])") $base`"
+echo "session,`us $(bench "ECDH.session(sks[i], peer)") $base`"
+echo "sign,`us $(bench "ECDH.sign(sks[i], hashes[i])") $base`"
+echo "sign_hashed,`us $(bench "ECDH.sign_hashed(sks[i], hashes[i], 32)") $base`"
+echo "verify_hashed,`us $(bench "assert(ECDH.verify_hashed(kp.public, hashes[1], sig, 32))") $base`"
+echo "recovery,`us $(bench "assert(ECDH.recovery(r, par and 1 or 0, hashes[1], sig) == kp.public)") $base`"
@@ -0,0 +1,43 @@
+#!/usr/bin/env bash
+
+# Time the verification of many ECDSA signatures one by one with
+# ECDH.verify_hashed and at once with ECDH.verify_batch, all made by
+# one key or each by a different key
+# usage: ./benchmark_verify_batch.sh [max number of signatures]
+# prints the time in milliseconds of each
+
+####################
+# common script init
+if ! test -r ../utils.sh; then
+	echo "run executable from its own directory: $0"; exit 1; fi
+. ../utils.sh
+Z="`detect_zenroom_path` `detect_zenroom_conf`"
+
+#################
+Max=${1:-1000}
+
+# $1 number of signatures, $2 number of keys, $3 statement
+bench() {
+	bench_time <<EOF
+local keys = { }
+for i=1,$2 do keys[i] = ECDH.keygen() end
+local pks, hashes, sigs = { }, { }, { }
+for i=1,$1 do
+   local k = keys[(i % $2) + 1]
+   pks[i] = ECDH.compress_public_key(k.public)
+   hashes[i] = sha256(O.from_string('message '..i))
+   sigs[i] = ECDH.sign_hashed(k.private, hashes[i], 32)
+end
+$3
+EOF
+}
+
+echo "signatures,keys,verify,verify_batch"
+for n in 10 100 $Max; do
+	for k in 1 $n; do
+		base=`bench $n $k ""`
+		one=`bench $n $k "for i=1,$n do assert(ECDH.verify_hashed(pks[i], hashes[i], sigs[i], 32)) end"`
+		batch=`bench $n $k "assert(ECDH.verify_batch(pks, hashes, sigs, 32))"`
+		echo "$n,$k,`bench_diff $one $base`,`bench_diff $batch $base`"
+	done
+done
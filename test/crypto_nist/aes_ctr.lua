@@ -67,4 +67,13 @@ Ciphertext = O.from_hex('1e031dda2fbe03d1792170a0f3009cee')
 Plaintext  = O.from_hex('f69f2445df4f9b17ad2b417be66c3710')
 assert( AES.ctr(Key, Ciphertext, Input) == Plaintext, "Error in block #4" )
 
+print(' F.5.1 CTR-AES128 all blocks in one call')
+Plaintext  = O.from_hex('6bc1bee22e409f96e93d7e117393172aae2d8a571e03ac9c9eb76fac45af8e5130c81c46a35ce411e5fbc1191a0a52eff69f2445df4f9b17ad2b417be66c3710')
+Ciphertext = O.from_hex('874d6191b620e3261bef6864990db6ce9806f66b7970fdff8617187bb9fffdff5ae4df3edbd5d35e5b4f09020db03eab1e031dda2fbe03d1792170a0f3009cee')
+assert( AES.ctr(Key, Plaintext, Counter) == Ciphertext, "Error in all blocks" )
+assert( AES.ctr(Key, Ciphertext, Counter) == Plaintext, "Error in all blocks" )
+-- the last block may be short
+assert( AES.ctr(Key, Plaintext:sub(1,50), Counter) == Ciphertext:sub(1,50),
+		"Error in partial block" )
+
 print('OK')
@@ -0,0 +1,84 @@
+print()
+print '= DEEPMAP, DEEPCOPY AND TABLE UTILITIES TESTS'
+print()
+
+local function equal(a, b)
+   if luatype(a) ~= luatype(b) then return false end
+   if luatype(a) ~= 'table' then return a == b end
+   for k, v in pairs(a) do if not equal(v, b[k]) then return false end end
+   for k, _ in pairs(b) do if a[k] == nil then return false end end
+   return true
+end
+
+local t = { a = 1, b = { c = 2, d = { 3, 4, { e = 5 } } }, f = 'x', g = { } }
+local mt = { __index = function() return 'meta' end }
+setmetatable(t.b, mt)
+
+print '== deepmap'
+local res = deepmap(function(v) return luatype(v) == 'number' and v * 10 or v end, t)
+assert(equal(res, { a = 10, b = { c = 20, d = { 30, 40, { e = 50 } } }, f = 'x', g = { } }),
+       "deepmap wrong result")
+assert(t.a == 1 and t.b.d[3].e == 5, "deepmap changed its argument")
+assert(getmetatable(res.b) == mt, "deepmap did not keep the metatable")
+-- keys and further arguments are passed to the function
+local keys = { }
+deepmap(function(v, k, acc) table.insert(acc, k) end, { x = 1, y = { z = 2 } }, keys)
+table.sort(keys)
+assert(equal(keys, { 'x', 'z' }), "deepmap keys or arguments not passed")
+-- nil results remove the value
+res = deepmap(function(v) if v ~= 2 then return v end end, { 1, 2, 3, k = { 2 } })
+assert(res[2] == nil and res[3] == 3 and next(res.k) == nil, "deepmap nil result")
+-- values are visited depth first in the order of pairs()
+local order, expected = { }, { }
+local flat = { { 1, 2, { 3, 4 } }, 5, { { { 6 } } } }
+deepmap(function(v) table.insert(order, v) end, flat)
+local function visit(t)
+   for _, v in pairs(t) do
+      if luatype(v) == 'table' then visit(v) else table.insert(expected, v) end
+   end
+end
+visit(flat)
+assert(equal(order, expected), "deepmap visit order differs from recursion")
+assert(not pcall(deepmap, 1, { }), "deepmap accepted a non function")
+assert(not pcall(deepmap, print, 'x'), "deepmap accepted a non table")
+
+print '== deepmap_inplace'
+local u = deepcopy(t)
+local r = deepmap_inplace(function(v) return luatype(v) == 'number' and v + 1 or nil end, u)
+assert(r == u, "deepmap_inplace did not return its argument")
+assert(equal(u, { a = 2, b = { c = 3, d = { 4, 5, { e = 6 } } }, g = { } }),
+       "deepmap_inplace wrong result")
+
+print '== deep nesting'
+local deep = { }
+local n = deep
+for i=1,10000 do n.next = { v = i } n = n.next end
+res = deepmap(function(v) return v * 2 end, deep)
+n = res
+for i=1,10000 do n = n.next assert(n.v == i * 2, "deep nesting wrong value") end
+assert(equal(deepcopy(deep), deep), "deepcopy of deep nesting differs")
+
+print '== deepcopy'
+local key = { 'k' }
+local src = { [key] = { 1 }, o = O.from_hex('ff'), s = 's', n = { 1, { 2 } } }
+setmetatable(src, { __index = { m = 1 } })
+local cp = deepcopy(src)
+assert(cp ~= src and cp.n ~= src.n and cp.n[2] ~= src.n[2], "deepcopy shares tables")
+assert(equal(cp.n, src.n) and cp.o == src.o and cp.s == 's', "deepcopy values differ")
+assert(getmetatable(cp) ~= getmetatable(src) and cp.m == 1, "deepcopy metatable")
+for k, v in pairs(cp) do
+   if luatype(k) == 'table' then
+      assert(k ~= key and k[1] == 'k' and v[1] == 1, "deepcopy table key")
+   end
+end
+assert(deepcopy(42) == 42 and deepcopy('s') == 's', "deepcopy of plain values")
+
+print '== isarray and isdictionary'
+assert(isarray({ 1, 2, 3 }) == 3 and isarray({ }) == 0, "isarray of array")
+assert(isarray({ 1, a = 2 }) == false and isarray(12) == false, "isarray of non array")
+assert(isdictionary({ a = 1, b = 2 }) == 2, "isdictionary of dictionary")
+assert(isdictionary({ 1, a = 2 }) == false and isdictionary('x') == false,
+       "isdictionary of non dictionary")
+assert(isarray(nil) == false and isdictionary(false) == false, "nil arguments")
+
+print '= OK'
@@ -107,5 +107,85 @@ while (tot<100) or (not shorter) do
 	tot = tot+1
 end
 
+print '== batch verification'
+local pks, msgs, sigs, hpks, hashes, hsigs = {}, {}, {}, {}, {}, {}
+for i=1,20 do
+   local k = (i % 2 == 0) and alice or bob
+   pks[i] = k.public
+   msgs[i] = O.random(20+i)
+   sigs[i] = ECDH.sign(k.private, msgs[i])
+   hashes[i] = sha256(msgs[i])
+   hsigs[i] = ECDH.sign_hashed(k.private, hashes[i], #hashes[i])
+   -- compressed and uncompressed keys
+   hpks[i] = (i % 3 == 0) and ECDH.compress_public_key(k.public) or k.public
+end
+local ok, failed = ECDH.verify_batch(pks, msgs, sigs)
+assert(ok and #failed == 0, "ecdh verify batch failed")
+ok, failed = ECDH.verify_batch(hpks, hashes, hsigs, 32)
+assert(ok and #failed == 0, "ecdh verify batch hashed failed")
+ok = ECDH.verify_batch(alice.public, { msgs[2], msgs[4] }, { sigs[2], sigs[4] })
+assert(ok, "ecdh verify batch with a single key failed")
+sigs[5] = { r = sigs[5].r, s = sigs[7].s }
+msgs[9] = O.random(10)
+pks[12] = bob.public
+hsigs[3] = { r = O.from_hex('00'), s = hsigs[3].s }
+hpks[8] = O.random(65)
+ok, failed = ECDH.verify_batch(pks, msgs, sigs)
+assert(not ok and ZEN.serialize(failed) == ZEN.serialize({5, 9, 12}),
+       "ecdh verify batch accepts invalid signatures")
+for i=1,20 do
+   assert(ECDH.verify(pks[i], msgs[i], sigs[i]) == not (i == 5 or i == 9 or i == 12))
+end
+ok, failed = ECDH.verify_batch(hpks, hashes, hsigs, 32)
+assert(not ok and ZEN.serialize(failed) == ZEN.serialize({3, 8}),
+       "ecdh verify batch hashed accepts invalid signatures")
+
+print '== GLV scalar multiplication'
+-- keys, sessions, signatures and recoveries of edge cases of the GLV
+-- split and of other scalars: the digest is the one computed by the
+-- generic ECP_mul and ECP_mul2 of milagro
+local edges = {
+   '0000000000000000000000000000000000000000000000000000000000000001',
+   '0000000000000000000000000000000000000000000000000000000000000002',
+   '000000000000000000000000000000000000000000000000000000000000000f',
+   '00000000000000000000000000000000ffffffffffffffffffffffffffffffff',
+   '0000000000000000000000000000000100000000000000000000000000000000',
+   '0000000000000000000000000000000300000000000000000000000000000001',
+   '5363ad4cc05c30e0a5261c028812645a122e22ea20816678df02967c1b23bd72',
+   '5363ad4cc05c30e0a5261c028812645a122e22ea20816678df02967c1b23bd73',
+   'ac9c52b33fa3cf1f5ad9e3fd77ed9ba4a880b9fc8ec739c2e0cfc810b51283ce',
+   '7fffffffffffffffffffffffffffffff5d576e7357a4501ddfe92f46681b20a0',
+   'fffffffffffffffffffffffffffffffebaaedce6af48a03bbfd25e8cd0364140',
+   'fffffffffffffffffffffffffffffffebaaedce6af48a03bbfd25e8cd036413f',
+   'ffffffffffffffffffffffffffffffffffffffffffffffffffffffffffffffff',
+}
+local scalars = { }
+for _,v in ipairs(edges) do table.insert(scalars, O.from_hex(v)) end
+for i=1,40 do table.insert(scalars, sha256(O.from_string('scalar '..i))) end
+local out = { }
+local pubs = { }
+for i,sk in ipairs(scalars) do pubs[i] = ECDH.pubgen(sk) end
+for i,sk in ipairs(scalars) do
+   local pk = pubs[i]
+   local peer = pubs[(i % #scalars) + 1]
+   local _, ses = ECDH.session(sk, peer)
+   local m = O.from_string('message '..i)
+   local h = sha256(m)
+   local k = scalars[#scalars - i + 1]
+   local sig = ECDH.sign(sk, m, k)
+   local hsig, parity = ECDH.sign_hashed(sk, h, #h, k)
+   assert(ECDH.verify(pk, m, sig), "verify failed at "..i)
+   assert(ECDH.verify_hashed(pk, h, hsig, #h), "verify_hashed failed at "..i)
+   assert(not ECDH.verify(pk, h, sig), "verify of wrong message at "..i)
+   local rpk, valid = ECDH.recovery(hsig.r, parity and 1 or 0, h, hsig)
+   assert(valid and rpk == pk, "recovery failed at "..i)
+   table.insert(out, pk .. ses .. sig.r .. sig.s .. hsig.r .. hsig.s .. rpk)
+end
+local digest = out[1]
+for i=2,#out do digest = sha256(digest .. out[i]) end
+assert(digest:hex() == 'cd65f6c977c1621a749accf9b87399a4c6168bb620abdeb0c8967d6a0711ade5',
+       "ecdh GLV results differ from milagro")
+
+
 print "OK"
 -- vk, sk = ecdh:keygen()
@@ -44,6 +44,30 @@ Aw2 = (g1*k) * c + g1 * rk
 
 assert(Aw1 == Aw2, 'Error in zero-knowledge proof')
 
+-- test discrete log of small multiples
+local h = ECP.hashtopoint(OCTET.from_string('dlog'))
+for _,n in ipairs({0, 1, 2, 15, 16, 17, 33, 127, 128, 129, 999, 1000}) do
+   assert(ECP.dlog(h * BIG.new(n), h) == n, 'Error in dlog of '..n)
+   assert((g1 * BIG.new(n)):dlog(g1, 1000) == n, 'Error in dlog of '..n)
+end
+assert(ECP.dlog(h * BIG.new(1001), h, 1000) == nil, 'Error in dlog out of range')
+assert(ECP.dlog(h * BIG.new(1000), h, 999) == nil, 'Error in dlog out of range')
+assert(ECP.dlog(h * INT.random(), h) == nil, 'Error in dlog not found')
+-- the larger table replaces the cached one, which is still valid
+for _,n in ipairs({54321, 123457, 999999, 1000000}) do
+   assert(ECP.dlog(h * BIG.new(n), h, 1000000) == n, 'Error in dlog of '..n)
+end
+assert(ECP.dlog(h * BIG.new(77), h, 100) == 77, 'Error in dlog with cached table')
+assert(ECP.dlog(g1 * BIG.new(1000000) + g1, g1, 1000000) == nil,
+	   'Error in dlog out of range')
+-- the cache keeps the last few bases, older ones are computed again
+for i=1,6 do
+   local b = ECP.hashtopoint(OCTET.from_string('dlog'..i))
+   assert(ECP.dlog(b * BIG.new(i*11), b) == i*11, 'Error in dlog of base '..i)
+end
+assert(ECP.dlog(h * BIG.new(999), h) == 999, 'Error in dlog after cache eviction')
+assert(not pcall(ECP.dlog, h, h, -1), 'Error in dlog of negative maximum')
+
 
 print "OK"
 print''
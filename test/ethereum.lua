@@ -55,6 +55,51 @@ for i=1,100 do
 	  "verification from not_add and decodedTx succeded")
 end
 
+print("Verify many transactions from their addresses")
+-- recovery of the public key followed by its address, as done in Lua
+local function verify_from_address_lua(add, txSigned)
+   local txHash = ETH.encodeTransaction({
+	 nonce=txSigned.nonce, gas_price=txSigned.gas_price,
+	 gas_limit=txSigned.gas_limit, to=txSigned.to,
+	 value=txSigned.value, data=txSigned.data,
+	 v=INT.shr(txSigned.v-INT.new(35), 1), r=O.new(), s=O.new() })
+   txHash = HASH.digest('keccak256', txHash)
+   local pk, valid = ECDH.recovery(txSigned.r, fif(txSigned.v:parity(), 0, 1),
+				   txHash, { r=txSigned.r, s=txSigned.s })
+   return valid and ETH.address_from_public_key(pk) == add
+end
+local txs, adds = {}, {}
+local alice = O.random(32)
+local alice_add = ETH.address_from_public_key(ECDH.pubgen(alice))
+for i=1,10 do
+   tx.v = INT.new(1337)
+   tx.r = O.new()
+   tx.s = O.new()
+   tx.nonce = INT.new(i)
+   local sk = (i % 2 == 0) and alice or O.random(32)
+   adds[i] = ETH.address_from_public_key(ECDH.pubgen(sk))
+   txs[i] = ETH.decodeTransaction(ETH.encodeSignedTransaction(sk, tx))
+   assert(verify_from_address_lua(adds[i], txs[i]))
+end
+local ok, failed = ETH.verify_from_address_batch(adds, txs)
+assert(ok and #failed == 0, "verification of many transactions failed")
+ok = ETH.verify_from_address_batch(alice_add, { txs[2], txs[4], txs[6] })
+assert(ok, "verification of many transactions from one address failed")
+ok, failed = ETH.verify_from_address_batch(alice_add, txs)
+assert(not ok and ZEN.serialize(failed) == ZEN.serialize({1, 3, 5, 7, 9}),
+       "verification of transactions from another address succeded")
+adds[3] = sha256(adds[3]):sub(13, 32)
+adds[6] = adds[6]:sub(1, 19)
+txs[8].s = txs[9].s
+txs[10].r = O.from_hex('00')
+ok, failed = ETH.verify_from_address_batch(adds, txs)
+assert(not ok and ZEN.serialize(failed) == ZEN.serialize({3, 6, 8, 10}),
+       "verification of many transactions accepts invalid ones")
+for i=1,10 do
+   assert(ETH.verify_from_address(adds[i], txs[i]) == not (i == 3 or i == 6 or i == 8 or i == 10))
+   assert(ETH.verify_from_address(adds[i], txs[i]) == verify_from_address_lua(adds[i], txs[i]))
+end
+
 assert(ETH.make_storage_data(O.from_string('ciao mondo')) == O.from_hex('b374012b0000000000000000000000000000000000000000000000000000000000000020000000000000000000000000000000000000000000000000000000000000000a6369616f206d6f6e646f00000000000000000000000000000000000000000000'))
 assert(ETH.make_storage_data(O.from_string('aaaabbbbccccddddaaaabbbbccccddddaaaabbbbccccddddaaaabbbbccccddddaaaabbbbccccddddaaaabbbbccccddddaaaabbbbccccddddaaaabbbbccccddddaaaabbbbccccddddaaaabbbbccccddddaaaabbbbccccddddaaaabbbbccccddddaaaabbbbccccddddaaaabbbbccccddddaaaabbbbccccddddaaaabbbbccccddddaaaabbbbccccddddaaaabbbbccccddddaaaabbbbccccddddaaaabbbbccccddddaaaabbbbccccddddaaaabbbbccccddddaaaabbbbccccddddaaaabbbbccccddddaaaabbbbccccddddaaaabbbbccccddddaaaabbbbccccddddaaaabbbbccccddddaaaabbbbccccddddaaaabbbbccccddddaaaabbbbccccddddaaaabbbbccccddddpadding')) == O.from_hex('b374012b00000000000000000000000000000000000000000000000000000000000000200000000000000000000000000000000000000000000000000000000000000207616161616262626263636363646464646161616162626262636363636464646461616161626262626363636364646464616161616262626263636363646464646161616162626262636363636464646461616161626262626363636364646464616161616262626263636363646464646161616162626262636363636464646461616161626262626363636364646464616161616262626263636363646464646161616162626262636363636464646461616161626262626363636364646464616161616262626263636363646464646161616162626262636363636464646461616161626262626363636364646464616161616262626263636363646464646161616162626262636363636464646461616161626262626363636364646464616161616262626263636363646464646161616162626262636363636464646461616161626262626363636364646464616161616262626263636363646464646161616162626262636363636464646461616161626262626363636364646464616161616262626263636363646464646161616162626262636363636464646461616161626262626363636364646464616161616262626263636363646464646161616162626262636363636464646461616161626262626363636364646464616161616262626263636363646464646161616162626262636363636464646470616464696e6700000000000000000000000000000000000000000000000000'))
 
@@ -81,6 +126,15 @@ local kp = ETH.keygen()
 print(kp.address:hex())
 print(kp.private:hex())
 
+print("Addresses of many public keys")
+local pks = {}
+for i=1,10 do pks[i] = ECDH.keygen().public end
+local addrs = ETH.address_from_public_keys(pks)
+assert(#addrs == #pks)
+for i=1,#pks do
+   assert(addrs[i] == ETH.address_from_public_key(pks[i]))
+end
+
 
 -- -- Send some eth to the new address
 -- tx = {
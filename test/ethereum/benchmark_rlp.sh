@@ -0,0 +1,169 @@
+#!/usr/bin/env bash
+
+# Time the RLP encoding and decoding of many Ethereum transactions
+# with the native ETH.encodeRLP/decodeRLP and with the Lua version
+# they replaced, which is kept below as reference
+# usage: ./benchmark_rlp.sh [number of transactions]
+# prints the best of 5 runs in milliseconds for each, after checking
+# that both give the same results
+
+####################
+# common script init
+if ! test -r ../utils.sh; then
+	echo "run executable from its own directory: $0"; exit 1; fi
+. ../utils.sh
+Z="`detect_zenroom_path` `detect_zenroom_conf`"
+
+#################
+Max=${1:-5000}
+Runs=5
+
+reference() {
+	cat <<'EOF'
+local ETH = require('crypto_ethereum')
+local LUA = {}
+-- the empty octect is encoded as nil
+-- a table contains in the first position (i.e. 1) the number of elements
+function LUA.encodeRLP(data)
+   local header = nil
+   local res = nil
+   local byt = nil
+
+   if type(data) == 'zenroom.big' then
+      data = ETH.n2o(data)
+   end
+
+   if type(data) == 'table' then
+      -- empty octet
+      res = O.new()
+      for _, v in pairs(data) do
+	 res = res .. LUA.encodeRLP(v)
+      end
+      if #res < 56 then
+	 res = INT.new(192+#res):octet() .. res
+      else
+	 -- Length of the result to be saved before the bytes themselves
+	 byt = INT.new(#res):octet()
+	 header = INT.new(247+#byt):octet() .. byt
+
+      end
+   elseif iszen(type(data)) then
+      res = data:octet()
+
+      -- index single bytes of an octet
+      local byt = INT.new(0)
+      if #res > 0 then
+	 byt = INT.new( res:chop(1) )
+      end
+
+      if #res ~= 1 or byt >= INT.new(128) then
+	 if #res < 56 then
+	    header = INT.new(128+#res):octet()
+	 else
+	    -- Length of the result to be saved before the bytes themselves
+	    byt = INT.new(#res):octet()
+	    header = INT.new(183+#byt):octet() .. byt
+	 end
+      end
+
+   else
+      error("Invalid data type for ETH RLP encoder: "..type(data))
+   end
+   if header then
+      res = header .. res
+   end
+   return res
+end
+
+
+-- i is the position from which we start to parse
+-- return a table with
+-- * res which is the content read
+-- * idx which is the position of the next byte to read
+local function decodeRLPgeneric(rlp, i)
+   local byt, bytInt, res, idx
+
+   byt = rlp:sub(i, i)
+   idx=i+1
+   bytInt = tonumber(byt:hex(), 16)
+
+   if bytInt < 128 then
+      res = byt
+   elseif bytInt <= 183 then
+      idx = i+bytInt-128+1
+      if bytInt == 128 then
+	 res = O.new()
+      else
+	 res = rlp:sub(i+1, idx-1)
+      end
+
+   elseif bytInt < 192 then
+      local sizeEnd = bytInt-183;
+      local size = tonumber(rlp:sub(i+1, i+sizeEnd):hex(), 16)
+      idx = i+sizeEnd+size+1
+      res = rlp:sub(i+sizeEnd+1, idx-1)
+   else -- it is a tuple
+      local j
+      if bytInt <= 247 then
+	 idx = i+bytInt-192+1 -- total number of bytes
+      else -- decode big endian encoding
+	 local sizeEnd
+	 sizeEnd = bytInt-247;
+	 local size = tonumber(rlp:sub(i+1, i+sizeEnd):hex(), 16)
+	 idx = i+sizeEnd+size+1
+	 i=i+sizeEnd
+      end
+      i=i+1 -- initial position
+      j=1 -- index inside res
+      res = {}
+      -- decode the tuple in a table
+      while i < idx do
+	 local readNext
+	 readNext = decodeRLPgeneric(rlp, i)
+	 res[j] = readNext.res
+	 j = j+1
+	 i = readNext.idx
+      end
+   end
+   return {
+      res=res,
+      idx=idx
+   }
+end
+
+function LUA.decodeRLP(rlp)
+   return decodeRLPgeneric(rlp, 1).res
+end
+EOF
+}
+
+# $1 number of transactions, $2 statement
+bench() {
+	{ reference; cat <<EOF
+local txs = { }
+for i=1,$1 do
+   txs[i] = { BIG.new(i), BIG.from_decimal('1000000000'), BIG.new(60000),
+	      O.random(20), BIG.new(0), O.random(68),
+	      BIG.new(27), O.random(32), O.random(32) }
+end
+local raw = { }
+for i=1,$1 do raw[i] = ETH.encodeRLP(txs[i]) end
+for i=1,$1,97 do
+   assert(LUA.encodeRLP(txs[i]) == raw[i])
+   local a, b = ETH.decodeRLP(raw[i]), LUA.decodeRLP(raw[i])
+   for j=1,9 do assert(a[j] == b[j]) end
+end
+$2
+EOF
+	} | bench_time
+}
+
+echo "transactions,lua encode,native encode,lua decode,native decode"
+for n in 100 $Max; do
+	base=`bench $n ""`
+	le=`bench $n "for i=1,$n do LUA.encodeRLP(txs[i]) end"`
+	ne=`bench $n "for i=1,$n do ETH.encodeRLP(txs[i]) end"`
+	ld=`bench $n "for i=1,$n do LUA.decodeRLP(raw[i]) end"`
+	nd=`bench $n "for i=1,$n do ETH.decodeRLP(raw[i]) end"`
+	echo "$n,`bench_diff $le $base`,`bench_diff $ne $base`,`bench_diff $ld $base`,`bench_diff $nd $base`"
+done
@@ -0,0 +1,77 @@
+#!/usr/bin/env bash
+
+# Time the verification of many signed Ethereum transactions from the
+# address of their sender: with the Lua version of
+# ETH.verify_from_address, kept below as reference, with the native
+# ETH.verify_from_address and with ETH.verify_from_address_batch
+# usage: ./benchmark_verify_address.sh [number of transactions]
+# prints the best of 5 runs in milliseconds for each
+
+####################
+# common script init
+if ! test -r ../utils.sh; then
+	echo "run executable from its own directory: $0"; exit 1; fi
+. ../utils.sh
+Z="`detect_zenroom_path` `detect_zenroom_conf`"
+
+#################
+Max=${1:-1000}
+Runs=5
+
+reference() {
+	cat <<'EOF'
+local ETH = require('crypto_ethereum')
+local LUA = {}
+function LUA.verify_from_address(add, txSigned)
+   local tx = {}
+   for _, v in pairs({"nonce", "gas_price", "gas_limit", "to",
+		      "value", "data"}) do
+      tx[v] = txSigned[v]
+   end
+   tx.v = INT.shr(txSigned.v-INT.new(35), 1)
+   tx.r = O.new()
+   tx.s = O.new()
+   local txHash = HASH.digest('keccak256', ETH.encodeTransaction(tx))
+   local sig = { r=txSigned.r, s=txSigned.s }
+   local y_parity = fif(txSigned.v:parity(), 0, 1)
+   local x = INT.new(sig.r)
+   local p = ECDH.prime()
+   local n = ECDH.order()
+   local h = ECDH.cofactor()
+   local pk, valid
+   repeat
+      pk, valid = ECDH.recovery(x:octet(), y_parity, txHash, sig)
+      if h > 0 then x = (x + n) % p end
+      h = h-1
+   until (valid and ETH.address_from_public_key(pk) == add) or (h < 0)
+   return (valid and ETH.address_from_public_key(pk) == add)
+end
+EOF
+}
+
+# $1 number of transactions, $2 statement
+bench() {
+	{ reference; cat <<EOF
+local txs, adds = { }, { }
+for i=1,$1 do
+   local sk = sha256(O.from_string('sender '..i))
+   adds[i] = ETH.address_from_public_key(ECDH.pubgen(sk))
+   txs[i] = ETH.decodeTransaction(ETH.encodeSignedTransaction(sk, {
+      nonce=INT.new(i), gas_price=INT.new(1000), gas_limit=INT.new(25000),
+      to=O.from_hex('627306090abaB3A6e1400e9345bC60c78a8BEf57'),
+      value=INT.new(11), data=O.new(), v=INT.new(1337),
+      r=O.new(), s=O.new() }))
+end
+$2
+EOF
+	} | bench_time
+}
+
+echo "transactions,lua,native,native batch"
+for n in 10 100 $Max; do
+	base=`bench $n ""`
+	l=`bench $n "for i=1,$n do assert(LUA.verify_from_address(adds[i], txs[i])) end"`
+	s=`bench $n "for i=1,$n do assert(ETH.verify_from_address(adds[i], txs[i])) end"`
+	b=`bench $n "assert(ETH.verify_from_address_batch(adds, txs))"`
+	echo "$n,`bench_diff $l $base`,`bench_diff $s $base`,`bench_diff $b $base`"
+done
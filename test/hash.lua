@@ -77,3 +77,52 @@ for i,h in ipairs(hash_algos) do
    print(h.." OK")
 end
 
+
+print " keccak256 known vectors"
+local K = HASH.new('keccak256')
+assert(K:process(O.from_str('abc')) == hex('4e03657aea45a94fc7d47ba826c8d667c0d1e6e33a64a036ec44f58fa12d6c45'), "Error in keccak256")
+-- padding fits in a single byte at the end of the block
+assert(K:process(O.from_str(string.rep('a',135))) == hex('34367dc248bbd832f4e3e69dfaac2f92638bd0bbd18f2912ba4ef454919cf446'), "Error in keccak256 on 135 bytes")
+assert(K:process(O.from_str(string.rep('a',271))) == hex('132f47effd6c8b1b299efa53fe68aece77ec8ae4eb2e294f668eec94f76001e1'), "Error in keccak256 on 271 bytes")
+print "keccak256 OK"
+
+print " batch test"
+for i,h in ipairs({'keccak256', 'sha3_256', 'sha256', 'sha512'}) do
+   local H = HASH.new(h)
+   local arr = { str448, str896, O.from_str(string.rep('a',135)) }
+   for j=1,41 do arr[#arr+1] = O.random(j * 7) end
+   for j=1,16 do arr[#arr+1] = O.random(64) end
+   local res = H:process_batch(arr)
+   assert(#res == #arr, "Error in batch "..h)
+   for j=1,#arr do
+      assert(res[j] == H:process(arr[j]), "Error in batch "..h.." at "..j)
+   end
+   print(h.." OK")
+end
+
+print " digest test"
+for i,h in ipairs(hash_algos) do
+   assert(HASH.digest(h, str448) == _G[h..'_str448'], "Error in digest "..h)
+   assert(HASH.digest(h, str896) == _G[h..'_str896'], "Error in digest "..h)
+   print(h.." OK")
+end
+for i,h in ipairs({'keccak256', 'ripemd160'}) do
+   for j=1,300,23 do
+      local o = O.random(j)
+      assert(HASH.digest(h, o) == HASH.new(h):process(o), "Error in digest "..h.." on "..j.." bytes")
+   end
+   print(h.." OK")
+end
+assert(HASH.hash160(O.from_str('abc')) == hex('bb1be98c142444d7a56aa3981c3942a978e4dc33'), "Error in hash160")
+assert(sha256('abc') == hex('ba7816bf8f01cfea414140de5dae2223b00361a396177a9cb410ff61f20015ad'), "Error in sha256 on string")
+assert(not pcall(HASH.digest, 'md5', str448), "Error in digest of unknown algorithm")
+
+print " dsha256 test"
+local a, b, c = O.random(70), O.random(3), O.random(130)
+local abc = a..b..c
+assert(HASH.dsha256(abc) == sha256(sha256(abc)), "Error in dsha256")
+assert(HASH.dsha256(a, b, c) == HASH.dsha256(abc), "Error in dsha256 of many arguments")
+assert(HASH.dsha256({ a, { b }, c:string() }) == HASH.dsha256(abc), "Error in dsha256 of arrays")
+assert(HASH.dsha256(O.from_str('hello')) == hex('9595c9df90075148eb06860365df33584b75bff782a510c6cd4883a419833d50'), "Error in dsha256 vector")
+assert(not pcall(HASH.dsha256, a, 1), "Error in dsha256 of a number")
+print("dsha256 OK")
@@ -236,3 +236,74 @@ test("encode escape", function()
     assert( res == v, fmt("'%s' was not escaped properly", k) )
   end
 end)
+
+
+-- the C decoder used by JSON.decode must match json.raw_decode
+local docs = {
+  '{"a": 1, "b": -2.5e3, "c": "0x10", "d": [true, false, "x"], "e": {}}',
+  '{"esc": "\\"\\\\\\/\\b\\f\\n\\r\\t", "u": "\\u00e8\\u4e16\\ud83d\\ude02"}',
+  '{ "nested" : { "deep" : [ [ [ 1 ] ], { "k" : "v" } ] } , "null": null }',
+  '{"big": 1234567890123456789, "neg": -0, "frac": 0.10000000012}',
+}
+for _, s in ipairs(docs) do
+  assert( equal(json.decode(s), json.raw_decode(s)), "C decoder differs on: "..s )
+end
+-- concatenated objects are merged and arrays appended
+local res = json.decode('{"a": 1} \n {"b": 2} [3, 4] [5]')
+assert( res.a == 1 and res.b == 2, "concatenated objects not merged" )
+assert( equal(res.array, {3, 4, 5}), "concatenated arrays not appended" )
+-- zero bytes are skipped between values, decoding stops at other bytes
+res = json.decode('{"a": 1}\0\0 {"b": 2}\xa0 {"c": 3}')
+assert( res.a == 1 and res.b == 2 and not res.c, "bytes between values" )
+-- braces inside strings do not end the object
+res = json.decode('{"a": "}{", "b": "]"} {"c": 3}')
+assert( res.a == "}{" and res.b == "]" and res.c == 3, "braces in strings" )
+-- strings converted while parsing
+res = json.decode('{"a": "deadbeef", "b": ["00", "ff"], "n": 3}', 'hex')
+assert( res.a == O.from_hex('deadbeef') and res.b[2] == O.from_hex('ff') and res.n == 3,
+        "conversion while decoding" )
+res = json.decode('{"a": "hello"}', O.from_string)
+assert( res.a == O.from_string('hello'), "conversion function while decoding" )
+for _, s in ipairs({ '{"a": }', '{"a" 1}', '{"a": tru}', '{"a": [1 2]}',
+                     '{"a": "\\q"}', '{"a": "abc', '{"a": 01x}' }) do
+  assert( not pcall(json.decode, s), "invalid JSON parsed: "..s )
+end
+print( "[pass] C decoder" )
+
+-- the C encoder used by JSON.encode must match json.raw_encode of the
+-- table processed by INSPECT
+local function lua_encode(t, enc)
+  return json.raw_encode(INSPECT.process(t, enc))
+end
+local data = {
+  str = "quote \" backslash \\ ctrl \1\t\n\r\b\f end",
+  utf = "\xc3\xa8\xe4\xb8\x96",
+  num = { 1, -2, 3.5, 2^53, 0.1 },
+  bool = { t = true, f = false },
+  empty = { },
+  octets = { O.random(3), O.random(4), O.random(5), O.random(64) },
+  mixed = { a = O.from_string('hello'), b = { c = O.random(33) } },
+  big = BIG.new(O.from_hex('0102030405')),
+  ecp = ECP.generator(),
+  nested = { { { 'deep' } }, { k = 'v' } },
+  ['z key'] = 1, ['a key'] = 2, ['A key'] = 3, ['aa'] = 4, ['a'] = 5,
+}
+for _, enc in ipairs({ 'base64', 'url64', 'hex', 'string', 'base58', 'bin' }) do
+  local c = json.encode(data, enc)
+  assert( c == lua_encode(data, enc), "C encoder differs with encoding "..enc )
+  assert( equal(json.raw_decode(c), json.raw_decode(lua_encode(data, enc))),
+          "C encoder output does not decode with encoding "..enc )
+end
+assert( json.encode(data, O.to_hex) == lua_encode(data, O.to_hex),
+        "C encoder differs with a conversion function" )
+assert( json.encode('str') == '"str"' and json.encode(42) == '42',
+        "C encoder of plain values" )
+-- empty octets are dropped from objects and at the end of arrays
+assert( json.encode({ a = O.new(), b = 1 }) == '{"b":1}', "empty octet in object" )
+assert( json.encode({ 1, O.new() }) == '[1]', "empty octet at end of array" )
+local circular = { }
+circular.self = circular
+for _, t in ipairs({ circular, { 1, 2, nil, 4 }, { 1, 2, x = 3 }, { [{ }] = 1 } }) do
+  assert( not pcall(json.encode, t), "invalid table encoded" )
+end
+print( "[pass] C encoder" )
@@ -132,4 +132,71 @@ jsoncryptotest('base64')
 jsoncryptotest('url64')
 jsoncryptotest('bin')
 
+print '== type() and iszen() of zenroom values'
+for name, v in pairs({ octet = O.random(8), big = BIG.new(1), ecp = ECP.generator(),
+		      ecp2 = ECP2.generator(), hash = HASH.new('sha256') }) do
+   assert(type(v) == 'zenroom.'..name, "Wrong type of zenroom."..name..": "..type(v))
+   assert(luatype(v) == 'userdata', "Wrong luatype of zenroom."..name)
+   assert(iszen(v) and iszen(type(v)), "Not recognized as zenroom: "..name)
+end
+for _, v in ipairs({ 'string', 1, true, { }, print }) do
+   assert(type(v) == luatype(v), "Wrong type of "..luatype(v))
+   assert(not iszen(v) and not iszen(type(v)), "Recognized as zenroom: "..luatype(v))
+end
+
+print '== OCTET.set()'
+local elems = { }
+for i=1,1000 do elems[i] = sha256(O.from_string('element '..i)) end
+local s = O.set()
+assert(#s == 0, "New set is not empty")
+for i=1,500 do assert(s:insert(elems[i]), "Element not inserted") end
+-- a copy of the same content is already in the set
+assert(not s:insert(O.from_hex(elems[1]:hex())), "Duplicate inserted")
+assert(#s == 500, "Wrong set size")
+for i=1,500 do assert(s:contains(O.from_hex(elems[i]:hex())), "Element not found") end
+for i=501,1000 do assert(not s:contains(elems[i]), "Element found") end
+local s2 = O.set(elems)
+assert(#s2 == 1000, "Wrong size of set from array")
+for i, v in ipairs(s2:array()) do assert(v == elems[i], "Wrong order of elements") end
+-- other zenroom values are converted to octet, strings taken as they are
+s2:insert(BIG.new(42))
+assert(s2:contains(BIG.new(42):octet()), "BIG not found")
+s2:insert('abc')
+assert(s2:contains(O.from_string('abc')), "String not found")
+assert(s2:insert(O.new()) and s2:contains(O.new()), "Empty octet not found")
+-- chunks of an octet found in the set
+assert(s:count_chunks(elems[3]..elems[600]..elems[7], 32) == 2, "Wrong chunks")
+assert(s:count_chunks(elems[3]..O.from_hex('0102'), 32) == 1, "Wrong chunks")
+-- only zenroom values are taken when asked
+local s3 = O.set({ 'abc', 1, { }, O.from_string('abc'), BIG.new(7) }, true)
+assert(#s3 == 2 and s3:contains(BIG.new(7)), "Wrong set of zenroom values")
+
+print '== OCTET.map()'
+local m = O.map()
+for i=1,1000 do assert(m:put(elems[i], i), "Key not added") end
+assert(not m:put(O.from_hex(elems[10]:hex()), 'ten'), "Duplicate key added")
+assert(#m == 1000, "Wrong map size")
+assert(m:get(elems[10]) == 'ten', "Value not replaced")
+for i=11,1000 do assert(m:get(elems[i]) == i, "Wrong value") end
+assert(m:get(sha256(O.from_string('missing'))) == nil, "Missing key found")
+assert(m:contains(elems[1]) and not m:contains(O.from_string('x')), "Wrong contains")
+for i, v in ipairs(m:keys()) do assert(v == elems[i], "Wrong order of keys") end
+local dict = { alice = 1, bob = O.from_string('two'), [3] = 'skipped' }
+dict[O.from_string('carl')] = 3
+local m2 = O.map(dict)
+assert(#m2 == 3, "Wrong size of map from table")
+assert(m2:get('alice') == 1 and m2:get(O.from_string('bob')) == O.from_string('two')
+	   and m2:get('carl') == 3, "Wrong values of map from table")
+assert(type(m2) == 'zenroom.octet_map' and type(s3) == 'zenroom.octet_set',
+	   "Wrong type of set or map")
+
+print '== OCTET.find()'
+local arr = { 'abc', 7, { }, BIG.new(7), O.from_string('abc'), elems[5] }
+assert(O.find(arr, O.from_string('abc')) == 5, "Wrong position of octet")
+assert(O.find(arr, BIG.new(7)) == 4, "Wrong position of BIG")
+assert(O.find(arr, elems[5]:octet()) == 6, "Wrong position of copy")
+assert(O.find(arr, elems[6]) == nil, "Missing element found")
+assert(O.find({ }, elems[1]) == nil, "Element found in empty array")
+
 print '= OK'
+
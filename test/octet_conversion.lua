@@ -39,3 +39,47 @@ assert(O.from_base58(msg_b58) == OK, 'fail in base64 import')
 assert(O.from_bin(msg_bin) == OK, 'fail in bin import')
 assert(O.from_bin(msg_bin_sp) == OK, 'fail in bin / space import')
 
+
+print '================================'
+print 'TEST AUTOMATIC ENCODING DETECTION'
+local function names(t) return t and table.concat(t, ',') or 'none' end
+-- the vectors above are detected in the order of preference of str()
+local _, enc = O.from_auto(msg_u64)
+assert(enc == 'url64', 'url64 not detected: '..enc)
+assert(O.from_auto(msg_u64) == OK, 'fail in url64 auto import')
+_, enc = O.from_auto(msg_b64)
+assert(enc == 'base64', 'base64 not detected: '..enc)
+assert(O.from_auto(msg_b64) == OK, 'fail in base64 auto import')
+assert(O.from_auto(msg_bin_sp) == OK, 'fail in bin auto import')
+assert(names(O.encodings(msg_bin)) == 'url64,base64,hex,bin',
+       'wrong encodings of bin: '..names(O.encodings(msg_bin)))
+assert(names(O.encodings('jdV1ApWfY6s')) == 'url64,base58',
+       'wrong encodings of base58: '..names(O.encodings('jdV1ApWfY6s')))
+assert(names(O.encodings('0')) == 'hex,bin', 'wrong encodings of 0')
+assert(O.encodings('not encoded!') == nil, 'encodings of a plain string')
+local o, enc = O.from_auto('not encoded!')
+assert(enc == 'string' and o:str() == 'not encoded!', 'fail in string auto import')
+-- same result of the single checks and decoders for random data
+for i=3,200 do
+   local r = O.random(i)
+   for _, s in ipairs({ r:url64(), r:base64(), r:base58(), r:hex(), r:bin() }) do
+      local exp, expenc
+      if O.is_url64(s) then exp, expenc = O.from_url64(s), 'url64'
+      elseif O.is_base64(s) then exp, expenc = O.from_base64(s), 'base64'
+      elseif O.is_base58(s) then exp, expenc = O.from_base58(s), 'base58'
+      elseif O.is_hex(s) then exp, expenc = O.from_hex(s), 'hex'
+      elseif O.is_bin(s) then exp, expenc = O.from_bin(s), 'bin' end
+      local got, enc = O.from_auto(s)
+      assert(enc == expenc and got == exp, 'auto import differs on '..s)
+      local list, len = O.encodings(s)
+      assert(list[1] == expenc, 'first encoding differs on '..s)
+      if expenc ~= 'base58' then
+	 assert(len == #exp, 'decoded length differs on '..s..': '..len..' ~= '..#exp)
+      else
+	 assert(len >= #exp, 'base58 decoded length too short on '..s)
+      end
+   end
+end
+assert(str('_ty6mHZUMhA') == OK:str(), 'fail in str() detection')
+assert(str('hello world') == 'hello world', 'fail in str() of plain string')
+print 'OK'
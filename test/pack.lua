@@ -0,0 +1,100 @@
+print()
+print '= MESSAGEPACK AND CBOR TESTS'
+print()
+
+local function equal(a, b)
+   if type(a) ~= type(b) then return false end
+   if luatype(a) ~= 'table' then return a == b end
+   for k, v in pairs(a) do if not equal(v, b[k]) then return false end end
+   for k, _ in pairs(b) do if a[k] == nil then return false end end
+   return true
+end
+
+local function bytes(s) return O.from_rawlen(s, #s):hex() end
+
+print '== known vectors'
+assert(bytes(MPACK.encode({ a = 1 })) == '81a16101', "mpack map")
+assert(bytes(CBOR.raw_encode({ a = 1 })) == 'a1616101', "cbor map")
+assert(bytes(MPACK.encode({ 1, 2, 3 })) == '93010203', "mpack array")
+assert(bytes(CBOR.raw_encode({ 1, 2, 3 })) == '83010203', "cbor array")
+assert(bytes(MPACK.encode({ })) == '90', "mpack empty table")
+assert(bytes(MPACK.encode(-1)) == 'ff', "mpack negative fixint")
+assert(bytes(MPACK.encode(-33)) == 'd0df', "mpack int8")
+assert(bytes(MPACK.encode(300)) == 'cd012c', "mpack uint16")
+assert(bytes(CBOR.raw_encode(-500)) == '3901f3', "cbor negative")
+assert(bytes(CBOR.raw_encode(1000000)) == '1a000f4240', "cbor uint32")
+assert(bytes(MPACK.encode(O.from_hex('00ff'))) == 'c40200ff', "mpack bin")
+assert(bytes(CBOR.raw_encode(O.from_hex('00ff'))) == '4200ff', "cbor bytes")
+assert(bytes(MPACK.encode({ true, false })) == '92c3c2', "mpack booleans")
+assert(bytes(CBOR.raw_encode({ true, false })) == '82f5f4', "cbor booleans")
+-- keys are sorted
+assert(bytes(MPACK.encode({ b = 2, a = 1, c = 3 })) == '83a16101a16202a16303',
+       "mpack keys not sorted")
+
+print '== round trip'
+local t = {
+   str = 'hello',
+   oct = O.from_hex('000102030000ff'),
+   empty = O.new(),
+   num = { 0, 127, 128, 65535, 65536, -32, -129, -70000, 2147483647 },
+   float = 1.5,
+   flags = { yes = true, no = false },
+   nested = { a = { b = { c = { O.random(300), 'x' } } } },
+   long = string.rep('z', 70000)
+}
+for _, f in pairs({ MPACK, CBOR }) do
+   local enc = f == MPACK and MPACK.encode(t) or CBOR.raw_encode(t)
+   local dec = f.decode(enc)
+   assert(equal(dec, t), "round trip failed")
+   assert(type(dec.oct) == 'zenroom.octet', "octet not decoded as octet")
+   assert(type(dec.str) == 'string', "string not decoded as string")
+   assert(math.type(dec.num[9]) == 'integer', "integer not decoded as integer")
+   -- decoding from an octet
+   assert(equal(f.decode(O.from_rawlen(enc, #enc)), t), "decoding octet failed")
+end
+
+print '== zenroom types'
+local z = { big = BIG.random(), ecp = ECP.random(), ecp2 = ECP2.random() }
+local d = MPACK.decode(MPACK.encode(z))
+assert(type(d.big) == 'zenroom.big' and d.big == z.big, "mpack BIG")
+assert(type(d.ecp) == 'zenroom.ecp' and d.ecp == z.ecp, "mpack ECP")
+assert(type(d.ecp2) == 'zenroom.ecp2' and d.ecp2 == z.ecp2, "mpack ECP2")
+d = CBOR.decode(CBOR.raw_encode(z))
+assert(d.big == z.big:octet() and d.ecp == z.ecp:octet(), "cbor zenroom types")
+
+print '== previous Lua encoder'
+-- { number = octet '0x11be7' } as packed by the Lua msgpack module
+d = MPACK.decode(O.from_base64('gaZudW1iZXLHAAAACk1IZ3hNV0psTnc='))
+assert(d.number == O.from_string('0x11be7'), "legacy octet not decoded")
+
+print '== cbor indefinite lengths, tags and floats'
+assert(equal(CBOR.decode(O.from_hex('9f0102ff')), { 1, 2 }), "indefinite array")
+assert(equal(CBOR.decode(O.from_hex('bf616101ff')), { a = 1 }), "indefinite map")
+assert(CBOR.decode(O.from_hex('5f4201024103ff')) == O.from_hex('010203'),
+       "indefinite bytes")
+assert(CBOR.decode(O.from_hex('7f626869616aff')) == 'hij', "indefinite text")
+assert(CBOR.decode(O.from_hex('f93c00')) == 1.0, "half float")
+assert(CBOR.decode(O.from_hex('f9c400')) == -4.0, "negative half float")
+assert(CBOR.decode(O.from_hex('c11a514b67b0')) == 1363896240, "tag")
+assert(equal(CBOR.decode(O.from_hex('a26161f66162f5')), { b = true }),
+       "null values are skipped in maps")
+
+print '== invalid inputs'
+local function fails(f, data, msg)
+   local ok = pcall(f, data)
+   assert(not ok, "invalid input accepted: "..msg)
+end
+fails(MPACK.decode, O.from_hex('930102'), "truncated array")
+fails(MPACK.decode, O.from_hex('c40501'), "truncated bin")
+fails(MPACK.decode, O.from_hex('0101'), "trailing data")
+fails(MPACK.decode, O.from_hex('c1'), "reserved byte")
+fails(MPACK.decode, O.from_hex('dfffffffff'), "huge map")
+fails(CBOR.decode, O.from_hex('1f'), "indefinite integer")
+fails(CBOR.decode, O.from_hex('9f01'), "unterminated array")
+fails(CBOR.decode, O.from_hex(string.rep('81', 300)..'01'), "nesting")
+local circular = { }
+circular.self = circular
+fails(MPACK.encode, circular, "circular reference")
+fails(MPACK.auto, MPACK.encode(1), "not a table")
+
+print '== OK'
@@ -29,6 +29,33 @@ for i=1,100 do
    assert(not QP.verified_msg(kp.public, sig, O.to_string(sha256(m))), "dilithium verify message failed")
 end
 
+print'batch sign/verify of 20 messages'
+local msgs = { }
+for i=1,20 do msgs[i] = O.random(32*i) end
+local sigs = QP.sign_batch(kp.private, msgs)
+assert(#sigs == #msgs, "dilithium batch sign wrong length")
+for i=1,#msgs do
+   assert(sigs[i] == QP.sign(kp.private, msgs[i]), "dilithium batch sign differs")
+end
+for i,ok in ipairs(QP.verify_batch(kp.public, sigs, msgs)) do
+   assert(ok, "dilithium batch verify failed")
+end
+local other = QP.sigkeygen()
+local pks = { }
+for i=1,#msgs do pks[i] = i % 2 == 0 and kp.public or other.public end
+for i,ok in ipairs(QP.verify_batch(pks, sigs, msgs)) do
+   assert(ok == (i % 2 == 0), "dilithium batch verify with many keys failed")
+end
+msgs[3] = sha256(msgs[3])
+local res = QP.verify_batch(kp.public, sigs, msgs)
+assert(not res[3] and res[4], "dilithium batch verify of wrong message failed")
+-- errors on an element release the expanded key
+assert(not pcall(QP.sign_batch, kp.private, { msgs[1], {} }),
+       "dilithium batch sign of invalid message succeeded")
+assert(not pcall(QP.verify_batch, kp.public, { sigs[1], {} }, { msgs[1], msgs[2] }),
+       "dilithium batch verify of invalid signature succeeded")
+collectgarbage'collect'
+
 
 print()
 print' KYBER ENC/DEC TEST'
@@ -49,3 +76,35 @@ for i=1,100 do
    local bob_secret = QP.ntrup_dec(kp.private, alice.cipher)
    assert(alice.secret == bob_secret, "ntrup decpription failed")
 end
+
+print()
+print' AVX2 / CLEAN CROSS-CHECK'
+local impl = QP.implementation()
+print('implementation in use: '..impl)
+if impl == 'avx2' then
+   print'iterate 20 tests comparing avx2 and clean outputs'
+   for i=1,20 do
+      local m = O.random(64+i)
+      -- dilithium: deterministic sign and pubgen must match byte by byte
+      local kp = QP.sigkeygen()
+      local avx_sig = QP.sign(kp.private, m)
+      local avx_pub = QP.sigpubgen(kp.private)
+      QP.implementation('clean')
+      local clean_sig = QP.sign(kp.private, m)
+      local clean_pub = QP.sigpubgen(kp.private)
+      assert(QP.verify(kp.public, avx_sig, m), "clean verify of avx2 signature failed")
+      QP.implementation('avx2')
+      assert(avx_sig == clean_sig, "dilithium avx2 and clean signatures differ")
+      assert(avx_pub == clean_pub, "dilithium avx2 and clean public keys differ")
+      assert(QP.verify(kp.public, clean_sig, m), "avx2 verify of clean signature failed")
+      -- kyber: encapsulate with one, decapsulate with the other
+      local kkp = QP.kemkeygen()
+      local alice = QP.enc(kkp.public)
+      QP.implementation('clean')
+      assert(QP.dec(kkp.private, alice.cipher) == alice.secret, "kyber clean dec of avx2 enc failed")
+      assert(QP.kempubgen(kkp.private) == kkp.public, "kyber avx2 and clean public keys differ")
+      local bob = QP.enc(kkp.public)
+      QP.implementation('avx2')
+      assert(QP.dec(kkp.private, bob.cipher) == bob.secret, "kyber avx2 dec of clean enc failed")
+   end
+end
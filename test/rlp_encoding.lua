@@ -397,3 +397,30 @@ for k, v in pairs(tests) do
    assert(ETH.encodeRLP(ETH.decodeRLP(v[2])) == v[2])
    assert(ZEN.serialize(ETH.decodeRLP(v[2])) == ZEN.serialize(v[1]))
 end
+
+-- numbers are encoded without leading zeroes, zero is the empty string
+assert(ETH.encodeRLP(BIG.new(0)) == O.from_hex('80'))
+assert(ETH.encodeRLP(BIG.new(15)) == O.from_hex('0f'))
+assert(ETH.encodeRLP(BIG.new(1024)) == O.from_hex('820400'))
+assert(ETH.encodeRLP({BIG.new(0), {}, {{}, O.from_hex('80')}}) == O.from_hex('c680c0c3c08180'))
+
+-- decoded octets stay valid after the input is collected
+local decoded = ETH.decodeRLP(O.from_hex('c680c0c3c08180'))
+collectgarbage()
+assert(#decoded == 3 and #decoded[1] == 0 and #decoded[2] == 0)
+assert(decoded[3][2] == O.from_hex('80'))
+
+-- decoded octets are copies, filling them leaves the input unchanged
+local input = O.from_hex('c88363617483646f67')
+ETH.decodeRLP(input)[1]:fill(O.from_string('XYZ'))
+assert(input == O.from_hex('c88363617483646f67'))
+local raw = O.to_string(input)
+ETH.decodeRLP(raw)[1]:fill(O.from_string('XYZ'))
+assert(raw == O.to_string(O.from_hex('c88363617483646f67')))
+
+-- truncated or malformed input is an error
+for _, bad in ipairs({ '', '81', 'b8', 'b90100', 'c2c3', 'c3830102', 'f9' }) do
+   assert(not pcall(ETH.decodeRLP, O.from_hex(bad)), bad)
+end
+assert(not pcall(ETH.encodeRLP, 'string'))
+assert(not pcall(ETH.encodeRLP, 42))
@@ -230,6 +230,31 @@ save() {
 	>&2 echo "===================================="
 }
 
+# benchmarks: run the Lua script read from stdin $Runs times (once if
+# unset) and print the "Time used" of each in microseconds, sorted
+bench_runs() {
+	local script=`mktemp`
+	cat > $script
+	for r in `seq ${Runs:-1}`; do
+		$Z $script 2>&1 >/dev/null | awk -F: '/Time used/ {print $2}'
+	done | sort -n
+	rm -f $script
+}
+
+# benchmarks: print the best time of bench_runs
+# example:
+# base=`bench_time <<EOF ... EOF`
+bench_time() {
+	bench_runs | head -1
+}
+
+# benchmarks: time $1 minus time $2 in microseconds, divided by $3 (1000
+# if unset, to print milliseconds) and printed with $4 decimals (1)
+bench_diff() {
+	awk -v t="$1" -v b="$2" -v n="${3:-1000}" -v d="${4:-1}" \
+		'BEGIN {printf "%." d "f", (t-b)/n}'
+}
+
 success() {
 	p=`pwd`
 	echo
@@ -43,6 +43,19 @@ and the 'lucky one' is not found in 'bonnetjes'
 Then print the 'lucky one'
 EOF
 
+# membership in an array of 32 octets is found by comparing contents in C (OCTET.find)
+cat <<EOF | zexe array_found_in.zen -a arr.json
+rule input encoding url64
+rule output encoding hex
+Given I have a 'url64 array' named 'bonnetjes'
+When I pick the random object in 'bonnetjes'
+and I rename the 'random object' to 'lucky one'
+and the 'lucky one' is found in 'bonnetjes'
+and I create the random object of '256' bits
+and the 'random object' is not found in 'bonnetjes'
+Then print the 'lucky one'
+EOF
+
 # cat <<EOF | zexe array_hashtopoint.zen -a arr.json > ecp.json
 # rule input encoding url64
 # rule output encoding url64
@@ -0,0 +1,43 @@
+#!/usr/bin/env bash
+
+# Time signing and verifying the witness of a segwit transaction with
+# many inputs, as in the consolidation of many unspent outputs
+# usage: ./benchmark_witness.sh [max number of inputs]
+# prints the time in milliseconds to sign all inputs and to verify all
+# signatures
+
+####################
+# common script init
+if ! test -r ../utils.sh; then
+	echo "run executable from its own directory: $0"; exit 1; fi
+. ../utils.sh
+Z="`detect_zenroom_path` `detect_zenroom_conf`"
+
+#################
+Max=${1:-500}
+
+# $1 number of inputs, $2 statement
+bench() {
+	bench_time <<EOF
+local btc = require('crypto_bitcoin')
+local sk = btc.wif_to_sk(O.from_base58('cPW7XRee1yx6sujBWeyZiyg18vhhQk9JaxxPdvwGwYX175YCF48G'))
+local from = O.from_segwit('tb1q04c9a079f3urc5nav647frx4x25hlv5vanfgug')
+local unspent = { }
+for i=1,$1 do
+   unspent[i] = { txid = sha256(O.from_string('tx'..i)), vout = i % 4,
+		  address = from, amount = BIG.from_decimal('100000') }
+end
+local tx = btc.build_tx_from_unspent(unspent,
+   O.from_segwit('tb1q73czlxl7us4s6num5sjlnq6r0yuf8uh5clr2tm'),
+   BIG.from_decimal(tostring($1 * 100000 - 5000)), BIG.from_decimal('1000'))
+$2
+EOF
+}
+
+echo "inputs,sign,verify"
+for n in 10 100 $Max; do
+	base=`bench $n ""`
+	sign=`bench $n "tx.witness = btc.build_witness(tx, sk)"`
+	verify=`bench $n "tx.witness = btc.build_witness(tx, sk) assert(btc.verify_witness(tx))"`
+	echo "$n,`bench_diff $sign $base`,`bench_diff $verify $sign`"
+done
@@ -0,0 +1,75 @@
+#!/usr/bin/env bash
+
+# Compare the C deepmap, deepmap_inplace and deepcopy with the previous
+# recursive Lua functions on nested dictionaries of 10^5 elements
+# usage: ./benchmark_deepmap.sh [elements] [iterations]
+# prints the mean time in milliseconds
+
+####################
+# common script init
+if ! test -r ../utils.sh; then
+	echo "run executable from its own directory: $0"; exit 1; fi
+. ../utils.sh
+Z="`detect_zenroom_path` `detect_zenroom_conf`"
+
+#################
+Elements=${1:-100000}
+Recursion=${2:-10}
+
+# $1 statement
+bench() {
+	bench_time <<EOF
+local function lua_deepmap(fun,t,...)
+   local res = {}
+   for k,v in pairs(t) do
+      if luatype(v) == 'table' then
+	 res[k] = lua_deepmap(fun,v,...)
+      else
+	 res[k] = fun(v,k,...)
+      end
+   end
+   return setmetatable(res, getmetatable(t))
+end
+local function lua_deepcopy(orig)
+   local copy
+   if type(orig) == 'table' then
+      copy = {}
+      for orig_key, orig_value in next, orig, nil do
+	 copy[lua_deepcopy(orig_key)] = lua_deepcopy(orig_value)
+      end
+      setmetatable(copy, lua_deepcopy(getmetatable(orig)))
+   else
+      copy = orig
+   end
+   return copy
+end
+-- dictionaries of 10 elements nested on three levels
+local t = { }
+local n = 0
+while n < $Elements do
+   local d = { }
+   for i=1,10 do
+      local e = { }
+      for j=1,10 do e['k'..j] = O.from_string('v'..j) n = n + 1 end
+      d['d'..i] = e
+   end
+   t['t'..n] = d
+end
+local function id(v) return v end
+for i=1,$Recursion do
+  $1
+end
+EOF
+}
+
+echo "operation,lua,c"
+base=`bench ""`
+for op in deepmap deepcopy guard; do
+	case $op in
+		deepmap) tl=`bench "lua_deepmap(id, t)"`; tc=`bench "deepmap(id, t)"` ;;
+		deepcopy) tl=`bench "lua_deepcopy(t)"`; tc=`bench "deepcopy(t)"` ;;
+		# heapguard pass on each statement
+		guard) tl=`bench "lua_deepmap(zenguard, t)"`; tc=`bench "deepmap_inplace(zenguard, t)"` ;;
+	esac
+	echo "$op,`bench_diff $tl $base $(( Recursion * 1000 )) 2`,`bench_diff $tc $base $(( Recursion * 1000 )) 2`"
+done
@@ -0,0 +1,81 @@
+#!/usr/bin/env bash
+
+# Time the proximity tracing of DP-3T on a list of infected day keys:
+# with the nested loops the scenario used to run, kept below as
+# reference, and with the native octet set; the ephemeral ids are
+# those of one of the infected
+# usage: ./benchmark_proximity.sh [infected keys] [epoch minutes]
+# prints the best of 3 runs in milliseconds for each
+
+####################
+# common script init
+if ! test -r ../utils.sh; then
+	echo "run executable from its own directory: $0"; exit 1; fi
+. ../utils.sh
+Z="`detect_zenroom_path` `detect_zenroom_conf`"
+
+#################
+Max=${1:-10000}
+Epoch=${2:-15}
+Runs=3
+
+reference() {
+	cat <<'EOF'
+local SHA256 = HASH.new('sha256')
+local function proximity_lua(infected, ephemeral_ids, broadcast_key, epoch)
+   local res = { }
+   local epd = (24*60)/epoch
+   -- AES.ctr used to encrypt only the first block of this buffer
+   local zero = OCTET.zero(16)
+   for n,sk in ipairs(infected) do
+	  local PRF = SHA256:hmac(sk, broadcast_key)
+	  for i = 0,epd,1 do
+		 local PRG = OCTET.chop( AES.ctr(PRF, zero, O.from_number(i)), 16)
+		 for nn,eph in next, ephemeral_ids, nil do
+			if eph == PRG then table.insert(res, sk) end
+		 end
+	  end
+   end
+   return res
+end
+local function proximity_set(infected, ephemeral_ids, broadcast_key, epoch)
+   local res = { }
+   local epd = math.floor((24*60)/epoch)
+   local zero = OCTET.zero((epd+1)*16)
+   local ids = OCTET.set(ephemeral_ids)
+   for n,sk in ipairs(infected) do
+	  local PRG = AES.ctr(SHA256:hmac(sk, broadcast_key), zero, O.from_number(0))
+	  for i = 1, ids:count_chunks(PRG, 16) do table.insert(res, sk) end
+   end
+   return res
+end
+EOF
+}
+
+# $1 number of infected keys, $2 statement
+bench() {
+	{ reference; cat <<EOF
+local BK = O.from_string('Broadcast key')
+local infected = { }
+for i=1,$1 do infected[i] = sha256(O.from_string('infected '..i)) end
+local PRG = AES.ctr(SHA256:hmac(infected[1], BK),
+                    OCTET.zero((math.floor(1440/$Epoch)+1)*16), O.from_number(0))
+local ids = { }
+for i=1,#PRG,16 do ids[#ids+1] = PRG:sub(i, i+15) end
+$2
+EOF
+	} | bench_time
+}
+
+echo "infected keys (epoch $Epoch),lua loops,octet set"
+for n in 10 100 1000 $Max; do
+	base=`bench $n ""`
+	l="-"
+	# the nested loops take minutes beyond
+	if [ $n -le 1000 ]; then
+		l=`bench $n "assert(#proximity_lua(infected, ids, BK, $Epoch) == #ids)"`
+		l=`bench_diff $l $base`
+	fi
+	s=`bench $n "assert(#proximity_set(infected, ids, BK, $Epoch) == #ids)"`
+	echo "$n,$l,`bench_diff $s $base`"
+done
@@ -92,6 +92,10 @@ and I create the proximity tracing of infected ids
 and debug
 Then print the 'proximity tracing'
 EOF
+# the infected picked above is found once for each of its ephemeral ids
+test "`jq '.proximity_tracing | length' SK_proximity.json`" = \
+	 "`jq '.ephemeral_ids | length' EphID_infected.json`"
+test "`jq -r '.proximity_tracing | unique | length' SK_proximity.json`" = 1
 
 # given a list of infected and a list of ephemeral ids 
 # cat <<EOF | zexe -c memmanager=sys -z -a $D/SK_infected_20k.json -k $D/EphID_2.json
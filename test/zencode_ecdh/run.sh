@@ -157,6 +157,61 @@ Then print the string 'Signature is valid'
 and print the 'message'
 EOF
 
+cat <<EOF | save ecdh messages.json
+{ "messages": [ "Hello World!", "Hello Zenroom!", "Hello Alice!" ] }
+EOF
+
+cat <<EOF | zexe sign_array_alice.zen -k alice_keys.json -a messages.json | save ecdh sign_array_alice.json
+Rule check version 2.0.0
+Scenario 'ecdh'
+Given that I am known as 'Alice'
+and I have my 'keyring'
+and I have a 'string array' named 'messages'
+When I create the copy of element '1' in array 'messages'
+and I create the signature of 'copy'
+and I rename the 'signature' to 'signature 1'
+and I remove 'copy'
+When I create the copy of element '2' in array 'messages'
+and I create the signature of 'copy'
+and I rename the 'signature' to 'signature 2'
+and I remove 'copy'
+When I create the copy of element '3' in array 'messages'
+and I create the signature of 'copy'
+and I rename the 'signature' to 'signature 3'
+When I create the new array
+and I rename the 'new array' to 'signatures'
+and I insert 'signature 1' in 'signatures'
+and I insert 'signature 2' in 'signatures'
+and I insert 'signature 3' in 'signatures'
+Then print the 'messages'
+and print the 'signatures'
+EOF
+
+cat <<EOF | zexe verify_array_alice.zen -k alice_pubkey.json -a sign_array_alice.json | jq .
+Rule check version 2.0.0
+Scenario 'ecdh'
+Given I have a 'ecdh public key' from 'Alice'
+and I have a 'string array' named 'messages'
+and I have a 'signature array' named 'signatures'
+When I verify the array 'messages' has signatures in 'signatures' by 'Alice'
+Then print string 'Signatures are valid'
+EOF
+
+# tamper the second message
+jq '.messages[1] = "Hello Bob!"' sign_array_alice.json > sign_array_tampered.json
+
+cat <<EOF | zexe verify_array_alice_fail.zen -k alice_pubkey.json -a sign_array_tampered.json | jq .
+Rule check version 2.0.0
+Scenario 'ecdh'
+Given I have a 'ecdh public key' from 'Alice'
+and I have a 'string array' named 'messages'
+and I have a 'signature array' named 'signatures'
+If I verify the array 'messages' has signatures in 'signatures' by 'Alice'
+Then print string 'Signatures are valid'
+EndIf
+Then print string 'Signatures are not valid'
+EOF
+
 success
 
 rm *.json *.zen
@@ -0,0 +1,49 @@
+#!/usr/bin/env bash
+
+# Compare hashing Ethereum addresses one at a time and in batch
+# usage: ./benchmark_keccak.sh [number of public keys]
+# prints the mean time per address in microseconds
+
+####################
+# common script init
+if ! test -r ../utils.sh; then
+	echo "run executable from its own directory: $0"; exit 1; fi
+. ../utils.sh
+Z="`detect_zenroom_path` `detect_zenroom_conf`"
+
+#################
+# Change 'Keys' to change the amount of addresses computed
+Keys=${1:-4000}
+
+# time the given statement over the same array of public keys,
+# the AVX2 switch is shared by the post-quantum and keccak code
+bench() {
+	bench_time <<EOF
+ETH = require'crypto_ethereum'
+QP = require'qp'
+QP.implementation('$1')
+local pks = {}
+local pk = ECDH.keygen().public
+for i=1,$Keys do pks[i] = pk end
+$2
+EOF
+}
+
+impls="clean"
+if [ "`echo "print(require'qp'.implementation())" | $Z 2>/dev/null`" == "avx2" ]; then
+	impls="clean avx2"
+fi
+
+single='for i=1,#pks do ETH.address_from_public_key(pks[i]) end'
+batch='ETH.address_from_public_keys(pks)'
+
+echo "method,`echo $impls | tr ' ' ','`"
+for method in single batch; do
+	line="$method"
+	for impl in $impls; do
+		base=`bench $impl ""`
+		t=`bench $impl "${!method}"`
+		line="$line,`bench_diff $t $base $Keys 2`"
+	done
+	echo "$line"
+done
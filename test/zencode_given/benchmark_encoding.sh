@@ -0,0 +1,49 @@
+#!/usr/bin/env bash
+
+# Compare the detection of input encodings done by checking each
+# encoding in turn (as str() did) and then decoding, with the single
+# scan of OCTET.from_auto, on encoded strings of growing size (up to
+# 1MB of base64, the largest from_base64 accepts)
+# usage: ./benchmark_encoding.sh [iterations]
+# prints the mean time in microseconds
+
+####################
+# common script init
+if ! test -r ../utils.sh; then
+	echo "run executable from its own directory: $0"; exit 1; fi
+. ../utils.sh
+Z="`detect_zenroom_path` `detect_zenroom_conf`"
+
+#################
+# Change 'Recursion' to change the amount of iterations per operation
+Recursion=${1:-100}
+
+# $1 bytes, $2 encoding, $3 statement
+bench() {
+	bench_time <<EOF
+local s = O.random($1):$2()
+local function chain(s)
+   if O.is_url64(s) then return O.from_url64(s)
+   elseif O.is_base64(s) then return O.from_base64(s)
+   elseif O.is_base58(s) then return O.from_base58(s)
+   elseif O.is_hex(s) then return O.from_hex(s)
+   elseif O.is_bin(s) then return O.from_bin(s) end
+   return O.from_string(s)
+end
+for i=1,$Recursion do
+  $3
+end
+EOF
+}
+
+echo "bytes,encoding,chain,auto"
+for size in 1024 65536 786432; do
+	for enc in url64 base64 hex bin; do
+		# binary strings are eight times the size
+		[ "$enc" == "bin" ] && n=$(( size / 8 )) || n=$size
+		base=`bench $n $enc ""`
+		tc=`bench $n $enc "chain(s)"`
+		ta=`bench $n $enc "O.from_auto(s)"`
+		echo "$n,$enc,`bench_diff $tc $base $Recursion 2`,`bench_diff $ta $base $Recursion 2`"
+	done
+done
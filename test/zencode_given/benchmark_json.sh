@@ -0,0 +1,73 @@
+#!/usr/bin/env bash
+
+# Compare the C JSON decoder with the previous Lua decoding path
+# (jsontok split and json.lua parser) on DATA of growing size
+# usage: ./benchmark_json.sh [max number of objects] [iterations]
+# prints the input size in bytes and the mean decoding time in milliseconds
+
+####################
+# common script init
+if ! test -r ../utils.sh; then
+	echo "run executable from its own directory: $0"; exit 1; fi
+. ../utils.sh
+Z="`detect_zenroom_path` `detect_zenroom_conf`"
+
+#################
+Max=${1:-4000}
+Recursion=${2:-10}
+
+# $1 number of objects, $2 decoding statement
+bench() {
+	bench_time <<EOF
+local t = { }
+for i=1,$1 do
+   t['key'..i] = { public_key = O.random(65):base64(),
+		   signature = { r = O.random(32):hex(), s = O.random(32):hex() },
+		   amount = i, tags = { 'a', 'b', 'c' } }
+end
+local data = JSON.encode(t)
+-- concatenate objects as in DATA with multiple sources
+data = data .. '\n' .. JSON.encode({ extra = O.random(32):hex() })
+-- previous decoding path
+local function lua_decode(data)
+   local res = {}
+   local right = data
+   local left, tmp
+   while right do
+      left, right = jsontok(right)
+      if not left then break end
+      tmp = JSON.raw_decode(left)
+      for k,v in pairs(tmp) do
+	 if type(k)=='number' then
+	    res.array = res.array or {}
+	    table.insert(res.array, v)
+	 else res[k] = v end
+      end
+   end
+   return res
+end
+for i=1,$Recursion do
+  $2
+end
+EOF
+}
+
+size() {
+	$Z 2>/dev/null <<EOF
+local t = { }
+for i=1,$1 do
+   t['key'..i] = { public_key = O.random(65):base64(),
+		   signature = { r = O.random(32):hex(), s = O.random(32):hex() },
+		   amount = i, tags = { 'a', 'b', 'c' } }
+end
+print(#JSON.encode(t) + 1 + #JSON.encode({ extra = O.random(32):hex() }))
+EOF
+}
+
+echo "objects,bytes,lua,c"
+for n in 100 1000 $Max; do
+	base=`bench $n ""`
+	tl=`bench $n "lua_decode(data)"`
+	tc=`bench $n "JSON.decode(data)"`
+	echo "$n,`size $n`,`bench_diff $tl $base $(( Recursion * 1000 )) 2`,`bench_diff $tc $base $(( Recursion * 1000 )) 2`"
+done
@@ -0,0 +1,57 @@
+#!/usr/bin/env bash
+
+# Compare hashing with a new HASH object per call and with HASH.digest
+# usage: ./benchmark_digest.sh [iterations]
+# prints the mean time in microseconds and the Lua heap allocated in
+# bytes per call (garbage collection is stopped while measuring). Each
+# HASH.new also allocates the hash state on the C heap (at least one
+# more malloc per call) which HASH.digest keeps on the stack.
+
+####################
+# common script init
+if ! test -r ../utils.sh; then
+	echo "run executable from its own directory: $0"; exit 1; fi
+. ../utils.sh
+Z="`detect_zenroom_path` `detect_zenroom_conf`"
+
+#################
+# Change 'Recursion' to change the amount of iterations per operation
+Recursion=${1:-10000}
+
+# $1 statement, prints time used
+bench() {
+	bench_time <<EOF
+local msg = O.random(64)
+for i=1,$Recursion do
+  $1
+end
+EOF
+}
+
+# $1 statement, prints bytes allocated per call
+heap() {
+	$Z 2>/dev/null <<EOF
+local msg = O.random(64)
+collectgarbage('collect')
+collectgarbage('stop')
+local before = collectgarbage('count')
+for i=1,$Recursion do
+  $1
+end
+print(string.format('%.1f', (collectgarbage('count') - before) * 1024 / $Recursion))
+EOF
+}
+
+echo "algo,method,time,heap"
+for algo in sha256 sha512 keccak256 ripemd160; do
+	base=`bench ""`
+	for method in new digest; do
+		if [ "$method" == "new" ]; then
+			op="HASH.new('$algo'):process(msg)"
+		else
+			op="HASH.digest('$algo', msg)"
+		fi
+		t=`bench "$op"`
+		echo "$algo,$method,`bench_diff $t $base $Recursion 2`,`heap "$op"`"
+	done
+done
@@ -0,0 +1,62 @@
+#!/usr/bin/env bash
+
+# Compare size and speed of JSON with base64 octets against the
+# MessagePack and CBOR binary formats carrying raw octets
+# usage: ./benchmark_formats.sh [max number of objects] [iterations]
+# prints the encoded size in bytes and the mean time in milliseconds
+# to encode and to decode back into octets
+
+####################
+# common script init
+if ! test -r ../utils.sh; then
+	echo "run executable from its own directory: $0"; exit 1; fi
+. ../utils.sh
+Z="`detect_zenroom_path` `detect_zenroom_conf`"
+
+#################
+Max=${1:-4000}
+Recursion=${2:-10}
+
+# $1 number of objects, $2 statement
+bench() {
+	bench_time <<EOF
+local t = { }
+for i=1,$1 do
+   t['key'..i] = { public_key = O.random(65),
+		   signature = { r = O.random(32), s = O.random(32) },
+		   amount = i }
+end
+local json = json_encode(t, 'base64')
+local mpack = mpack_encode(t)
+local cbor = cbor_encode(t)
+for i=1,$Recursion do
+  $2
+end
+EOF
+}
+
+# $1 number of objects, $2 encoder
+size() {
+	$Z 2>/dev/null <<EOF
+local t = { }
+for i=1,$1 do
+   t['key'..i] = { public_key = O.random(65),
+		   signature = { r = O.random(32), s = O.random(32) },
+		   amount = i }
+end
+print(#$2)
+EOF
+}
+
+# $1 time, $2 base time
+ms() {
+	bench_diff $1 $2 $(( Recursion * 1000 )) 2
+}
+
+echo "objects,format,bytes,encode,decode"
+for n in 100 1000 $Max; do
+	base=`bench $n ""`
+	echo "$n,json,`size $n "json_encode(t, 'base64')"`,`ms $(bench $n "json_encode(t, 'base64')") $base`,`ms $(bench $n "json_decode(json, 'base64')") $base`"
+	echo "$n,mpack,`size $n "mpack_encode(t)"`,`ms $(bench $n "mpack_encode(t)") $base`,`ms $(bench $n "mpack_decode(mpack)") $base`"
+	echo "$n,cbor,`size $n "cbor_encode(t)"`,`ms $(bench $n "cbor_encode(t)") $base`,`ms $(bench $n "cbor_decode(cbor)") $base`"
+done
@@ -0,0 +1,69 @@
+#!/usr/bin/env bash
+
+# Compare zstd compression levels and dictionaries on small JSON payloads
+# like the ones packed by "create the zpack of ''"
+# usage: ./benchmark_zstd.sh [iterations]
+# prints ratio and mean time of compression and decompression in microseconds
+
+####################
+# common script init
+if ! test -r ../utils.sh; then
+	echo "run executable from its own directory: $0"; exit 1; fi
+. ../utils.sh
+Z="`detect_zenroom_path` `detect_zenroom_conf`"
+
+#################
+# Change 'Recursion' to change the amount of iterations per operation
+Recursion=${1:-1000}
+
+# $1 level, $2 dictionary (or nil), $3 statement
+bench() {
+	bench_time <<EOF
+local function block(n)
+   return O.from_string(JSON.encode({
+      hash = sha256(O.from_string('block'..n)):hex(),
+      parentHash = sha256(O.from_string('block'..(n-1))):hex(),
+      number = string.format('0x%x', n),
+      timestamp = string.format('0x%x', 1652271067 + n),
+      miner = '0x0000000000000000000000000000000000000000',
+      difficulty = '0x2', gasUsed = '0x0', gasLimit = '0x7a1200' }))
+end
+local msg = block(72691)
+local dict = $2
+local c = compress(msg, $1, dict)
+for i=1,$Recursion do
+  $3
+end
+EOF
+}
+
+ratio() {
+	$Z 2>/dev/null <<EOF
+local function block(n)
+   return O.from_string(JSON.encode({
+      hash = sha256(O.from_string('block'..n)):hex(),
+      parentHash = sha256(O.from_string('block'..(n-1))):hex(),
+      number = string.format('0x%x', n),
+      timestamp = string.format('0x%x', 1652271067 + n),
+      miner = '0x0000000000000000000000000000000000000000',
+      difficulty = '0x2', gasUsed = '0x0', gasLimit = '0x7a1200' }))
+end
+local msg = block(72691)
+local dict = $2
+print(string.format('%.3f', #compress(msg, $1, dict) / #msg))
+EOF
+}
+
+# a dictionary made of a few previous payloads
+dict="block(72690)..block(72689)..block(72688)"
+
+echo "level,dictionary,ratio,compress,decompress"
+for level in 1 3 9 19 22; do
+	for d in nil "$dict"; do
+		base=`bench $level "$d" ""`
+		tc=`bench $level "$d" "compress(msg, $level, dict)"`
+		td=`bench $level "$d" "decompress(c, dict)"`
+		[ "$d" == "nil" ] && dn=no || dn=yes
+		echo "$level,$dn,`ratio $level "$d"`,`bench_diff $tc $base $Recursion 2`,`bench_diff $td $base $Recursion 2`"
+	done
+done
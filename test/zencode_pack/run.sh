@@ -80,6 +80,78 @@ Then print the string 'ZPACK SUCCESS'
 EOF
 
 
+# a dictionary made of a sample payload helps small similar messages
+cat << EOF | save zenswarm zpack_dictionary.json
+{ "dictionary": "{\"hash\":\"0x7ecfebbf3af7d1a93bbcf5dbd2c756de2cad823708fea8e10e3e811950d7726a\",\"number\":\"0x11bf2\",\"parentHash\":\"0x56e81f171bcc55a6ff8345e692c0f86e5b48e01b996cadc001622fb5e363b421\",\"timestamp\":\"0x627ba95b\"}" }
+EOF
+
+cat << EOF | zexe zpack_dict.zen -a newblock.json -k zpack_dictionary.json | save zenswarm zpack_dict.json
+Given I have a 'hex dictionary' named 'newblock'
+and I have a 'string' named 'dictionary'
+When I create the zpack of 'newblock' with dictionary 'dictionary'
+Then print the 'zpack' as 'base64'
+EOF
+
+jq -s '.[0]*.[1]' zpack_dict.json zpack_dictionary.json | save zenswarm zpack_dict_data.json
+
+cat << EOF | zexe zunpack_dict.zen -a newblock.json -k zpack_dict_data.json
+Given I have a 'base64' named 'zpack'
+and I have a 'string' named 'dictionary'
+and I have a 'hex dictionary' named 'newblock'
+When I create the 'decoded' decoded from zpack 'zpack' with dictionary 'dictionary'
+and I verify 'decoded' is equal to 'newblock'
+Then print the string 'ZPACK DICTIONARY SUCCESS'
+EOF
+
+
+# binary input and output formats: octets are carried as raw bytes
+for format in mpack cbor; do
+cat << EOF | zexe output_$format.zen | save zenswarm output.$format
+rule output format $format
+Given nothing
+When I set 'oct' to 'deadbeef' as 'hex'
+When I write string 'hello' in 'str'
+When I set 'num' to '42' as 'number'
+Then print the 'oct'
+Then print the 'str'
+Then print the 'num'
+EOF
+
+res=`cat << EOF | zexe input_$format.zen -a output.$format
+rule input format $format
+Given I have a 'hex' named 'oct'
+Given I have a 'string' named 'str'
+Given I have a 'number' named 'num'
+Then print the 'oct'
+Then print the 'str'
+Then print the 'num'
+EOF`
+if [ "$res" != '{"num":42,"oct":"deadbeef","str":"hello"}' ]; then
+	>&2 echo "$format input and output format failed: $res"
+	exit 1
+fi
+done
+
+# binary data with zero bytes, loaded as an octet without copies
+cat << EOF | zexe output_zeros.zen | save zenswarm zeros.mpack
+rule output format mpack
+Given nothing
+When I set 'oct' to '00ff000000' as 'hex'
+When I write string 'zero' in 'str'
+Then print the 'oct'
+Then print the 'str'
+EOF
 
+res=`cat << EOF | Z="$Z -c input=octet" zexe input_zeros.zen -a zeros.mpack
+rule input format mpack
+Given I have a 'hex' named 'oct'
+Given I have a 'string' named 'str'
+Then print the 'oct'
+Then print the 'str'
+EOF`
+if [ "$res" != '{"oct":"00ff000000","str":"zero"}' ]; then
+	>&2 echo "binary input as octet failed: $res"
+	exit 1
+fi
 
 success
@@ -0,0 +1,57 @@
+#!/usr/bin/env bash
+
+# Compare the clean and AVX2 implementations of Dilithium2 and Kyber512
+# usage: ./benchmark_avx2.sh [iterations]
+# prints the mean time of each operation in microseconds
+
+####################
+# common script init
+if ! test -r ../utils.sh; then
+	echo "run executable from its own directory: $0"; exit 1; fi
+. ../utils.sh
+Z="`detect_zenroom_path` `detect_zenroom_conf`"
+
+#################
+# Change 'Recursion' to change the amount of iterations per operation
+Recursion=${1:-1000}
+
+# $1 implementation, $2 statement
+bench() {
+	bench_time <<EOF
+QP = require'qp'
+QP.implementation('$1')
+local msg = O.random(512)
+local kp = QP.sigkeygen()
+local sig = QP.sign(kp.private, msg)
+local kkp = QP.kemkeygen()
+local ct = QP.enc(kkp.public).cipher
+for i=1,$Recursion do
+  $2
+end
+EOF
+}
+
+declare -A ops=(
+	[sigkeygen]="QP.sigkeygen()"
+	[sign]="QP.sign(kp.private, msg)"
+	[verify]="QP.verify(kp.public, sig, msg)"
+	[kemkeygen]="QP.kemkeygen()"
+	[enc]="QP.enc(kkp.public)"
+	[dec]="QP.dec(kkp.private, ct)"
+)
+
+impls="clean"
+if [ "`echo "print(require'qp'.implementation())" | $Z 2>/dev/null`" == "avx2" ]; then
+	impls="clean avx2"
+fi
+
+echo "op,`echo $impls | tr ' ' ','`"
+for op in sigkeygen sign verify kemkeygen enc dec; do
+	line="$op"
+	for impl in $impls; do
+		base=`bench $impl ""`
+		t=`bench $impl "${ops[$op]}"`
+		line="$line,`bench_diff $t $base $Recursion 2`"
+	done
+	echo "$line"
+done
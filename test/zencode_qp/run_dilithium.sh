@@ -126,6 +126,32 @@ Then print string 'Zenroom certifies that signatures are all correct!'
 EOF
 
 
+#--- batch signatures of an array of messages ---#
+cat <<EOF | zexe Dilithium_sign_batch.zen -k Alice_Dilithium_privatekey.keys -a message.json | save $SUBDOC Alice_Dilithium_sign_batch.json
+Rule check version 2.0.0
+Scenario qp : Alice signs each message in the array
+Given that I am known as 'Alice'
+and I have the 'keyring'
+and I have a 'string array' named 'message array'
+When I create the dilithium signatures of each object in 'message array'
+Then print the 'dilithium signatures'
+and print the 'message array'
+EOF
+
+jq -s '.[0]*.[1]' Alice_Dilithium_pubkey.json Alice_Dilithium_sign_batch.json | save $SUBDOC Alice_Dilithium_batch_data.json
+
+cat <<EOF | zexe Dilithium_verify_batch.zen -a Alice_Dilithium_batch_data.json
+Rule check version 2.0.0
+Scenario qp : Bob verifies all Alice signatures at once
+Given that I am known as 'Bob'
+and I have a 'dilithium public key' from 'Alice'
+and I have a 'string array' named 'message array'
+and I have a 'base64 array' named 'dilithium signatures'
+When I verify the array 'message array' has dilithium signatures in 'dilithium signatures' by 'Alice'
+Then print string 'Zenroom certifies that signatures are all correct!'
+EOF
+
+
 
 #--- Test for multiple Dilithium keys ---#
 cat <<EOF | zexe Eve_Dilithium_pubkey.zen | save $SUBDOC Eve_Dilithium_pubkey.json
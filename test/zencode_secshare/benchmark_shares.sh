@@ -0,0 +1,95 @@
+#!/usr/bin/env bash
+
+# Time the creation and composition of secret shares for a growing
+# number of shares (quorum is half of them): with the former Lua
+# code, one BIG per modular operation and an inversion per share
+# (only up to 100 shares, it takes minutes at 1000), and with
+# crypto_lagrange_interpolation.lua, which runs in C.
+# usage: ./benchmark_shares.sh [runs]
+# prints the best run in milliseconds for each
+
+####################
+# common script init
+if ! test -r ../utils.sh; then
+	echo "run executable from its own directory: $0"; exit 1; fi
+. ../utils.sh
+Z="`detect_zenroom_path` `detect_zenroom_conf`"
+
+#################
+Runs=${1:-3}
+
+reference() {
+	cat <<'EOF'
+local P = BIG.new(O.from_hex('ffffffffffffffffffffffffffffffffffffffffffffffffffffffffffffff43'))
+function lua_create(total, quorum, secret)
+   local coeff = { BIG.new(secret) }
+   for i=2,quorum do coeff[i] = BIG.modrand(P) end
+   local shares = { }
+   for i=1,total do
+      local x
+      repeat
+	 x = BIG.modrand(P)
+	 if x ~=0 then
+	    for _, k in pairs(shares) do
+	       if x == k then x = 0 end
+	    end
+	 end
+      until x ~= 0
+      local y = coeff[1]
+      local x_n = BIG.new(1)
+      for n=2,quorum do
+	 x_n = x_n:modmul(x, P)
+	 y = BIG.mod(BIG.add(y, coeff[n]:modmul(x_n, P)), P)
+      end
+      table.insert(shares, {x = x, y = y})
+   end
+   return shares
+end
+function lua_compose(shares)
+   local sec = BIG.new(0)
+   local quorum = #shares
+   for i = 1,quorum do
+      local num = BIG.new(1)
+      local den = BIG.new(1)
+      for j = 1,quorum do
+	 if j~=i then
+	    num = num:modmul(shares[j].x, P)
+	    den = den:modmul((shares[i].x):modsub(shares[j].x, P), P)
+	 end
+      end
+      sec = BIG.mod(BIG.add(sec, (shares[i].y):modmul(num:moddiv(den, P), P)), P)
+   end
+   return sec
+end
+EOF
+}
+
+# $1 statements
+bench() {
+	{ reference; cat <<EOF
+local LI = require_once('crypto_lagrange_interpolation')
+local secret = O.from_hex('640e744984d511506a3ea1e52417c0a49caa11762626c7cae8f5302138205a07')
+$1
+EOF
+	} | bench_time
+}
+
+echo "shares,lua create,lua compose,create,compose"
+for n in 10 100 1000 10000; do
+	q=$(( n / 2 ))
+	base=`bench ""`
+	lc="-"; lp="-"
+	if [ $n -le 100 ]; then
+		lc=`bench "local sh = lua_create($n, $q, secret)"`
+		lp=`bench "local sh = lua_create($n, $q, secret)
+local sub = { table.unpack(sh, 1, $q) }
+lua_compose(sub)"`
+		lp=`bench_diff $lp $lc`
+		lc=`bench_diff $lc $base`
+	fi
+	c=`bench "local sh = LI.create_shared_secret($n, $q, secret)"`
+	p=`bench "local sh = LI.create_shared_secret($n, $q, secret)
+local sub = { table.unpack(sh, 1, $q) }
+assert(LI.compose_shared_secret(sub):octet() == secret)"`
+	echo "$n,$lc,$lp,`bench_diff $c $base`,`bench_diff $p $c`"
+done
@@ -209,3 +209,30 @@ and I verify 'original secret' is equal to 'secret'
 Then print string 'SECRETS MATCH'
 EOF
 
+
+# an even quorum, recomposed from a subset of the shares
+cat <<EOF | zexe even_quorum.zen -k 32secret.json | save secshare even_shares.json
+Rule check version 2.0.0
+Scenario secshare: create a shared secret
+
+Given I have a 'hex' named 'secret'
+
+When I create the secret shares of 'secret' with '6' quorum '4'
+
+Then print the 'secret shares'
+EOF
+jq '.secret_shares |= .[1:5]' even_shares.json > even_subset.json
+
+cat <<EOF | zexe even_compose.zen -k even_subset.json -a 32secret.json | jq .
+Rule check version 2.0.0
+Scenario secshare: compose a shared secret
+
+Given I have a 'secret shares'
+and I have a 'hex' named 'secret'
+
+When I rename 'secret' to 'original secret'
+and I compose the secret using 'secret shares'
+and I verify 'original secret' is equal to 'secret'
+
+Then print string 'SECRETS MATCH'
+EOF
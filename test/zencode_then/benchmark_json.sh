@@ -0,0 +1,55 @@
+#!/usr/bin/env bash
+
+# Compare the C JSON encoder with the previous Lua encoding path
+# (INSPECT.process and json.lua) on OUT tables of growing size
+# usage: ./benchmark_json.sh [max number of objects] [iterations]
+# prints the output size in bytes and the mean encoding time in milliseconds
+
+####################
+# common script init
+if ! test -r ../utils.sh; then
+	echo "run executable from its own directory: $0"; exit 1; fi
+. ../utils.sh
+Z="`detect_zenroom_path` `detect_zenroom_conf`"
+
+#################
+Max=${1:-4000}
+Recursion=${2:-10}
+
+# $1 number of objects, $2 encoding statement
+bench() {
+	bench_time <<EOF
+local t = { }
+for i=1,$1 do
+   t['key'..i] = { public_key = O.random(65),
+		   signature = { r = O.random(32), s = BIG.random() },
+		   amount = i, tags = { 'a', 'b', 'c' } }
+end
+for i=1,$Recursion do
+  $2
+end
+EOF
+}
+
+# $1 number of objects, $2 encoding
+size() {
+	$Z 2>/dev/null <<EOF
+local t = { }
+for i=1,$1 do
+   t['key'..i] = { public_key = O.random(65),
+		   signature = { r = O.random(32), s = BIG.random() },
+		   amount = i, tags = { 'a', 'b', 'c' } }
+end
+print(#JSON.encode(t, '$2'))
+EOF
+}
+
+echo "objects,encoding,bytes,lua,c"
+for n in 100 1000 $Max; do
+	base=`bench $n ""`
+	for enc in base64 hex; do
+		tl=`bench $n "JSON.raw_encode(INSPECT.process(t, '$enc'))"`
+		tc=`bench $n "JSON.encode(t, '$enc')"`
+		echo "$n,$enc,`size $n $enc`,`bench_diff $tl $base $(( Recursion * 1000 )) 2`,`bench_diff $tc $base $(( Recursion * 1000 )) 2`"
+	done
+done
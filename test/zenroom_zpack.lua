@@ -1,14 +1,7 @@
 print''
 print("TEST ZPACK (msgpack + ZSTD)")
 print''
-OCTET = require'zenroom_octet'
-ECP = require('zenroom_ecp')
-ECP2 = require('zenroom_ecp2')
-BIG = require('zenroom_big')
 MPACK = require'zenroom_msgpack'
-ZPACK = require'zenroom_zpack'
-ZEN = require'zencode'
-HASH = require'zenroom_hash'
 
 G = ECP.generator()
 salt = ECP.hashtopoint("Constant random string")
@@ -35,12 +28,38 @@ res_hash = sha256( ZEN.serialize(d) ):hex()
 print( "DEC SHA256: ".. res_hash)
 assert( res_hash == test_hash, "msgpack encoding and decoding mismatch")
 
-zc = ZPACK.encode(test)
-zd = ZPACK.decode(zc)
+sm = O.from_rawlen(sm, #sm)
+zc = compress(sm)
+zd = MPACK.decode( decompress(zc):string() )
 res_hash = sha256( ZEN.serialize(zd) ):hex()
 print ("ZDEC SHA256:"..res_hash)
 print("uncompressed size: "..#sm)
 print("compressed size:   "..#zc)
 print("compression ration: ".. (#zc / #sm))
 assert( res_hash == test_hash, "zpack encoding and decoding mismatch")
+
+print''
+print("TEST ZSTD levels, dictionaries and streaming")
+-- highly compressible input used to overflow the old 3x output guess
+local big = O.from_string(string.rep('zenroom ', 4096))
+for _,l in ipairs({1, 3, 9, 19}) do
+   local c = compress(big, l)
+   print("level "..l..": "..#big.." -> "..#c)
+   assert(decompress(c) == big, "zstd level "..l.." roundtrip failed")
+end
+-- concatenated frames are decompressed by streaming
+local a = O.from_string(string.rep('a', 1000))
+local b = O.from_string(string.rep('b', 1000))
+assert(decompress(compress(a)..compress(b)) == a..b,
+       "zstd concatenated frames roundtrip failed")
+-- a raw content dictionary shared by similar small payloads
+local dict = O.from_string('{"hash":"0x75e602c49a900cf3b92113f4c09db2cd543345347c83986524b694262310e74c","number":"0x11bf3"}')
+local msg = O.from_string('{"hash":"0x7ecfebbf3af7d1a93bbcf5dbd2c756de2cad823708fea8e10e3e811950d7726a","number":"0x11bf4"}')
+local cd = compress(msg, nil, dict)
+print("dictionary: "..#compress(msg).." -> "..#cd)
+assert(#cd < #compress(msg), "zstd dictionary did not improve ratio")
+assert(decompress(cd, dict) == msg, "zstd dictionary roundtrip failed")
+assert(decompress(compress(msg)) == msg, "zstd context not reset after dictionary")
+assert(decompress(cd..compress(msg), dict) == msg..msg,
+       "zstd streaming with dictionary failed")
 print''